@@ -26,6 +26,7 @@
 #include "ApplicationMessenger.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
+#include "utils/StartupTimeline.h"
 #ifdef TARGET_WINDOWS
 #include "WIN32Util.h"
 #endif
@@ -107,6 +108,7 @@ void CAppParamParser::DisplayHelp()
   printf("  --test\t\tEnable test mode. [FILE] required.\n");
   printf("  --settings=<filename>\t\tLoads specified file after advancedsettings.xml replacing any settings specified\n");
   printf("  \t\t\t\tspecified file must exist in special://xbmc/system/\n");
+  printf("  --trace-startup[=<filename>]\tWrite a Chrome trace of the startup phases, to special://temp/startuptrace.json by default\n");
   exit(0);
 }
 
@@ -137,6 +139,10 @@ void CAppParamParser::ParseArg(const CStdString &arg)
     m_testmode = true;
   else if (arg.substr(0, 11) == "--settings=")
     g_advancedSettings.AddSettingsFile(arg.substr(11));
+  else if (arg == "--trace-startup")
+    CStartupTimeline::Get().SetOutput("");
+  else if (arg.substr(0, 16) == "--trace-startup=")
+    CStartupTimeline::Get().SetOutput(arg.substr(16));
   else if (arg.length() != 0 && arg[0] != '-')
   {
     if (m_testmode)
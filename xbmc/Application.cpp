@@ -314,8 +314,11 @@
 #include "utils/AlarmClock.h"
 #include "utils/RssReader.h"
 #include "utils/StringUtils.h"
+#include "utils/StartupTimeline.h"
+#include "utils/PlaybackTrace.h"
 #include "utils/Weather.h"
 #include "DatabaseManager.h"
+#include "dbwrappers/sqlitedataset.h"
 
 #include "settings/DisplaySettings.h"
 #include "settings/MediaSettings.h"
@@ -582,6 +585,8 @@ void CApplication::Preflight()
 
 bool CApplication::Create()
 {
+  CStartupSpan span("CApplication::Create");
+
 #if defined(HAS_LINUX_NETWORK)
   m_network = new CNetworkLinux();
 #elif defined(HAS_WIN32_NETWORK)
@@ -726,13 +731,16 @@ bool CApplication::Create()
   g_powerManager.Initialize();
 
   // Load the AudioEngine before settings as they need to query the engine
+  CStartupSpan loadEngineSpan("CAEFactory::LoadEngine");
   if (!CAEFactory::LoadEngine())
   {
     CLog::Log(LOGFATAL, "CApplication::Create: Failed to load an AudioEngine");
     return false;
   }
+  loadEngineSpan.End();
 
   // Initialize default Settings - don't move
+  CStartupSpan settingsSpan("CSettings::Load");
   CLog::Log(LOGNOTICE, "load settings...");
   if (!CSettings::Get().Initialize())
     return false;
@@ -746,6 +754,7 @@ bool CApplication::Create()
     return false;
   }
   CSettings::Get().SetLoaded();
+  settingsSpan.End();
 
   CLog::Log(LOGINFO, "creating subdirectories");
   CLog::Log(LOGINFO, "userdata folder: %s", CProfilesManager::Get().GetProfileUserDataFolder().c_str());
@@ -767,6 +776,7 @@ bool CApplication::Create()
   CStdString strLangInfoPath;
   strLangInfoPath.Format("special://xbmc/language/%s/langinfo.xml", strLanguage.c_str());
 
+  CStartupSpan languageSpan("CLocalizeStrings::Load");
   CLog::Log(LOGINFO, "load language info file: %s", strLangInfoPath.c_str());
   g_langInfo.Load(strLangInfoPath);
 
@@ -778,13 +788,16 @@ bool CApplication::Create()
     CLog::Log(LOGFATAL, "%s: Failed to load %s language file, from path: %s", __FUNCTION__, strLanguage.c_str(), strLanguagePath.c_str());
     return false;
   }
+  languageSpan.End();
 
   // start the AudioEngine
+  CStartupSpan startEngineSpan("CAEFactory::StartEngine");
   if (!CAEFactory::StartEngine())
   {
     CLog::Log(LOGFATAL, "CApplication::Create: Failed to start the AudioEngine");
     return false;
   }
+  startEngineSpan.End();
 
   // restore AE's previous volume state
   SetHardwareVolume(m_volumeLevel);
@@ -806,11 +819,13 @@ bool CApplication::Create()
 
   // start-up Addons Framework
   // currently bails out if either cpluff Dll is unavailable or system dir can not be scanned
+  CStartupSpan addonsSpan("CAddonMgr::Init");
   if (!CAddonMgr::Get().Init())
   {
     CLog::Log(LOGFATAL, "CApplication::Create: Unable to start CAddonMgr");
     return false;
   }
+  addonsSpan.End();
 
   // set logging from debug add-on
   AddonPtr addon;
@@ -818,7 +833,9 @@ bool CApplication::Create()
   if (addon)
     g_advancedSettings.SetExtraLogsFromAddon(addon.get());
 
+  CStartupSpan peripheralsSpan("CPeripherals::Initialise");
   g_peripherals.Initialise();
+  peripheralsSpan.End();
 
   // Create the Mouse, Keyboard, Remote, and Joystick devices
   // Initialize after loading settings to get joystick deadzone setting
@@ -837,7 +854,9 @@ bool CApplication::Create()
 
   CUtil::InitRandomSeed();
 
+  CStartupSpan mediaManagerSpan("CMediaManager::Initialize");
   g_mediaManager.Initialize();
+  mediaManagerSpan.End();
 
   m_lastFrameTime = XbmcThreads::SystemClockMillis();
   m_lastRenderTime = m_lastFrameTime;
@@ -846,6 +865,8 @@ bool CApplication::Create()
 
 bool CApplication::CreateGUI()
 {
+  CStartupSpan span("CApplication::CreateGUI");
+
   m_renderGUI = true;
 #ifdef HAS_SDL
   CLog::Log(LOGNOTICE, "Setup SDL");
@@ -947,8 +968,10 @@ bool CApplication::CreateGUI()
 
   // The key mappings may already have been loaded by a peripheral
   CLog::Log(LOGINFO, "load keymapping");
+  CStartupSpan keymapSpan("CButtonTranslator::Load");
   if (!CButtonTranslator::GetInstance().Load())
     return false;
+  keymapSpan.End();
 
   RESOLUTION_INFO info = g_graphicsContext.GetResInfo();
   CLog::Log(LOGINFO, "GUI format %ix%i, Display %s",
@@ -1234,6 +1257,8 @@ void CApplication::CreateUserDirs()
 
 bool CApplication::Initialize()
 {
+  CStartupSpan span("CApplication::Initialize");
+
 #if defined(HAS_DVD_DRIVE) && !defined(TARGET_WINDOWS) // somehow this throws an "unresolved external symbol" on win32
   // turn off cdio logging
   cdio_loglevel_default = CDIO_LOG_ERROR;
@@ -1263,7 +1288,9 @@ bool CApplication::Initialize()
   g_curlInterface.Unload();
 
   // initialize (and update as needed) our databases
+  CStartupSpan databasesSpan("CDatabaseManager::Initialize");
   CDatabaseManager::Get().Initialize();
+  databasesSpan.End();
 
   StartServices();
 
@@ -1273,6 +1300,7 @@ bool CApplication::Initialize()
   {
     CSettings::Get().GetSetting("powermanagement.displaysoff")->SetRequirementsMet(m_dpms->IsSupported());
 
+    CStartupSpan windowsSpan("CGUIWindowManager::Add");
     g_windowManager.Add(new CGUIWindowHome);
     g_windowManager.Add(new CGUIWindowPrograms);
     g_windowManager.Add(new CGUIWindowPictures);
@@ -1387,6 +1415,7 @@ bool CApplication::Initialize()
     g_windowManager.Add(new CGUIWindowStartup);
 
     /* window id's 3000 - 3100 are reserved for python */
+    windowsSpan.End();
 
     // Make sure we have at least the default skin
     string defaultSkin = ((const CSettingString*)CSettings::Get().GetSetting("lookandfeel.skin"))->GetDefault();
@@ -1423,6 +1452,7 @@ bool CApplication::Initialize()
       else
       {
         StartPVRManager(false);
+        CStartupSpan activateSpan("CGUIWindowManager::ActivateWindow");
         g_windowManager.ActivateWindow(g_SkinInfo->GetFirstWindow());
       }
 
@@ -1459,6 +1489,13 @@ bool CApplication::Initialize()
 
   CLog::Log(LOGNOTICE, "initialize done");
 
+  // without a gui there is no first frame to wait for
+  if (!g_windowManager.Initialized())
+  {
+    span.End();
+    CStartupTimeline::Get().Finish();
+  }
+
   m_bInitializing = false;
 
   // reset our screensaver (starts timers etc.)
@@ -1538,6 +1575,8 @@ void CApplication::StopPVRManager()
 
 void CApplication::StartServices()
 {
+  CStartupSpan span("CApplication::StartServices");
+
 #if !defined(TARGET_WINDOWS) && defined(HAS_DVD_DRIVE)
   // Start Thread for DVD Mediatype detection
   CLog::Log(LOGNOTICE, "start dvd mediatype detection");
@@ -1770,6 +1809,8 @@ bool CApplication::LoadSkin(const CStdString& skinID)
 
 void CApplication::LoadSkin(const SkinPtr& skin)
 {
+  CStartupSpan span("CApplication::LoadSkin");
+
   string defaultSkin = ((const CSettingString*)CSettings::Get().GetSetting("lookandfeel.skin"))->GetDefault();
   if (!skin)
   {
@@ -1942,6 +1983,8 @@ void CApplication::UnloadSkin(bool forReload /* = false */)
 
 bool CApplication::LoadUserWindows()
 {
+  CStartupSpan span("CApplication::LoadUserWindows");
+
   // Start from wherever home.xml is
   std::vector<CStdString> vecSkinPath;
   g_SkinInfo->GetSkinPaths(vecSkinPath);
@@ -2075,6 +2118,7 @@ void CApplication::Render()
     return;
 
   MEASURE_FUNCTION;
+  CStartupSpan span("CApplication::Render");
 
   int vsync_mode = CSettings::Get().GetInt("videoscreen.vsync");
 
@@ -2196,9 +2240,17 @@ void CApplication::Render()
   m_lastFrameTime = XbmcThreads::SystemClockMillis();
 
   if (flip)
+  {
+    CPlaybackTraceSpan flipSpan("CGraphicContext::Flip");
     g_graphicsContext.Flip(dirtyRegions);
+  }
   CTimeUtils::UpdateFrameTime(flip);
 
+  // the first presented frame ends the startup
+  span.End();
+  if (flip && CStartupTimeline::Get().IsRecording())
+    CStartupTimeline::Get().Finish();
+
   g_renderManager.UpdateResolution();
   g_renderManager.ManageCaptures();
 }
@@ -3443,6 +3495,9 @@ void CApplication::Stop(int exitCode)
     CSFTPSessionManager::DisconnectAllSessions();
 #endif
 
+    // checkpoints the WAL of the databases that were kept open for reuse
+    dbiplus::SqliteDatabase::close_idle_connections();
+
     CLog::Log(LOGNOTICE, "unload skin");
     UnloadSkin();
 
@@ -22,17 +22,59 @@
 #include "FileItem.h"
 #include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 
+#include <algorithm>
+
 using namespace std;
 
-CBackgroundInfoLoader::CBackgroundInfoLoader() : m_thread (NULL)
+// how often the items shown are checked for
+#define PRIORITY_INTERVAL 100
+
+namespace
+{
+  /*! \brief Orders the indices of items by their distance from those shown, the nearest last */
+  class CPriorityOrder
+  {
+  public:
+    CPriorityOrder(int shownStart, int shownEnd) : m_start(shownStart), m_end(shownEnd) {}
+
+    bool operator()(int a, int b) const
+    {
+      int distanceA = Distance(a), distanceB = Distance(b);
+      if (distanceA != distanceB)
+        return distanceA > distanceB;
+      return a > b;
+    }
+
+  private:
+    int Distance(int index) const
+    {
+      if (index < m_start)
+        return m_start - index;
+      if (index > m_end)
+        return index - m_end;
+      return 0;
+    }
+
+    int m_start;
+    int m_end;
+  };
+}
+
+CBackgroundInfoLoader::CBackgroundInfoLoader()
 {
   m_bStop = true;
   m_pObserver=NULL;
   m_pProgressCallback=NULL;
   m_pVecItems = NULL;
   m_bIsLoading = false;
+  m_shownStart = 0;
+  m_shownEnd = 0;
+  m_prioritiesTime = 0;
+  m_bStartCalled = false;
+  m_activeWorkers = 0;
 }
 
 CBackgroundInfoLoader::~CBackgroundInfoLoader()
@@ -44,53 +86,46 @@ void CBackgroundInfoLoader::Run()
 {
   try
   {
-    if (m_vecItems.size() > 0)
     {
-      OnLoaderStart();
-
-      // Stage 1: All "fast" stuff we have already cached
-      for (vector<CFileItemPtr>::const_iterator iter = m_vecItems.begin(); iter != m_vecItems.end(); ++iter)
+      CSingleLock lock(m_lock);
+      if (!m_bStartCalled)
       {
-        CFileItemPtr pItem = *iter;
-
-        // Ask the callback if we should abort
-        if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
-          break;
-
-        try
-        {
-          if (LoadItemCached(pItem.get()) && m_pObserver)
-            m_pObserver->OnItemLoaded(pItem.get());
-        }
-        catch (...)
-        {
-          CLog::Log(LOGERROR, "CBackgroundInfoLoader::LoadItemCached - Unhandled exception for item %s", pItem->GetPath().c_str());
-        }
+        OnLoaderStart();
+        m_bStartCalled = true;
       }
+    }
+
+    // Stage 1: All "fast" stuff we have already cached
+    // Stage 2: All "slow" stuff that we need to lookup
+    while (!m_bStop)
+    {
+      // Ask the callback if we should abort
+      if (m_pProgressCallback && m_pProgressCallback->Abort())
+        break;
+
+      bool lookup;
+      CFileItemPtr pItem = GetNextItem(lookup);
+      if (!pItem)
+        break;
 
-      // Stage 2: All "slow" stuff that we need to lookup
-      for (vector<CFileItemPtr>::const_iterator iter = m_vecItems.begin(); iter != m_vecItems.end(); ++iter)
+      try
       {
-        CFileItemPtr pItem = *iter;
-
-        // Ask the callback if we should abort
-        if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
-          break;
-
-        try
-        {
-          if (LoadItemLookup(pItem.get()) && m_pObserver)
-            m_pObserver->OnItemLoaded(pItem.get());
-        }
-        catch (...)
-        {
-          CLog::Log(LOGERROR, "CBackgroundInfoLoader::LoadItemLookup - Unhandled exception for item %s", pItem->GetPath().c_str());
-        }
+        bool loaded = lookup ? LoadItemLookup(pItem.get()) : LoadItemCached(pItem.get());
+        if (loaded && m_pObserver)
+          m_pObserver->OnItemLoaded(pItem.get());
+      }
+      catch (...)
+      {
+        CLog::Log(LOGERROR, "CBackgroundInfoLoader::%s - Unhandled exception for item %s", lookup ? "LoadItemLookup" : "LoadItemCached", pItem->GetPath().c_str());
       }
     }
 
-    OnLoaderFinish();
-    m_bIsLoading = false;
+    CSingleLock lock(m_lock);
+    if (--m_activeWorkers == 0)
+    {
+      OnLoaderFinish();
+      m_bIsLoading = false;
+    }
   }
   catch (...)
   {
@@ -99,6 +134,64 @@ void CBackgroundInfoLoader::Run()
   }
 }
 
+CFileItemPtr CBackgroundInfoLoader::GetNextItem(bool &lookup)
+{
+  CSingleLock lock(m_lock);
+  UpdatePriorities();
+
+  int index;
+  if (!m_cachedItems.empty())
+  {
+    index = m_cachedItems.back();
+    m_cachedItems.pop_back();
+    // keep the lookups in order too
+    CPriorityOrder order(m_shownStart, m_shownEnd);
+    m_lookupItems.insert(upper_bound(m_lookupItems.begin(), m_lookupItems.end(), index, order), index);
+    lookup = false;
+  }
+  else if (!m_lookupItems.empty())
+  {
+    index = m_lookupItems.back();
+    m_lookupItems.pop_back();
+    lookup = true;
+  }
+  else
+    return CFileItemPtr();
+
+  return m_vecItems[index];
+}
+
+void CBackgroundInfoLoader::UpdatePriorities()
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (now - m_prioritiesTime < PRIORITY_INTERVAL)
+    return;
+  m_prioritiesTime = now;
+
+  // items only have layouts while a container shows them or has them cached around those shown.
+  // this is just a hint, so it's read without the gui lock.
+  int start = -1, end = -1;
+  for (int i = 0; i < (int)m_vecItems.size(); i++)
+  {
+    if (m_vecItems[i]->GetLayout() || m_vecItems[i]->GetFocusedLayout())
+    {
+      if (start < 0)
+        start = i;
+      end = i;
+    }
+  }
+
+  // when nothing is shown keep to the items shown last
+  if (start < 0 || (start == m_shownStart && end == m_shownEnd))
+    return;
+
+  m_shownStart = start;
+  m_shownEnd = end;
+  CPriorityOrder order(m_shownStart, m_shownEnd);
+  sort(m_cachedItems.begin(), m_cachedItems.end(), order);
+  sort(m_lookupItems.begin(), m_lookupItems.end(), order);
+}
+
 void CBackgroundInfoLoader::Load(CFileItemList& items)
 {
   StopThread();
@@ -111,15 +204,32 @@ void CBackgroundInfoLoader::Load(CFileItemList& items)
   for (int nItem=0; nItem < items.Size(); nItem++)
     m_vecItems.push_back(items[nItem]);
 
+  // in the order of the list until a container shows the items
+  for (int nItem = items.Size() - 1; nItem >= 0; nItem--)
+    m_cachedItems.push_back(nItem);
+  m_shownStart = 0;
+  m_shownEnd = 0;
+  m_prioritiesTime = XbmcThreads::SystemClockMillis();
+
   m_pVecItems = &items;
   m_bStop = false;
   m_bIsLoading = true;
+  m_bStartCalled = false;
 
-  m_thread = new CThread(this, "BackgroundLoader");
-  m_thread->Create();
+  // the last worker to finish calls OnLoaderFinish(), so there has to be at least one
+  int workers = 1;
+  if (CanLoadConcurrently())
+    workers = std::max(1, std::min(g_advancedSettings.m_bgInfoLoaderMaxThreads, items.Size()));
+  m_activeWorkers = workers;
+  for (int i = 0; i < workers; i++)
+  {
+    CThread *thread = new CThread(this, "BackgroundLoader");
+    thread->Create();
 #ifndef TARGET_POSIX
-  m_thread->SetPriority(THREAD_PRIORITY_BELOW_NORMAL);
+    thread->SetPriority(THREAD_PRIORITY_BELOW_NORMAL);
 #endif
+    m_workers.push_back(thread);
+  }
 }
 
 void CBackgroundInfoLoader::StopAsync()
@@ -132,13 +242,15 @@ void CBackgroundInfoLoader::StopThread()
 {
   StopAsync();
 
-  if (m_thread)
+  for (vector<CThread*>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
   {
-    m_thread->StopThread();
-    delete m_thread;
-    m_thread = NULL;
+    (*it)->StopThread();
+    delete *it;
   }
+  m_workers.clear();
   m_vecItems.clear();
+  m_cachedItems.clear();
+  m_lookupItems.clear();
   m_pVecItems = NULL;
   m_bIsLoading = false;
 }
@@ -37,6 +37,13 @@ public:
   virtual void OnItemLoaded(CFileItem* pItem) = 0;
 };
 
+/*!
+ \brief Loads the info of the items of a list in the background.
+
+ The cached info of all items is loaded before any is looked up. Items shown by a container are
+ loaded first, then those near them, then the rest of the list, so the items on screen are loaded
+ first after scrolling or jumping through a long list.
+ */
 class CBackgroundInfoLoader : public IRunnable
 {
 public:
@@ -52,22 +59,44 @@ public:
   virtual bool LoadItemCached(CFileItem* pItem) { return false; };
   virtual bool LoadItemLookup(CFileItem* pItem) { return false; };
 
-  void StopThread(); // will actually stop the loader thread.
+  void StopThread(); // will actually stop the loader threads.
   void StopAsync();  // will ask loader to stop as soon as possible, but not block
 
 protected:
   virtual void OnLoaderStart() {};
   virtual void OnLoaderFinish() {};
 
+  /*! \brief Whether LoadItemCached() and LoadItemLookup() may run for several items at once
+   Loaders sharing a database connection between items can't. The others load on up to
+   <bginfoloadermaxthreads> threads.
+   */
+  virtual bool CanLoadConcurrently() const { return false; };
+
   CFileItemList *m_pVecItems;
   std::vector<CFileItemPtr> m_vecItems; // FileItemList would delete the items and we only want to keep a reference.
   CCriticalSection m_lock;
 
   volatile bool m_bIsLoading;
   volatile bool m_bStop;
-  CThread *m_thread;
 
   IBackgroundLoaderObserver* m_pObserver;
   IProgressCallback* m_pProgressCallback;
+
+private:
+  /*! \brief Take the next item to load, the one nearest to those shown
+   \param lookup set to whether to look up the item rather than load its cached info.
+   \return the item, or an empty pointer if all are loaded.
+   */
+  CFileItemPtr GetNextItem(bool &lookup);
+  void UpdatePriorities();
+
+  std::vector<int> m_cachedItems; ///< indices of the items to load cached info for, the next one last
+  std::vector<int> m_lookupItems; ///< indices of the items to look up, the next one last
+  int m_shownStart;               ///< first and last index of the items shown when last checked
+  int m_shownEnd;
+  unsigned int m_prioritiesTime;
+  bool m_bStartCalled;
+  int m_activeWorkers;
+  std::vector<CThread*> m_workers;
 };
 
@@ -28,6 +28,7 @@
 #include "pvr/PVRDatabase.h"
 #include "epg/EpgDatabase.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/StartupTimeline.h"
 
 using namespace std;
 using namespace EPG;
@@ -84,6 +85,7 @@ bool CDatabaseManager::CanOpen(const std::string &name)
 void CDatabaseManager::UpdateDatabase(CDatabase &db, DatabaseSettings *settings)
 {
   std::string name = db.GetBaseDBName();
+  CStartupSpan span("CDatabaseManager::UpdateDatabase", name.c_str());
   UpdateStatus(name, DB_UPDATING);
   if (db.Update(settings ? *settings : DatabaseSettings()))
     UpdateStatus(name, DB_READY);
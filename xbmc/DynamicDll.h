@@ -395,6 +395,24 @@ public: \
 #define RESOLVE_METHOD_RENAME_FP(dllmethod, method) \
   m_dll->ResolveExport( #dllmethod , & method##_ptr ) &&
 
+///////////////////////////////////////////////////////////
+//
+//  RESOLVE_METHOD_RENAME_OPTIONAL
+//
+//  Resolves a method from a dll if it is exported, older
+//  versions of the dll may lack it. The method pointer is
+//  NULL then, check it with IS_METHOD_RESOLVED before use.
+//
+//  dllmethod: Name of the function exported from the dll
+//  method: Name of the method defined with DEFINE_METHOD
+//          or DEFINE_METHOD_LINKAGE
+//
+#define RESOLVE_METHOD_RENAME_OPTIONAL(dllmethod, method) \
+  ((m_##method##_ptr = NULL), m_dll->ResolveExport( #dllmethod , & m_##method##_ptr, false ), 1) &&
+
+#define IS_METHOD_RESOLVED(method) \
+  (m_##method##_ptr != NULL)
+
 
 ////////////////////////////////////////////////////////////////////
 //
@@ -796,7 +796,7 @@ bool CFileItem::IsVideo() const
      return true;
   }
 
-  return URIUtils::HasExtension(m_strPath, g_advancedSettings.m_videoExtensions);
+  return (g_advancedSettings.m_mediaExtensions.GetTypes(m_strPath) & MEDIA_EXTENSION_VIDEO) != 0;
 }
 
 bool CFileItem::IsEPG() const
@@ -831,7 +831,7 @@ bool CFileItem::IsDiscStub() const
     return dbItem.IsDiscStub();
   }
 
-  return URIUtils::HasExtension(m_strPath, g_advancedSettings.m_discStubExtensions);
+  return (g_advancedSettings.m_mediaExtensions.GetTypes(m_strPath) & MEDIA_EXTENSION_DISCSTUB) != 0;
 }
 
 bool CFileItem::IsAudio() const
@@ -854,7 +854,7 @@ bool CFileItem::IsAudio() const
      return true;
   }
 
-  return URIUtils::HasExtension(m_strPath, g_advancedSettings.m_musicExtensions);
+  return (g_advancedSettings.m_mediaExtensions.GetTypes(m_strPath) & MEDIA_EXTENSION_MUSIC) != 0;
 }
 
 bool CFileItem::IsKaraoke() const
@@ -2086,6 +2086,14 @@ bool CGUIInfoManager::GetBoolValue(unsigned int expression, const CGUIListItem *
   return false;
 }
 
+CStdString CGUIInfoManager::GetBoolExpression(unsigned int expression)
+{
+  CSingleLock lock(m_critInfo);
+  if (expression && --expression < m_bools.size())
+    return m_bools[expression]->GetExpression();
+  return "";
+}
+
 // checks the condition and returns it as necessary.  Currently used
 // for toggle button controls and visibility of images.
 bool CGUIInfoManager::GetBool(int condition1, int contextWindow, const CGUIListItem *item)
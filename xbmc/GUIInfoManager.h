@@ -724,6 +724,12 @@ public:
    */
   bool GetBoolValue(unsigned int expression, const CGUIListItem *item = NULL);
 
+  /*! \brief Get the expression a boolean was registered with
+   \return the expression, empty if it isn't registered.
+   \sa Register
+   */
+  CStdString GetBoolExpression(unsigned int expression);
+
   /*! \brief Evaluate a boolean expression
    \param expression the expression to evaluate
    \param context the context in which to evaluate the expression (currently windows)
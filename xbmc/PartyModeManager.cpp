@@ -33,6 +33,7 @@
 #include "playlists/PlayList.h"
 #include "utils/TimeUtils.h"
 #include "utils/log.h"
+#include "utils/Variant.h"
 #include "Application.h"
 #include "interfaces/AnnouncementManager.h"
 
@@ -45,6 +46,7 @@ CPartyModeManager::CPartyModeManager(void)
 {
   m_bIsVideo = false;
   m_bEnabled = false;
+  m_idsChanged = false;
   m_strCurrentFilterMusic.Empty();
   m_strCurrentFilterVideo.Empty();
   ClearState();
@@ -173,6 +175,10 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
   if (m_songsInHistory > 200)
     m_songsInHistory = 200;
 
+  m_songPicker.SetHistorySize(m_songsInHistory);
+  m_musicVideoPicker.SetHistorySize(m_songsInHistory);
+  SetIds(songIDs);
+
   CLog::Log(LOGINFO,"PARTY MODE MANAGER: Matching songs = %i, History size = %i", m_iMatchingSongs, m_songsInHistory);
   CLog::Log(LOGINFO,"PARTY MODE MANAGER: Party mode enabled!");
 
@@ -206,6 +212,8 @@ bool CPartyModeManager::Enable(PartyModeContext context /*= PARTYMODECONTEXT_MUS
   }
 
   // done
+  ANNOUNCEMENT::CAnnouncementManager::RemoveAnnouncer(this);
+  ANNOUNCEMENT::CAnnouncementManager::AddAnnouncer(this);
   m_bEnabled = true;
   Announce();
   return true;
@@ -215,6 +223,7 @@ void CPartyModeManager::Disable()
 {
   if (!IsEnabled())
     return;
+  ANNOUNCEMENT::CAnnouncementManager::RemoveAnnouncer(this);
   m_bEnabled = false;
   Announce();
   CLog::Log(LOGINFO,"PARTY MODE MANAGER: Party mode disabled.");
@@ -328,33 +337,26 @@ bool CPartyModeManager::AddRandomSongs(int iSongs /* = 0 */)
     }
   }
 
+  if (m_idsChanged && !UpdateIds())
+  {
+    OnError(16034, (CStdString)"Cannot get songs from database. Aborting.");
+    return false;
+  }
+
   // add songs to fill queue
   if (m_type.Equals("songs") || m_type.Equals("mixed"))
   {
     CMusicDatabase database;
     if (database.Open())
     {
-      // Method:
-      // 1. Grab a random entry from the database using a where clause
-      // 2. Iterate on iSongs.
-
-      // Note: At present, this method is faster than the alternative, which is to grab
-      // all valid songids, then select a random number of them (as done in AddInitialSongs()).
-      // The reason for this is simply the number of songs we are requesting - we generally
-      // only want one here.  Any more than about 3 songs and it is more efficient
-      // to use the technique in AddInitialSongs.  As it's unlikely that we'll require
-      // more than 1 song at a time here, this method is faster.
+      // pick from the ids fetched when party mode was enabled, rather than having the
+      // database sort all matching songs randomly for every song
       bool error(false);
       for (int i = 0; i < iSongsToAdd; i++)
       {
-        pair<CStdString,CStdString> whereClause = GetWhereClauseWithHistory();
-        CFileItemPtr item(new CFileItem);
-        int songID;
-        if (database.GetRandomSong(item.get(), songID, whereClause.first))
-        { // success
+        CFileItemPtr item = GetRandomSong(database);
+        if (item)
           Add(item);
-          AddToHistory(1,songID);
-        }
         else
         {
           error = true;
@@ -381,27 +383,12 @@ bool CPartyModeManager::AddRandomSongs(int iSongs /* = 0 */)
     CVideoDatabase database;
     if (database.Open())
     {
-      // Method:
-      // 1. Grab a random entry from the database using a where clause
-      // 2. Iterate on iSongs.
-
-      // Note: At present, this method is faster than the alternative, which is to grab
-      // all valid songids, then select a random number of them (as done in AddInitialSongs()).
-      // The reason for this is simply the number of songs we are requesting - we generally
-      // only want one here.  Any more than about 3 songs and it is more efficient
-      // to use the technique in AddInitialSongs.  As it's unlikely that we'll require
-      // more than 1 song at a time here, this method is faster.
       bool error(false);
       for (int i = 0; i < iVidsToAdd; i++)
       {
-        pair<CStdString,CStdString> whereClause = GetWhereClauseWithHistory();
-        CFileItemPtr item(new CFileItem);
-        int songID;
-        if (database.GetRandomMusicVideo(item.get(), songID, whereClause.second))
-        { // success
+        CFileItemPtr item = GetRandomMusicVideo(database);
+        if (item)
           Add(item);
-          AddToHistory(2,songID);
-        }
         else
         {
           error = true;
@@ -508,6 +495,7 @@ void CPartyModeManager::OnError(int iError, const CStdString&  strLogMessage)
   // open error dialog
   CGUIDialogOK::ShowAndGetInput(257, 16030, iError, 0);
   CLog::Log(LOGERROR, "PARTY MODE MANAGER: %s", strLogMessage.c_str());
+  ANNOUNCEMENT::CAnnouncementManager::RemoveAnnouncer(this);
   m_bEnabled = false;
   SendUpdateMessage();
 }
@@ -576,7 +564,9 @@ void CPartyModeManager::ClearState()
   m_iRandomSongs = 0;
 
   m_songsInHistory = 0;
-  m_history.clear();
+  m_songPicker.Clear();
+  m_musicVideoPicker.Clear();
+  m_idsChanged = false;
 }
 
 void CPartyModeManager::UpdateStats()
@@ -630,7 +620,13 @@ bool CPartyModeManager::AddInitialSongs(vector<pair<int,int> > &songIDs)
       database.GetMusicVideosByWhere("videodb://musicvideos/titles/", sqlWhereVideo, items);
     }
 
-    m_history = chosenSongIDs;
+    for (vector< pair<int,int> >::iterator it = chosenSongIDs.begin(); it != chosenSongIDs.end(); it++)
+    {
+      if (it->first == 1)
+        m_songPicker.AddToHistory(it->second);
+      if (it->first == 2)
+        m_musicVideoPicker.AddToHistory(it->second);
+    }
     items.Randomize(); //randomizing the initial list or they will be in database order
     for (int i = 0; i < items.Size(); i++)
     {
@@ -642,44 +638,88 @@ bool CPartyModeManager::AddInitialSongs(vector<pair<int,int> > &songIDs)
   return true;
 }
 
-pair<CStdString,CStdString> CPartyModeManager::GetWhereClauseWithHistory() const
+void CPartyModeManager::SetIds(const vector< pair<int,int> > &songIDs)
 {
-  CStdString historyWhereMusic;
-  CStdString historyWhereVideo;
-  // now add this on to the normal where clause
-  if (m_history.size())
+  vector<int> songs, musicVideos;
+  for (vector< pair<int,int> >::const_iterator it = songIDs.begin(); it != songIDs.end(); ++it)
   {
-    if (m_strCurrentFilterMusic.IsEmpty())
-      historyWhereMusic = "songview.idSong not in (";
-    else
-      historyWhereMusic = m_strCurrentFilterMusic + " and songview.idSong not in (";
-    if (m_strCurrentFilterVideo.IsEmpty())
-      historyWhereVideo = "idMVideo not in (";
-    else
-      historyWhereVideo = m_strCurrentFilterVideo + " and idMVideo not in (";
+    if (it->first == 1)
+      songs.push_back(it->second);
+    if (it->first == 2)
+      musicVideos.push_back(it->second);
+  }
+  m_songPicker.SetIds(songs);
+  m_musicVideoPicker.SetIds(musicVideos);
+}
 
-    for (unsigned int i = 0; i < m_history.size(); i++)
-    {
-      CStdString number;
-      number.Format("%i,", m_history[i].second);
-      if (m_history[i].first == 1)
-        historyWhereMusic += number;
-      if (m_history[i].first == 2)
-        historyWhereVideo += number;
-    }
-    historyWhereMusic.TrimRight(",");
-    historyWhereMusic += ")";
-    historyWhereVideo.TrimRight(",");
-    historyWhereVideo += ")";
+bool CPartyModeManager::UpdateIds()
+{
+  // cleared first, so a change while the ids are fetched isn't lost
+  m_idsChanged = false;
+
+  vector< pair<int,int> > songIDs;
+  if (m_type.Equals("songs") || m_type.Equals("mixed"))
+  {
+    CMusicDatabase db;
+    if (!db.Open())
+      return false;
+    db.GetSongIDs(m_strCurrentFilterMusic, songIDs);
   }
-  return make_pair(historyWhereMusic,historyWhereVideo);
+  if (m_type.Equals("musicvideos") || m_type.Equals("mixed"))
+  {
+    vector< pair<int,int> > songIDs2;
+    CVideoDatabase db;
+    if (!db.Open())
+      return false;
+    db.GetMusicVideoIDs(m_strCurrentFilterVideo, songIDs2);
+    songIDs.insert(songIDs.end(), songIDs2.begin(), songIDs2.end());
+  }
+
+  CLog::Log(LOGDEBUG, "PARTY MODE MANAGER: Library changed, matching songs = %i", (int)songIDs.size());
+  m_iMatchingSongs = (int)songIDs.size();
+  SetIds(songIDs);
+  return true;
 }
 
-void CPartyModeManager::AddToHistory(int type, int songID)
+CFileItemPtr CPartyModeManager::GetRandomSong(CMusicDatabase &database)
 {
-  while (m_history.size() >= m_songsInHistory && m_songsInHistory)
-    m_history.erase(m_history.begin());
-  m_history.push_back(make_pair(type,songID));
+  int songID;
+  while (m_songPicker.Pick(songID))
+  {
+    CStdString where = database.PrepareSQL("songview.idSong = %i", songID);
+    if (!m_strCurrentFilterMusic.IsEmpty())
+      where = "(" + m_strCurrentFilterMusic + ") and " + where;
+
+    CFileItemList items;
+    if (!database.GetSongsByWhere("musicdb://songs/", where, items))
+      break;
+    if (items.Size() == 1)
+      return items[0];
+
+    // removed or no longer matching the filter since the ids were fetched
+    m_songPicker.Remove(songID);
+  }
+  return CFileItemPtr();
+}
+
+CFileItemPtr CPartyModeManager::GetRandomMusicVideo(CVideoDatabase &database)
+{
+  int musicVideoID;
+  while (m_musicVideoPicker.Pick(musicVideoID))
+  {
+    CStdString where = database.PrepareSQL("idMVideo = %i", musicVideoID);
+    if (!m_strCurrentFilterVideo.IsEmpty())
+      where = "(" + m_strCurrentFilterVideo + ") and " + where;
+
+    CFileItemList items;
+    if (!database.GetMusicVideosByWhere("videodb://musicvideos/titles/", where, items))
+      break;
+    if (items.Size() == 1)
+      return items[0];
+
+    m_musicVideoPicker.Remove(musicVideoID);
+  }
+  return CFileItemPtr();
 }
 
 void CPartyModeManager::GetRandomSelection(vector< pair<int,int> >& in, unsigned int number, vector< pair<int,int> >& out)
@@ -710,3 +750,15 @@ void CPartyModeManager::Announce()
     ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::Player, "xbmc", "OnPropertyChanged", data);
   }
 }
+
+void CPartyModeManager::Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+{
+  if (!(flag & (ANNOUNCEMENT::AudioLibrary | ANNOUNCEMENT::VideoLibrary)) || strcmp(sender, "xbmc") != 0)
+    return;
+
+  // updates (eg. play counts) don't refetch the ids, as every song played is one. songs that
+  // no longer match the filter are skipped when picked instead.
+  if (strcmp(message, "OnRemove") == 0 || strcmp(message, "OnScanFinished") == 0 ||
+      strcmp(message, "OnCleanFinished") == 0)
+    m_idsChanged = true;
+}
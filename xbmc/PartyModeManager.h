@@ -20,11 +20,15 @@
  */
 
 #include "utils/StdString.h"
+#include "interfaces/IAnnouncer.h"
+#include "utils/RandomPicker.h"
 
 #include <boost/shared_ptr.hpp>
 
 class CFileItem; typedef boost::shared_ptr<CFileItem> CFileItemPtr;
 class CFileItemList;
+class CMusicDatabase;
+class CVideoDatabase;
 namespace PLAYLIST
 {
   class CPlayList;
@@ -37,7 +41,7 @@ typedef enum
   PARTYMODECONTEXT_VIDEO
 } PartyModeContext;
 
-class CPartyModeManager
+class CPartyModeManager : public ANNOUNCEMENT::IAnnouncer
 {
 public:
   CPartyModeManager(void);
@@ -58,6 +62,8 @@ public:
   int GetRandomSongs();
   PartyModeContext GetType() const;
 
+  virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
 private:
   void Process();
   bool AddRandomSongs(int iSongs = 0);
@@ -69,8 +75,10 @@ private:
   void OnError(int iError, const CStdString& strLogMessage);
   void ClearState();
   void UpdateStats();
-  std::pair<CStdString,CStdString> GetWhereClauseWithHistory() const;
-  void AddToHistory(int type, int songID);
+  void SetIds(const std::vector< std::pair<int,int> > &songIDs);
+  bool UpdateIds();
+  CFileItemPtr GetRandomSong(CMusicDatabase &database);
+  CFileItemPtr GetRandomMusicVideo(CVideoDatabase &database);
   void GetRandomSelection(std::vector< std::pair<int,int> > &in, unsigned int number, std::vector< std::pair<int, int> > &out);
   void Announce();
 
@@ -92,7 +100,11 @@ private:
 
   // history
   unsigned int m_songsInHistory;
-  std::vector< std::pair<int,int> > m_history;
+
+  // ids matching the filters, refetched when the library changed
+  CRandomPicker m_songPicker;
+  CRandomPicker m_musicVideoPicker;
+  volatile bool m_idsChanged;
 };
 
 extern CPartyModeManager g_partyModeManager;
@@ -27,6 +27,7 @@
 #include "GUIInfoManager.h"
 #include "filesystem/DllLibCurl.h"
 #include "filesystem/DirectoryCache.h"
+#include "filesystem/StatCache.h"
 #include "GUIPassword.h"
 #include "LangInfo.h"
 #include "utils/LangCodeExpander.h"
@@ -59,6 +60,7 @@
   CLocalizeStrings   g_localizeStringsTemp;
 
   XFILE::CDirectoryCache g_directoryCache;
+  XFILE::CStatCache      g_statCache;
 
   CGUITextureManager g_TextureManager;
   CGUILargeTextureManager g_largeTextureManager;
@@ -502,8 +502,7 @@ bool CUtil::IsTVRecording(const CStdString& strFile)
 
 bool CUtil::IsPicture(const CStdString& strFile)
 {
-  return URIUtils::HasExtension(strFile,
-                  g_advancedSettings.m_pictureExtensions + "|.tbn|.dds");
+  return (g_advancedSettings.m_mediaExtensions.GetTypes(strFile) & (MEDIA_EXTENSION_PICTURE | MEDIA_EXTENSION_THUMB)) != 0;
 }
 
 bool CUtil::ExcludeFileOrFolder(const CStdString& strFileOrFolder, const CStdStringArray& regexps)
@@ -520,7 +519,7 @@ bool CUtil::ExcludeFileOrFolder(const CStdString& strFileOrFolder, const CStdStr
       CLog::Log(LOGERROR, "%s: Invalid exclude RegExp:'%s'", __FUNCTION__, regexps[i].c_str());
       continue;
     }
-    if (regExExcludes.RegFind(strFileOrFolder) > -1)
+    if (regExExcludes.RegMatch(strFileOrFolder) > -1)
     {
       CLog::Log(LOGDEBUG, "%s: File '%s' excluded. (Matches exclude rule RegExp:'%s')", __FUNCTION__, strFileOrFolder.c_str(), regexps[i].c_str());
       return true;
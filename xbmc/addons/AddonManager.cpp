@@ -28,6 +28,7 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "utils/log.h"
+#include "utils/StartupTimeline.h"
 #include "utils/XBMCTinyXML.h"
 #ifdef HAS_VISUALISATION
 #include "Visualisation.h"
@@ -839,7 +840,10 @@ bool CAddonMgr::StartServices(const bool beforelogin)
     {
       if ( (beforelogin && service->GetStartOption() == CService::STARTUP)
         || (!beforelogin && service->GetStartOption() == CService::LOGIN) )
+      {
+        CStartupSpan span("CService::Start", service->ID().c_str());
         ret &= service->Start();
+      }
     }
   }
 
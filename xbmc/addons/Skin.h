@@ -113,6 +113,16 @@ public:
 //  static bool Check(const CStdString& strSkinDir); // checks if everything is present and accounted for without loading the skin
   static double GetMinVersion();
   void LoadIncludes();
+
+  /*! \brief Load an additional include file, as done when resolving <include file="foo">
+   \param includeFile path of the include file.
+   \return true if the file was loaded or had been already.
+   */
+  bool LoadIncludes(const CStdString &includeFile) { return m_includes.LoadIncludes(includeFile); };
+
+  /*! \brief Retrieve the include files loaded so far, the windows resolved against them depend on them
+   */
+  const std::vector<CStdString> &GetIncludeFiles() const { return m_includes.GetFiles(); };
   const INFO::CSkinVariableString* CreateSkinVariable(const CStdString& name, int context);
 
   static void SettingOptionsSkinColorsFiller(const CSetting *setting, std::vector< std::pair<std::string, std::string> > &list, std::string &current);
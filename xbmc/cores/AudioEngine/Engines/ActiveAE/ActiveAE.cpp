@@ -28,6 +28,7 @@ using namespace ActiveAE;
 
 #include "settings/Settings.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/PlaybackTrace.h"
 #include "windowing/WindowingFactory.h"
 
 #define MAX_CACHE_LEVEL 0.5   // total cache time of stream in seconds
@@ -1446,6 +1447,7 @@ void CActiveAE::UnconfigureSink()
 
 bool CActiveAE::RunStages()
 {
+  CPlaybackTraceSpan span("CActiveAE::RunStages");
   bool busy = false;
 
   // serve input streams
@@ -26,6 +26,7 @@
 #include "ActiveAE.h"
 
 #include "settings/Settings.h"
+#include "utils/PlaybackTrace.h"
 
 using namespace ActiveAE;
 
@@ -750,6 +751,7 @@ void CActiveAESink::ReturnBuffers()
 
 unsigned int CActiveAESink::OutputSamples(CSampleBuffer* samples)
 {
+  CPlaybackTraceSpan span("CActiveAESink::OutputSamples");
   uint8_t *buffer = samples->pkt->data[0];
   unsigned int frames = samples->pkt->nb_samples;
   unsigned int maxFrames;
@@ -21,6 +21,7 @@
 #include "system.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/PlaybackTrace.h"
 #include "utils/MathUtils.h"
 
 #include "AEFactory.h"
@@ -85,6 +86,7 @@ unsigned int CActiveAEStream::GetSpace()
 
 unsigned int CActiveAEStream::AddData(void *data, unsigned int size)
 {
+  CPlaybackTraceSpan span("CActiveAEStream::AddData");
   Message *msg;
   unsigned int copied = 0;
   int bytesToCopy = size;
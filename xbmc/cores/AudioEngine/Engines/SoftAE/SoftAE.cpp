@@ -24,6 +24,7 @@
 
 #include "system.h"
 #include "utils/log.h"
+#include "utils/PlaybackTrace.h"
 #include "utils/TimeUtils.h"
 #include "utils/MathUtils.h"
 #include "utils/EndianSwap.h"
@@ -1223,7 +1224,9 @@ unsigned int CSoftAE::WriteSink(CAEBuffer& src, unsigned int src_len, uint8_t *d
   XbmcThreads::EndTime timeout(m_sinkBlockTime * 2);
   while(m_sink && src.Used() >= src_len)
   {
+    CPlaybackTraceSpan sinkSpan("CSoftAE::WriteSink");
     int frames = m_sink->AddPackets(data, m_sinkFormat.m_frames, hasAudio);
+    sinkSpan.End();
 
     /* Return value of INT_MAX signals error in sink - restart */
     if (frames == INT_MAX)
@@ -1419,6 +1422,8 @@ unsigned int CSoftAE::RunStreamStage(unsigned int channelCount, void *out, bool
   if (m_playingStreams.empty())
     return 0;
 
+  CPlaybackTraceSpan span("CSoftAE::RunStreamStage");
+
   float *dst = (float*)out;
   unsigned int mixed = 0;
 
@@ -21,6 +21,7 @@
 #include "system.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/PlaybackTrace.h"
 #include "utils/MathUtils.h"
 
 #include "AEFactory.h"
@@ -262,6 +263,7 @@ unsigned int CSoftAEStream::GetSpace()
 
 unsigned int CSoftAEStream::AddData(void *data, unsigned int size)
 {
+  CPlaybackTraceSpan span("CSoftAEStream::AddData");
   CSingleLock lock(m_lock);
 
   if (!m_valid || size == 0 || data == NULL)
@@ -21,12 +21,16 @@
 #include "DVDMessageQueue.h"
 #include "DVDDemuxers/DVDDemuxUtils.h"
 #include "utils/log.h"
+#include "utils/PlaybackTrace.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
 
 using namespace std;
 
+const CDVDMessageQueue::PacketTimes CDVDMessageQueue::NoTimes = { DVD_NOPTS_VALUE, 0, DVD_NOPTS_VALUE, 0 };
+
 CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owner(owner)
 {
   m_iDataSize     = 0;
@@ -35,10 +39,24 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owne
   m_bCaching      = false;
   m_bEmptied      = true;
 
-  m_TimeBack      = DVD_NOPTS_VALUE;
-  m_TimeFront     = DVD_NOPTS_VALUE;
+  m_ringTimes.version = 0;
+  m_ringTimes.times   = NoTimes;
+  m_listTimes.version = 0;
+  m_listTimes.times   = NoTimes;
+  m_getTimes.version  = 0;
+  m_getTimes.times    = NoTimes;
+  m_flushSequence = 0;
   m_TimeSize      = 1.0 / 4.0; /* 4 seconds */
   m_iMaxDataSize  = 0;
+
+  m_ringWrite     = 0;
+  m_ringRead      = 0;
+  m_sequence      = 0;
+  m_waiting       = 0;
+  m_producerState = 0;
+  m_ringClosed    = 1;
+  m_ringPutting   = 0;
+  memset(m_ring, 0, sizeof(m_ring));
 }
 
 CDVDMessageQueue::~CDVDMessageQueue()
@@ -49,12 +67,17 @@ CDVDMessageQueue::~CDVDMessageQueue()
 
 void CDVDMessageQueue::Init()
 {
+  CSingleLock lock(m_section);
+  ResetRing();
+
   m_iDataSize     = 0;
   m_bAbortRequest = false;
   m_bEmptied      = true;
+  m_flushSequence = AtomicAdd(&m_sequence, 0);
+  WriteTimes(m_getTimes, NoTimes);
   m_bInitialized  = true;
-  m_TimeBack      = DVD_NOPTS_VALUE;
-  m_TimeFront     = DVD_NOPTS_VALUE;
+
+  cas(&m_ringClosed, 1, 0);
 }
 
 void CDVDMessageQueue::Flush(CDVDMsg::Message type)
@@ -64,16 +87,31 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
   for(SList::iterator it = m_list.begin(); it != m_list.end();)
   {
     if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
+    {
+      if (it->priority == 0)
+        AtomicSubtract(&m_iDataSize, PacketSize(it->message));
       it = m_list.erase(it);
+    }
     else
       ++it;
   }
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
-    m_iDataSize = 0;
-    m_TimeBack  = DVD_NOPTS_VALUE;
-    m_TimeFront = DVD_NOPTS_VALUE;
+    // we are the consumer while holding m_section, a packet the producer
+    // is putting right now stays queued and accounted
+    for (unsigned long count = RingCount(); count > 0; count--)
+    {
+      RingSlot& slot = m_ring[m_ringRead & (MSGQ_RING_SIZE - 1)];
+      AtomicSubtract(&m_iDataSize, PacketSize(slot.message));
+      slot.message->Release();
+      slot.message = NULL;
+      AtomicIncrement(&m_ringRead);
+    }
+
+    // the putting sides keep their times, everything put up to now is gone for them
+    m_flushSequence = AtomicAdd(&m_sequence, 0);
+    WriteTimes(m_getTimes, NoTimes);
     m_bEmptied = true;
   }
 }
@@ -92,15 +130,151 @@ void CDVDMessageQueue::End()
   CSingleLock lock(m_section);
 
   Flush();
+  ResetRing();
 
   m_bInitialized  = false;
   m_iDataSize     = 0;
   m_bAbortRequest = false;
 }
 
+void CDVDMessageQueue::ResetRing()
+{
+  CSingleLock lock(m_section);
+
+  // refuse new ring puts and let the one in flight finish, PutRing announces
+  // itself before it checks m_ringClosed
+  cas(&m_ringClosed, 0, 1);
+  while (AtomicAdd(&m_ringPutting, 0))
+    Sleep(1);
+
+  while (RingCount() > 0)
+  {
+    RingSlot& slot = m_ring[m_ringRead & (MSGQ_RING_SIZE - 1)];
+    slot.message->Release();
+    slot.message = NULL;
+    AtomicIncrement(&m_ringRead);
+  }
+
+  // the next stream may be fed by another thread
+  m_ringWrite     = 0;
+  m_ringRead      = 0;
+  m_producerState = 0;
+}
+
+unsigned long CDVDMessageQueue::RingCount()
+{
+  return (unsigned long)AtomicAdd(&m_ringWrite, 0) - (unsigned long)AtomicAdd(&m_ringRead, 0);
+}
+
+bool CDVDMessageQueue::IsRingProducer()
+{
+  if (m_producerState == 2)
+    return CThread::IsCurrentThread(m_producer);
+
+  // the first thread putting a packet owns the ring, others use the list
+  if (cas(&m_producerState, 0, 1) == 0)
+  {
+    m_producer = CThread::GetCurrentThreadId();
+    AtomicIncrement(&m_producerState);
+    return true;
+  }
+  return false;
+}
+
+int CDVDMessageQueue::PacketSize(CDVDMsg* pMsg) const
+{
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return 0;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  return packet ? packet->iSize : 0;
+}
+
+void CDVDMessageQueue::AccountPut(CDVDMsg* pMsg, long sequence, TimeSide &side)
+{
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if(packet)
+  {
+    AtomicAdd(&m_iDataSize, packet->iSize);
+
+    double time = packet->dts != DVD_NOPTS_VALUE ? packet->dts : packet->pts;
+    if(time != DVD_NOPTS_VALUE)
+    {
+      // we are the only writer of this side
+      PacketTimes times = side.times;
+      times.last    = time;
+      times.lastSeq = sequence;
+      if((long)((unsigned long)times.firstSeq - (unsigned long)m_flushSequence) <= 0)
+      {
+        times.first    = time;
+        times.firstSeq = sequence;
+      }
+      WriteTimes(side, times);
+    }
+  }
+}
+
+void CDVDMessageQueue::AccountGet(CDVDMsg* pMsg)
+{
+  if (!pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return;
+
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if(packet)
+  {
+    AtomicSubtract(&m_iDataSize, packet->iSize);
+
+    double time = packet->dts != DVD_NOPTS_VALUE ? packet->dts : packet->pts;
+    if(time != DVD_NOPTS_VALUE)
+    {
+      PacketTimes times = m_getTimes.times;
+      times.last = time;
+      WriteTimes(m_getTimes, times);
+    }
+  }
+
+  if(m_bEmptied && m_iDataSize > 0)
+    m_bEmptied = false;
+}
+
+bool CDVDMessageQueue::PutRing(CDVDMsg* pMsg)
+{
+  // ResetRing waits for us once it closed the ring
+  AtomicIncrement(&m_ringPutting);
+  bool put = false;
+
+  long write = m_ringWrite;
+  if (!AtomicAdd(&m_ringClosed, 0) && IsRingProducer()
+  &&  (unsigned long)write - (unsigned long)AtomicAdd(&m_ringRead, 0) < MSGQ_RING_SIZE) // full, the list takes it
+  {
+    // account before publishing so the consumer never sees it uncounted
+    long sequence = AtomicIncrement(&m_sequence);
+    AccountPut(pMsg, sequence, m_ringTimes);
+
+    RingSlot& slot = m_ring[write & (MSGQ_RING_SIZE - 1)];
+    slot.message  = pMsg; // the ring keeps the callers reference
+    slot.sequence = sequence;
+    AtomicIncrement(&m_ringWrite);
+
+    // only pay for the event if the consumer is (about to be) blocked
+    if (AtomicAdd(&m_waiting, 0))
+      m_hEvent.Set();
+    put = true;
+  }
+
+  AtomicDecrement(&m_ringPutting);
+  return put;
+}
 
 MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 {
+  if (pMsg && priority == 0 && m_bInitialized
+  &&  pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && PutRing(pMsg))
+    return MSGQ_OK;
+
   CSingleLock lock(m_section);
 
   if (!m_bInitialized)
@@ -122,22 +296,11 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
       break;
     ++it;
   }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
+  long sequence = priority == 0 ? AtomicIncrement(&m_sequence) : 0;
+  m_list.insert(it, DVDMessageListItem(pMsg, priority, sequence));
 
-  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
-  {
-    DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
-    if(packet)
-    {
-      m_iDataSize += packet->iSize;
-      if     (packet->dts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->dts;
-      else if(packet->pts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->pts;
-      if(m_TimeBack == DVD_NOPTS_VALUE)
-        m_TimeBack = m_TimeFront;
-    }
-  }
+  if (priority == 0)
+    AccountPut(pMsg, sequence, m_listTimes);
 
   pMsg->Release();
 
@@ -160,7 +323,7 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  if(m_list.empty() && RingCount() == 0 && m_bEmptied == false && priority == 0 && m_owner != "teletext")
   {
 #if !defined(TARGET_RASPBERRY_PI)
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
@@ -170,26 +333,20 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    bool fromList = !m_list.empty() && m_list.back().priority >= priority && !m_bCaching;
+    bool fromRing = priority <= 0 && RingCount() > 0 && !m_bCaching;
+
+    // priority 0 messages leave in the order they were put
+    if (fromList && fromRing && m_list.back().priority == 0)
+      fromList = (long)((unsigned long)m_list.back().sequence - (unsigned long)m_ring[m_ringRead & (MSGQ_RING_SIZE - 1)].sequence) < 0;
+
+    if (fromList)
     {
       DVDMessageListItem& item(m_list.back());
       priority = item.priority;
 
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
-      {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
-        if(packet)
-        {
-          m_iDataSize -= packet->iSize;
-          if     (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if(packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
-        }
-
-        if(m_bEmptied && m_iDataSize > 0)
-          m_bEmptied = false;
-      }
+      if (item.priority == 0)
+        AccountGet(item.message);
 
       *pMsg = item.message->Acquire();
       m_list.pop_back();
@@ -197,6 +354,20 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
       ret = MSGQ_OK;
       break;
     }
+    else if (fromRing)
+    {
+      RingSlot& slot = m_ring[m_ringRead & (MSGQ_RING_SIZE - 1)];
+      priority = 0;
+
+      AccountGet(slot.message);
+
+      *pMsg = slot.message;
+      slot.message = NULL;
+      AtomicIncrement(&m_ringRead);
+
+      ret = MSGQ_OK;
+      break;
+    }
     else if (!iTimeoutInMilliSeconds)
     {
       ret = MSGQ_TIMEOUT;
@@ -205,10 +376,23 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     else
     {
       m_hEvent.Reset();
+
+      // announce the wait before checking the ring a last time, a producer
+      // publishing after this check is bound to see the flag and signal
+      AtomicIncrement(&m_waiting);
+      if (priority <= 0 && RingCount() > 0)
+      {
+        AtomicDecrement(&m_waiting);
+        continue;
+      }
       lock.Leave();
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
+      CPlaybackTraceSpan waitSpan("CDVDMessageQueue::Wait");
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
+      waitSpan.End();
+      AtomicDecrement(&m_waiting);
+      if (!signaled)
         return MSGQ_TIMEOUT;
 
       lock.Enter();
@@ -229,6 +413,9 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
     return 0;
 
   unsigned count = 0;
+  if (type == CDVDMsg::DEMUXER_PACKET)
+    count += RingCount();
+
   for(SList::iterator it = m_list.begin(); it != m_list.end();++it)
   {
     if(it->message->IsType(type))
@@ -249,28 +436,84 @@ void CDVDMessageQueue::WaitUntilEmpty()
 
 int CDVDMessageQueue::GetLevel() const
 {
-  if(m_iDataSize > m_iMaxDataSize)
+  int dataSize = (int)m_iDataSize;
+  if(dataSize > m_iMaxDataSize)
     return 100;
-  if(m_iDataSize == 0)
+  if(dataSize == 0)
     return 0;
 
-  if(IsDataBased())
-    return min(100, 100 * m_iDataSize / m_iMaxDataSize);
+  double front, back;
+  GetTimes(front, back);
+  if(IsDataBased(front, back))
+    return min(100, 100 * dataSize / m_iMaxDataSize);
 
-  return min(100, MathUtils::round_int(100.0 * m_TimeSize * (m_TimeFront - m_TimeBack) / DVD_TIME_BASE ));
+  return min(100, MathUtils::round_int(100.0 * m_TimeSize * (front - back) / DVD_TIME_BASE ));
 }
 
 int CDVDMessageQueue::GetTimeSize() const
 {
-  if(IsDataBased())
+  double front, back;
+  GetTimes(front, back);
+  if(IsDataBased(front, back))
     return 0;
   else
-    return (int)((m_TimeFront - m_TimeBack) / DVD_TIME_BASE);
+    return (int)((front - back) / DVD_TIME_BASE);
 }
 
 bool CDVDMessageQueue::IsDataBased() const
 {
-  return (m_TimeBack == DVD_NOPTS_VALUE  ||
-          m_TimeFront == DVD_NOPTS_VALUE ||
-          m_TimeFront <= m_TimeBack);
+  double front, back;
+  GetTimes(front, back);
+  return IsDataBased(front, back);
+}
+
+void CDVDMessageQueue::WriteTimes(TimeSide &side, const PacketTimes &times)
+{
+  AtomicIncrement(&side.version);
+  side.times = times;
+  AtomicIncrement(&side.version);
+}
+
+CDVDMessageQueue::PacketTimes CDVDMessageQueue::ReadTimes(const TimeSide &side)
+{
+  // doubles aren't written atomically on every platform
+  volatile long *version = const_cast<volatile long*>(&side.version);
+  PacketTimes times;
+  long before;
+  do
+  {
+    before = AtomicAdd(version, 0);
+    times  = side.times;
+  } while ((before & 1) || AtomicAdd(version, 0) != before);
+  return times;
+}
+
+void CDVDMessageQueue::GetTimes(double &front, double &back) const
+{
+  long flushed = AtomicAdd(const_cast<volatile long*>(&m_flushSequence), 0);
+  PacketTimes ring = ReadTimes(m_ringTimes);
+  PacketTimes list = ReadTimes(m_listTimes);
+
+  // the side that put last has the front
+  const PacketTimes &newest = (long)((unsigned long)ring.lastSeq - (unsigned long)list.lastSeq) > 0 ? ring : list;
+  front = (long)((unsigned long)newest.lastSeq - (unsigned long)flushed) > 0 ? newest.last : DVD_NOPTS_VALUE;
+
+  // until a packet is taken the back is the first one put
+  back = ReadTimes(m_getTimes).last;
+  if(back == DVD_NOPTS_VALUE)
+  {
+    bool fromRing = (long)((unsigned long)ring.firstSeq - (unsigned long)flushed) > 0;
+    bool fromList = (long)((unsigned long)list.firstSeq - (unsigned long)flushed) > 0;
+    if(fromRing && (!fromList || (long)((unsigned long)ring.firstSeq - (unsigned long)list.firstSeq) < 0))
+      back = ring.first;
+    else if(fromList)
+      back = list.first;
+  }
+}
+
+bool CDVDMessageQueue::IsDataBased(double front, double back)
+{
+  return (back == DVD_NOPTS_VALUE  ||
+          front == DVD_NOPTS_VALUE ||
+          front <= back);
 }
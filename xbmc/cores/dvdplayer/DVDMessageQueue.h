@@ -25,18 +25,24 @@
 #include <list>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
+#include "threads/Thread.h"
+
+// number of demuxer packets the lock free ring holds, power of two
+#define MSGQ_RING_SIZE 1024
 
 struct DVDMessageListItem
 {
-  DVDMessageListItem(CDVDMsg* msg, int prio)
+  DVDMessageListItem(CDVDMsg* msg, int prio, long seq = 0)
   {
     message  = msg->Acquire();
     priority = prio;
+    sequence = seq;
   }
   DVDMessageListItem()
   {
     message  = NULL;
     priority = 0;
+    sequence = 0;
   }
   DVDMessageListItem(const DVDMessageListItem& item)
   {
@@ -45,6 +51,7 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    sequence = item.sequence;
   }
  ~DVDMessageListItem()
   {
@@ -61,11 +68,13 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    sequence = item.sequence;
     return *this;
   }
 
   CDVDMsg* message;
   int      priority;
+  long     sequence; // order of priority 0 messages across list and ring
 };
 
 enum MsgQueueReturnCode
@@ -105,7 +114,7 @@ public:
     return Get(pMsg, iTimeoutInMilliSeconds, priority);
   }
 
-  int GetDataSize() const               { return m_iDataSize; }
+  int GetDataSize() const               { return (int)m_iDataSize; }
   int GetTimeSize() const;
   unsigned GetPacketCount(CDVDMsg::Message type);
   bool ReceivedAbortRequest()           { return m_bAbortRequest; }
@@ -124,6 +133,54 @@ public:
 
 private:
 
+  /*
+   * Demuxer packets of priority 0 put by a single producer thread bypass
+   * m_section and m_list through a bounded single producer/single consumer
+   * ring. The producer owns m_ringWrite, m_ringRead is only advanced with
+   * m_section held, so Get and Flush act as the one consumer. Priority 0
+   * messages in the list and in the ring are merged by sequence number to
+   * keep their order, anything with a higher priority goes first as before.
+   */
+  struct RingSlot
+  {
+    CDVDMsg* message;
+    long     sequence;
+  };
+
+  /*
+   * The packet times of one side of the queue. Each side has one writer at
+   * a time: the ring producer, Put under m_section, and Get/Flush under
+   * m_section. Readers don't lock, the writer keeps version odd while it
+   * updates, a reader retries until it saw the same even version before and
+   * after. A flush doesn't touch the putting sides, times with a sequence
+   * up to m_flushSequence are ignored instead.
+   */
+  struct PacketTimes
+  {
+    double last;      // of the newest packet
+    long   lastSeq;
+    double first;     // of the first packet after a flush
+    long   firstSeq;
+  };
+  struct TimeSide
+  {
+    volatile long version;
+    PacketTimes   times;
+  };
+  static const PacketTimes NoTimes;
+
+  bool PutRing(CDVDMsg* pMsg);
+  bool IsRingProducer();
+  unsigned long RingCount();
+  void ResetRing();
+  void AccountPut(CDVDMsg* pMsg, long sequence, TimeSide &side);
+  void AccountGet(CDVDMsg* pMsg);
+  static void WriteTimes(TimeSide &side, const PacketTimes &times);
+  static PacketTimes ReadTimes(const TimeSide &side);
+  int  PacketSize(CDVDMsg* pMsg) const;
+  void GetTimes(double &front, double &back) const;
+  static bool IsDataBased(double front, double back);
+
   CEvent m_hEvent;
   mutable CCriticalSection m_section;
 
@@ -131,9 +188,11 @@ private:
   bool m_bInitialized;
   bool m_bCaching;
 
-  int m_iDataSize;
-  double m_TimeFront;
-  double m_TimeBack;
+  volatile long m_iDataSize;
+  TimeSide m_ringTimes;           // written by the ring producer
+  TimeSide m_listTimes;           // written by Put under m_section
+  TimeSide m_getTimes;            // last is the back of the queue, written under m_section
+  volatile long m_flushSequence;  // sequence of the last packet flushed
   double m_TimeSize;
 
   int m_iMaxDataSize;
@@ -142,5 +201,15 @@ private:
 
   typedef std::list<DVDMessageListItem> SList;
   SList m_list;
+
+  RingSlot m_ring[MSGQ_RING_SIZE];
+  volatile long m_ringWrite;     // next slot the producer fills
+  volatile long m_ringRead;      // next slot the consumer takes
+  volatile long m_sequence;
+  volatile long m_waiting;       // consumer is about to block on m_hEvent
+  volatile long m_producerState; // 0 unclaimed, 1 being claimed, 2 m_producer valid
+  volatile long m_ringClosed;    // refuses ring puts while it is reset, until Init
+  volatile long m_ringPutting;   // producer is inside PutRing
+  ThreadIdentifier m_producer;
 };
 
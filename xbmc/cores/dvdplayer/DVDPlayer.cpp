@@ -68,6 +68,7 @@
 #include "settings/Settings.h"
 #include "settings/MediaSettings.h"
 #include "utils/log.h"
+#include "utils/PlaybackTrace.h"
 #include "utils/TimeUtils.h"
 #include "utils/StreamDetails.h"
 #include "pvr/PVRManager.h"
@@ -455,6 +456,9 @@ bool CDVDPlayer::OpenFile(const CFileItem& file, const CPlayerOptions &options)
   {
     CLog::Log(LOGNOTICE, "DVDPlayer: Opening: %s", file.GetPath().c_str());
 
+    if (g_advancedSettings.m_playbackTrace && !CPlaybackTrace::IsEnabled())
+      CPlaybackTrace::Enable(true);
+
     // if playing a file close it first
     // this has to be changed so we won't have to close it.
     if(IsRunning())
@@ -769,6 +773,7 @@ void CDVDPlayer::OpenDefaultStreams(bool reset)
 
 bool CDVDPlayer::ReadPacket(DemuxPacket*& packet, CDemuxStream*& stream)
 {
+  CPlaybackTraceSpan span("CDVDPlayer::ReadPacket");
 
   // check if we should read from subtitle demuxer
   if( m_pSubtitleDemuxer && m_dvdPlayerSubtitle.AcceptsData() )
@@ -1116,6 +1121,12 @@ void CDVDPlayer::Process()
     && (m_dvdPlayerVideo.GetLevel() > 50 || m_CurrentVideo.id < 0))
       Sleep(0);
 
+    if (CPlaybackTrace::IsEnabled())
+    {
+      CPlaybackTrace::AddCounter("AudioQueueLevel", m_dvdPlayerAudio.GetLevel());
+      CPlaybackTrace::AddCounter("VideoQueueLevel", m_dvdPlayerVideo.GetLevel());
+    }
+
     DemuxPacket* pPacket = NULL;
     CDemuxStream *pStream = NULL;
     ReadPacket(pPacket, pStream);
@@ -2006,6 +2017,10 @@ void CDVDPlayer::OnExit()
     m_pDemuxer = NULL;
   }
 
+  // the audio and video threads have finished, their events are all in
+  if (g_advancedSettings.m_playbackTrace)
+    CPlaybackTrace::Save();
+
   m_bStop = true;
   // if we didn't stop playing, advance to the next item in xbmc's playlist
   if(m_PlayerOptions.identify == false)
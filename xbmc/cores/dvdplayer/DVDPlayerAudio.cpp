@@ -28,6 +28,7 @@
 #include "settings/Settings.h"
 #include "video/VideoReferenceClock.h"
 #include "utils/log.h"
+#include "utils/PlaybackTrace.h"
 #include "utils/TimeUtils.h"
 #include "utils/MathUtils.h"
 #include "cores/AudioEngine/AEFactory.h"
@@ -272,7 +273,9 @@ int CDVDPlayerAudio::DecodeFrame(DVDAudioFrame &audioframe, bool bDropPacket)
       if (dts != DVD_NOPTS_VALUE)
         m_audioClock = dts;
 
+      CPlaybackTraceSpan decodeSpan("CDVDPlayerAudio::Decode");
       int len = m_pAudioCodec->Decode(m_decode.data, m_decode.size);
+      decodeSpan.End();
       m_audioStats.AddSampleBytes(m_decode.size);
       if (len < 0)
       {
@@ -682,6 +685,7 @@ void CDVDPlayerAudio::HandleSyncError(double duration)
 
   if( fabs(error) > DVD_MSEC_TO_TIME(100) || m_syncclock )
   {
+    CPlaybackTrace::AddInstant("CDVDPlayerAudio::Discontinuity");
     m_pClock->Discontinuity(clock+error);
     if(m_speed == DVD_PLAYSPEED_NORMAL)
       CLog::Log(LOGDEBUG, "CDVDPlayerAudio:: Discontinuity1 - was:%f, should be:%f, error:%f", clock, clock+error, error);
@@ -716,6 +720,7 @@ void CDVDPlayerAudio::HandleSyncError(double duration)
   {
     m_errortime = now;
     m_error = m_errorbuff / m_errorcount;
+    CPlaybackTrace::AddCounter("AudioSyncError", (int64_t)m_error);
 
     m_errorbuff = 0;
     m_errorcount = 0;
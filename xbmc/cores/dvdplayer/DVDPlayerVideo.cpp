@@ -45,6 +45,7 @@
 #include <iterator>
 #include "guilib/GraphicContext.h"
 #include "utils/log.h"
+#include "utils/PlaybackTrace.h"
 
 using namespace std;
 using namespace RenderManager;
@@ -550,7 +551,9 @@ void CDVDPlayerVideo::Process()
 
       mFilters = m_pVideoCodec->SetFilters(mFilters);
 
+      CPlaybackTraceSpan decodeSpan("CDVDPlayerVideo::Decode");
       int iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      decodeSpan.End();
 
       // buffer packets so we can recover should decoder flush for some reason
       if(m_pVideoCodec->GetConvergeCount() > 0)
@@ -568,6 +571,7 @@ void CDVDPlayerVideo::Process()
       // pictures when they come from demuxer
       if(bRequestDrop && !bPacketDrop && (iDecoderState & VC_BUFFER) && !(iDecoderState & VC_PICTURE))
       {
+        CPlaybackTrace::AddInstant("CDVDPlayerVideo::DroppedFrame");
         m_iDroppedFrames++;
         iDropped++;
       }
@@ -713,6 +717,7 @@ void CDVDPlayerVideo::Process()
 
             if( (iResult & EOS_DROPPED) && !bPacketDrop )
             {
+              CPlaybackTrace::AddInstant("CDVDPlayerVideo::DroppedFrame");
               m_iDroppedFrames++;
               iDropped++;
             }
@@ -1221,7 +1226,9 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
 
   AutoCrop(pPicture);
 
+  CPlaybackTraceSpan waitSpan("CXBMCRenderManager::WaitForBuffer");
   int buffer = g_renderManager.WaitForBuffer(m_bStop, std::max(DVD_TIME_TO_MSEC(iSleepTime) + 500, 0));
+  waitSpan.End();
   if (buffer < 0)
     return EOS_DROPPED;
 
@@ -1244,6 +1251,7 @@ int CDVDPlayerVideo::OutputPicture(const DVDVideoPicture* src, double pts)
   if (index < 0)
     return EOS_DROPPED;
 
+  CPlaybackTraceSpan flipSpan("CXBMCRenderManager::FlipPage");
   g_renderManager.FlipPage(CThread::m_bStop, (iCurrentClock + iSleepTime) / DVD_TIME_BASE, -1, mDisplayField);
 
   return result;
@@ -0,0 +1,310 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "threads/SystemClock.h"
+
+#include "threads/test/TestHelpers.h"
+
+#include <algorithm>
+
+static CDVDMsg* MakePacket(int size, double dts)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(size);
+  packet->iSize = size;
+  packet->dts   = dts;
+  packet->pts   = DVD_NOPTS_VALUE;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+static double PacketDts(CDVDMsg* msg)
+{
+  return ((CDVDMsgDemuxerPacket*)msg)->GetPacket()->dts;
+}
+
+class packet_producer : public IRunnable
+{
+  CDVDMessageQueue& queue;
+  int count;
+public:
+  packet_producer(CDVDMessageQueue& q, int c) : queue(q), count(c) {}
+
+  void Run()
+  {
+    for (int i = 0; i < count; i++)
+    {
+      // don't let the queue grow without bounds, like CDVDPlayer does
+      while (queue.GetDataSize() > 1024 * 1024)
+        SleepMillis(0);
+      queue.Put(MakePacket(188, (double)i));
+    }
+  }
+};
+
+TEST(TestDVDMessageQueue, Order)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(MakePacket(10, 1 * DVD_TIME_BASE));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  queue.Put(MakePacket(20, 2 * DVD_TIME_BASE));
+  EXPECT_EQ(30, queue.GetDataSize());
+  EXPECT_EQ(2U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(1 * DVD_TIME_BASE, PacketDts(msg));
+  msg->Release();
+  EXPECT_EQ(20, queue.GetDataSize());
+
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  msg->Release();
+
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_EQ(2 * DVD_TIME_BASE, PacketDts(msg));
+  msg->Release();
+  EXPECT_EQ(0, queue.GetDataSize());
+
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Priority)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(MakePacket(10, 1 * DVD_TIME_BASE));
+  queue.Put(MakePacket(10, 2 * DVD_TIME_BASE));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 1);
+
+  CDVDMsg* msg;
+  int priority = 1;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_FLUSH));
+  EXPECT_EQ(1, priority);
+  msg->Release();
+
+  // nothing left at that priority, the packets stay
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0, priority));
+  EXPECT_EQ(20, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Flush)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  for (int i = 0; i < 10; i++)
+    queue.Put(MakePacket(100, i * DVD_TIME_BASE));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  EXPECT_EQ(1000, queue.GetDataSize());
+  EXPECT_EQ(9, queue.GetTimeSize());
+
+  queue.Flush();
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(0, queue.GetLevel());
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(1U, queue.GetPacketCount(CDVDMsg::GENERAL_RESYNC));
+
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  msg->Release();
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, TimeSize)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  // before anything is taken the back is the first packet put
+  for (int i = 1; i <= 10; i++)
+    queue.Put(MakePacket(100, i * DVD_TIME_BASE));
+  EXPECT_EQ(9, queue.GetTimeSize());
+  EXPECT_FALSE(queue.IsDataBased());
+
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  msg->Release();
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  msg->Release();
+  EXPECT_EQ(8, queue.GetTimeSize());
+
+  // the times of flushed packets are forgotten
+  queue.Flush();
+  EXPECT_TRUE(queue.IsDataBased());
+  for (int i = 20; i <= 22; i++)
+    queue.Put(MakePacket(100, i * DVD_TIME_BASE));
+  EXPECT_EQ(2, queue.GetTimeSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, RingOverflow)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  // once the ring is full packets continue through the list, in order
+  const int count = MSGQ_RING_SIZE + 100;
+  for (int i = 0; i < count; i++)
+    queue.Put(MakePacket(1, (double)i));
+  EXPECT_EQ(count, queue.GetDataSize());
+  EXPECT_EQ((unsigned)count, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  CDVDMsg* msg;
+  for (int i = 0; i < count; i++)
+  {
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    EXPECT_EQ((double)i, PacketDts(msg));
+    msg->Release();
+  }
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Abort)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+  queue.Abort();
+
+  CDVDMsg* msg;
+  EXPECT_EQ(MSGQ_ABORT, queue.Get(&msg, 1000));
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, EndWhilePutting)
+{
+  CDVDMessageQueue queue("test");
+  queue.SetMaxDataSize(2 * 1024 * 1024);
+  queue.Init();
+
+  // the ring is reset while the producer keeps putting, nothing may be left behind
+  packet_producer producer(queue, 50000);
+  thread producerThread(producer);
+  for (int i = 0; i < 100; i++)
+  {
+    SleepMillis(1);
+    queue.End();
+    queue.Init();
+  }
+  queue.End();
+  producerThread.join();
+
+  queue.Init();
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Throughput)
+{
+  CDVDMessageQueue queue("test");
+  queue.SetMaxDataSize(2 * 1024 * 1024);
+  queue.Init();
+
+  const int count = 200000;
+  packet_producer producer(queue, count);
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  thread producerThread(producer);
+
+  CDVDMsg* msg;
+  for (int i = 0; i < count; i++)
+  {
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 5000));
+    ASSERT_EQ((double)i, PacketDts(msg));
+    msg->Release();
+  }
+  producerThread.join();
+
+  unsigned int elapsed = std::max(1U, XbmcThreads::SystemClockMillis() - start);
+  RecordProperty("elapsedMs", (int)elapsed);
+  RecordProperty("packetsPerSecond", (int)((int64_t)count * 1000 / elapsed));
+
+  // far below a demuxer's rate, a queue falling back to a wait per packet would miss it
+  EXPECT_GT(10000U, elapsed);
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+class packet_waker : public IRunnable
+{
+  CDVDMessageQueue& queue;
+  int count;
+public:
+  volatile long ready;
+  unsigned int sent;
+
+  packet_waker(CDVDMessageQueue& q, int c) : queue(q), count(c), ready(0), sent(0) {}
+
+  void Run()
+  {
+    for (int i = 0; i < count; i++)
+    {
+      // let the consumer block on the empty queue first
+      while (!ready)
+        SleepMillis(0);
+      ready = 0;
+      SleepMillis(1);
+      sent = XbmcThreads::SystemClockMillis();
+      queue.Put(MakePacket(188, (double)i));
+    }
+  }
+};
+
+TEST(TestDVDMessageQueue, WakeupLatency)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  const int count = 200;
+  packet_waker waker(queue, count);
+  thread wakerThread(waker);
+
+  unsigned int total = 0;
+  unsigned int worst = 0;
+  CDVDMsg* msg;
+  for (int i = 0; i < count; i++)
+  {
+    AtomicIncrement(&waker.ready);
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 5000));
+    unsigned int latency = XbmcThreads::SystemClockMillis() - waker.sent;
+    total += latency;
+    worst  = std::max(worst, latency);
+    msg->Release();
+  }
+  wakerThread.join();
+
+  RecordProperty("avgLatencyMs", (int)(total / count));
+  RecordProperty("maxLatencyMs", (int)worst);
+  EXPECT_GT(50U, total / count);
+  // a lost wakeup would show up as the full Get timeout
+  EXPECT_LT(worst, 1000U);
+  queue.End();
+}
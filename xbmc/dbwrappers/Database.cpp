@@ -27,6 +27,7 @@
 #include "utils/AutoPtrHandle.h"
 #include "utils/log.h"
 #include "utils/SortUtils.h"
+#include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "sqlitedataset.h"
 #include "DatabaseManager.h"
@@ -105,6 +106,7 @@ CDatabase::CDatabase(void)
   m_openCount = 0;
   m_sqlite = true;
   m_bMultiWrite = false;
+  m_searchMinWordLength = 0;
 }
 
 CDatabase::~CDatabase(void)
@@ -308,6 +310,152 @@ bool CDatabase::CommitInsertQueries()
   return bReturn;
 }
 
+/* words of a search, the characters the full-text query languages give a meaning to are separators.
+   words shorter than minLength (counted in bytes, which errs on the side of keeping them) aren't indexed */
+static std::vector<std::string> GetSearchWords(const std::string &search, unsigned int minLength)
+{
+  std::vector<std::string> words;
+  std::string word;
+  for (std::string::const_iterator it = search.begin(); it != search.end(); ++it)
+  {
+    unsigned char c = (unsigned char)*it;
+    if (c >= 0x80 || isalnum(c))
+      word += *it;
+    else if (!word.empty())
+    {
+      if (word.size() >= minLength)
+        words.push_back(word);
+      word.clear();
+    }
+  }
+  if (!word.empty() && word.size() >= minLength)
+    words.push_back(word);
+  return words;
+}
+
+bool CDatabase::CreateSearchIndex(const std::string &table, const std::string &columns)
+{
+  try
+  {
+    if (m_sqlite)
+      m_pDS->exec(PrepareSQL("CREATE VIRTUAL TABLE %s USING fts4(%s)", table.c_str(), columns.c_str()).c_str());
+    else
+    {
+      /* MATCH() has to name the exact columns of a FULLTEXT index, so there is one per column too */
+      std::vector<std::string> names = StringUtils::Split(columns, ",");
+      std::string definition = "docid integer primary key";
+      for (std::vector<std::string>::iterator it = names.begin(); it != names.end(); ++it)
+      {
+        StringUtils::Trim(*it);
+        definition += ", " + *it + " text";
+      }
+      definition += ", FULLTEXT (" + columns + ")";
+      if (names.size() > 1)
+      {
+        for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+          definition += ", FULLTEXT (" + *it + ")";
+      }
+      m_pDS->exec(PrepareSQL("CREATE TABLE %s (%s) ENGINE=MyISAM", table.c_str(), definition.c_str()).c_str());
+    }
+  }
+  catch (...)
+  {
+    CLog::Log(LOGWARNING, "%s - unable to create the full-text index %s, searches will scan the tables", __FUNCTION__, table.c_str());
+    return false;
+  }
+  m_searchIndexes[table] = true;
+  return true;
+}
+
+void CDatabase::CreateUpdateTrigger(const std::string &name, const std::string &table, const std::string &columns, const std::string &body)
+{
+  if (m_sqlite)
+  {
+    m_pDS->exec(("CREATE TRIGGER " + name + " AFTER UPDATE OF " + columns + " ON " + table + " FOR EACH ROW BEGIN " + body + " END").c_str());
+    return;
+  }
+
+  /* mysql triggers can't name columns, the body checks whether one of them changed */
+  std::string unchanged;
+  std::vector<std::string> names = StringUtils::Split(columns, ",");
+  for (std::vector<std::string>::iterator it = names.begin(); it != names.end(); ++it)
+  {
+    StringUtils::Trim(*it);
+    unchanged += (unchanged.empty() ? "" : " AND ") + std::string("old.") + *it + " <=> new." + *it;
+  }
+  m_pDS->exec(("CREATE TRIGGER " + name + " AFTER UPDATE ON " + table + " FOR EACH ROW BEGIN IF NOT (" + unchanged + ") THEN " + body + " END IF; END").c_str());
+}
+
+bool CDatabase::HasSearchIndex(const std::string &table)
+{
+  std::map<std::string, bool>::const_iterator it = m_searchIndexes.find(table);
+  if (it != m_searchIndexes.end())
+    return it->second;
+
+  std::string query;
+  if (m_sqlite)
+    query = PrepareSQL("SELECT name FROM sqlite_master WHERE type='table' AND name='%s'", table.c_str());
+  else
+    query = PrepareSQL("SHOW TABLES LIKE '%s'", table.c_str());
+  bool exists = !GetSingleValue(query, m_pDS).empty();
+  m_searchIndexes[table] = exists;
+  return exists;
+}
+
+bool CDatabase::CanSearchIndex(const std::string &table, const std::string &search)
+{
+  if (!HasSearchIndex(table))
+    return false;
+
+  if (!m_sqlite && m_searchMinWordLength == 0)
+  {
+    int length = atoi(GetSingleValue("SELECT @@ft_min_word_len", m_pDS).c_str());
+    m_searchMinWordLength = length > 0 ? length : 4; // the server default
+  }
+  return !GetSearchWords(search, m_sqlite ? 1 : m_searchMinWordLength).empty();
+}
+
+std::string CDatabase::PrepareSearchMatch(const std::string &table, const std::string &columns, const std::string &search) const
+{
+  // a required word that isn't indexed would match nothing, CanSearchIndex() tells whether any word is left
+  std::vector<std::string> words = GetSearchWords(search, m_sqlite ? 1 : std::max(1U, m_searchMinWordLength));
+  if (words.empty())
+    return "0 = 1";
+
+  std::string query;
+  bool singleColumn = columns.find(',') == std::string::npos;
+  for (std::vector<std::string>::const_iterator it = words.begin(); it != words.end(); ++it)
+  {
+    if (!query.empty())
+      query += " ";
+    if (m_sqlite)
+      query += (singleColumn ? columns + ":" : "") + *it + "*";
+    else
+      query += "+" + *it + "*";
+  }
+
+  if (m_sqlite)
+    return PrepareSQL("%s MATCH '%s'", table.c_str(), query.c_str());
+
+  /* qualified, as the indexed table usually has columns of the same names */
+  std::string qualified;
+  std::vector<std::string> names = StringUtils::Split(columns, ",");
+  for (std::vector<std::string>::iterator it = names.begin(); it != names.end(); ++it)
+  {
+    StringUtils::Trim(*it);
+    qualified += (qualified.empty() ? "" : ", ") + table + "." + *it;
+  }
+  return PrepareSQL("MATCH (%s) AGAINST ('%s' IN BOOLEAN MODE)", qualified.c_str(), query.c_str());
+}
+
+std::string CDatabase::PrepareSearchRank(const std::string &table, const std::string &columns, const std::string &search) const
+{
+  /* offsets() lists four space separated numbers per matching word, rows matching more often rank higher */
+  if (m_sqlite)
+    return PrepareSQL("length(offsets(%s)) - length(replace(offsets(%s), ' ', ''))", table.c_str(), table.c_str());
+  return PrepareSearchMatch(table, columns, search);
+}
+
 bool CDatabase::Open()
 {
   DatabaseSettings db_fallback;
@@ -436,7 +584,9 @@ bool CDatabase::Connect(const CStdString &dbName, const DatabaseSettings &dbSett
   // create the appropriate database structure
   if (dbSettings.type.Equals("sqlite3"))
   {
-    m_pDB.reset( new SqliteDatabase() ) ;
+    SqliteDatabase *sqlite = new SqliteDatabase();
+    sqlite->setWAL(g_advancedSettings.m_databaseWAL);
+    m_pDB.reset(sqlite);
   }
 #ifdef HAS_MYSQL
   else if (dbSettings.type.Equals("mysql"))
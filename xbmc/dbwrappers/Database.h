@@ -27,6 +27,7 @@ namespace dbiplus {
   class Dataset;
 }
 
+#include <map>
 #include <memory>
 
 class DatabaseSettings; // forward
@@ -160,6 +161,44 @@ protected:
 
   bool BuildSQL(const CStdString &strQuery, const Filter &filter, CStdString &strSQL);
 
+  /*! \brief Create a full-text index of text columns, with a FTS4 table on sqlite and a FULLTEXT indexed table on mysql.
+   The index has a docid column, the id of the indexed row, and has to be kept up to date with triggers.
+   \param table name of the index.
+   \param columns comma separated names of the indexed columns.
+   \return false if full-text indexes aren't supported, in which case searches have to scan the tables.
+   */
+  bool CreateSearchIndex(const std::string &table, const std::string &columns);
+
+  /*! \brief Create a trigger that runs after an update of some columns of a table only.
+   Keeps full-text indexes from being rewritten when unrelated columns like play counts change.
+   \param name name of the trigger.
+   \param table the updated table.
+   \param columns comma separated names of the columns whose update runs the trigger.
+   \param body the statements of the trigger, each terminated by a semicolon.
+   */
+  void CreateUpdateTrigger(const std::string &name, const std::string &table, const std::string &columns, const std::string &body);
+
+  /*! \brief Whether a full-text index was created */
+  bool HasSearchIndex(const std::string &table);
+
+  /*! \brief Whether a full-text index exists and can answer the search.
+   MySQL doesn't index words shorter than ft_min_word_len, a search made of such words only
+   has to scan the tables.
+   */
+  bool CanSearchIndex(const std::string &table, const std::string &search);
+
+  /*! \brief Condition for rows of a full-text index that contain a word starting with each word of the search.
+   \param table name of the index.
+   \param columns the columns to search, either a single indexed column or all of them as passed to CreateSearchIndex().
+   \param search the search text.
+   */
+  std::string PrepareSearchMatch(const std::string &table, const std::string &columns, const std::string &search) const;
+
+  /*! \brief Relevance of the rows matched by PrepareSearchMatch(), higher is better.
+   \sa PrepareSearchMatch
+   */
+  std::string PrepareSearchRank(const std::string &table, const std::string &columns, const std::string &search) const;
+
   bool m_sqlite; ///< \brief whether we use sqlite (defaults to true)
 
   std::auto_ptr<dbiplus::Database> m_pDB;
@@ -173,4 +212,6 @@ private:
 
   bool m_bMultiWrite; /*!< True if there are any queries in the queue, false otherwise */
   unsigned int m_openCount;
+  std::map<std::string, bool> m_searchIndexes; /*!< whether the full-text indexes that were looked for exist */
+  unsigned int m_searchMinWordLength;          /*!< shortest word in a full-text index, 0 if not known yet */
 };
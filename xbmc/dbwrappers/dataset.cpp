@@ -75,6 +75,81 @@ string Database::prepare(const char *format, ...)
   return result;
 }
 
+/* runs a statement by substituting the bound values for its placeholders */
+class FormattedStatement : public Statement {
+public:
+  FormattedStatement(Database *db, const std::string &sql)
+    : db(db), ds(db->CreateDataset())
+  {
+    // split the sql at the placeholders, quoted question marks are not placeholders
+    std::string part;
+    bool quoted = false;
+    for (std::string::const_iterator c = sql.begin(); c != sql.end(); ++c)
+    {
+      if (*c == '\'')
+        quoted = !quoted;
+      if (*c == '?' && !quoted)
+      {
+        parts.push_back(part);
+        part.clear();
+      }
+      else
+        part += *c;
+    }
+    parts.push_back(part);
+    values.resize(parts.size() - 1, "NULL");
+  }
+
+  virtual ~FormattedStatement() { delete ds; }
+
+  virtual void bind(int index, int64_t value)
+  {
+    char buffer[32];
+    sprintf(buffer, "%lld", (long long)value);
+    set(index, buffer);
+  }
+
+  virtual void bind(int index, const std::string &value)
+  {
+    set(index, db->prepare("'%s'", value.c_str()));
+  }
+
+  virtual void bind_null(int index)
+  {
+    set(index, "NULL");
+  }
+
+  virtual void exec()
+  {
+    std::string sql = parts[0];
+    for (unsigned int i = 0; i < values.size(); i++)
+    {
+      sql += values[i];
+      sql += parts[i + 1];
+      values[i] = "NULL";
+    }
+    ds->exec(sql);
+  }
+
+private:
+  void set(int index, const std::string &value)
+  {
+    if (index < 1 || index > (int)values.size())
+      throw DbErrors("Statement parameter %d out of range", index);
+    values[index - 1] = value;
+  }
+
+  Database                *db;
+  Dataset                 *ds;
+  std::vector<std::string> parts;
+  std::vector<std::string> values;
+};
+
+Statement *Database::prepare_statement(const std::string &sql)
+{
+  return new FormattedStatement(this, sql);
+}
+
 //************* Dataset implementation ***************
 
 Dataset::Dataset() {
@@ -42,6 +42,7 @@
 
 namespace dbiplus {
 class Dataset;		// forward declaration of class Dataset
+class Statement;	// forward declaration of class Statement
 
 
 #define S_NO_CONNECTION "No active connection";
@@ -153,6 +154,32 @@ public:
 
   virtual bool in_transaction() {return false;};
 
+/* virtual methods for bulk writes */
+
+  /*! \brief Compile a write statement to run it many times with different values.
+   The default implementation formats the values into the sql and runs it as a query.
+   \param sql - the statement, with ? in place of each value.
+   \return the statement, owned by the caller.
+   */
+  virtual Statement *prepare_statement(const std::string &sql);
+
+};
+
+/******************* Class Statement definition *******************
+
+   a write statement with ? placeholders, bound by position
+   (starting at 1) before each exec; bound values are cleared
+   after exec. errors throw DbErrors
+
+******************************************************************/
+class Statement {
+public:
+  virtual ~Statement() {}
+
+  virtual void bind(int index, int64_t value) = 0;
+  virtual void bind(int index, const std::string &value) = 0;
+  virtual void bind_null(int index) = 0;
+  virtual void exec() = 0;
 };
 
 
@@ -27,20 +27,101 @@
  **********************************************************************/
 
 #include <iostream>
+#include <map>
 #include <string>
 
 #include "sqlitedataset.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "system.h" // for Sleep(), OutputDebugString() and GetLastError()
 #include "utils/URIUtils.h"
 
+#ifdef TARGET_POSIX
+#include <sys/stat.h>
+#endif
+#if defined(TARGET_LINUX)
+#include <sys/vfs.h>
+#elif defined(TARGET_DARWIN) || defined(TARGET_FREEBSD)
+#include <sys/param.h>
+#include <sys/mount.h>
+#endif
+
 #ifdef TARGET_WINDOWS
 #pragma comment(lib, "sqlite3.lib")
 #endif
 
 using namespace std;
 
+// idle connections kept per database file
+#define SQLITE_POOL_SIZE 4
+
 namespace dbiplus {
+
+/* Databases are opened and closed for almost every library listing, so connections are handed
+   back here instead of being closed. In WAL mode each of them reads its own snapshot while a
+   single writer holds the write lock, so they don't wait for the scanner. */
+typedef std::pair<uint64_t, uint64_t> FileId; // device and inode of the database file
+struct IdleConnection
+{
+  sqlite3 *conn;
+  FileId   file;
+};
+static CCriticalSection                      g_poolSection;
+static std::multimap<string, IdleConnection> g_idleConnections;
+static bool                              g_poolClosed = false;
+
+/* A connection is only reused on the file it was opened on, not on one created at the same
+   path after the database was removed. Without inodes (windows) an open file can't be replaced. */
+static FileId GetFileId(const string &path)
+{
+#ifdef TARGET_POSIX
+  struct stat st;
+  if (stat(path.c_str(), &st) == 0)
+    return FileId(st.st_dev, st.st_ino);
+#endif
+  return FileId(0, 0);
+}
+
+/* Temporary tables and the like belong to the connection, a caller that left them behind would
+   collide with the next user of a reused connection */
+static bool HasTemporaryObjects(sqlite3 *conn)
+{
+  sqlite3_stmt *stmt = NULL;
+  if (sqlite3_prepare_v2(conn, "SELECT 1 FROM sqlite_temp_master LIMIT 1", -1, &stmt, NULL) != SQLITE_OK)
+    return true;
+  bool found = sqlite3_step(stmt) != SQLITE_DONE;
+  sqlite3_finalize(stmt);
+  return found;
+}
+
+/* WAL needs shared memory which doesn't work over NFS or SMB, the database could get corrupted */
+static bool IsNetworkFileSystem(const string &path)
+{
+#if defined(TARGET_WINDOWS)
+  return path.compare(0, 2, "\\\\") == 0;
+#elif defined(TARGET_LINUX)
+  struct statfs fsInfo;
+  if (statfs(path.c_str(), &fsInfo) != 0)
+    return false;
+  switch ((unsigned long)fsInfo.f_type)
+  {
+  case 0x6969:      // NFS
+  case 0x517B:      // SMB
+  case 0xFF534D42:  // CIFS
+  case 0x65735546:  // FUSE, eg. sshfs
+    return true;
+  }
+  return false;
+#elif defined(TARGET_DARWIN) || defined(TARGET_FREEBSD)
+  struct statfs fsInfo;
+  if (statfs(path.c_str(), &fsInfo) != 0)
+    return false;
+  return (fsInfo.f_flags & MNT_LOCAL) == 0;
+#else
+  return false;
+#endif
+}
 //************* Callback function ***************************
 
 int callback(void* res_ptr,int ncol, char** reslt,char** cols)
@@ -92,6 +173,7 @@ SqliteDatabase::SqliteDatabase() {
 
   active = false;	
   _in_transaction = false;		// for transaction
+  wal = true;
 
   error = "Unknown database error";//S_NO_CONNECTION;
   host = "localhost";
@@ -216,6 +298,27 @@ int SqliteDatabase::connect(bool create) {
   try
   {
     disconnect();
+    {
+      FileId file = GetFileId(db_fullpath);
+      CSingleLock lock(g_poolSection);
+      multimap<string, IdleConnection>::iterator it;
+      while ((it = g_idleConnections.find(db_fullpath)) != g_idleConnections.end())
+      {
+        IdleConnection idle = it->second;
+        g_idleConnections.erase(it);
+        if (idle.file != file)
+        {
+          // the database was removed or replaced since
+          sqlite3_close(idle.conn);
+          continue;
+        }
+        conn = idle.conn;
+        file_id = file;
+        active = true;
+        return DB_CONNECTION_OK;
+      }
+    }
+
     int flags = SQLITE_OPEN_READWRITE;
     if (create)
       flags |= SQLITE_OPEN_CREATE;
@@ -227,9 +330,18 @@ int SqliteDatabase::connect(bool create) {
       {
         throw DbErrors(getErrorMsg());
       }
+      // readers no longer block writers and vice versa. the mode is stored in the file,
+      // it stays a rollback journal where WAL isn't available (eg. no shared memory)
+      const char *journal = "PRAGMA journal_mode=DELETE";
+      if (wal && !IsNetworkFileSystem(host))
+        journal = "PRAGMA journal_mode=WAL";
+      if (sqlite3_exec(getHandle(),journal,NULL,NULL,NULL) != SQLITE_OK)
+        CLog::Log(LOGWARNING, "%s - unable to set %s for %s", __FUNCTION__, journal, db_fullpath.c_str());
+      file_id = GetFileId(db_fullpath);
       active = true;
       return DB_CONNECTION_OK;
     }
+    sqlite3_close(conn);
 
     return DB_CONNECTION_NONE;
   }
@@ -259,8 +371,39 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
-  sqlite3_close(conn);
   active = false;
+  _in_transaction = false;
+
+  // only connections without an open transaction, statement or temporary table can be reused
+  if (sqlite3_get_autocommit(conn) && sqlite3_next_stmt(conn, NULL) == NULL && !HasTemporaryObjects(conn))
+  {
+    string db_fullpath = URIUtils::AddFileToFolder(host, db);
+    CSingleLock lock(g_poolSection);
+    if (!g_poolClosed && g_idleConnections.count(db_fullpath) < SQLITE_POOL_SIZE)
+    {
+      IdleConnection idle = { conn, file_id };
+      g_idleConnections.insert(make_pair(db_fullpath, idle));
+      return;
+    }
+  }
+  sqlite3_close(conn);
+}
+
+void SqliteDatabase::close_idle_connections(const string &db_fullpath)
+{
+  CSingleLock lock(g_poolSection);
+  if (db_fullpath.empty())
+    g_poolClosed = true;
+  for (multimap<string, IdleConnection>::iterator it = g_idleConnections.begin(); it != g_idleConnections.end(); )
+  {
+    if (db_fullpath.empty() || it->first == db_fullpath)
+    {
+      sqlite3_close(it->second.conn);
+      g_idleConnections.erase(it++);
+    }
+    else
+      ++it;
+  }
 }
 
 int SqliteDatabase::create() {
@@ -316,6 +459,7 @@ int SqliteDatabase::copy(const char *backup_name) {
 int SqliteDatabase::drop() {
   if (active == false) throw DbErrors("Can't drop database: no active connection...");
   disconnect();
+  close_idle_connections(URIUtils::AddFileToFolder(host, db));
   if (!unlink(db.c_str())) {
      throw DbErrors("Can't drop database: can't unlink the file %s,\nError: %s",db.c_str(),strerror(errno));
      }
@@ -372,6 +516,65 @@ void SqliteDatabase::rollback_transaction() {
 }
 
 
+// methods for bulk writes
+// ---------------------------------------------
+class SqliteStatement : public Statement {
+public:
+  SqliteStatement(SqliteDatabase *db, const string &sql)
+    : db(db), sql(sql), stmt(NULL)
+  {
+    if (db->setErr(sqlite3_prepare_v2(db->getHandle(), sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+      throw DbErrors(db->getErrorMsg());
+  }
+
+  virtual ~SqliteStatement() { sqlite3_finalize(stmt); }
+
+  virtual void bind(int index, int64_t value)
+  {
+    check(sqlite3_bind_int64(stmt, index, value));
+  }
+
+  virtual void bind(int index, const string &value)
+  {
+    check(sqlite3_bind_text(stmt, index, value.c_str(), value.size(), SQLITE_TRANSIENT));
+  }
+
+  virtual void bind_null(int index)
+  {
+    check(sqlite3_bind_null(stmt, index));
+  }
+
+  virtual void exec()
+  {
+    int result = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    if (result != SQLITE_DONE && result != SQLITE_ROW)
+    {
+      db->setErr(result, sql.c_str());
+      throw DbErrors(db->getErrorMsg());
+    }
+  }
+
+private:
+  void check(int result)
+  {
+    if (db->setErr(result, sql.c_str()) != SQLITE_OK)
+      throw DbErrors(db->getErrorMsg());
+  }
+
+  SqliteDatabase *db;
+  string          sql;
+  sqlite3_stmt   *stmt;
+};
+
+Statement *SqliteDatabase::prepare_statement(const string &sql)
+{
+  if (!active)
+    throw DbErrors("No Database Connection");
+  return new SqliteStatement(this, sql);
+}
+
 // methods for formatting
 // ---------------------------------------------
 string SqliteDatabase::vprepare(const char *format, va_list args)
@@ -45,6 +45,9 @@ protected:
   sqlite3 *conn;
   bool _in_transaction;
   int last_err;
+  bool wal;
+/* device and inode of the database file the connection has open */
+  std::pair<uint64_t, uint64_t> file_id;
 
 public:
 /* default constructor */
@@ -65,12 +68,17 @@ public:
   virtual void setHostName(const char *newHost);
 /* sets a database name */
   virtual void setDatabase(const char *newDb);
+/* enables write-ahead logging for new connections, it's never used on network filesystems */
+  void setWAL(bool enable) { wal = enable; }
 
 /* func. connects to database-server */
 
   virtual int connect(bool create);
-/* func. disconnects from database-server */
+/* func. disconnects from database-server, keeping the connection for reuse */
   virtual void disconnect();
+/* closes the connections kept for reuse, of a single database file or of all of them.
+   once all of them are closed, connections are no longer kept on disconnect */
+  static void close_idle_connections(const std::string &db_fullpath = "");
 /* func. creates new database */
   virtual int create();
 /* func. deletes database */
@@ -94,6 +102,9 @@ public:
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* virtual methods for bulk writes */
+  virtual Statement *prepare_statement(const std::string &sql);
+
 };
 
 
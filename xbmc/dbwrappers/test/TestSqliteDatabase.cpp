@@ -0,0 +1,223 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/Event.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <memory>
+
+#define TEST_DATABASE "TestSqliteDatabase.db"
+
+using namespace dbiplus;
+
+class CTestSqliteDatabase : public SqliteDatabase
+{
+public:
+  CTestSqliteDatabase()
+  {
+    setHostName(CSpecialProtocol::TranslatePath("special://temp/").c_str());
+    setDatabase(TEST_DATABASE);
+  }
+
+  int Count()
+  {
+    std::auto_ptr<Dataset> ds(CreateDataset());
+    if (!ds->query("SELECT COUNT(1) FROM items") || ds->num_rows() != 1)
+      return -1;
+    int count = ds->fv(0).get_asInt();
+    ds->close();
+    return count;
+  }
+
+  void Insert(int count)
+  {
+    std::auto_ptr<Dataset> ds(CreateDataset());
+    for (int i = 0; i < count; i++)
+      ds->exec(StringUtils::Format("INSERT INTO items (strName) VALUES ('item %i')", i));
+  }
+};
+
+/* Writes items in transactions of batchSize rows, like a scanner adding a directory at a time. */
+class CWriterThread : public CThread
+{
+public:
+  CWriterThread(int batches, int batchSize)
+    : CThread("TestSqliteDatabaseWriter"), m_batches(batches), m_batchSize(batchSize)
+  {
+    m_db.connect(false);
+  }
+
+  CTestSqliteDatabase m_db;
+  CEvent              m_done;
+
+protected:
+  virtual void Process()
+  {
+    for (int i = 0; i < m_batches; i++)
+    {
+      m_db.start_transaction();
+      m_db.Insert(m_batchSize);
+      m_db.commit_transaction();
+    }
+    m_done.Set();
+  }
+
+  int m_batches;
+  int m_batchSize;
+};
+
+class TestSqliteDatabase : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    DeleteFiles();
+    ASSERT_EQ(DB_CONNECTION_OK, m_db.connect(true));
+    std::auto_ptr<Dataset> ds(m_db.CreateDataset());
+    ds->exec("CREATE TABLE items (idItem integer primary key, strName text)");
+    m_db.start_transaction();
+    m_db.Insert(1000);
+    m_db.commit_transaction();
+  }
+
+  virtual void TearDown()
+  {
+    m_db.disconnect();
+    DeleteFiles();
+  }
+
+  static void DeleteFiles()
+  {
+    SqliteDatabase::close_idle_connections(CSpecialProtocol::TranslatePath("special://temp/" TEST_DATABASE));
+    XFILE::CFile::Delete("special://temp/" TEST_DATABASE);
+    XFILE::CFile::Delete("special://temp/" TEST_DATABASE "-wal");
+    XFILE::CFile::Delete("special://temp/" TEST_DATABASE "-shm");
+  }
+
+  CTestSqliteDatabase m_db;
+};
+
+TEST_F(TestSqliteDatabase, WAL)
+{
+  // datasets only run selects
+  sqlite3_stmt *stmt = NULL;
+  ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(m_db.getHandle(), "PRAGMA journal_mode", -1, &stmt, NULL));
+  ASSERT_EQ(SQLITE_ROW, sqlite3_step(stmt));
+  EXPECT_STREQ("wal", (const char *)sqlite3_column_text(stmt, 0));
+  sqlite3_finalize(stmt);
+}
+
+TEST_F(TestSqliteDatabase, Pool)
+{
+  CTestSqliteDatabase first;
+  ASSERT_EQ(DB_CONNECTION_OK, first.connect(false));
+  sqlite3 *handle = first.getHandle();
+  first.disconnect();
+
+  CTestSqliteDatabase second;
+  ASSERT_EQ(DB_CONNECTION_OK, second.connect(false));
+  EXPECT_EQ(handle, second.getHandle());
+  EXPECT_EQ(1000, second.Count());
+
+  // connections in a transaction are closed, which rolls it back, rather than reused
+  second.start_transaction();
+  second.Insert(10);
+  second.disconnect();
+  EXPECT_EQ(1000, m_db.Count());
+}
+
+TEST_F(TestSqliteDatabase, PoolSkipsTemporaryTables)
+{
+  CTestSqliteDatabase first;
+  ASSERT_EQ(DB_CONNECTION_OK, first.connect(false));
+  std::auto_ptr<Dataset> ds(first.CreateDataset());
+  ds->exec("CREATE TEMPORARY TABLE scratch (id integer)");
+  sqlite3 *handle = first.getHandle();
+  first.disconnect();
+
+  // the table would collide with the next CREATE on a reused connection
+  CTestSqliteDatabase second;
+  ASSERT_EQ(DB_CONNECTION_OK, second.connect(false));
+  EXPECT_NE(handle, second.getHandle());
+  std::auto_ptr<Dataset> ds2(second.CreateDataset());
+  EXPECT_NO_THROW(ds2->exec("CREATE TEMPORARY TABLE scratch (id integer)"));
+}
+
+TEST_F(TestSqliteDatabase, PoolSkipsReplacedFile)
+{
+  m_db.disconnect();
+
+  // remove the database behind the pool's back and create a new one at the same path
+  XFILE::CFile::Delete("special://temp/" TEST_DATABASE);
+  XFILE::CFile::Delete("special://temp/" TEST_DATABASE "-wal");
+  XFILE::CFile::Delete("special://temp/" TEST_DATABASE "-shm");
+
+  CTestSqliteDatabase replaced;
+  ASSERT_EQ(DB_CONNECTION_OK, replaced.connect(true));
+  EXPECT_FALSE(replaced.exists());
+}
+
+TEST_F(TestSqliteDatabase, ReaderDoesNotBlockWriter)
+{
+  // an open read transaction keeps its snapshot
+  std::auto_ptr<Dataset> ds(m_db.CreateDataset());
+  ds->exec("BEGIN");
+  EXPECT_EQ(1000, m_db.Count());
+
+  CWriterThread writer(1, 100);
+  writer.Create();
+  // in rollback journal mode the commit would wait for the reader to finish
+  EXPECT_TRUE(writer.m_done.WaitMSec(5000));
+  EXPECT_EQ(1000, m_db.Count());
+
+  ds->exec("COMMIT");
+  writer.StopThread(true);
+  EXPECT_EQ(1100, m_db.Count());
+}
+
+TEST_F(TestSqliteDatabase, ConcurrentBrowse)
+{
+  CWriterThread writer(50, 200);
+  writer.Create();
+
+  // browse while the scan runs, a read that had to wait for the writer would take at least a
+  // 100ms retry of the busy handler. the timings are only recorded, they depend on the machine
+  unsigned int reads = 0, slowest = 0;
+  while (!writer.m_done.WaitMSec(0))
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    EXPECT_LE(1000, m_db.Count());
+    slowest = std::max(slowest, XbmcThreads::SystemClockMillis() - start);
+    reads++;
+  }
+  writer.StopThread(true);
+
+  RecordProperty("reads", (int)reads);
+  RecordProperty("slowestReadMs", (int)slowest);
+  EXPECT_EQ(1000 + 50 * 200, m_db.Count());
+}
@@ -41,6 +41,7 @@ using namespace std;
 CEpg::CEpg(int iEpgID, const CStdString &strName /* = "" */, const CStdString &strScraperName /* = "" */, bool bLoadedFromDb /* = false */) :
     m_bChanged(!bLoadedFromDb),
     m_bTagsChanged(false),
+    m_bNowNextChanged(true),
     m_bLoaded(false),
     m_bUpdatePending(false),
     m_iEpgID(iEpgID),
@@ -55,6 +56,7 @@ CEpg::CEpg(int iEpgID, const CStdString &strName /* = "" */, const CStdString &s
 CEpg::CEpg(CPVRChannelPtr channel, bool bLoadedFromDb /* = false */) :
     m_bChanged(!bLoadedFromDb),
     m_bTagsChanged(false),
+    m_bNowNextChanged(true),
     m_bLoaded(false),
     m_bUpdatePending(false),
     m_iEpgID(channel->EpgID()),
@@ -68,6 +70,7 @@ CEpg::CEpg(CPVRChannelPtr channel, bool bLoadedFromDb /* = false */) :
 CEpg::CEpg(void) :
     m_bChanged(false),
     m_bTagsChanged(false),
+    m_bNowNextChanged(true),
     m_bLoaded(false),
     m_bUpdatePending(false),
     m_iEpgID(0),
@@ -86,6 +89,7 @@ CEpg &CEpg::operator =(const CEpg &right)
 {
   m_bChanged          = right.m_bChanged;
   m_bTagsChanged      = right.m_bTagsChanged;
+  m_bNowNextChanged   = true;
   m_bLoaded           = right.m_bLoaded;
   m_bUpdatePending    = right.m_bUpdatePending;
   m_iEpgID            = right.m_iEpgID;
@@ -158,6 +162,7 @@ void CEpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
   m_tags.clear();
+  m_bNowNextChanged = true;
 }
 
 void CEpg::Cleanup(void)
@@ -179,6 +184,7 @@ void CEpg::Cleanup(const CDateTime &Time)
 
       it->second->ClearTimer();
       m_tags.erase(it++);
+      m_bNowNextChanged = true;
     }
   }
 }
@@ -298,6 +304,24 @@ CEpgInfoTagPtr CEpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &
   return retVal;
 }
 
+bool CEpg::GetNowNext(const CDateTime &time, CEpgInfoTagPtr &now, CEpgInfoTagPtr &next)
+{
+  CSingleLock lock(m_critSection);
+  m_bNowNextChanged = false;
+  now.reset();
+  next.reset();
+
+  /* the last tag that started before the given time is the active one. if there's a gap it's
+     the last one that ended, like InfoTagNow() returns */
+  map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.upper_bound(time);
+  if (it != m_tags.end())
+    next = it->second;
+  if (it != m_tags.begin())
+    now = (--it)->second;
+
+  return now || next;
+}
+
 CEpgInfoTagPtr CEpg::GetTagAround(const CDateTime &time) const
 {
   CSingleLock lock(m_critSection);
@@ -326,6 +350,7 @@ void CEpg::AddEntry(const CEpgInfoTag &tag)
 
   if (newTag)
   {
+    m_bNowNextChanged = true;
     newTag->Update(tag);
     newTag->SetPVRChannel(m_pvrChannel);
     newTag->m_epg          = this;
@@ -354,6 +379,7 @@ bool CEpg::UpdateEntry(const CEpgInfoTag &tag, bool bUpdateDatabase /* = false *
 
   infoTag->Update(tag, bNewTag);
   infoTag->m_epg          = this;
+  m_bNowNextChanged       = true;
   infoTag->m_pvrChannel   = m_pvrChannel;
 
   if (bUpdateDatabase)
@@ -531,7 +557,7 @@ int CEpg::Get(CFileItemList &results, const EpgSearchFilter &filter) const
   return results.Size() - iInitialSize;
 }
 
-bool CEpg::Persist(void)
+bool CEpg::Persist(SEpgChanges &changes)
 {
   if (CSettings::Get().GetBool("epg.ignoredbforclient") || !NeedsSave())
     return true;
@@ -557,13 +583,17 @@ bool CEpg::Persist(void)
     }
 
     for (std::map<int, CEpgInfoTagPtr>::iterator it = m_deletedTags.begin(); it != m_deletedTags.end(); it++)
-      database->Delete(*it->second);
+    {
+      /* tags without a database ID were not persisted */
+      if (it->second->BroadcastId() > 0)
+        changes.deletedTags.push_back(it->second->BroadcastId());
+    }
 
     for (std::map<int, CEpgInfoTagPtr>::iterator it = m_changedTags.begin(); it != m_changedTags.end(); it++)
-      it->second->Persist(false);
+      changes.changedTags.push_back(it->second);
 
     if (m_bUpdateLastScanTime)
-      database->PersistLastEpgScanTime(m_iEpgID, true);
+      changes.scannedEpgs.push_back(m_iEpgID);
 
     m_deletedTags.clear();
     m_changedTags.clear();
@@ -606,6 +636,7 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
 {
   bool bReturn(true);
   CEpgInfoTagPtr previousTag, currentTag;
+  m_bNowNextChanged = true;
 
   for (map<CDateTime, CEpgInfoTagPtr>::iterator it = m_tags.begin(); it != m_tags.end(); it != m_tags.end() ? it++ : it)
   {
@@ -24,6 +24,7 @@
 
 #include "threads/CriticalSection.h"
 
+#include "EpgDatabase.h"
 #include "EpgInfoTag.h"
 #include "EpgSearchFilter.h"
 #include "utils/Observer.h"
@@ -182,6 +183,20 @@ namespace EPG
      */
     CEpgInfoTagPtr GetTagAround(const CDateTime &time) const;
 
+    /*!
+     * @brief Get the tag that is active at the given time and the one after it.
+     * @param time The time in UTC.
+     * @param now The active tag. In a gap between two tags the one that ended last, as InfoTagNow() returns. Empty if no tag started yet.
+     * @param next The first tag that starts after the given time, if any.
+     * @return True if either tag was found, false otherwise.
+     */
+    bool GetNowNext(const CDateTime &time, CEpgInfoTagPtr &now, CEpgInfoTagPtr &next);
+
+    /*!
+     * @return True if the tags of this table changed since GetNowNext() was last called.
+     */
+    bool NowNextChanged(void) const { return m_bNowNextChanged; }
+
     /*!
      * Get the event that occurs between the given begin and end time.
      * @param beginTime Minimum start time in UTC of the event.
@@ -237,10 +252,12 @@ namespace EPG
     int Get(CFileItemList &results, const EpgSearchFilter &filter) const;
 
     /*!
-     * @brief Persist this table in the database.
+     * @brief Persist this table in the database. Its changed and deleted tags are moved to changes instead
+     *        of being written, so that the changes of all tables can be written at once.
+     * @param changes The changes to add the changes of this table to.
      * @return True if the table was persisted, false otherwise.
      */
-    bool Persist(void);
+    bool Persist(SEpgChanges &changes);
 
     /*!
      * @brief Get the start time of the first entry in this table.
@@ -344,6 +361,7 @@ namespace EPG
     std::map<int, CEpgInfoTagPtr>       m_deletedTags;
     bool                                m_bChanged;        /*!< true if anything changed that needs to be persisted, false otherwise */
     bool                                m_bTagsChanged;    /*!< true when any tags are changed and not persisted, false otherwise */
+    bool                                m_bNowNextChanged; /*!< true when tags were changed since GetNowNext() was last called */
     bool                                m_bLoaded;         /*!< true when the initial entries have been loaded */
     bool                                m_bUpdatePending;  /*!< true if manual update is pending */
     int                                 m_iEpgID;          /*!< the database ID of this table */
@@ -55,6 +55,7 @@ CEpgContainer::CEpgContainer(void) :
   m_updateEvent.Reset();
   m_bLoaded = false;
   m_bHasPendingUpdates = false;
+  m_bPersisting = false;
 }
 
 CEpgContainer::~CEpgContainer(void)
@@ -99,6 +100,7 @@ void CEpgContainer::Clear(bool bClearDb /* = false */)
       delete it->second;
     }
     m_epgs.clear();
+    m_nowNext.Clear();
     m_iNextEpgUpdate  = 0;
     m_bIsInitialising = true;
     m_iNextEpgId = 0;
@@ -149,6 +151,16 @@ bool CEpgContainer::Stop(void)
 {
   StopThread();
 
+  /* write the remaining changes here, as a queued write job is cancelled when shutting down.
+     this waits for a running job to finish. */
+  CollectChanges(true);
+  if (m_database.IsOpen() && !WriteChanges(m_database))
+    CLog::Log(LOGERROR, "EPG - %s - failed to write the changes", __FUNCTION__);
+  {
+    CSingleLock lock(m_critSection);
+    m_bPersisting = false;
+  }
+
   if (m_database.IsOpen())
     m_database.Close();
 
@@ -210,20 +222,77 @@ bool CEpgContainer::PersistTables(void)
 }
 
 bool CEpgContainer::PersistAll(void)
+{
+  bool bReturn = CollectChanges(false);
+
+  CSingleLock lock(m_critSection);
+  if (!m_bPersisting && !m_unsavedChanges.IsEmpty())
+  {
+    m_bPersisting = true;
+    CJobManager::GetInstance().AddJob(new CEpgPersistJob(*this), NULL);
+  }
+
+  return bReturn;
+}
+
+bool CEpgContainer::CollectChanges(bool bAll)
 {
   bool bReturn(true);
+  SEpgChanges changes;
   CSingleLock lock(m_critSection);
-  for (map<unsigned int, CEpg *>::iterator it = m_epgs.begin(); it != m_epgs.end() && !m_bStop; it++)
+  for (map<unsigned int, CEpg *>::iterator it = m_epgs.begin(); it != m_epgs.end() && (bAll || !m_bStop); it++)
   {
     CEpg *epg = it->second;
     if (epg && epg->NeedsSave())
     {
       lock.Leave();
-      bReturn &= epg->Persist();
+      bReturn &= epg->Persist(changes);
       lock.Enter();
     }
   }
 
+  m_unsavedChanges.Append(changes);
+  return bReturn;
+}
+
+bool CEpgContainer::WriteChanges(CEpgDatabase &database)
+{
+  CSingleLock persistLock(m_persistSection);
+
+  SEpgChanges changes;
+  {
+    CSingleLock lock(m_critSection);
+    std::swap(changes, m_unsavedChanges);
+  }
+  if (changes.IsEmpty())
+    return true;
+
+  if (!database.Persist(changes))
+  {
+    /* try again the next time, before the changes made since */
+    CSingleLock lock(m_critSection);
+    changes.Append(m_unsavedChanges);
+    std::swap(changes, m_unsavedChanges);
+    return false;
+  }
+
+  return true;
+}
+
+bool CEpgPersistJob::DoWork(void)
+{
+  bool bReturn(false);
+  CEpgDatabase database;
+  if (database.Open())
+  {
+    bReturn = m_container.WriteChanges(database);
+    database.Close();
+  }
+  else
+    CLog::Log(LOGERROR, "EPG - %s - could not open the database", __FUNCTION__);
+
+  CSingleLock lock(m_container.m_critSection);
+  m_container.m_bPersisting = false;
   return bReturn;
 }
 
@@ -271,6 +340,13 @@ void CEpgContainer::Process(void)
     if (!m_bStop)
       CheckPlayingEvents();
 
+    /* refresh the now and next tags of tables that changed or of which the active tag ended */
+    if (!m_bStop)
+    {
+      CSingleLock lock(m_critSection);
+      m_nowNext.Update(m_epgs, false);
+    }
+
     /* check for changes that need to be saved every 60 seconds */
     if (iNow - iLastSave > 60)
     {
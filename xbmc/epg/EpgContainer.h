@@ -24,10 +24,12 @@
 #include "settings/ISettingCallback.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
+#include "utils/JobManager.h"
 #include "utils/Observer.h"
 
 #include "Epg.h"
 #include "EpgDatabase.h"
+#include "EpgNowNextIndex.h"
 
 #include <map>
 
@@ -44,6 +46,7 @@ namespace EPG
                         private CThread
   {
     friend class CEpgDatabase;
+    friend class CEpgPersistJob;
 
   public:
     /*!
@@ -214,7 +217,17 @@ namespace EPG
     bool IsInitialising(void) const;
 
     /*!
-     * @brief Call Persist() on each table
+     * @brief Get the now and next tags of a table from the index, without locking the container or the table.
+     * @param iEpgId The id of the table.
+     * @param now The active tag, empty if none is active.
+     * @param next The next tag, empty if there is none.
+     * @return True if the table was indexed, false if it has to be looked up in the table itself.
+     */
+    bool GetNowNext(int iEpgId, CEpgInfoTagPtr &now, CEpgInfoTagPtr &next) const { return m_nowNext.Get(iEpgId, now, next); }
+
+    /*!
+     * @brief Call Persist() on each table and write the changed tags of all tables in the background,
+     *        in a single transaction. Changes made while a write is in progress are written the next time.
      * @return True when they all were persisted, false otherwise.
      */
     bool PersistAll(void);
@@ -222,6 +235,20 @@ namespace EPG
     bool PersistTables(void);
 
   protected:
+    /*!
+     * @brief Move the changes of the tables to the unsaved changes.
+     * @param bAll True to include all tables even when the update thread is stopping.
+     * @return True when they all were persisted, false otherwise.
+     */
+    bool CollectChanges(bool bAll);
+
+    /*!
+     * @brief Write the unsaved changes. They are kept to be written the next time if this fails.
+     * @param database The database to write to.
+     * @return True if the changes were written, false otherwise.
+     */
+    bool WriteChanges(CEpgDatabase &database);
+
     /*!
      * @brief Load the EPG settings.
      * @return True if the settings were loaded successfully, false otherwise.
@@ -284,5 +311,25 @@ namespace EPG
     CGUIDialogProgressBarHandle *  m_progressHandle; /*!< the progress dialog that is visible when updating the first time */
     CCriticalSection               m_critSection;    /*!< a critical section for changes to this container */
     CEvent                         m_updateEvent;    /*!< trigger when an update finishes */
+    bool                           m_bPersisting;    /*!< true while a job to write the changes is queued or running */
+    SEpgChanges                    m_unsavedChanges; /*!< changes taken from the tables that haven't been written yet */
+    CCriticalSection               m_persistSection; /*!< held while changes are written */
+    CEpgNowNextIndex               m_nowNext;        /*!< the now and next tags of all tables, refreshed by the update thread */
+  };
+
+  /*!
+   * @brief Writes the changes of the EPG tables to the database, off the EPG update thread.
+   */
+  class CEpgPersistJob : public CJob
+  {
+  public:
+    CEpgPersistJob(CEpgContainer &container) : m_container(container) {}
+    virtual ~CEpgPersistJob() {}
+    virtual const char *GetType() const { return "epg-persist"; }
+
+    virtual bool DoWork();
+
+  private:
+    CEpgContainer &m_container;
   };
 }
@@ -21,6 +21,7 @@
 #include "dbwrappers/dataset.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/VideoSettings.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 #include "addons/include/xbmc_pvr_types.h"
 
@@ -415,6 +416,105 @@ int CEpgDatabase::Persist(const CEpgInfoTag &tag, bool bSingleUpdate /* = true *
   return iReturn;
 }
 
+bool CEpgDatabase::Persist(const SEpgChanges &changes)
+{
+  if (changes.IsEmpty())
+    return true;
+  if (NULL == m_pDB.get())
+    return false;
+
+  unsigned int iStart = XbmcThreads::SystemClockMillis();
+  BeginTransaction();
+  try
+  {
+    /* one statement per operation, compiled once and bound for every row */
+    std::auto_ptr<Statement> deleteTag(m_pDB->prepare_statement("DELETE FROM epgtags WHERE idBroadcast = ?"));
+    for (vector<int>::const_iterator it = changes.deletedTags.begin(); it != changes.deletedTags.end(); ++it)
+    {
+      deleteTag->bind(1, *it);
+      deleteTag->exec();
+    }
+
+    std::auto_ptr<Statement> persistTag(m_pDB->prepare_statement("REPLACE INTO epgtags (idEpg, iStartTime, "
+        "iEndTime, sTitle, sPlotOutline, sPlot, iGenreType, iGenreSubType, sGenre, "
+        "iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
+        "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid, idBroadcast) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
+    for (vector<CEpgInfoTagPtr>::const_iterator it = changes.changedTags.begin(); it != changes.changedTags.end(); ++it)
+    {
+      const CEpgInfoTag &tag = **it;
+      if (tag.EpgID() <= 0)
+      {
+        CLog::Log(LOGERROR, "%s - tag '%s' does not have a valid table", __FUNCTION__, tag.Title(true).c_str());
+        continue;
+      }
+
+      time_t iStartTime, iEndTime, iFirstAired;
+      tag.StartAsUTC().GetAsTime(iStartTime);
+      tag.EndAsUTC().GetAsTime(iEndTime);
+      tag.FirstAiredAsUTC().GetAsTime(iFirstAired);
+
+      /* Only store the genre string when needed */
+      CStdString strGenre = (tag.GenreType() == EPG_GENRE_USE_STRING) ? StringUtils::Join(tag.Genre(), g_advancedSettings.m_videoItemSeparator) : "";
+
+      persistTag->bind(1, tag.EpgID());
+      persistTag->bind(2, iStartTime);
+      persistTag->bind(3, iEndTime);
+      persistTag->bind(4, tag.Title(true));
+      persistTag->bind(5, tag.PlotOutline(true));
+      persistTag->bind(6, tag.Plot(true));
+      persistTag->bind(7, tag.GenreType());
+      persistTag->bind(8, tag.GenreSubType());
+      persistTag->bind(9, strGenre);
+      persistTag->bind(10, iFirstAired);
+      persistTag->bind(11, tag.ParentalRating());
+      persistTag->bind(12, tag.StarRating());
+      persistTag->bind(13, tag.Notify());
+      persistTag->bind(14, tag.SeriesNum());
+      persistTag->bind(15, tag.EpisodeNum());
+      persistTag->bind(16, tag.EpisodePart());
+      persistTag->bind(17, tag.EpisodeName());
+      persistTag->bind(18, tag.UniqueBroadcastID());
+      if (tag.BroadcastId() < 0)
+        persistTag->bind_null(19);
+      else
+        persistTag->bind(19, tag.BroadcastId());
+      persistTag->exec();
+    }
+
+    if (!changes.scannedEpgs.empty())
+    {
+      CStdString strLastScan = CDateTime::GetCurrentDateTime().GetAsUTCDateTime().GetAsDBDateTime();
+      std::auto_ptr<Statement> persistScan(m_pDB->prepare_statement("REPLACE INTO lastepgscan(idEpg, sLastScan) VALUES (?, ?)"));
+      for (vector<int>::const_iterator it = changes.scannedEpgs.begin(); it != changes.scannedEpgs.end(); ++it)
+      {
+        persistScan->bind(1, *it);
+        persistScan->bind(2, strLastScan);
+        persistScan->exec();
+      }
+    }
+
+    CommitTransaction();
+  }
+  catch (DbErrors &error)
+  {
+    CLog::Log(LOGERROR, "EpgDB - %s - failed to persist the EPG changes: %s", __FUNCTION__, error.getMsg());
+    RollbackTransaction();
+    return false;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "EpgDB - %s - failed to persist the EPG changes", __FUNCTION__);
+    RollbackTransaction();
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG, "EpgDB - %s - persisted %u changed tags, %u deleted tags and %u scan times in %u ms", __FUNCTION__,
+      (unsigned int)changes.changedTags.size(), (unsigned int)changes.deletedTags.size(),
+      (unsigned int)changes.scannedEpgs.size(), XbmcThreads::SystemClockMillis() - iStart);
+  return true;
+}
+
 int CEpgDatabase::GetLastEPGId(void)
 {
   CStdString strQuery = FormatSQL("SELECT MAX(idEpg) FROM epg");
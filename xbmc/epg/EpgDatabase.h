@@ -21,13 +21,41 @@
 
 #include "dbwrappers/Database.h"
 #include "XBDateTime.h"
+#include "EpgInfoTag.h"
+
+#include <vector>
 
 namespace EPG
 {
   class CEpg;
-  class CEpgInfoTag;
   class CEpgContainer;
 
+  /*!
+   * @brief Changes of EPG tables since they were last persisted, written to the database at once.
+   */
+  struct SEpgChanges
+  {
+    std::vector<CEpgInfoTagPtr> changedTags;  /*!< new and changed tags */
+    std::vector<int>            deletedTags;  /*!< broadcast ids of removed tags */
+    std::vector<int>            scannedEpgs;  /*!< ids of the tables to update the last scan time for */
+
+    bool IsEmpty(void) const { return changedTags.empty() && deletedTags.empty() && scannedEpgs.empty(); }
+
+    void Append(const SEpgChanges &changes)
+    {
+      changedTags.insert(changedTags.end(), changes.changedTags.begin(), changes.changedTags.end());
+      deletedTags.insert(deletedTags.end(), changes.deletedTags.begin(), changes.deletedTags.end());
+      scannedEpgs.insert(scannedEpgs.end(), changes.scannedEpgs.begin(), changes.scannedEpgs.end());
+    }
+
+    void Clear(void)
+    {
+      changedTags.clear();
+      deletedTags.clear();
+      scannedEpgs.clear();
+    }
+  };
+
   /** The EPG database */
 
   class CEpgDatabase : public CDatabase
@@ -138,6 +166,13 @@ namespace EPG
      */
     virtual int Persist(const CEpgInfoTag &tag, bool bSingleUpdate = true);
 
+    /*!
+     * @brief Persist the changes of any number of tables in a single transaction.
+     * @param changes The changes to write.
+     * @return True if all changes were written, false if nothing was written.
+     */
+    virtual bool Persist(const SEpgChanges &changes);
+
     /*!
      * @return Last EPG id in the database
      */
@@ -0,0 +1,136 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EpgNowNextIndex.h"
+#include "Epg.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+
+using namespace std;
+using namespace EPG;
+
+CEpgNowNextIndex::CEpgNowNextIndex(void) :
+    m_iCurrent(0)
+{
+  m_snapshots[0] = new Snapshot;
+  m_snapshots[1] = NULL;
+  m_iReaders[0]  = 0;
+  m_iReaders[1]  = 0;
+}
+
+CEpgNowNextIndex::~CEpgNowNextIndex(void)
+{
+  delete m_snapshots[0];
+  delete m_snapshots[1];
+}
+
+void CEpgNowNextIndex::Update(const map<unsigned int, CEpg *> &epgs, bool bAll)
+{
+  CSingleLock lock(m_critSection);
+  CDateTime now = CDateTime::GetUTCDateTime();
+  bool bChanged(false);
+
+  /* drop the entries of removed tables */
+  for (Snapshot::iterator it = m_entries.begin(); it != m_entries.end();)
+  {
+    if (epgs.find(it->first) == epgs.end())
+    {
+      m_entries.erase(it++);
+      bChanged = true;
+    }
+    else
+      ++it;
+  }
+
+  for (map<unsigned int, CEpg *>::const_iterator it = epgs.begin(); it != epgs.end(); it++)
+  {
+    CEpg *epg = it->second;
+    if (!epg)
+      continue;
+
+    Snapshot::iterator entryIt = m_entries.find(it->first);
+    if (!bAll && !epg->NowNextChanged() && entryIt != m_entries.end() &&
+        (!entryIt->second.change.IsValid() || entryIt->second.change > now))
+      continue;
+
+    SEntry entry;
+    epg->GetNowNext(now, entry.now, entry.next);
+    if (entry.now && entry.now->EndAsUTC() > now)
+      entry.change = entry.now->EndAsUTC();
+    else if (entry.next)
+      entry.change = entry.next->StartAsUTC();
+
+    if (entryIt == m_entries.end() || entryIt->second.now != entry.now || entryIt->second.next != entry.next)
+      bChanged = true;
+    m_entries[it->first] = entry;
+  }
+
+  if (bChanged)
+    Publish();
+}
+
+void CEpgNowNextIndex::Publish(void)
+{
+  long iCurrent = AtomicAdd(&m_iCurrent, 0);
+  long iNext    = 1 - iCurrent;
+
+  /* readers that looked at the previous snapshot copy two pointers, this doesn't take long */
+  while (AtomicAdd(&m_iReaders[iNext], 0) != 0)
+    XbmcThreads::ThreadSleep(0);
+
+  delete m_snapshots[iNext];
+  m_snapshots[iNext] = new Snapshot(m_entries);
+  cas(&m_iCurrent, iCurrent, iNext);
+}
+
+bool CEpgNowNextIndex::Get(int iEpgId, CEpgInfoTagPtr &now, CEpgInfoTagPtr &next) const
+{
+  long iCurrent;
+  for (;;)
+  {
+    iCurrent = AtomicAdd(&m_iCurrent, 0);
+    AtomicIncrement(&m_iReaders[iCurrent]);
+    if (AtomicAdd(&m_iCurrent, 0) == iCurrent)
+      break;
+    /* the writer flipped in the meantime and may be replacing this slot */
+    AtomicDecrement(&m_iReaders[iCurrent]);
+  }
+
+  bool bReturn(false);
+  const Snapshot *snapshot = m_snapshots[iCurrent];
+  Snapshot::const_iterator it = snapshot->find(iEpgId);
+  if (it != snapshot->end())
+  {
+    now     = it->second.now;
+    next    = it->second.next;
+    bReturn = true;
+  }
+
+  AtomicDecrement(&m_iReaders[iCurrent]);
+  return bReturn;
+}
+
+void CEpgNowNextIndex::Clear(void)
+{
+  CSingleLock lock(m_critSection);
+  m_entries.clear();
+  Publish();
+}
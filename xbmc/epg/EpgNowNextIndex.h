@@ -0,0 +1,90 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "XBDateTime.h"
+#include "threads/CriticalSection.h"
+#include "EpgInfoTag.h"
+
+#include <map>
+
+namespace EPG
+{
+  class CEpg;
+
+  /*!
+   * @brief The now and next tags of all EPG tables, readable without taking any lock.
+   *
+   * The EPG thread refreshes the entries of tables that changed and of tables whose now playing
+   * tag ended, and publishes them as a new snapshot. Readers, like the channel lists and the
+   * info labels, look up the current snapshot in a map keyed by EPG id instead of locking and
+   * searching each table.
+   */
+  class CEpgNowNextIndex
+  {
+  public:
+    CEpgNowNextIndex(void);
+    virtual ~CEpgNowNextIndex(void);
+
+    /*!
+     * @brief Refresh the entries that are out of date and publish them if anything changed.
+     * @param epgs The tables to index. The caller has to prevent changes to this map while updating.
+     * @param bAll Refresh all entries, not just the changed and expired ones.
+     */
+    void Update(const std::map<unsigned int, CEpg *> &epgs, bool bAll);
+
+    /*!
+     * @brief Get the now and next tags of a table. Doesn't take any lock.
+     * @param iEpgId The id of the table.
+     * @param now The active tag, or the one that ended last in a gap, empty if none started yet.
+     * @param next The next tag, empty if there is none.
+     * @return True if the table is indexed, false otherwise.
+     */
+    bool Get(int iEpgId, CEpgInfoTagPtr &now, CEpgInfoTagPtr &next) const;
+
+    /*!
+     * @brief Remove all entries.
+     */
+    void Clear(void);
+
+  private:
+    struct SEntry
+    {
+      CEpgInfoTagPtr now;
+      CEpgInfoTagPtr next;
+      CDateTime      change;  /*!< the time at which now or next changes, invalid if never */
+    };
+    typedef std::map<int, SEntry> Snapshot;
+
+    CEpgNowNextIndex(const CEpgNowNextIndex&);
+    CEpgNowNextIndex const& operator=(CEpgNowNextIndex const&);
+
+    void Publish(void);
+
+    CCriticalSection  m_critSection;     /*!< held by writers only */
+    Snapshot          m_entries;         /*!< the writer's copy of the entries */
+
+    /* readers announce themselves on the slot they read, the writer only replaces the slot that
+       isn't current once no reader is left on it */
+    const Snapshot   *m_snapshots[2];
+    volatile long     m_iCurrent;
+    mutable volatile long m_iReaders[2];
+  };
+}
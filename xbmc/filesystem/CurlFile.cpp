@@ -37,6 +37,7 @@
 #include "../linux/ConvUtils.h"
 #endif
 
+#include "CurlRangeReader.h"
 #include "DllLibCurl.h"
 #include "ShoutcastFile.h"
 #include "SpecialProtocol.h"
@@ -247,6 +248,7 @@ CCurlFile::CReadState::CReadState()
   m_cancelled = false;
   m_bFirstLoop = true;
   m_sendRange = true;
+  m_rangeEnd = -1;
   m_headerdone = false;
   m_readBuffer = 0;
   m_isPaused = false;
@@ -309,6 +311,15 @@ void CCurlFile::CReadState::SetResume(void)
    * request header. If we don't the server may provide different content causing seeking to fail.
    * This only affects HTTP-like items, for FTP it's a null operation.
    */
+  if (m_rangeEnd >= 0)
+  {
+    CStdString range;
+    range.Format("%"PRId64"-%"PRId64, m_filePos, m_rangeEnd);
+    g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RANGE, range.c_str());
+    g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RESUME_FROM_LARGE, (int64_t)0);
+    return;
+  }
+
   if (m_sendRange && m_filePos == 0)
     g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RANGE, "0-");
   else
@@ -414,6 +425,7 @@ CCurlFile::CCurlFile()
   m_proxytype = PROXY_HTTP;
   m_state = new CReadState();
   m_oldState = NULL;
+  m_rangeReader = NULL;
   m_skipshout = false;
   m_httpresponse = -1;
 }
@@ -429,6 +441,9 @@ void CCurlFile::Close()
   if (m_opened && m_forWrite && !m_inError)
       Write(NULL, 0);
 
+  delete m_rangeReader;
+  m_rangeReader = NULL;
+
   m_state->Disconnect();
   delete m_oldState;
   m_oldState = NULL;
@@ -514,8 +529,8 @@ void CCurlFile::SetCommonOptions(CReadState* state)
   g_curlInterface.easy_setopt(h, CURLOPT_SSL_VERIFYPEER, 0);
   g_curlInterface.easy_setopt(h, CURLOPT_SSL_VERIFYHOST, 0);
 
-  g_curlInterface.easy_setopt(m_state->m_easyHandle, CURLOPT_URL, m_url.c_str());
-  g_curlInterface.easy_setopt(m_state->m_easyHandle, CURLOPT_TRANSFERTEXT, FALSE);
+  g_curlInterface.easy_setopt(h, CURLOPT_URL, m_url.c_str());
+  g_curlInterface.easy_setopt(h, CURLOPT_TRANSFERTEXT, FALSE);
 
   // setup POST data if it is set (and it may be empty)
   if (m_postdataset)
@@ -963,6 +978,22 @@ bool CCurlFile::Open(const CURL& url)
   if (CURLE_OK == g_curlInterface.easy_getinfo(m_state->m_easyHandle, CURLINFO_EFFECTIVE_URL,&efurl) && efurl)
     m_url = efurl;
 
+  // fetch large files through several concurrent range requests if requested
+  if (m_seekable && m_multisession
+  &&  g_advancedSettings.m_curlParallelRanges > 1
+  &&  m_state->m_fileSize >= 2 * (int64_t)g_advancedSettings.m_curlRangeChunkSize)
+  {
+    CLog::Log(LOGDEBUG, "CCurlFile::Open - using up to %u parallel range requests", g_advancedSettings.m_curlParallelRanges);
+    m_rangeReader = new CCurlRangeReader(*this, m_state->m_fileSize, g_advancedSettings.m_curlParallelRanges, g_advancedSettings.m_curlRangeChunkSize);
+
+    // the initial transfer isn't read anymore, don't keep it connected. nothing is buffered
+    // at a valid position, so falling back to a single stream has to reconnect
+    int64_t fileSize = m_state->m_fileSize;
+    m_state->Disconnect();
+    m_state->m_fileSize = fileSize;
+    m_state->m_filePos  = -1;
+  }
+
   return true;
 }
 
@@ -1128,7 +1159,7 @@ bool CCurlFile::Exists(const CURL& url)
 
 int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
 {
-  int64_t nextPos = m_state->m_filePos;
+  int64_t nextPos = GetPosition();
   switch(iWhence)
   {
     case SEEK_SET:
@@ -1150,6 +1181,9 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   // We can't seek beyond EOF
   if (m_state->m_fileSize && nextPos > m_state->m_fileSize) return -1;
 
+  if (m_rangeReader)
+    return m_rangeReader->Seek(nextPos) ? nextPos : -1;
+
   if(m_state->Seek(nextPos))
     return nextPos;
 
@@ -1216,9 +1250,36 @@ int64_t CCurlFile::GetLength()
 int64_t CCurlFile::GetPosition()
 {
   if (!m_opened) return 0;
+  if (m_rangeReader)
+    return m_rangeReader->GetPosition();
   return m_state->m_filePos;
 }
 
+unsigned int CCurlFile::Read(void* lpBuf, int64_t uiBufSize)
+{
+  if (m_rangeReader)
+  {
+    unsigned int read = m_rangeReader->Read(lpBuf, uiBufSize);
+    if (!m_rangeReader->HasFailed())
+      return read;
+
+    // server doesn't cooperate, continue with a single stream
+    int64_t pos = m_rangeReader->GetPosition();
+    delete m_rangeReader;
+    m_rangeReader = NULL;
+    if (Seek(pos, SEEK_SET) != pos)
+      return 0;
+  }
+  return m_state->Read(lpBuf, uiBufSize);
+}
+
+bool CCurlFile::ReadString(char *szLine, int iLineLength)
+{
+  if (m_rangeReader)
+    return IFile::ReadString(szLine, iLineLength);
+  return m_state->ReadString(szLine, iLineLength);
+}
+
 int CCurlFile::Stat(const CURL& url, struct __stat64* buffer)
 {
   // if file is already running, get info from it
@@ -1607,5 +1668,14 @@ int CCurlFile::IoControl(EIoControl request, void* param)
   if(request == IOCTRL_SEEK_POSSIBLE)
     return m_seekable ? 1 : 0;
 
+  if(request == IOCTRL_GET_VALIDATOR)
+  {
+    CStdString *validator = (CStdString*)param;
+    *validator = m_state->m_httpheader.GetValue("etag");
+    if (validator->empty())
+      *validator = m_state->m_httpheader.GetValue("last-modified");
+    return validator->empty() ? -1 : 0;
+  }
+
   return -1;
 }
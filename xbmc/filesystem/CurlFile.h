@@ -35,8 +35,11 @@ class CHttpHeader;
 
 namespace XFILE
 {
+  class CCurlRangeReader;
+
   class CCurlFile : public IFile
   {
+    friend class CCurlRangeReader;
     public:
       typedef enum
       {
@@ -57,8 +60,8 @@ namespace XFILE
       virtual int64_t  GetLength();
       virtual int  Stat(const CURL& url, struct __stat64* buffer);
       virtual void Close();
-      virtual bool ReadString(char *szLine, int iLineLength)     { return m_state->ReadString(szLine, iLineLength); }
-      virtual unsigned int Read(void* lpBuf, int64_t uiBufSize)  { return m_state->Read(lpBuf, uiBufSize); }
+      virtual bool ReadString(char *szLine, int iLineLength);
+      virtual unsigned int Read(void* lpBuf, int64_t uiBufSize);
       virtual int Write(const void* lpBuf, int64_t uiBufSize);
       virtual CStdString GetMimeType()                           { return m_state->m_httpheader.GetMimeType(); }
       virtual int IoControl(EIoControl request, void* param);
@@ -115,6 +118,7 @@ namespace XFILE
           bool            m_bFirstLoop;
           bool            m_isPaused;
           bool            m_sendRange;
+          int64_t         m_rangeEnd;         // last byte to request, -1 for the rest of the file
 
           char*           m_readBuffer;
 
@@ -150,6 +154,7 @@ namespace XFILE
     protected:
       CReadState*     m_state;
       CReadState*     m_oldState;
+      CCurlRangeReader* m_rangeReader;
       unsigned int    m_bufferSize;
       int64_t         m_writeOffset;
 
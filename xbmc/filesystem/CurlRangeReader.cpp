@@ -0,0 +1,363 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "CurlRangeReader.h"
+#include "DllLibCurl.h"
+#include "URL.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+using namespace XFILE;
+using namespace XCURL;
+
+#define dllselect select
+
+CCurlRangeReader::CCurlRangeReader(CCurlFile &file, int64_t fileSize, unsigned int maxConnections, unsigned int chunkSize)
+  : m_file(file)
+  , m_fileSize(fileSize)
+  , m_filePos(0)
+  , m_nextStart(0)
+  , m_maxConnections(maxConnections)
+  , m_connections(std::min(2U, maxConnections))
+  , m_chunkSize(chunkSize)
+  , m_failed(false)
+  , m_periodStart(XbmcThreads::SystemClockMillis())
+  , m_periodBytes(0)
+  , m_periodChunks(0)
+  , m_lastRate(0)
+  , m_totalStart(XbmcThreads::SystemClockMillis())
+  , m_totalBytes(0)
+{
+}
+
+CCurlRangeReader::~CCurlRangeReader()
+{
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - m_totalStart;
+  if (m_totalBytes > 0 && elapsed > 0)
+    CLog::Log(LOGDEBUG, "CCurlRangeReader - fetched %"PRId64" bytes at %"PRId64" KB/s, %u concurrent requests at close",
+              m_totalBytes, m_totalBytes * 1000 / elapsed / 1024, m_connections);
+
+  Clear();
+  for (std::vector<CCurlFile::CReadState*>::iterator it = m_idle.begin(); it != m_idle.end(); ++it)
+    delete *it;
+}
+
+int64_t CCurlRangeReader::Received(const CChunk *chunk) const
+{
+  return chunk->consumed + chunk->state->m_buffer.getMaxReadSize() + chunk->state->m_overflowSize;
+}
+
+void CCurlRangeReader::StartChunk(CChunk *chunk)
+{
+  CCurlFile::CReadState *state = chunk->state;
+  if (!state)
+  {
+    if (!m_idle.empty())
+    {
+      state = m_idle.back();
+      m_idle.pop_back();
+    }
+    else
+    {
+      CURL url(m_file.m_url);
+      state = new CCurlFile::CReadState();
+      g_curlInterface.easy_aquire(url.GetProtocol(), url.GetHostName(), &state->m_easyHandle, &state->m_multiHandle);
+    }
+
+    m_file.SetCommonOptions(state);
+    m_file.SetRequestHeaders(state);
+
+    if (state->m_buffer.getSize() != m_chunkSize)
+    {
+      state->m_buffer.Destroy();
+      state->m_buffer.Create(m_chunkSize);
+    }
+    state->m_buffer.Clear();
+    state->m_fileSize = m_fileSize;
+    state->m_filePos  = chunk->start;
+    chunk->state = state;
+  }
+  else
+  {
+    // resume an interrupted transfer after what we already have
+    g_curlInterface.multi_remove_handle(state->m_multiHandle, state->m_easyHandle);
+    state->m_filePos = chunk->start + Received(chunk);
+  }
+
+  state->m_rangeEnd     = chunk->end - 1;
+  state->m_stillRunning = 1;
+  state->SetResume();
+  g_curlInterface.multi_add_handle(state->m_multiHandle, state->m_easyHandle);
+}
+
+void CCurlRangeReader::FinishChunk(CChunk *chunk)
+{
+  chunk->state->Disconnect();
+  chunk->state->m_rangeEnd = -1;
+  m_idle.push_back(chunk->state);
+  delete chunk;
+}
+
+void CCurlRangeReader::Clear()
+{
+  while (!m_chunks.empty())
+  {
+    FinishChunk(m_chunks.front());
+    m_chunks.pop_front();
+  }
+}
+
+void CCurlRangeReader::Schedule()
+{
+  while (m_chunks.size() < m_connections && m_nextStart < m_fileSize)
+  {
+    CChunk *chunk    = new CChunk;
+    chunk->state     = NULL;
+    chunk->start     = m_nextStart;
+    chunk->end       = std::min(m_nextStart + m_chunkSize, m_fileSize);
+    chunk->consumed  = 0;
+    chunk->started   = XbmcThreads::SystemClockMillis();
+    chunk->retries   = 0;
+    chunk->verified  = false;
+    chunk->done      = false;
+    m_nextStart      = chunk->end;
+
+    StartChunk(chunk);
+    m_chunks.push_back(chunk);
+  }
+}
+
+void CCurlRangeReader::Adapt(CChunk *chunk)
+{
+  m_periodBytes += chunk->end - chunk->start;
+  m_totalBytes  += chunk->end - chunk->start;
+
+  // judge a setting only after a full window went through with it
+  if (++m_periodChunks < m_connections)
+    return;
+
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (now == m_periodStart)
+    return;
+
+  unsigned int rate = (unsigned int)(m_periodBytes * 1000 / (now - m_periodStart));
+  unsigned int connections = m_connections;
+  if (rate > m_lastRate + m_lastRate / 10 && m_connections < m_maxConnections)
+    m_connections++;
+  else if (rate < m_lastRate - m_lastRate / 10 && m_connections > 1)
+    m_connections--;
+
+  if (connections != m_connections)
+    CLog::Log(LOGDEBUG, "CCurlRangeReader - %u KB/s with %u requests (was %u KB/s), now using %u",
+              rate / 1024, connections, m_lastRate / 1024, m_connections);
+
+  m_lastRate     = rate;
+  m_periodStart  = now;
+  m_periodBytes  = 0;
+  m_periodChunks = 0;
+}
+
+bool CCurlRangeReader::CheckChunk(CChunk *chunk)
+{
+  CCurlFile::CReadState *state = chunk->state;
+
+  long response = 0;
+  if (!chunk->verified && Received(chunk) > 0)
+  {
+    if (CURLE_OK == g_curlInterface.easy_getinfo(state->m_easyHandle, CURLINFO_RESPONSE_CODE, &response) && response != 206)
+    {
+      CLog::Log(LOGWARNING, "CCurlRangeReader - server answered range request with %ld, disabling parallel fetching", response);
+      m_failed = true;
+      return false;
+    }
+    chunk->verified = true;
+  }
+
+  if (state->m_stillRunning)
+    return true;
+
+  CURLcode result = CURLE_OK;
+  CURLMsg* msg;
+  int msgs;
+  while ((msg = g_curlInterface.multi_info_read(state->m_multiHandle, &msgs)))
+  {
+    if (msg->msg == CURLMSG_DONE)
+      result = msg->data.result;
+  }
+
+  if (result == CURLE_OK && Received(chunk) >= chunk->end - chunk->start)
+  {
+    chunk->done = true;
+    Adapt(chunk);
+    return true;
+  }
+
+  if (++chunk->retries > g_advancedSettings.m_curlretries)
+  {
+    CLog::Log(LOGERROR, "CCurlRangeReader - range %"PRId64"-%"PRId64" failed: %s(%d)",
+              chunk->start, chunk->end, g_curlInterface.easy_strerror(result), result);
+    m_failed = true;
+    return false;
+  }
+
+  CLog::Log(LOGNOTICE, "CCurlRangeReader - reconnecting range %"PRId64"-%"PRId64", (re)try %i", chunk->start, chunk->end, chunk->retries);
+  StartChunk(chunk);
+  return true;
+}
+
+bool CCurlRangeReader::Perform()
+{
+  fd_set fdread;
+  fd_set fdwrite;
+  fd_set fdexcep;
+  int  maxfd   = -1;
+  long timeout = 200;
+  bool running = false;
+
+  FD_ZERO(&fdread);
+  FD_ZERO(&fdwrite);
+  FD_ZERO(&fdexcep);
+
+  for (std::deque<CChunk*>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+  {
+    CChunk *chunk = *it;
+    if (chunk->done)
+      continue;
+
+    CURLMcode result;
+    do
+    {
+      result = g_curlInterface.multi_perform(chunk->state->m_multiHandle, &chunk->state->m_stillRunning);
+    } while (result == CURLM_CALL_MULTI_PERFORM);
+
+    if (result != CURLM_OK)
+    {
+      CLog::Log(LOGERROR, "CCurlRangeReader - Multi perform failed with code %d, aborting", result);
+      m_failed = true;
+      return false;
+    }
+
+    if (!CheckChunk(chunk))
+      return false;
+
+    if (chunk->done)
+      continue;
+
+    int fd = -1;
+    g_curlInterface.multi_fdset(chunk->state->m_multiHandle, &fdread, &fdwrite, &fdexcep, &fd);
+    maxfd = std::max(maxfd, fd);
+
+    long chunkTimeout = -1;
+    if (CURLM_OK == g_curlInterface.multi_timeout(chunk->state->m_multiHandle, &chunkTimeout) && chunkTimeout >= 0)
+      timeout = std::min(timeout, chunkTimeout);
+    running = true;
+  }
+
+  if (!running)
+    return true;
+
+  struct timeval t = { timeout / 1000, (timeout % 1000) * 1000 };
+  if (SOCKET_ERROR == dllselect(maxfd + 1, &fdread, &fdwrite, &fdexcep, &t))
+  {
+    CLog::Log(LOGERROR, "CCurlRangeReader - Failed with socket error");
+    m_failed = true;
+    return false;
+  }
+  return true;
+}
+
+unsigned int CCurlRangeReader::Read(void* lpBuf, int64_t uiBufSize)
+{
+  if (m_failed || m_filePos >= m_fileSize)
+    return 0;
+
+  while (!m_file.m_state->m_cancelled)
+  {
+    Schedule();
+    if (m_chunks.empty())
+      return 0;
+
+    CChunk *chunk = m_chunks.front();
+    unsigned int avail = chunk->state->m_buffer.getMaxReadSize();
+    if (avail > 0)
+    {
+      unsigned int want = (unsigned int)std::min<int64_t>(std::min<int64_t>(avail, uiBufSize), chunk->end - m_filePos);
+      if (!chunk->state->m_buffer.ReadData((char *)lpBuf, want))
+        return 0;
+
+      chunk->consumed += want;
+      m_filePos       += want;
+      if (m_filePos >= chunk->end)
+      {
+        m_chunks.pop_front();
+        FinishChunk(chunk);
+      }
+      return want;
+    }
+
+    if (!Perform())
+      return 0;
+  }
+  return 0;
+}
+
+bool CCurlRangeReader::Seek(int64_t pos)
+{
+  if (pos < 0 || pos > m_fileSize)
+    return false;
+
+  while (!m_chunks.empty())
+  {
+    CChunk *chunk = m_chunks.front();
+    if (pos < chunk->start)
+      break;
+
+    if (pos >= chunk->end)
+    {
+      m_chunks.pop_front();
+      FinishChunk(chunk);
+      continue;
+    }
+
+    // within this chunk, use the data we have if possible
+    int64_t skip = pos - (chunk->start + chunk->consumed);
+    if (skip <= (int64_t)chunk->state->m_buffer.getMaxReadSize()
+    &&  skip >= -chunk->consumed
+    &&  chunk->state->m_buffer.SkipBytes((int)skip))
+    {
+      chunk->consumed += skip;
+      m_filePos = pos;
+      return true;
+    }
+    break;
+  }
+
+  // restart the read ahead at the new position
+  Clear();
+  m_filePos      = pos;
+  m_nextStart    = pos;
+  m_periodStart  = XbmcThreads::SystemClockMillis();
+  m_periodBytes  = 0;
+  m_periodChunks = 0;
+  return true;
+}
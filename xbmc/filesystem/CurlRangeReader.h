@@ -0,0 +1,92 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <vector>
+
+#include "CurlFile.h"
+
+namespace XFILE
+{
+  /*!
+   \brief Reads a http resource ahead through several concurrent Range requests.
+
+   The file is split into chunks that are fetched on separate pooled curl
+   sessions and handed out in file order. The number of concurrent requests
+   adapts to the measured throughput, between 1 and the configured maximum.
+   Used by CCurlFile when advancedsettings <network><curlparallelranges> is > 1.
+   */
+  class CCurlRangeReader
+  {
+  public:
+    CCurlRangeReader(CCurlFile &file, int64_t fileSize, unsigned int maxConnections, unsigned int chunkSize);
+    ~CCurlRangeReader();
+
+    unsigned int Read(void* lpBuf, int64_t uiBufSize);
+    bool         Seek(int64_t pos);
+    int64_t      GetPosition() const { return m_filePos; }
+
+    /*! \brief true if the server doesn't honour range requests, the caller has to fall back to a single stream */
+    bool         HasFailed() const { return m_failed; }
+
+  private:
+    struct CChunk
+    {
+      CCurlFile::CReadState *state;
+      int64_t                start;
+      int64_t                end;      ///< exclusive
+      int64_t                consumed; ///< bytes handed out to the reader
+      unsigned int           started;
+      int                    retries;
+      bool                   verified; ///< response has been checked to be a partial content reply
+      bool                   done;
+    };
+
+    void         Schedule();
+    void         StartChunk(CChunk *chunk);
+    void         FinishChunk(CChunk *chunk);
+    void         Clear();
+    bool         Perform();
+    bool         CheckChunk(CChunk *chunk);
+    void         Adapt(CChunk *chunk);
+    int64_t      Received(const CChunk *chunk) const;
+
+    CCurlFile                          &m_file;
+    int64_t                             m_fileSize;
+    int64_t                             m_filePos;
+    int64_t                             m_nextStart;  ///< start of the next chunk to schedule
+    unsigned int                        m_maxConnections;
+    unsigned int                        m_connections; ///< current concurrency
+    unsigned int                        m_chunkSize;
+    bool                                m_failed;
+
+    std::deque<CChunk*>                 m_chunks;     ///< chunks in file order, front is being read
+    std::vector<CCurlFile::CReadState*> m_idle;       ///< connected sessions available for reuse
+
+    // throughput measurement
+    unsigned int                        m_periodStart;
+    int64_t                             m_periodBytes;
+    unsigned int                        m_periodChunks;
+    unsigned int                        m_lastRate;
+    unsigned int                        m_totalStart;
+    int64_t                             m_totalBytes;
+  };
+}
@@ -24,6 +24,7 @@
 #include "commons/Exception.h"
 #include "FileItem.h"
 #include "DirectoryCache.h"
+#include "StatCache.h"
 #include "settings/Settings.h"
 #include "utils/log.h"
 #include "utils/Job.h"
@@ -32,12 +33,14 @@
 #include "guilib/GUIWindowManager.h"
 #include "dialogs/GUIDialogBusy.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/URIUtils.h"
 
 using namespace std;
 using namespace XFILE;
 
 #define TIME_TO_BUSY_DIALOG 500
+#define TIME_TO_PARTIAL_LISTING 100
 
 class CGetDirectory
 {
@@ -104,6 +107,22 @@ public:
     list.Copy(m_result->m_list);
     return true;
   }
+
+  /*! \brief Copy the items added to the listing since the last call
+   \param listed the number of items already copied, updated to the number now copied.
+   */
+  void GetPartial(CFileItemList& list, int &listed)
+  {
+    // the listing is still being added to, but each access of the list is locked
+    for (int i = listed; i < m_result->m_list.Size(); i++)
+    {
+      CFileItemPtr item = m_result->m_list.Get(i);
+      if (!item)
+        break;
+      list.Add(CFileItemPtr(new CFileItem(*item)));
+      listed = i + 1;
+    }
+  }
   boost::shared_ptr<CResult> m_result;
   unsigned int               m_id;
 };
@@ -151,22 +170,53 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
         {
           CSingleExit ex(g_graphicsContext);
 
+          unsigned int start = XbmcThreads::SystemClockMillis();
           CGetDirectory get(pDirectory, realPath);
-          if(!get.Wait(TIME_TO_BUSY_DIALOG))
+          if(!get.Wait(hints.callback ? TIME_TO_PARTIAL_LISTING : TIME_TO_BUSY_DIALOG))
           {
             CGUIDialogBusy* dialog = (CGUIDialogBusy*)g_windowManager.GetWindow(WINDOW_DIALOG_BUSY);
-            dialog->Show();
+            bool busy = false;
+
+            // items listed so far go to the callback, filtered as the complete listing will be
+            boost::shared_ptr<IDirectory> filter;
+            if (hints.callback)
+            {
+              filter.reset(CDirectoryFactory::Create(realPath));
+              if (filter.get())
+                filter->SetMask(hints.mask);
+            }
+            int listed = 0;
 
             while(!get.Wait(10))
             {
               CSingleLock lock(g_graphicsContext);
 
+              if (hints.callback)
+              {
+                CFileItemList partial;
+                get.GetPartial(partial, listed);
+                if (filter.get())
+                  FilterItems(filter.get(), partial, hints.flags);
+                if (!hints.callback->OnPartialListing(partial))
+                {
+                  cancel = true;
+                  pDirectory->CancelDirectory();
+                  break;
+                }
+              }
+
+              if (dialog && !busy && XbmcThreads::SystemClockMillis() - start >= TIME_TO_BUSY_DIALOG)
+              {
+                dialog->Show();
+                busy = true;
+              }
+
               // update progress
               float progress = pDirectory->GetProgress();
-              if (progress > 0)
+              if (busy && progress > 0)
                 dialog->SetProgress(progress);
 
-              if(dialog->IsCanceled())
+              if(busy && dialog->IsCanceled())
               {
                 cancel = true;
                 pDirectory->CancelDirectory();
@@ -174,12 +224,13 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
               }
 
               lock.Leave(); // prevent an occasional deadlock on exit
-              g_windowManager.ProcessRenderLoop(false);
+              // the items aren't final, so input has to wait for the busy dialog that keeps it away
+              g_windowManager.ProcessRenderLoop(!busy);
             }
-            if(dialog)
+            if(busy)
               dialog->Close();
           }
-          result = get.GetDirectory(items);
+          result = !cancel && get.GetDirectory(items);
         }
         else
         {
@@ -199,22 +250,12 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
       // cache the directory, if necessary
       if (!(hints.flags & DIR_FLAG_BYPASS_CACHE))
         g_directoryCache.SetDirectory(realPath, items, pDirectory->GetCacheType(strPath));
+      g_statCache.AddDirectory(realPath, items);
     }
 
     // now filter for allowed files
     pDirectory->SetMask(hints.mask);
-    for (int i = 0; i < items.Size(); ++i)
-    {
-      CFileItemPtr item = items[i];
-      // TODO: we shouldn't be checking the gui setting here;
-      // callers should use getHidden instead
-      if ((!item->m_bIsFolder && !pDirectory->IsAllowed(item->GetPath())) ||
-          (item->GetProperty("file:hidden").asBoolean() && !(hints.flags & DIR_FLAG_GET_HIDDEN) && !CSettings::Get().GetBool("filelists.showhidden")))
-      {
-        items.Remove(i);
-        i--; // don't confuse loop
-      }
-    }
+    FilterItems(pDirectory.get(), items, hints.flags);
 
     //  Should any of the files we read be treated as a directory?
     //  Disable for database folders, as they already contain the extracted items
@@ -240,7 +281,10 @@ bool CDirectory::Create(const CStdString& strPath)
     auto_ptr<IDirectory> pDirectory(CDirectoryFactory::Create(realPath));
     if (pDirectory.get())
       if(pDirectory->Create(realPath.c_str()))
+      {
+        g_statCache.Remove(realPath);
         return true;
+      }
   }
   XBMCCOMMONS_HANDLE_UNCHECKED
   catch (...)
@@ -288,6 +332,7 @@ bool CDirectory::Remove(const CStdString& strPath)
       if(pDirectory->Remove(realPath.c_str()))
       {
         g_directoryCache.ClearFile(realPath);
+        g_statCache.Remove(realPath);
         return true;
       }
   }
@@ -300,6 +345,22 @@ bool CDirectory::Remove(const CStdString& strPath)
   return false;
 }
 
+void CDirectory::FilterItems(IDirectory *directory, CFileItemList &items, int flags)
+{
+  for (int i = 0; i < items.Size(); ++i)
+  {
+    CFileItemPtr item = items[i];
+    // TODO: we shouldn't be checking the gui setting here;
+    // callers should use getHidden instead
+    if ((!item->m_bIsFolder && !directory->IsAllowed(item->GetPath())) ||
+        (item->GetProperty("file:hidden").asBoolean() && !(flags & DIR_FLAG_GET_HIDDEN) && !CSettings::Get().GetBool("filelists.showhidden")))
+    {
+      items.Remove(i);
+      i--; // don't confuse loop
+    }
+  }
+}
+
 void CDirectory::FilterFileDirectories(CFileItemList &items, const CStdString &mask)
 {
   for (int i=0; i< items.Size(); ++i)
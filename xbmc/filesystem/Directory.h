@@ -33,14 +33,34 @@ public:
   CDirectory(void);
   virtual ~CDirectory(void);
 
+  /*!
+   \brief Receives the items of a directory while it's being listed in the background.
+
+   Only used for listings on the application thread that are allowed to use threads. The items
+   are copies that passed the mask, so they can be shown before the listing is done. They aren't
+   final: the complete listing is still returned by GetDirectory().
+   */
+  class IListingCallback
+  {
+  public:
+    virtual ~IListingCallback() {};
+
+    /*! \brief Called from time to time with the items listed since the last call
+     The items may be empty, the call is also the chance to cancel a listing that stalls.
+     \return false to cancel the listing.
+     */
+    virtual bool OnPartialListing(const CFileItemList &items) = 0;
+  };
+
   class CHints
   {
   public:
-    CHints() : flags(DIR_FLAG_DEFAULTS)
+    CHints() : flags(DIR_FLAG_DEFAULTS), callback(NULL)
     {
     };
     CStdString mask;
     int flags;
+    IListingCallback *callback;
   };
 
   static bool GetDirectory(const CStdString& strPath
@@ -62,5 +82,9 @@ public:
    \param items The item list to filter
    \param mask  The mask to apply when filtering files */
   static void FilterFileDirectories(CFileItemList &items, const CStdString &mask);
+
+private:
+  /*! \brief Remove the files the mask of a directory doesn't allow, and hidden files unless asked for */
+  static void FilterItems(IDirectory *directory, CFileItemList &items, int flags);
 };
 }
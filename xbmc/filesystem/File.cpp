@@ -27,9 +27,11 @@
 #include "DirectoryCache.h"
 #include "Directory.h"
 #include "FileCache.h"
+#include "StatCache.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/BitstreamStats.h"
+#include "utils/StartupTimeline.h"
 #include "Util.h"
 #include "URL.h"
 
@@ -213,6 +215,7 @@ bool CFile::Cache(const CStdString& strFileName, const CStdString& strDest, XFIL
 //*********************************************************************************************
 bool CFile::Open(const CStdString& strFileName, unsigned int flags)
 {
+  CStartupTimeline::CountFileOpen();
   m_flags = flags;
   try
   {
@@ -324,6 +327,9 @@ bool CFile::OpenForWrite(const CStdString& strFileName, bool bOverWrite)
     {
       // add this file to our directory cache (if it's stored)
       g_directoryCache.AddFile(storedFileName);
+      // and forget its stat until it's written
+      g_statCache.Remove(url.Get());
+      m_writePath = url.Get();
       return true;
     }
     return false;
@@ -353,13 +359,19 @@ bool CFile::Exists(const CStdString& strFileName, bool bUseCache /* = true */)
         return true;
       if (bPathInCache)
         return false;
+
+      bool exists;
+      if (g_statCache.Exists(url.Get(), exists))
+        return exists;
     }
 
     auto_ptr<IFile> pFile(CFileFactory::CreateLoader(url));
     if (!pFile.get())
       return false;
 
-    return pFile->Exists(url);
+    bool exists = pFile->Exists(url);
+    g_statCache.SetExists(url.Get(), exists);
+    return exists;
   }
   XBMCCOMMONS_HANDLE_UNCHECKED
   catch (CRedirectException *pRedirectEx)
@@ -416,11 +428,17 @@ int CFile::Stat(const CStdString& strFileName, struct __stat64* buffer)
   try
   {
     url = URIUtils::SubstitutePath(strFileName);
-    
+
+    int result;
+    if (g_statCache.Stat(url.Get(), buffer, result))
+      return result;
+
     auto_ptr<IFile> pFile(CFileFactory::CreateLoader(url));
     if (!pFile.get())
       return -1;
-    return pFile->Stat(url, buffer);
+    result = pFile->Stat(url, buffer);
+    g_statCache.SetStat(url.Get(), buffer, result);
+    return result;
   }
   XBMCCOMMONS_HANDLE_UNCHECKED
   catch (CRedirectException *pRedirectEx)
@@ -526,6 +544,12 @@ void CFile::Close()
 
     SAFE_DELETE(m_pBuffer);
     SAFE_DELETE(m_pFile);
+
+    if (!m_writePath.empty())
+    {
+      g_statCache.Remove(m_writePath);
+      m_writePath.clear();
+    }
   }
   XBMCCOMMONS_HANDLE_UNCHECKED
   catch(...)
@@ -720,8 +744,11 @@ bool CFile::Delete(const CStdString& strFileName)
     if (!pFile.get())
       return false;
 
+    g_statCache.Remove(url.Get());
     if(pFile->Delete(url))
     {
+      // a concurrent Exists() may have cached the file again while it was deleted
+      g_statCache.Remove(url.Get());
       g_directoryCache.ClearFile(url.Get());
       return true;
     }
@@ -747,8 +774,12 @@ bool CFile::Rename(const CStdString& strFileName, const CStdString& strNewFileNa
     if (!pFile.get())
       return false;
 
+    g_statCache.Remove(url.Get());
+    g_statCache.Remove(urlnew.Get());
     if(pFile->Rename(url, urlnew))
     {
+      g_statCache.Remove(url.Get());
+      g_statCache.Remove(urlnew.Get());
       g_directoryCache.ClearFile(url.Get());
       g_directoryCache.AddFile(urlnew.Get());
       return true;
@@ -118,6 +118,7 @@ private:
   IFile* m_pFile;
   CFileStreamBuffer* m_pBuffer;
   BitstreamStats* m_bitStreamStats;
+  CStdString m_writePath; ///< of a file opened for writing, to drop from the stat cache when closed
 };
 
 // streambuf for file io, only supports buffered input currently
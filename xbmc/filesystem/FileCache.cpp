@@ -26,8 +26,10 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "PersistentCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/StringUtils.h"
 #include "utils/TimeUtils.h"
 #include "settings/AdvancedSettings.h"
 
@@ -102,6 +104,12 @@ CFileCache::CFileCache(bool useDoubleCache) : CThread("FileCache")
    {
      m_pCache = new CSimpleDoubleCache(m_pCache);
    }
+   m_pPersistentCache = NULL;
+   if (CPersistentCacheStore::Get().IsEnabled())
+   {
+     m_pPersistentCache = new CPersistentCache(m_pCache);
+     m_pCache = m_pPersistentCache;
+   }
    m_seekPossible = 0;
    m_cacheFull = false;
 }
@@ -109,6 +117,7 @@ CFileCache::CFileCache(bool useDoubleCache) : CThread("FileCache")
 CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache) : CThread("FileCacheStrategy")
 {
   m_pCache = pCache;
+  m_pPersistentCache = NULL;
   m_bDeleteCache = bDeleteCache;
   m_seekPos = 0;
   m_readPos = 0;
@@ -133,6 +142,7 @@ void CFileCache::SetCacheStrategy(CCacheStrategy *pCache, bool bDeleteCache)
     delete m_pCache;
 
   m_pCache = pCache;
+  m_pPersistentCache = NULL;
   m_bDeleteCache = bDeleteCache;
 }
 
@@ -187,6 +197,28 @@ bool CFileCache::Open(const CURL& url)
   m_seekEvent.Reset();
   m_seekEnded.Reset();
 
+  // skip whatever a previous session already downloaded
+  if (m_pPersistentCache)
+  {
+    CStdString validator;
+    m_source.IoControl(IOCTRL_GET_VALIDATOR, &validator);
+
+    // sources without http validators change their modification time with their content,
+    // the size is part of the key already
+    struct __stat64 st;
+    if (validator.empty() && CFile::Stat(m_sourcePath, &st) == 0 && st.st_mtime > 0)
+      validator = StringUtils::Format("mtime:%"PRId64, (int64_t)st.st_mtime);
+    if (m_pPersistentCache->SetSource(m_sourcePath, m_source.GetLength(), validator) && m_seekPossible > 0)
+    {
+      int64_t cacheMaxPos = m_pCache->CachedDataEndPosIfSeekTo(0);
+      if (cacheMaxPos > 0 && (cacheMaxPos == m_source.GetLength() || m_source.Seek(cacheMaxPos, SEEK_SET) == cacheMaxPos))
+      {
+        m_pCache->Reset(0, false);
+        m_writePos = m_pCache->CachedDataEndPos();
+      }
+    }
+  }
+
   CThread::Create(false);
 
   return true;
@@ -210,7 +242,9 @@ void CFileCache::Process()
 
   CWriteRate limiter;
   CWriteRate average;
-  bool cacheReachEOF = false;
+  limiter.Reset(m_writePos);
+  average.Reset(m_writePos);
+  bool cacheReachEOF = m_writePos > 0 && m_writePos == m_source.GetLength();
 
   while (!m_bStop)
   {
@@ -27,6 +27,7 @@
 
 namespace XFILE
 {
+  class CPersistentCache;
 
   class CFileCache : public IFile, public CThread
   {
@@ -62,6 +63,7 @@ namespace XFILE
 
   private:
     CCacheStrategy *m_pCache;
+    CPersistentCache *m_pPersistentCache;
     bool      m_bDeleteCache;
     int        m_seekPossible;
     CFile      m_source;
@@ -0,0 +1,235 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <list>
+#include <set>
+
+#include "FileExistenceChecker.h"
+#include "Directory.h"
+#include "File.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/URIUtils.h"
+
+using namespace XFILE;
+
+// directories listed at the same time per host, and in total
+#define CHECKS_PER_HOST 4
+#define MAX_CHECKS      16
+
+namespace
+{
+  struct SDirectory
+  {
+    std::string path;
+    std::string host;
+    const std::vector< std::pair<int, std::string> > *files;
+  };
+
+  /* The directories left to list, handed out to the threads without exceeding CHECKS_PER_HOST,
+     and what was found so far. */
+  class CCheckState
+  {
+  public:
+    CCheckState() : m_checked(0), m_cancelled(false) {};
+
+    void Add(const SDirectory &directory)
+    {
+      m_directories.push_back(directory);
+    }
+
+    bool Get(SDirectory &directory)
+    {
+      CSingleLock lock(m_section);
+      while (!m_cancelled && !m_directories.empty())
+      {
+        for (std::list<SDirectory>::iterator it = m_directories.begin(); it != m_directories.end(); ++it)
+        {
+          if (m_active[it->host] < CHECKS_PER_HOST)
+          {
+            m_active[it->host]++;
+            directory = *it;
+            m_directories.erase(it);
+            return true;
+          }
+        }
+        // all hosts left are busy
+        CSingleExit exit(m_section);
+        m_changed.WaitMSec(100);
+      }
+      return false;
+    }
+
+    void Done(const SDirectory &directory, const std::vector<int> &missing)
+    {
+      CSingleLock lock(m_section);
+      m_active[directory.host]--;
+      m_missing.insert(m_missing.end(), missing.begin(), missing.end());
+      m_checked += directory.files->size();
+      m_changed.Set();
+    }
+
+    void Cancel()
+    {
+      CSingleLock lock(m_section);
+      m_cancelled = true;
+    }
+
+    unsigned int GetChecked()
+    {
+      CSingleLock lock(m_section);
+      return m_checked;
+    }
+
+    std::vector<int> GetMissing()
+    {
+      CSingleLock lock(m_section);
+      return m_missing;
+    }
+
+    bool WaitForChange(unsigned int milliSeconds) { return m_changed.WaitMSec(milliSeconds); }
+
+  private:
+    CCriticalSection           m_section;
+    CEvent                     m_changed;
+    std::list<SDirectory>      m_directories;
+    std::map<std::string, int> m_active;
+    std::vector<int>           m_missing;
+    unsigned int               m_checked;
+    bool                       m_cancelled;
+  };
+
+  class CCheckThread : public CThread
+  {
+  public:
+    CCheckThread(CCheckState &state) : CThread("FileExistenceChecker"), m_state(state) {};
+
+  protected:
+    virtual void Process()
+    {
+      SDirectory directory;
+      while (!m_bStop && m_state.Get(directory))
+      {
+        std::vector<int> missing;
+        Check(directory, missing);
+        m_state.Done(directory, missing);
+      }
+    }
+
+    static void Check(const SDirectory &directory, std::vector<int> &missing)
+    {
+      CFileItemList items;
+      std::set<std::string> names;
+      bool listed = CDirectory::GetDirectory(directory.path, items, "",
+                                             DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_NO_FILE_INFO |
+                                             DIR_FLAG_GET_HIDDEN | DIR_FLAG_BYPASS_CACHE);
+      if (listed)
+      {
+        for (int i = 0; i < items.Size(); i++)
+        {
+          CStdString path = items[i]->GetPath();
+          URIUtils::RemoveSlashAtEnd(path);
+          names.insert(URIUtils::GetFileName(path));
+        }
+      }
+      else if (!CDirectory::Exists(directory.path, false))
+      {
+        for (unsigned int i = 0; i < directory.files->size(); i++)
+          missing.push_back((*directory.files)[i].first);
+        return;
+      }
+
+      for (unsigned int i = 0; i < directory.files->size(); i++)
+      {
+        const std::pair<int, std::string> &file = (*directory.files)[i];
+        if (listed && names.find(URIUtils::GetFileName(file.second)) != names.end())
+          continue;
+        if (!CFile::Exists(file.second, false))
+          missing.push_back(file.first);
+      }
+    }
+
+    CCheckState &m_state;
+  };
+}
+
+void CFileExistenceChecker::Add(int id, const std::string &path)
+{
+  m_directories[URIUtils::GetDirectory(path)].push_back(std::make_pair(id, path));
+  m_count++;
+}
+
+bool CFileExistenceChecker::Check(std::vector<int> &missing, IProgress *progress /* = NULL */)
+{
+  CCheckState state;
+  std::map<std::string, unsigned int> hosts;
+  for (std::map<std::string, Files>::const_iterator it = m_directories.begin(); it != m_directories.end(); ++it)
+  {
+    SDirectory directory;
+    directory.path  = it->first;
+    directory.host  = CURL(it->first).GetHostName();
+    directory.files = &it->second;
+    state.Add(directory);
+    hosts[directory.host]++;
+  }
+
+  // no more threads than can list directories at the same time
+  unsigned int threads = 0;
+  for (std::map<std::string, unsigned int>::const_iterator it = hosts.begin(); it != hosts.end(); ++it)
+    threads += std::min(it->second, (unsigned int)CHECKS_PER_HOST);
+  threads = std::min(threads, (unsigned int)MAX_CHECKS);
+
+  std::vector<CCheckThread*> checkThreads;
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    checkThreads.push_back(new CCheckThread(state));
+    checkThreads.back()->Create();
+  }
+
+  bool cancelled = false;
+  bool running = !checkThreads.empty();
+  while (running && !cancelled)
+  {
+    state.WaitForChange(100);
+    if (progress && !progress->OnProgress(state.GetChecked(), m_count))
+    {
+      state.Cancel();
+      cancelled = true;
+    }
+
+    // the threads exit once all directories are listed
+    running = false;
+    for (std::vector<CCheckThread*>::const_iterator it = checkThreads.begin(); it != checkThreads.end(); ++it)
+      running |= (*it)->IsRunning();
+  }
+
+  for (std::vector<CCheckThread*>::iterator it = checkThreads.begin(); it != checkThreads.end(); ++it)
+  {
+    (*it)->StopThread(true);
+    delete *it;
+  }
+
+  missing = state.GetMissing();
+  return !cancelled;
+}
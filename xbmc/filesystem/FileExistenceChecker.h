@@ -0,0 +1,72 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace XFILE
+{
+  /*!
+   \brief Finds which of a large number of files are missing, for cleaning the libraries.
+
+   Files are grouped by the directory they are in, and each directory is listed once instead
+   of checking every file with its own network round-trip. Directories are listed by a few
+   threads at a time per host. Files that aren't in the listing of their directory, or whose
+   directory can't be listed but exists, are checked on their own with CFile::Exists(), so
+   listings that leave out files don't get them removed.
+   */
+  class CFileExistenceChecker
+  {
+  public:
+    CFileExistenceChecker() : m_count(0) {};
+
+    /*! \brief Receives the progress of Check(), on the thread that called it */
+    class IProgress
+    {
+    public:
+      virtual ~IProgress() {}
+      /*! \return false to cancel the check */
+      virtual bool OnProgress(unsigned int checked, unsigned int total) = 0;
+    };
+
+    /*! \brief Add a file to check
+     \param id returned by Check() if the file is missing.
+     \param path the full path of the file.
+     */
+    void Add(int id, const std::string &path);
+
+    unsigned int Size() const { return m_count; };
+
+    /*! \brief Check all added files
+     \param missing the ids of the files that don't exist.
+     \param progress optional progress callback.
+     \return false if the check was cancelled.
+     */
+    bool Check(std::vector<int> &missing, IProgress *progress = NULL);
+
+  private:
+    typedef std::vector< std::pair<int, std::string> > Files; ///< id and path
+
+    std::map<std::string, Files> m_directories;
+    unsigned int m_count;
+  };
+}
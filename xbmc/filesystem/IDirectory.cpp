@@ -28,6 +28,11 @@
 
 using namespace XFILE;
 
+// types of the extensions in m_fileMask
+#define MASK_ALLOWED 0x01
+#define MASK_IFO     0x02
+#define MASK_DAT     0x04
+
 IDirectory::IDirectory(void)
 {
   m_strFileMask = "";
@@ -51,11 +56,12 @@ bool IDirectory::IsAllowed(const CStdString& strFile) const
     return true;
 
   // Check if strFile have an allowed extension
-  if (!URIUtils::HasExtension(strFile, m_strFileMask))
+  unsigned int types = m_fileMask.GetTypes(strFile);
+  if (!(types & MASK_ALLOWED))
     return false;
 
   // We should ignore all non dvd/vcd related ifo and dat files.
-  if (URIUtils::HasExtension(strFile, ".ifo"))
+  if (types & MASK_IFO)
   {
     CStdString fileName = URIUtils::GetFileName(strFile);
 
@@ -65,7 +71,7 @@ bool IDirectory::IsAllowed(const CStdString& strFile) const
            fileName.Right(6).CompareNoCase("_0.ifo") == 0);
   }
   
-  if (URIUtils::HasExtension(strFile, ".dat"))
+  if (types & MASK_DAT)
   {
     CStdString fileName = URIUtils::GetFileName(strFile);
 
@@ -96,6 +102,11 @@ void IDirectory::SetMask(const CStdString& strMask)
   m_strFileMask.ToLower();
   if (m_strFileMask.size() && m_strFileMask[m_strFileMask.size() - 1] != '|')
     m_strFileMask += '|';
+
+  m_fileMask.Clear();
+  m_fileMask.Add(m_strFileMask, MASK_ALLOWED);
+  m_fileMask.Add(".ifo", MASK_IFO);
+  m_fileMask.Add(".dat", MASK_DAT);
 }
 
 /*!
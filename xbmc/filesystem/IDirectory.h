@@ -19,6 +19,7 @@
  *
  */
 
+#include "utils/FileExtensions.h"
 #include "utils/StdString.h"
 #include "utils/Variant.h"
 
@@ -158,6 +159,7 @@ protected:
   void RequireAuthentication(const CStdString &url);
 
   CStdString m_strFileMask;  ///< Holds the file mask specified by SetMask()
+  CFileExtensions m_fileMask; ///< The same compiled for IsAllowed(), with the .ifo and .dat extensions it checks
 
   int m_flags; ///< Directory flags - see DIR_FLAG
 
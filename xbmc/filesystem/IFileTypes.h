@@ -43,6 +43,7 @@ typedef enum {
   IOCTRL_CACHE_STATUS  = 3, /**< SCacheStatus structure */
   IOCTRL_CACHE_SETRATE = 4, /**< unsigned int with speed limit for caching in bytes per second */
   IOCTRL_SET_CACHE    = 8, /** <CFileCache */
+  IOCTRL_GET_VALIDATOR = 9, /**< CStdString receiving a token (ETag, Last-Modified) that changes whenever the content does */
 } EIoControl;
 
 }
@@ -31,12 +31,16 @@
 #include "utils/URIUtils.h"
 #include "network/DNSNameCache.h"
 #include "threads/SystemClock.h"
+#include "settings/AdvancedSettings.h"
 
 #include <nfsc/libnfs-raw-mount.h>
 
 #ifdef TARGET_WINDOWS
 #include <fcntl.h>
 #include <sys\stat.h>
+#define poll WSAPoll
+#else
+#include <poll.h>
 #endif
 
 //KEEP_ALIVE_TIMEOUT is decremented every half a second
@@ -48,6 +52,13 @@
 //6 mins (360s) cached context timeout
 #define CONTEXT_TIMEOUT 360000
 
+//number of consecutive reads after which a file is considered
+//to be read sequentially and the read ahead window kicks in
+#define READAHEAD_SEQUENTIAL_READS 3
+
+//give up on a read ahead request after 30s and fall back to the sync api
+#define READAHEAD_TIMEOUT 30000
+
 //return codes for getContextForExport
 #define CONTEXT_INVALID  0    //getcontext failed
 #define CONTEXT_NEW      1    //new context created
@@ -464,6 +475,17 @@ CNFSFile::CNFSFile()
 : m_fileSize(0)
 , m_pFileHandle(NULL)
 , m_pNfsContext(NULL)
+, m_filePos(0)
+, m_handleStale(false)
+, m_sequentialReads(0)
+, m_readAheadDepth(0)
+, m_chunkSize(0)
+, m_nextOffset(0)
+, m_readAheadBytes(0)
+, m_readAheadRequests(0)
+, m_readAheadStalls(0)
+, m_readAheadWait(0)
+, m_readAheadStart(0)
 {
   gNfsConnection.AddActiveConnection();
 }
@@ -481,6 +503,10 @@ int64_t CNFSFile::GetPosition()
   CSingleLock lock(gNfsConnection);
   
   if (gNfsConnection.GetNfsContext() == NULL || m_pFileHandle == NULL) return 0;
+
+  //while reading ahead the handle offset isn't updated
+  if (m_handleStale)
+    return m_filePos;
   
   ret = (int)gNfsConnection.GetImpl()->nfs_lseek(gNfsConnection.GetNfsContext(), m_pFileHandle, 0, SEEK_CUR, &offset);
   
@@ -542,6 +568,20 @@ bool CNFSFile::Open(const CURL& url)
   }
   
   m_fileSize = tmpBuffer.st_size;//cache the size of this file
+  m_filePos = 0;
+  m_handleStale = false;
+  m_sequentialReads = 0;
+  m_readAheadDepth = g_advancedSettings.m_nfsReadAheadDepth;
+  if (!gNfsConnection.GetImpl()->HasAsyncRead())
+    m_readAheadDepth = 0;
+  m_chunkSize = gNfsConnection.GetMaxReadChunkSize();
+  if (m_chunkSize == 0)
+    m_chunkSize = 32768;
+  m_readAheadBytes = 0;
+  m_readAheadRequests = 0;
+  m_readAheadStalls = 0;
+  m_readAheadWait = 0;
+  m_readAheadStart = 0;
   // We've successfully opened the file!
   return true;
 }
@@ -599,6 +639,212 @@ int CNFSFile::Stat(const CURL& url, struct __stat64* buffer)
   return ret;
 }
 
+void CNFSFile::ReadCallback(int err, struct nfs_context *nfs, void *data, void *private_data)
+{
+  //called from within nfs_service - with gNfsConnection locked
+  CReadRequest *request = (CReadRequest *)private_data;
+
+  if (request->abandoned)
+  {
+    delete[] request->buffer;
+    delete request;
+    return;
+  }
+
+  if (err > 0)
+    memcpy(request->buffer, data, err);
+  request->result = err;
+  request->done = true;
+}
+
+void CNFSFile::FillReadAhead()
+{
+  if (m_readAhead.empty())
+    m_nextOffset = m_filePos;
+
+  //only read ahead within the size known at open time, anything
+  //beyond (growing files) is left to the sync read
+  while (m_readAhead.size() < m_readAheadDepth && (int64_t)m_nextOffset < m_fileSize)
+  {
+    CReadRequest *request = new CReadRequest;
+    request->offset = m_nextOffset;
+    request->size = std::min<uint64_t>(m_chunkSize, m_fileSize - m_nextOffset);
+    request->buffer = new char[request->size];
+    request->result = 0;
+    request->consumed = 0;
+    request->done = false;
+    request->abandoned = false;
+
+    if (gNfsConnection.GetImpl()->nfs_pread_async(m_pNfsContext, m_pFileHandle, request->offset, request->size, ReadCallback, request) != 0)
+    {
+      CLog::Log(LOGERROR, "%s - Error( %s )", __FUNCTION__, gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+      delete[] request->buffer;
+      delete request;
+      break;
+    }
+
+    m_readAhead.push_back(request);
+    m_nextOffset += request->size;
+    m_readAheadRequests++;
+  }
+}
+
+bool CNFSFile::WaitForRequest(CReadRequest *request)
+{
+  if (request->done)
+    return true;
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  XbmcThreads::EndTime timeout(READAHEAD_TIMEOUT);
+  m_readAheadStalls++;
+
+  //drive the context until our reply arrived, replies to other files
+  //on the same context are dispatched to their callbacks on the way
+  while (!request->done)
+  {
+    struct pollfd pfd;
+    pfd.fd = gNfsConnection.GetImpl()->nfs_get_fd(m_pNfsContext);
+    pfd.events = gNfsConnection.GetImpl()->nfs_which_events(m_pNfsContext);
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, 100) < 0 && errno != EINTR)
+    {
+      CLog::Log(LOGERROR, "%s - poll failed (%d)", __FUNCTION__, errno);
+      return false;
+    }
+
+    if (gNfsConnection.GetImpl()->nfs_service(m_pNfsContext, pfd.revents) < 0)
+    {
+      CLog::Log(LOGERROR, "%s - Error( %s )", __FUNCTION__, gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+      return false;
+    }
+
+    if (!request->done && timeout.IsTimePast())
+    {
+      CLog::Log(LOGERROR, "%s - Timeout reading %"PRIu64" bytes at %"PRIu64, __FUNCTION__, request->size, request->offset);
+      return false;
+    }
+  }
+
+  m_readAheadWait += XbmcThreads::SystemClockMillis() - start;
+  return true;
+}
+
+void CNFSFile::DropRequest(CReadRequest *request)
+{
+  //forget about the replies that arrived meanwhile
+  for (std::deque<CReadRequest*>::iterator it = m_droppedRequests.begin(); it != m_droppedRequests.end();)
+  {
+    if ((*it)->done)
+    {
+      delete[] (*it)->buffer;
+      delete *it;
+      it = m_droppedRequests.erase(it);
+    }
+    else
+      ++it;
+  }
+
+  //the reply of a request in flight is still going to arrive
+  if (!request->done)
+  {
+    m_droppedRequests.push_back(request);
+    return;
+  }
+  delete[] request->buffer;
+  delete request;
+}
+
+void CNFSFile::DiscardReadAhead()
+{
+  while (!m_readAhead.empty())
+  {
+    CReadRequest *request = m_readAhead.front();
+    m_readAhead.pop_front();
+    DropRequest(request);
+  }
+}
+
+bool CNFSFile::SkipReadAhead(int64_t iFilePosition)
+{
+  //keep the window if the new position is within it, drop whatever lies before
+  while (!m_readAhead.empty())
+  {
+    CReadRequest *request = m_readAhead.front();
+    if (iFilePosition < (int64_t)request->offset)
+      break;
+
+    if (iFilePosition < (int64_t)(request->offset + request->size))
+    {
+      request->consumed = (int)(iFilePosition - request->offset);
+      return true;
+    }
+
+    m_readAhead.pop_front();
+    DropRequest(request);
+  }
+  DiscardReadAhead();
+  return false;
+}
+
+int CNFSFile::ReadAhead(void *lpBuf, int64_t uiBufSize)
+{
+  SkipReadAhead(m_filePos);
+  FillReadAhead();
+  if (m_readAhead.empty())
+    return -1;
+
+  if (m_readAheadStart == 0)
+    m_readAheadStart = XbmcThreads::SystemClockMillis();
+
+  int bytesRead = 0;
+  //hand out what's there, only block for the first request
+  while (!m_readAhead.empty() && bytesRead < uiBufSize)
+  {
+    CReadRequest *request = m_readAhead.front();
+    if (bytesRead > 0 && !request->done)
+      break;
+
+    if (!WaitForRequest(request) || request->result < 0)
+    {
+      if (request->done)
+        CLog::Log(LOGERROR, "%s - Error( %d, %s )", __FUNCTION__, request->result, gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+      DiscardReadAhead();
+      break;
+    }
+
+    int avail = request->result - request->consumed;
+    int copy = (int)std::min<int64_t>(avail, uiBufSize - bytesRead);
+    if (copy > 0)
+    {
+      memcpy((char *)lpBuf + bytesRead, request->buffer + request->consumed, copy);
+      request->consumed += copy;
+      bytesRead += copy;
+      m_filePos += copy;
+      m_handleStale = true;
+    }
+
+    if (request->consumed >= request->result)
+    {
+      //a short read means the file shrunk or we hit eof, the rest of the
+      //window doesn't line up anymore
+      bool shortRead = (uint64_t)request->result < request->size;
+      m_readAhead.pop_front();
+      delete[] request->buffer;
+      delete request;
+      if (shortRead)
+      {
+        DiscardReadAhead();
+        break;
+      }
+      FillReadAhead();
+    }
+  }
+
+  m_readAheadBytes += bytesRead;
+  return bytesRead > 0 ? bytesRead : -1;
+}
+
 unsigned int CNFSFile::Read(void *lpBuf, int64_t uiBufSize)
 {
   int numberOfBytesRead = 0;
@@ -606,7 +852,29 @@ unsigned int CNFSFile::Read(void *lpBuf, int64_t uiBufSize)
   
   if (m_pFileHandle == NULL || m_pNfsContext == NULL ) return 0;
 
-  numberOfBytesRead = gNfsConnection.GetImpl()->nfs_read(m_pNfsContext, m_pFileHandle, uiBufSize, (char *)lpBuf);  
+  if (m_sequentialReads < READAHEAD_SEQUENTIAL_READS)
+    m_sequentialReads++;
+
+  //sequential access - keep several READs in flight
+  if (m_readAheadDepth > 0 && m_sequentialReads >= READAHEAD_SEQUENTIAL_READS)
+    numberOfBytesRead = ReadAhead(lpBuf, uiBufSize);
+  else
+    numberOfBytesRead = -1;
+
+  //nothing from the window (error, eof or beyond the size known at open) - use the sync api
+  if (numberOfBytesRead < 0)
+  {
+    if (m_handleStale)
+    {
+      uint64_t offset = 0;
+      gNfsConnection.GetImpl()->nfs_lseek(m_pNfsContext, m_pFileHandle, m_filePos, SEEK_SET, &offset);
+      m_handleStale = false;
+    }
+
+    numberOfBytesRead = gNfsConnection.GetImpl()->nfs_read(m_pNfsContext, m_pFileHandle, uiBufSize, (char *)lpBuf);  
+    if (numberOfBytesRead > 0)
+      m_filePos += numberOfBytesRead;
+  }
 
   lock.Leave();//no need to keep the connection lock after that
   
@@ -629,6 +897,12 @@ int64_t CNFSFile::Seek(int64_t iFilePosition, int iWhence)
   CSingleLock lock(gNfsConnection);  
   if (m_pFileHandle == NULL || m_pNfsContext == NULL) return -1;
   
+  //the handle offset lags behind while reading ahead
+  if (m_handleStale && iWhence == SEEK_CUR)
+  {
+    iFilePosition += m_filePos;
+    iWhence = SEEK_SET;
+  }
  
   ret = (int)gNfsConnection.GetImpl()->nfs_lseek(m_pNfsContext, m_pFileHandle, iFilePosition, iWhence, &offset);
   if (ret < 0) 
@@ -636,6 +910,12 @@ int64_t CNFSFile::Seek(int64_t iFilePosition, int iWhence)
     CLog::Log(LOGERROR, "%s - Error( seekpos: %"PRId64", whence: %i, fsize: %"PRId64", %s)", __FUNCTION__, iFilePosition, iWhence, m_fileSize, gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
     return -1;
   }
+
+  //small forward skips within the window don't break sequential access
+  if ((int64_t)offset != m_filePos && !SkipReadAhead(offset))
+    m_sequentialReads = 0;
+  m_filePos = offset;
+  m_handleStale = false;
   return (int64_t)offset;
 }
 
@@ -667,11 +947,42 @@ void CNFSFile::Close()
     // remove it from keep alive list before closing
     // so keep alive code doens't process it anymore
     gNfsConnection.removeFromKeepAliveList(m_pFileHandle);
-    ret = gNfsConnection.GetImpl()->nfs_close(m_pNfsContext, m_pFileHandle);
-        
-	  if (ret < 0) 
+
+    if (m_readAheadBytes > 0)
+    {
+      unsigned int elapsed = XbmcThreads::SystemClockMillis() - m_readAheadStart;
+      CLog::Log(LOGDEBUG, "CNFSFile::Close - read ahead served %"PRId64" bytes with %u requests at %"PRId64" KB/s, %u stalls (%u ms)",
+                m_readAheadBytes, m_readAheadRequests, elapsed ? m_readAheadBytes * 1000 / elapsed / 1024 : 0,
+                m_readAheadStalls, m_readAheadWait);
+    }
+
+    //the handle must outlive the READs still in flight, including
+    //those dropped by earlier seeks
+    DiscardReadAhead();
+    while (!m_droppedRequests.empty() && WaitForRequest(m_droppedRequests.front()))
+    {
+      delete[] m_droppedRequests.front()->buffer;
+      delete m_droppedRequests.front();
+      m_droppedRequests.pop_front();
+    }
+
+    if (!m_droppedRequests.empty())
+    {
+      //libnfs can't cancel a READ - leave the handle open rather than
+      //have the late replies touch it, their callbacks free the requests
+      CLog::Log(LOGERROR, "CNFSFile::Close - %u reads still pending, not closing %s", (unsigned int)m_droppedRequests.size(), m_url.GetFileName().c_str());
+      for (std::deque<CReadRequest*>::iterator it = m_droppedRequests.begin(); it != m_droppedRequests.end(); ++it)
+        (*it)->abandoned = true;
+      m_droppedRequests.clear();
+    }
+    else
     {
-      CLog::Log(LOGERROR, "Failed to close(%s) - %s\n", m_url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+      ret = gNfsConnection.GetImpl()->nfs_close(m_pNfsContext, m_pFileHandle);
+
+      if (ret < 0)
+      {
+        CLog::Log(LOGERROR, "Failed to close(%s) - %s\n", m_url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+      }
     }
     m_pFileHandle = NULL;
     m_pNfsContext = NULL;    
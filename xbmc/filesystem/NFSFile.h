@@ -28,6 +28,7 @@
 #include <list>
 #include "SectionLoader.h"
 #include <map>
+#include <deque>
 
 #ifdef TARGET_WINDOWS
 #define S_IRGRP 0
@@ -157,6 +158,43 @@ namespace XFILE
     struct nfsfh  *m_pFileHandle;
     struct nfs_context *m_pNfsContext;//current nfs context
     std::string m_exportPath;
+
+  private:
+    //one outstanding or completed asynchronous READ of the read ahead window
+    struct CReadRequest
+    {
+      uint64_t offset;
+      uint64_t size;
+      char    *buffer;
+      int      result;   //bytes read or a negative error, valid once done
+      int      consumed; //bytes already handed out to the reader
+      bool     done;
+      bool     abandoned;//the file was closed while in flight - the callback frees it
+    };
+
+    static void ReadCallback(int err, struct nfs_context *nfs, void *data, void *private_data);
+    int  ReadAhead(void *lpBuf, int64_t uiBufSize);
+    void FillReadAhead();
+    bool WaitForRequest(CReadRequest *request);
+    void DiscardReadAhead();
+    void DropRequest(CReadRequest *request);//frees it, or keeps it until its reply arrived
+    bool SkipReadAhead(int64_t iFilePosition);//false if the position is outside the window
+
+    int64_t m_filePos;             //position of the reader, the handle lags behind while reading ahead
+    bool m_handleStale;            //handle offset isn't m_filePos
+    unsigned int m_sequentialReads;//consecutive reads without a seek
+    unsigned int m_readAheadDepth; //max outstanding READs, 0 disables read ahead
+    uint64_t m_chunkSize;          //READ size, the servers rsize
+    uint64_t m_nextOffset;         //offset of the next READ to issue
+    std::deque<CReadRequest*> m_readAhead;//window in file order
+    std::deque<CReadRequest*> m_droppedRequests;//left the window while in flight
+
+    //read ahead statistics
+    int64_t m_readAheadBytes;
+    unsigned int m_readAheadRequests;
+    unsigned int m_readAheadStalls;//reads that had to wait for the network
+    unsigned int m_readAheadWait;  //ms spent waiting
+    unsigned int m_readAheadStart; //time the first read was served from the window
   };
 }
 #endif // FILENFS_H_
@@ -0,0 +1,534 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "PersistentCache.h"
+#include "Directory.h"
+#include "FileItem.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+using namespace XFILE;
+
+CPersistentCacheStore::CPersistentCacheStore()
+  : m_initialized(false)
+  , m_size(0)
+  , m_bytesRead(0)
+  , m_bytesFromCache(0)
+  , m_bytesStored(0)
+{
+}
+
+CPersistentCacheStore::~CPersistentCacheStore()
+{
+}
+
+CPersistentCacheStore &CPersistentCacheStore::Get()
+{
+  static CPersistentCacheStore s_store;
+  return s_store;
+}
+
+bool CPersistentCacheStore::IsEnabled() const
+{
+  return g_advancedSettings.m_cachePersistentSize > 0;
+}
+
+CStdString CPersistentCacheStore::GetKey(const CStdString &url, int64_t length, const CStdString &validator)
+{
+  if (length <= 0 || validator.empty())
+    return "";
+
+  return XBMC::XBMC_MD5::GetMD5(StringUtils::Format("%s|%"PRId64"|%s", url.c_str(), length, validator.c_str()));
+}
+
+CStdString CPersistentCacheStore::GetBlockPath(const CStdString &key, unsigned int index) const
+{
+  return URIUtils::AddFileToFolder(m_path, StringUtils::Format("%s_%u.blk", key.c_str(), index));
+}
+
+void CPersistentCacheStore::Initialize()
+{
+  if (m_initialized)
+    return;
+  m_initialized = true;
+
+  m_path = URIUtils::AddFileToFolder(g_advancedSettings.m_cachePath, "persistentcache/");
+  if (!CDirectory::Exists(m_path) && !CDirectory::Create(m_path))
+  {
+    CLog::Log(LOGERROR, "%s - unable to create %s", __FUNCTION__, m_path.c_str());
+    return;
+  }
+
+  // rebuild the index from what previous sessions left behind, oldest first
+  CFileItemList items;
+  CDirectory::GetDirectory(m_path, items, ".blk", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE);
+  items.Sort(SortByDate, SortOrderAscending);
+
+  for (int i = 0; i < items.Size(); i++)
+  {
+    CStdString name = URIUtils::GetFileName(items[i]->GetPath());
+    URIUtils::RemoveExtension(name);
+    size_t separator = name.rfind('_');
+    if (separator == std::string::npos || items[i]->m_dwSize <= 0 || items[i]->m_dwSize > PERSISTENT_CACHE_BLOCK_SIZE)
+    {
+      CFile::Delete(items[i]->GetPath());
+      continue;
+    }
+
+    CBlock block;
+    block.id   = BlockId(name.substr(0, separator), (unsigned int)atoi(name.substr(separator + 1).c_str()));
+    block.size = (unsigned int)items[i]->m_dwSize;
+    m_lru.push_front(block);
+    m_blocks[block.id] = m_lru.begin();
+    m_size += block.size;
+  }
+
+  CLog::Log(LOGDEBUG, "%s - %u blocks (%"PRIu64" bytes) in persistent cache", __FUNCTION__, (unsigned int)m_blocks.size(), m_size);
+  Trim();
+}
+
+void CPersistentCacheStore::Trim()
+{
+  uint64_t budget = g_advancedSettings.m_cachePersistentSize;
+  BlockList::iterator it = m_lru.end();
+  while (m_size > budget && it != m_lru.begin())
+  {
+    --it;
+    if (m_pinned.find(it->id.first) != m_pinned.end())
+      continue;
+
+    CFile::Delete(GetBlockPath(it->id.first, it->id.second));
+    m_size -= it->size;
+    m_blocks.erase(it->id);
+    it = m_lru.erase(it);
+  }
+}
+
+bool CPersistentCacheStore::HasBlock(const CStdString &key, unsigned int index, unsigned int &size)
+{
+  CSingleLock lock(m_critSection);
+  Initialize();
+
+  std::map<BlockId, BlockList::iterator>::const_iterator it = m_blocks.find(BlockId(key, index));
+  if (it == m_blocks.end())
+    return false;
+
+  size = it->second->size;
+  return true;
+}
+
+bool CPersistentCacheStore::OpenBlock(const CStdString &key, unsigned int index, CFile &file, unsigned int &size)
+{
+  CStdString path;
+  {
+    CSingleLock lock(m_critSection);
+    Initialize();
+
+    std::map<BlockId, BlockList::iterator>::iterator it = m_blocks.find(BlockId(key, index));
+    if (it == m_blocks.end())
+      return false;
+
+    size = it->second->size;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    path = GetBlockPath(key, index);
+  }
+
+  return file.Open(path, READ_NO_CACHE);
+}
+
+bool CPersistentCacheStore::StoreBlock(const CStdString &key, unsigned int index, const char *buffer, unsigned int size)
+{
+  BlockId id(key, index);
+  CStdString path;
+  {
+    CSingleLock lock(m_critSection);
+    Initialize();
+
+    if (m_blocks.find(id) != m_blocks.end() || m_writing.find(id) != m_writing.end())
+      return true;
+    m_writing.insert(id);
+    path = GetBlockPath(key, index);
+  }
+
+  // readers of other blocks don't have to wait for the disk
+  CFile file;
+  bool written = file.OpenForWrite(path, true) && file.Write(buffer, size) == (int)size;
+  file.Close();
+
+  CSingleLock lock(m_critSection);
+  m_writing.erase(id);
+  if (!written)
+  {
+    CLog::Log(LOGERROR, "%s - failed to write %s", __FUNCTION__, path.c_str());
+    CFile::Delete(path);
+    return false;
+  }
+
+  CBlock block;
+  block.id   = id;
+  block.size = size;
+  m_lru.push_front(block);
+  m_blocks[id] = m_lru.begin();
+  m_size += size;
+  m_bytesStored += size;
+
+  Trim();
+  return true;
+}
+
+void CPersistentCacheStore::Pin(const CStdString &key)
+{
+  CSingleLock lock(m_critSection);
+  m_pinned[key]++;
+}
+
+void CPersistentCacheStore::Unpin(const CStdString &key)
+{
+  CSingleLock lock(m_critSection);
+  std::map<CStdString, int>::iterator it = m_pinned.find(key);
+  if (it != m_pinned.end() && --it->second <= 0)
+    m_pinned.erase(it);
+}
+
+void CPersistentCacheStore::AddStats(uint64_t bytesRead, uint64_t bytesFromCache)
+{
+  CSingleLock lock(m_critSection);
+  m_bytesRead      += bytesRead;
+  m_bytesFromCache += bytesFromCache;
+}
+
+void CPersistentCacheStore::GetStats(uint64_t &bytesRead, uint64_t &bytesFromCache, uint64_t &bytesStored) const
+{
+  CSingleLock lock(m_critSection);
+  bytesRead      = m_bytesRead;
+  bytesFromCache = m_bytesFromCache;
+  bytesStored    = m_bytesStored;
+}
+
+void CPersistentCacheStore::Clear()
+{
+  CSingleLock lock(m_critSection);
+  Initialize();
+
+  for (BlockList::const_iterator it = m_lru.begin(); it != m_lru.end(); ++it)
+    CFile::Delete(GetBlockPath(it->id.first, it->id.second));
+  m_lru.clear();
+  m_blocks.clear();
+  m_size = 0;
+}
+
+CPersistentCache::CPersistentCache(CCacheStrategy *impl)
+  : m_pCache(impl)
+  , m_length(0)
+  , m_diskStart(0)
+  , m_diskEnd(0)
+  , m_readPos(0)
+  , m_writePos(0)
+  , m_block(NULL)
+  , m_blockIndex(0)
+  , m_blockFill(0)
+  , m_readIndex(-1)
+  , m_readSize(0)
+  , m_bytesRead(0)
+  , m_bytesFromCache(0)
+{
+  assert(NULL != impl);
+}
+
+CPersistentCache::~CPersistentCache()
+{
+  Close();
+  delete m_pCache;
+}
+
+int CPersistentCache::Open()
+{
+  Close();
+  return m_pCache->Open();
+}
+
+void CPersistentCache::Close()
+{
+  m_pCache->Close();
+
+  if (!m_key.empty())
+  {
+    if (m_bytesRead)
+    {
+      CLog::Log(LOGDEBUG, "CPersistentCache::Close - served %"PRIu64" of %"PRIu64" bytes from persistent cache", m_bytesFromCache, m_bytesRead);
+      CPersistentCacheStore::Get().AddStats(m_bytesRead, m_bytesFromCache);
+    }
+    CPersistentCacheStore::Get().Unpin(m_key);
+    m_key.clear();
+  }
+
+  m_readFile.Close();
+  m_readIndex = -1;
+
+  delete[] m_block;
+  m_block = NULL;
+  m_blockFill = 0;
+  m_diskStart = m_diskEnd = 0;
+  m_readPos = m_writePos = 0;
+  m_bytesRead = m_bytesFromCache = 0;
+}
+
+bool CPersistentCache::SetSource(const CStdString &url, int64_t length, const CStdString &validator)
+{
+  if (!CPersistentCacheStore::Get().IsEnabled())
+    return false;
+
+  CStdString key = CPersistentCacheStore::GetKey(url, length, validator);
+  if (key.empty())
+    return false;
+
+  m_key    = key;
+  m_length = length;
+  m_block  = new char[PERSISTENT_CACHE_BLOCK_SIZE];
+  m_blockFill = 0;
+  CPersistentCacheStore::Get().Pin(m_key);
+  return true;
+}
+
+int64_t CPersistentCache::PersistedDataEnd(int64_t iFilePosition)
+{
+  if (m_key.empty())
+    return iFilePosition;
+
+  int64_t end = iFilePosition;
+  unsigned int index = (unsigned int)(iFilePosition / PERSISTENT_CACHE_BLOCK_SIZE);
+  unsigned int size;
+  while (end < m_length && CPersistentCacheStore::Get().HasBlock(m_key, index, size))
+  {
+    end = (int64_t)index * PERSISTENT_CACHE_BLOCK_SIZE + size;
+    if (size < PERSISTENT_CACHE_BLOCK_SIZE)
+      break;
+    index++;
+  }
+  return std::max(end, iFilePosition);
+}
+
+bool CPersistentCache::IsOnDisk(int64_t iFilePosition) const
+{
+  return iFilePosition >= m_diskStart && iFilePosition < m_diskEnd;
+}
+
+void CPersistentCache::StoreData(const char *pBuffer, size_t iSize)
+{
+  while (iSize > 0)
+  {
+    unsigned int index  = (unsigned int)(m_writePos / PERSISTENT_CACHE_BLOCK_SIZE);
+    unsigned int offset = (unsigned int)(m_writePos % PERSISTENT_CACHE_BLOCK_SIZE);
+    unsigned int size   = std::min<unsigned int>(PERSISTENT_CACHE_BLOCK_SIZE - offset, iSize);
+
+    // only collect blocks we have seen from their start
+    if (m_blockFill == 0 || index != m_blockIndex || offset != m_blockFill)
+    {
+      m_blockFill  = 0;
+      m_blockIndex = index;
+    }
+    if (offset == m_blockFill)
+    {
+      memcpy(m_block + m_blockFill, pBuffer, size);
+      m_blockFill += size;
+    }
+
+    m_writePos += size;
+    pBuffer    += size;
+    iSize      -= size;
+
+    if (m_blockFill == PERSISTENT_CACHE_BLOCK_SIZE)
+      FlushBlock();
+  }
+}
+
+void CPersistentCache::FlushBlock()
+{
+  // a short block is only complete if it is the last one of the file
+  if (m_blockFill == PERSISTENT_CACHE_BLOCK_SIZE
+  || (m_blockFill > 0 && (int64_t)m_blockIndex * PERSISTENT_CACHE_BLOCK_SIZE + m_blockFill == m_length))
+    CPersistentCacheStore::Get().StoreBlock(m_key, m_blockIndex, m_block, m_blockFill);
+  m_blockFill = 0;
+}
+
+int CPersistentCache::ReadBlock(char *pBuffer, size_t iSize)
+{
+  unsigned int index  = (unsigned int)(m_readPos / PERSISTENT_CACHE_BLOCK_SIZE);
+  unsigned int offset = (unsigned int)(m_readPos % PERSISTENT_CACHE_BLOCK_SIZE);
+
+  // keep the block open, the reader usually continues where it left off
+  if (m_readIndex != (int)index)
+  {
+    m_readFile.Close();
+    m_readIndex = -1;
+    if (!CPersistentCacheStore::Get().OpenBlock(m_key, index, m_readFile, m_readSize))
+      return -1;
+    m_readIndex = (int)index;
+  }
+  if (offset >= m_readSize)
+    return -1;
+
+  if (m_readFile.GetPosition() != offset && m_readFile.Seek(offset, SEEK_SET) != offset)
+    return -1;
+
+  unsigned int size = std::min<size_t>(iSize, m_readSize - offset);
+  unsigned int read = 0;
+  while (read < size)
+  {
+    unsigned int ret = m_readFile.Read(pBuffer + read, size - read);
+    if (ret == 0)
+      break;
+    read += ret;
+  }
+  return read == size ? (int)read : -1;
+}
+
+int CPersistentCache::WriteToCache(const char *pBuffer, size_t iSize)
+{
+  int iWritten = m_pCache->WriteToCache(pBuffer, iSize);
+  if (iWritten > 0 && m_block)
+    StoreData(pBuffer, iWritten);
+  return iWritten;
+}
+
+int CPersistentCache::ReadFromCache(char *pBuffer, size_t iMaxSize)
+{
+  if (IsOnDisk(m_readPos))
+  {
+    int iRead = ReadBlock(pBuffer, std::min<int64_t>(iMaxSize, m_diskEnd - m_readPos));
+    if (iRead <= 0)
+    {
+      CLog::Log(LOGERROR, "CPersistentCache::ReadFromCache - failed to read block %u", (unsigned int)(m_readPos / PERSISTENT_CACHE_BLOCK_SIZE));
+      m_readFile.Close();
+      m_readIndex = -1;
+      return CACHE_RC_ERROR;
+    }
+
+    m_readPos        += iRead;
+    m_bytesRead      += iRead;
+    m_bytesFromCache += iRead;
+    m_space.Set();
+    return iRead;
+  }
+
+  int iRead = m_pCache->ReadFromCache(pBuffer, iMaxSize);
+  if (iRead > 0)
+  {
+    m_readPos   += iRead;
+    m_bytesRead += iRead;
+  }
+  return iRead;
+}
+
+int64_t CPersistentCache::WaitForData(unsigned int iMinAvail, unsigned int iMillis)
+{
+  if (!IsOnDisk(m_readPos))
+    return m_pCache->WaitForData(iMinAvail, iMillis);
+
+  int64_t onDisk = m_diskEnd - m_readPos;
+  if (onDisk >= iMinAvail)
+    iMillis = 0;
+
+  int64_t ret = m_pCache->WaitForData(onDisk >= iMinAvail ? 0 : iMinAvail - (unsigned int)onDisk, iMillis);
+  if (ret < 0)
+    return iMillis == 0 ? onDisk : ret;
+  return onDisk + ret;
+}
+
+int64_t CPersistentCache::Seek(int64_t iFilePosition)
+{
+  if (IsOnDisk(iFilePosition))
+  {
+    // the wrapped cache continues where the store leaves off
+    if (m_pCache->Seek(m_diskEnd) != m_diskEnd)
+      return CACHE_RC_ERROR;
+    m_readPos = iFilePosition;
+    return iFilePosition;
+  }
+
+  int64_t ret = m_pCache->Seek(iFilePosition);
+  if (ret == iFilePosition)
+    m_readPos = iFilePosition;
+  return ret;
+}
+
+void CPersistentCache::Reset(int64_t iSourcePosition, bool clearAnyway)
+{
+  m_blockFill = 0;
+  m_readPos   = iSourcePosition;
+
+  int64_t diskEnd = PersistedDataEnd(iSourcePosition);
+  if (diskEnd > iSourcePosition
+  && (clearAnyway || diskEnd > m_pCache->CachedDataEndPosIfSeekTo(iSourcePosition)))
+  {
+    m_diskStart = iSourcePosition;
+    m_diskEnd   = diskEnd;
+    m_pCache->Reset(diskEnd, true);
+  }
+  else
+  {
+    m_diskStart = m_diskEnd = 0;
+    m_pCache->Reset(iSourcePosition, clearAnyway);
+  }
+  m_writePos = m_pCache->CachedDataEndPos();
+}
+
+void CPersistentCache::EndOfInput()
+{
+  if (m_block && m_writePos == m_length)
+    FlushBlock();
+  m_pCache->EndOfInput();
+}
+
+bool CPersistentCache::IsEndOfInput()
+{
+  return m_pCache->IsEndOfInput();
+}
+
+void CPersistentCache::ClearEndOfInput()
+{
+  m_pCache->ClearEndOfInput();
+}
+
+int64_t CPersistentCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  return std::max(PersistedDataEnd(iFilePosition), m_pCache->CachedDataEndPosIfSeekTo(iFilePosition));
+}
+
+int64_t CPersistentCache::CachedDataEndPos()
+{
+  return m_pCache->CachedDataEndPos();
+}
+
+bool CPersistentCache::IsCachedPosition(int64_t iFilePosition)
+{
+  return IsOnDisk(iFilePosition) || m_pCache->IsCachedPosition(iFilePosition);
+}
+
+CCacheStrategy *CPersistentCache::CreateNew()
+{
+  return new CPersistentCache(m_pCache->CreateNew());
+}
@@ -0,0 +1,170 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <map>
+#include <set>
+
+#include "CacheStrategy.h"
+#include "File.h"
+#include "threads/CriticalSection.h"
+#include "utils/StdString.h"
+
+#define PERSISTENT_CACHE_BLOCK_SIZE (256 * 1024)
+
+namespace XFILE
+{
+  /*!
+   \brief On-disk store of fixed size blocks of previously downloaded files.
+
+   Blocks live in <cachepath>/persistentcache/ as <key>_<index>.blk, where the key
+   identifies both the source url and the version of its content. The store
+   survives restarts and is trimmed to the configured budget in LRU order.
+   */
+  class CPersistentCacheStore
+  {
+  public:
+    static CPersistentCacheStore &Get();
+
+    /*! \brief Whether the store is enabled (advancedsettings cachepersistentsize > 0) */
+    bool IsEnabled() const;
+
+    /*! \brief Build the key for a source file.
+     \param url the url of the source.
+     \param length the length of the source in bytes.
+     \param validator an opaque token that changes whenever the content changes (ETag, mtime...).
+     \return the key, empty if the source can't be identified reliably.
+     */
+    static CStdString GetKey(const CStdString &url, int64_t length, const CStdString &validator);
+
+    bool HasBlock(const CStdString &key, unsigned int index, unsigned int &size);
+    /*! \brief Open the file of a block for reading, it stays valid while the key is pinned */
+    bool OpenBlock(const CStdString &key, unsigned int index, CFile &file, unsigned int &size);
+    bool StoreBlock(const CStdString &key, unsigned int index, const char *buffer, unsigned int size);
+
+    /*! \brief Prevent blocks of the given key from being evicted while a reader relies on them */
+    void Pin(const CStdString &key);
+    void Unpin(const CStdString &key);
+
+    /*! \brief Account a finished read session, for hit ratio reporting */
+    void AddStats(uint64_t bytesRead, uint64_t bytesFromCache);
+    void GetStats(uint64_t &bytesRead, uint64_t &bytesFromCache, uint64_t &bytesStored) const;
+
+    /*! \brief Remove every block from disk */
+    void Clear();
+
+  private:
+    CPersistentCacheStore();
+    CPersistentCacheStore(const CPersistentCacheStore&);
+    CPersistentCacheStore const& operator=(CPersistentCacheStore const&);
+    virtual ~CPersistentCacheStore();
+
+    typedef std::pair<CStdString, unsigned int> BlockId;
+    struct CBlock
+    {
+      BlockId      id;
+      unsigned int size;
+    };
+    typedef std::list<CBlock> BlockList;
+
+    void Initialize();
+    void Trim();
+    CStdString GetBlockPath(const CStdString &key, unsigned int index) const;
+
+    bool                              m_initialized;
+    CStdString                        m_path;
+    BlockList                         m_lru;     ///< most recently used first
+    std::map<BlockId, BlockList::iterator> m_blocks;
+    std::map<CStdString, int>         m_pinned;
+    std::set<BlockId>                 m_writing; ///< blocks being written outside of the lock
+    uint64_t                          m_size;
+    uint64_t                          m_bytesRead;
+    uint64_t                          m_bytesFromCache;
+    uint64_t                          m_bytesStored;
+    mutable CCriticalSection          m_critSection;
+  };
+
+  /*!
+   \brief Cache strategy that keeps downloaded data across sessions.
+
+   Wraps another cache strategy which handles the data coming from the source.
+   Everything written through it is also collected into blocks of the persistent
+   store, and ranges that are already in the store are served from disk so the
+   source only has to be read from the end of the persisted range onwards.
+   */
+  class CPersistentCache : public CCacheStrategy
+  {
+  public:
+    CPersistentCache(CCacheStrategy *impl);
+    virtual ~CPersistentCache();
+
+    /*! \brief Identify the source, has to be called after Open() and before data is written
+     \sa CPersistentCacheStore::GetKey
+     */
+    bool SetSource(const CStdString &url, int64_t length, const CStdString &validator);
+
+    virtual int Open();
+    virtual void Close();
+
+    virtual int WriteToCache(const char *pBuffer, size_t iSize);
+    virtual int ReadFromCache(char *pBuffer, size_t iMaxSize);
+    virtual int64_t WaitForData(unsigned int iMinAvail, unsigned int iMillis);
+
+    virtual int64_t Seek(int64_t iFilePosition);
+    virtual void Reset(int64_t iSourcePosition, bool clearAnyway=true);
+    virtual void EndOfInput();
+    virtual bool IsEndOfInput();
+    virtual void ClearEndOfInput();
+
+    virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
+    virtual int64_t CachedDataEndPos();
+    virtual bool IsCachedPosition(int64_t iFilePosition);
+
+    virtual CCacheStrategy *CreateNew();
+
+  private:
+    int64_t PersistedDataEnd(int64_t iFilePosition);
+    bool IsOnDisk(int64_t iFilePosition) const;
+    void StoreData(const char *pBuffer, size_t iSize);
+    void FlushBlock();
+    int  ReadBlock(char *pBuffer, size_t iSize);
+
+    CCacheStrategy *m_pCache;
+    CStdString      m_key;
+    int64_t         m_length;
+
+    int64_t         m_diskStart;   ///< range served from the store, empty if m_diskStart == m_diskEnd
+    int64_t         m_diskEnd;
+    int64_t         m_readPos;     ///< file position of the next byte returned to the reader
+    int64_t         m_writePos;    ///< file position of the next byte written by the source
+
+    char           *m_block;       ///< block being collected from the written data
+    unsigned int    m_blockIndex;
+    unsigned int    m_blockFill;
+
+    CFile           m_readFile;    ///< block of the store being read
+    int             m_readIndex;   ///< index of that block, -1 if none is open
+    unsigned int    m_readSize;
+
+    uint64_t        m_bytesRead;
+    uint64_t        m_bytesFromCache;
+  };
+}
@@ -18,6 +18,7 @@
  *
  */
 
+#include <list>
 #include <math.h>
 
 #include "SmartPlaylistDirectory.h"
@@ -25,9 +26,13 @@
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
 #include "filesystem/FileDirectoryFactory.h"
+#include "interfaces/AnnouncementManager.h"
 #include "music/MusicDatabase.h"
 #include "playlists/SmartPlayList.h"
+#include "profiles/ProfilesManager.h"
 #include "settings/Settings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -39,6 +44,117 @@
 #define PROPERTY_GROUP_BY           "group.by"
 #define PROPERTY_GROUP_MIXED        "group.mixed"
 
+// evaluated playlists kept, the home screen of most skins shows a handful
+#define CACHE_SIZE                  20
+// lists this long are browsed rather than shown in widgets and aren't worth keeping
+#define CACHE_MAX_ITEMS             2000
+// bounds how stale a result can get from changes that aren't announced, like relative dates
+// of rules passing, edits of referenced playlists or other clients of a shared database
+#define CACHE_LIFETIME              (10 * 60 * 1000)
+
+namespace
+{
+  /*! \brief Results of evaluated smart playlists, dropped whenever the video or music library
+   announces a change.
+   */
+  class CSmartPlaylistCache : public ANNOUNCEMENT::IAnnouncer
+  {
+  public:
+    static CSmartPlaylistCache &Get()
+    {
+      static CSmartPlaylistCache cache;
+      return cache;
+    }
+
+    unsigned int GetGeneration()
+    {
+      CSingleLock lock(m_section);
+      return m_generation;
+    }
+
+    bool GetItems(const std::string &key, CFileItemList &items)
+    {
+      CSingleLock lock(m_section);
+      for (std::list<SEntry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+      {
+        if (it->key != key)
+          continue;
+        if (XbmcThreads::SystemClockMillis() - it->time >= CACHE_LIFETIME)
+        {
+          m_entries.erase(it);
+          return false;
+        }
+        items.Copy(*it->items);
+        m_entries.splice(m_entries.begin(), m_entries, it);
+        return true;
+      }
+      return false;
+    }
+
+    /*! \brief Keep the result of a playlist evaluated while the library was at the given generation */
+    void SetItems(const std::string &key, const CFileItemList &items, unsigned int generation)
+    {
+      if (items.Size() > CACHE_MAX_ITEMS)
+        return;
+
+      SEntry entry;
+      entry.key = key;
+      entry.time = XbmcThreads::SystemClockMillis();
+      entry.items.reset(new CFileItemList);
+      entry.items->Copy(items);
+
+      CSingleLock lock(m_section);
+      // the library changed while the playlist was evaluated
+      if (generation != m_generation)
+        return;
+
+      for (std::list<SEntry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+      {
+        if (it->key == key)
+        {
+          m_entries.erase(it);
+          break;
+        }
+      }
+      m_entries.push_front(entry);
+      if (m_entries.size() > CACHE_SIZE)
+        m_entries.pop_back();
+    }
+
+    virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+    {
+      if ((flag & (ANNOUNCEMENT::VideoLibrary | ANNOUNCEMENT::AudioLibrary)) == 0)
+        return;
+
+      CSingleLock lock(m_section);
+      m_generation++;
+      m_entries.clear();
+    }
+
+  private:
+    CSmartPlaylistCache() : m_generation(0)
+    {
+      ANNOUNCEMENT::CAnnouncementManager::AddAnnouncer(this);
+    }
+
+    virtual ~CSmartPlaylistCache()
+    {
+      ANNOUNCEMENT::CAnnouncementManager::RemoveAnnouncer(this);
+    }
+
+    struct SEntry
+    {
+      std::string                     key;
+      unsigned int                    time;
+      boost::shared_ptr<CFileItemList> items;
+    };
+
+    CCriticalSection  m_section;
+    std::list<SEntry> m_entries;    ///< most recently used first
+    unsigned int      m_generation; ///< number of library changes seen
+  };
+}
+
 namespace XFILE
 {
   CSmartPlaylistDirectory::CSmartPlaylistDirectory()
@@ -55,9 +171,29 @@ namespace XFILE
     CSmartPlaylist playlist;
     if (!playlist.Load(strPath))
       return false;
+
+    // random playlists are expected to differ each time. the rules and settings are part of
+    // the key, so edited playlists are evaluated again, and so is the profile, whose library
+    // may differ
+    std::string key;
+    CStdString xsp;
+    if (playlist.GetOrder() != SortByRandom && playlist.SaveAsJson(xsp))
+    {
+      key = StringUtils::Format("%d\n", CProfilesManager::Get().GetCurrentProfileId()) + strPath + "\n" + xsp;
+      if (CSettings::Get().GetBool("filelists.ignorethewhensorting"))
+        key += "\nignorethe";
+      if (CSmartPlaylistCache::Get().GetItems(key, items))
+        return true;
+    }
+
+    unsigned int generation = CSmartPlaylistCache::Get().GetGeneration();
     bool result = GetDirectory(playlist, items);
     if (result)
+    {
       items.SetProperty("library.smartplaylist", true);
+      if (!key.empty())
+        CSmartPlaylistCache::Get().SetItems(key, items, generation);
+    }
     
     return result;
   }
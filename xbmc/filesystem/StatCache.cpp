@@ -0,0 +1,250 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "StatCache.h"
+#include "FileItem.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+using namespace XFILE;
+
+#define STAT_CACHE_LOG_INTERVAL 60000
+
+CStatCache::CStatCache()
+  : m_hits(0), m_misses(0), m_lastLog(0)
+{
+}
+
+bool CStatCache::Exists(const std::string &path, bool &exists)
+{
+  CSingleLock lock(m_section);
+  CEntry *entry = Find(GetKey(path));
+  if (!entry || !entry->existsKnown)
+  {
+    m_misses++;
+    return false;
+  }
+  m_hits++;
+  exists = entry->exists;
+  return true;
+}
+
+bool CStatCache::Stat(const std::string &path, struct __stat64 *buffer, int &result)
+{
+  CSingleLock lock(m_section);
+  CEntry *entry = Find(GetKey(path));
+  if (!entry || !entry->statKnown)
+  {
+    m_misses++;
+    return false;
+  }
+  m_hits++;
+  result = entry->statResult;
+  if (result == 0 && buffer)
+    *buffer = entry->stat;
+  return true;
+}
+
+void CStatCache::SetExists(const std::string &path, bool exists)
+{
+  unsigned int ttl = GetTTL(path);
+  if (!ttl)
+    return;
+
+  CSingleLock lock(m_section);
+  CEntry *entry = Insert(GetKey(path), ttl);
+  if (entry->existsKnown && entry->exists != exists)
+    entry->statKnown = false;
+  entry->existsKnown = true;
+  entry->exists = exists;
+  if (!exists)
+  { // a missing file can't be stat'd either
+    entry->statKnown = true;
+    entry->statResult = -1;
+  }
+}
+
+void CStatCache::SetStat(const std::string &path, const struct __stat64 *buffer, int result)
+{
+  unsigned int ttl = GetTTL(path);
+  if (!ttl || (result == 0 && !buffer))
+    return;
+
+  CSingleLock lock(m_section);
+  CEntry *entry = Insert(GetKey(path), ttl);
+  entry->statKnown = true;
+  entry->statResult = result;
+  if (result == 0)
+  {
+    entry->stat = *buffer;
+    entry->existsKnown = true;
+    entry->exists = true;
+  }
+  // a failed stat doesn't mean the file is missing, as not every protocol supports it
+}
+
+void CStatCache::AddDirectory(const std::string &path, const CFileItemList &items)
+{
+  unsigned int ttl = GetTTL(path);
+  if (!ttl)
+    return;
+
+  // listings carry a size and a date, but the dates are local time and on some protocols only to
+  // the minute, so they would give other hashes than a stat does. Only existence is taken.
+  CSingleLock lock(m_section);
+  CEntry *entry = Insert(GetKey(path), ttl);
+  entry->existsKnown = true;
+  entry->exists = true;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const std::string &itemPath = items[i]->GetPath();
+    if (items[i]->IsParentFolder() || GetTTL(itemPath) != ttl)
+      continue;
+    entry = Insert(GetKey(itemPath), ttl);
+    if (entry->existsKnown && !entry->exists)
+      entry->statKnown = false;
+    entry->existsKnown = true;
+    entry->exists = true;
+  }
+}
+
+void CStatCache::Remove(const std::string &path)
+{
+  std::string key = GetKey(path);
+
+  CSingleLock lock(m_section);
+  EntryMap::iterator it = m_entries.lower_bound(key);
+  while (it != m_entries.end() && it->first.compare(0, key.size(), key) == 0)
+  {
+    if (it->first.size() == key.size() || it->first[key.size()] == '/' || it->first[key.size()] == '\\')
+      Erase(it++);
+    else
+      ++it;
+  }
+}
+
+void CStatCache::Clear()
+{
+  CSingleLock lock(m_section);
+  m_entries.clear();
+  m_order.clear();
+}
+
+void CStatCache::GetStats(unsigned int &hits, unsigned int &misses) const
+{
+  CSingleLock lock(m_section);
+  hits = m_hits;
+  misses = m_misses;
+}
+
+CStatCache::CEntry *CStatCache::Find(const std::string &key)
+{
+  LogStats();
+
+  EntryMap::iterator it = m_entries.find(key);
+  if (it == m_entries.end())
+    return NULL;
+  if (XbmcThreads::SystemClockMillis() - it->second.time >= it->second.ttl)
+  {
+    Erase(it);
+    return NULL;
+  }
+  return &it->second;
+}
+
+CStatCache::CEntry *CStatCache::Insert(const std::string &key, unsigned int ttl)
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+
+  EntryMap::iterator it = m_entries.find(key);
+  if (it != m_entries.end())
+  {
+    CEntry &entry = it->second;
+    if (now - entry.time >= entry.ttl)
+    { // expired, start over
+      entry.existsKnown = false;
+      entry.statKnown = false;
+    }
+    entry.time = now;
+    entry.ttl = ttl;
+    m_order.splice(m_order.end(), m_order, entry.order);
+    return &entry;
+  }
+
+  // the oldest entries are the first to expire, drop them to make room
+  unsigned int maxSize = std::max(g_advancedSettings.m_statCacheSize, 1U);
+  while (m_entries.size() >= maxSize)
+    Erase(m_entries.find(m_order.front()));
+
+  CEntry &entry = m_entries[key];
+  entry.time = now;
+  entry.ttl = ttl;
+  entry.existsKnown = false;
+  entry.exists = false;
+  entry.statKnown = false;
+  entry.statResult = -1;
+  entry.order = m_order.insert(m_order.end(), key);
+  return &entry;
+}
+
+void CStatCache::Erase(EntryMap::iterator it)
+{
+  m_order.erase(it->second.order);
+  m_entries.erase(it);
+}
+
+void CStatCache::LogStats()
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (now - m_lastLog < STAT_CACHE_LOG_INTERVAL)
+    return;
+
+  if (m_hits || m_misses)
+    CLog::Log(LOGDEBUG, "%s - %u hits, %u misses (%.1f%%), %u paths cached", __FUNCTION__,
+              m_hits, m_misses, 100.0 * m_hits / (m_hits + m_misses), (unsigned int)m_entries.size());
+  m_lastLog = now;
+}
+
+std::string CStatCache::GetKey(const std::string &path)
+{
+  CStdString key(path);
+  URIUtils::RemoveSlashAtEnd(key);
+  return key;
+}
+
+unsigned int CStatCache::GetTTL(const std::string &path)
+{
+  size_t protocol = path.find("://");
+  if (protocol == std::string::npos)
+    return 0;
+
+  std::string name = path.substr(0, protocol);
+  StringUtils::ToLower(name);
+  std::map<std::string, unsigned int>::const_iterator it = g_advancedSettings.m_statCacheTTL.find(name);
+  if (it == g_advancedSettings.m_statCacheTTL.end())
+    return 0;
+  return it->second * 1000;
+}
@@ -0,0 +1,103 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "PlatformDefs.h"
+#include "threads/CriticalSection.h"
+
+class CFileItemList;
+
+namespace XFILE
+{
+  /*!
+   \brief Remembers the results of CFile::Exists() and CFile::Stat() on network shares for a few seconds.
+
+   Scanners and thumb loaders check the same paths over and over, and each check is a round-trip
+   to the server. Results are kept for the time set per protocol in advancedsettings.xml, and
+   protocols without a time aren't cached at all. Missing files are remembered as well, and files
+   in directory listings are remembered as existing. CFile removes paths it writes to, deletes or
+   renames.
+   */
+  class CStatCache
+  {
+  public:
+    CStatCache();
+
+    /*! \brief Look up whether a path exists
+     \param exists receives whether the path exists, if it's cached.
+     \return true if the path is cached.
+     */
+    bool Exists(const std::string &path, bool &exists);
+
+    /*! \brief Look up the stat of a path
+     \param buffer receives the stat of the path, if it's cached and the stat succeeded.
+     \param result receives the result of the stat, if it's cached.
+     \return true if the path is cached.
+     */
+    bool Stat(const std::string &path, struct __stat64 *buffer, int &result);
+
+    void SetExists(const std::string &path, bool exists);
+    void SetStat(const std::string &path, const struct __stat64 *buffer, int result);
+
+    /*! \brief Remember that a directory and the items listed in it exist */
+    void AddDirectory(const std::string &path, const CFileItemList &items);
+
+    /*! \brief Forget a path and anything below it */
+    void Remove(const std::string &path);
+    void Clear();
+
+    void GetStats(unsigned int &hits, unsigned int &misses) const;
+
+  private:
+    struct CEntry
+    {
+      unsigned int time;
+      unsigned int ttl;
+      bool         existsKnown;
+      bool         exists;
+      bool         statKnown;
+      int          statResult;
+      struct __stat64 stat;
+      std::list<std::string>::iterator order;
+    };
+    typedef std::map<std::string, CEntry> EntryMap;
+
+    CEntry *Find(const std::string &key);
+    CEntry *Insert(const std::string &key, unsigned int ttl);
+    void Erase(EntryMap::iterator it);
+    void LogStats();
+
+    static std::string GetKey(const std::string &path);
+    static unsigned int GetTTL(const std::string &path);
+
+    CCriticalSection       m_section;
+    EntryMap               m_entries;
+    std::list<std::string> m_order;   ///< keys from the oldest to the newest entry, for evicting
+    unsigned int           m_hits;
+    unsigned int           m_misses;
+    unsigned int           m_lastLog; ///< time the statistics were logged
+  };
+}
+
+extern XFILE::CStatCache g_statCache;
@@ -43,6 +43,7 @@ CVirtualDirectory::CVirtualDirectory(void)
   m_flags = DIR_FLAG_ALLOW_PROMPT;
   m_allowNonLocalSources = true;
   m_allowThreads = true;
+  m_listingCallback = NULL;
 }
 
 CVirtualDirectory::~CVirtualDirectory(void)
@@ -77,7 +78,13 @@ bool CVirtualDirectory::GetDirectory(const CStdString& strPath, CFileItemList &i
   if (!bUseFileDirectories)
     flags |= DIR_FLAG_NO_FILE_DIRS;
   if (!strPath.IsEmpty() && strPath != "files://")
-    return CDirectory::GetDirectory(strPath, items, m_strFileMask, flags, m_allowThreads);
+  {
+    CDirectory::CHints hints;
+    hints.mask = m_strFileMask;
+    hints.flags = flags;
+    hints.callback = m_listingCallback;
+    return CDirectory::GetDirectory(strPath, items, hints, m_allowThreads);
+  }
 
   // if strPath is blank, clear the list (to avoid parent items showing up)
   if (strPath.IsEmpty())
@@ -20,6 +20,7 @@
  */
 
 #include "IDirectory.h"
+#include "Directory.h"
 #include "MediaSource.h"
 
 namespace XFILE
@@ -64,11 +65,18 @@ namespace XFILE
      \param allowThreads if true we allow threads, if false we don't.
      */
     void SetAllowThreads(bool allowThreads) { m_allowThreads = allowThreads; };
+
+    /*! \brief Set a callback that receives the items of threaded listings while they are listed.
+     \param callback the callback, or NULL for none.
+     \sa CDirectory::IListingCallback
+     */
+    void SetListingCallback(CDirectory::IListingCallback *callback) { m_listingCallback = callback; };
   protected:
     void CacheThumbs(CFileItemList &items);
 
     VECSOURCES m_vecSources;
     bool       m_allowNonLocalSources;
     bool       m_allowThreads;
+    CDirectory::IListingCallback *m_listingCallback;
   };
 }
@@ -0,0 +1,274 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/CurlFile.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Atomics.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+#include "URL.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+#define TEST_FILE_SIZE (1024 * 1024 + 1000)
+#define TEST_CHUNK_SIZE (64 * 1024)
+
+static char TestByte(int64_t pos)
+{
+  return (char)(pos * 7);
+}
+
+/* Answers the http requests of a single connection, with 206 replies to range requests if enabled */
+class CTestHttpConnection : public CThread
+{
+public:
+  CTestHttpConnection(SOCKET socket, bool ranges, volatile long &rangeReplies)
+    : CThread("TestHttpConnection"), m_socket(socket), m_ranges(ranges), m_rangeReplies(rangeReplies)
+  {
+    // don't block the end of the test on a client that doesn't read anymore
+    struct timeval timeout = { 2, 0 };
+    setsockopt(m_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  }
+
+  ~CTestHttpConnection()
+  {
+    StopThread(true);
+    close(m_socket);
+  }
+
+protected:
+  virtual void Process()
+  {
+    std::string request;
+    char buffer[4096];
+    while (!m_bStop)
+    {
+      size_t end = request.find("\r\n\r\n");
+      if (end == std::string::npos)
+      {
+        ssize_t len = recv(m_socket, buffer, sizeof(buffer), 0);
+        if (len <= 0)
+          return;
+        request.append(buffer, len);
+        continue;
+      }
+
+      std::string headers = request.substr(0, end);
+      request.erase(0, end + 4);
+
+      int64_t start = 0, last = TEST_FILE_SIZE - 1;
+      bool partial = false;
+      size_t range = headers.find("Range: bytes=");
+      if (m_ranges && range != std::string::npos)
+      {
+        long long first = 0, final = -1;
+        if (sscanf(headers.c_str() + range + 13, "%lld-%lld", &first, &final) >= 1)
+        {
+          start   = first;
+          if (final >= 0 && final < last)
+            last  = final;
+          partial = true;
+          AtomicIncrement(&m_rangeReplies);
+        }
+      }
+
+      std::string reply;
+      if (partial)
+        reply = StringUtils::Format("HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %lld-%lld/%d\r\n", (long long)start, (long long)last, TEST_FILE_SIZE);
+      else
+        reply = "HTTP/1.1 200 OK\r\n";
+      reply += StringUtils::Format("Content-Length: %lld\r\nAccept-Ranges: bytes\r\n\r\n", (long long)(last - start + 1));
+      if (!Send(reply.c_str(), reply.size()))
+        return;
+
+      if (headers.compare(0, 5, "HEAD ") == 0)
+        continue;
+
+      for (int64_t pos = start; pos <= last; )
+      {
+        int len = 0;
+        for (; len < (int)sizeof(buffer) && pos <= last; len++, pos++)
+          buffer[len] = TestByte(pos);
+        if (!Send(buffer, len))
+          return;
+      }
+    }
+  }
+
+  bool Send(const char *data, size_t size)
+  {
+    while (size > 0 && !m_bStop)
+    {
+      ssize_t sent = send(m_socket, data, size, MSG_NOSIGNAL);
+      if (sent <= 0)
+        return false;
+      data += sent;
+      size -= sent;
+    }
+    return size == 0;
+  }
+
+  SOCKET         m_socket;
+  bool           m_ranges;
+  volatile long &m_rangeReplies;
+};
+
+/* Serves a generated file over http on localhost */
+class CTestHttpServer : public CThread
+{
+public:
+  CTestHttpServer(bool ranges)
+    : CThread("TestHttpServer"), m_socket(INVALID_SOCKET), m_port(0), m_ranges(ranges), m_rangeReplies(0)
+  {
+  }
+
+  ~CTestHttpServer()
+  {
+    StopThread(true);
+    if (m_socket != (SOCKET)INVALID_SOCKET)
+      close(m_socket);
+    for (std::vector<CTestHttpConnection*>::iterator it = m_connections.begin(); it != m_connections.end(); ++it)
+      delete *it;
+  }
+
+  bool Start()
+  {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t size = sizeof(addr);
+
+    m_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_socket == (SOCKET)INVALID_SOCKET
+    ||  bind(m_socket, (struct sockaddr*)&addr, sizeof(addr)) != 0
+    ||  listen(m_socket, 16) != 0
+    ||  getsockname(m_socket, (struct sockaddr*)&addr, &size) != 0)
+      return false;
+
+    m_port = ntohs(addr.sin_port);
+    Create();
+    return true;
+  }
+
+  CStdString GetURL() const { return StringUtils::Format("http://127.0.0.1:%d/movie.mkv", m_port); }
+  long       GetRangeReplies() const { return m_rangeReplies; }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      fd_set set;
+      FD_ZERO(&set);
+      FD_SET(m_socket, &set);
+      struct timeval timeout = { 0, 100000 };
+      if (select(m_socket + 1, &set, NULL, NULL, &timeout) <= 0)
+        continue;
+
+      SOCKET client = accept(m_socket, NULL, NULL);
+      if (client == (SOCKET)INVALID_SOCKET)
+        continue;
+      CTestHttpConnection *connection = new CTestHttpConnection(client, m_ranges, m_rangeReplies);
+      m_connections.push_back(connection);
+      connection->Create();
+    }
+  }
+
+  SOCKET                            m_socket;
+  int                               m_port;
+  bool                              m_ranges;
+  volatile long                     m_rangeReplies;
+  std::vector<CTestHttpConnection*> m_connections;
+};
+
+class TestCurlFile : public testing::Test
+{
+protected:
+  TestCurlFile()
+  {
+    g_advancedSettings.m_curlParallelRanges = 4;
+    g_advancedSettings.m_curlRangeChunkSize = TEST_CHUNK_SIZE;
+  }
+
+  ~TestCurlFile()
+  {
+    g_advancedSettings.m_curlParallelRanges = 0;
+    g_advancedSettings.m_curlRangeChunkSize = 1024 * 1024;
+  }
+
+  /* reads the file from pos to its end, checking every byte */
+  static void ReadAndCompare(CCurlFile &file, int64_t pos)
+  {
+    std::vector<char> buffer(100000);
+    while (pos < TEST_FILE_SIZE)
+    {
+      unsigned int read = file.Read(&buffer[0], buffer.size());
+      ASSERT_LT(0u, read);
+      for (unsigned int i = 0; i < read; i++, pos++)
+        ASSERT_EQ(TestByte(pos), buffer[i]) << "at " << pos;
+      EXPECT_EQ(pos, file.GetPosition());
+    }
+    EXPECT_EQ(0u, file.Read(&buffer[0], buffer.size()));
+  }
+};
+
+TEST_F(TestCurlFile, ParallelRanges)
+{
+  CTestHttpServer server(true);
+  ASSERT_TRUE(server.Start());
+
+  CCurlFile file;
+  ASSERT_TRUE(file.Open(CURL(server.GetURL())));
+  EXPECT_EQ(TEST_FILE_SIZE, file.GetLength());
+  ReadAndCompare(file, 0);
+  // every chunk was fetched with its own range request
+  EXPECT_LE((TEST_FILE_SIZE + TEST_CHUNK_SIZE - 1) / TEST_CHUNK_SIZE, server.GetRangeReplies());
+
+  // seek back into the middle of a chunk
+  int64_t pos = 3 * TEST_CHUNK_SIZE + 123;
+  ASSERT_EQ(pos, file.Seek(pos, SEEK_SET));
+  ReadAndCompare(file, pos);
+  file.Close();
+}
+
+TEST_F(TestCurlFile, RangesIgnored)
+{
+  // the server answers with the whole file, the reader has to continue on a single stream
+  CTestHttpServer server(false);
+  ASSERT_TRUE(server.Start());
+
+  CCurlFile file;
+  ASSERT_TRUE(file.Open(CURL(server.GetURL())));
+  EXPECT_EQ(TEST_FILE_SIZE, file.GetLength());
+  ReadAndCompare(file, 0);
+  EXPECT_EQ(0, server.GetRangeReplies());
+  file.Close();
+}
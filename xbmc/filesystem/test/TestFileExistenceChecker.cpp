@@ -0,0 +1,73 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/FileExistenceChecker.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+class CCancelProgress : public XFILE::CFileExistenceChecker::IProgress
+{
+public:
+  virtual bool OnProgress(unsigned int checked, unsigned int total) { return false; }
+};
+
+TEST(TestFileExistenceChecker, Check)
+{
+  XFILE::CFileExistenceChecker checker;
+  checker.Add(1, XBMC_REF_FILE_PATH("xbmc/filesystem/test/reffile.txt"));
+  checker.Add(2, XBMC_REF_FILE_PATH("xbmc/filesystem/test/reffile.txt.zip"));
+  checker.Add(3, XBMC_REF_FILE_PATH("xbmc/filesystem/test/missing.txt"));
+  checker.Add(4, XBMC_REF_FILE_PATH("xbmc/filesystem/test/missing/reffile.txt"));
+  checker.Add(5, XBMC_REF_FILE_PATH("xbmc/utils/test/CXBMCTinyXML-test.xml"));
+  EXPECT_EQ(5u, checker.Size());
+
+  std::vector<int> missing;
+  ASSERT_TRUE(checker.Check(missing));
+  std::sort(missing.begin(), missing.end());
+  ASSERT_EQ(2u, missing.size());
+  EXPECT_EQ(3, missing[0]);
+  EXPECT_EQ(4, missing[1]);
+}
+
+TEST(TestFileExistenceChecker, Empty)
+{
+  XFILE::CFileExistenceChecker checker;
+  std::vector<int> missing;
+  EXPECT_TRUE(checker.Check(missing));
+  EXPECT_TRUE(missing.empty());
+}
+
+TEST(TestFileExistenceChecker, Cancel)
+{
+  XFILE::CFileExistenceChecker checker;
+  for (int i = 0; i < 100; i++)
+  {
+    CStdString path;
+    path.Format("xbmc/filesystem/test/missing%i/file.txt", i);
+    checker.Add(i, XBMC_REF_FILE_PATH(path));
+  }
+
+  CCancelProgress progress;
+  std::vector<int> missing;
+  EXPECT_FALSE(checker.Check(missing, &progress));
+}
@@ -0,0 +1,152 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#ifdef HAS_FILESYSTEM_NFS
+#include "filesystem/NFSFile.h"
+#include "settings/AdvancedSettings.h"
+#include "URL.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+/*
+ * These tests need an NFS server, e.g. a userspace one like unfs3 exporting
+ * a directory on localhost. XBMC_TEST_NFS_URL names a file of a few MB on it:
+ *
+ *   XBMC_TEST_NFS_URL=nfs://127.0.0.1/tmp/export/movie.mkv
+ *
+ * Without it there is nothing to read and they pass without checking.
+ */
+class TestNFSFile : public testing::Test
+{
+protected:
+  TestNFSFile()
+  {
+    const char *url = getenv("XBMC_TEST_NFS_URL");
+    if (url)
+      m_url = url;
+  }
+
+  ~TestNFSFile()
+  {
+    g_advancedSettings.m_nfsReadAheadDepth = 0;
+  }
+
+  virtual void SetUp()
+  {
+    if (m_url.empty())
+    {
+      RecordProperty("skipped", "XBMC_TEST_NFS_URL not set");
+      return;
+    }
+
+    // the synchronous reads are the reference
+    g_advancedSettings.m_nfsReadAheadDepth = 0;
+    CNFSFile file;
+    ASSERT_TRUE(file.Open(CURL(m_url)));
+    m_data.resize((size_t)file.GetLength());
+    ASSERT_LT(0U, m_data.size());
+    size_t pos = 0;
+    while (pos < m_data.size())
+    {
+      unsigned int read = file.Read(&m_data[pos], m_data.size() - pos);
+      ASSERT_LT(0U, read);
+      pos += read;
+    }
+    file.Close();
+  }
+
+  /* reads from pos to the end of the file in chunks of size, checking every byte */
+  void ReadAndCompare(CNFSFile &file, int64_t pos, unsigned int size)
+  {
+    std::vector<char> buffer(size);
+    while (pos < (int64_t)m_data.size())
+    {
+      unsigned int read = file.Read(&buffer[0], buffer.size());
+      ASSERT_LT(0U, read) << "at " << pos;
+      ASSERT_EQ(0, memcmp(&m_data[(size_t)pos], &buffer[0], read)) << "at " << pos;
+      pos += read;
+      ASSERT_EQ(pos, file.GetPosition());
+    }
+    EXPECT_EQ(0U, file.Read(&buffer[0], buffer.size()));
+  }
+
+  std::string       m_url;
+  std::vector<char> m_data;
+};
+
+TEST_F(TestNFSFile, ReadAhead)
+{
+  if (m_url.empty())
+    return;
+
+  g_advancedSettings.m_nfsReadAheadDepth = 8;
+  CNFSFile file;
+  ASSERT_TRUE(file.Open(CURL(m_url)));
+  ReadAndCompare(file, 0, 64 * 1024);
+  file.Close();
+}
+
+TEST_F(TestNFSFile, ReadAheadSmallReads)
+{
+  if (m_url.empty())
+    return;
+
+  // reads smaller than a READ are served from the same reply
+  g_advancedSettings.m_nfsReadAheadDepth = 4;
+  CNFSFile file;
+  ASSERT_TRUE(file.Open(CURL(m_url)));
+  ReadAndCompare(file, 0, 1000);
+  file.Close();
+}
+
+TEST_F(TestNFSFile, ReadAheadSeek)
+{
+  if (m_url.empty())
+    return;
+
+  g_advancedSettings.m_nfsReadAheadDepth = 8;
+  CNFSFile file;
+  ASSERT_TRUE(file.Open(CURL(m_url)));
+  std::vector<char> buffer(64 * 1024);
+  int64_t size = (int64_t)m_data.size();
+
+  // get the window going, then skip a little ahead inside it
+  for (int i = 0; i < 4; i++)
+    ASSERT_LT(0U, file.Read(&buffer[0], buffer.size()));
+  int64_t pos = std::min(size, file.GetPosition() + 1000);
+  ASSERT_EQ(pos, file.Seek(pos, SEEK_SET));
+  ReadAndCompare(file, pos, buffer.size());
+
+  // back to the middle, which drops the window
+  pos = size / 2 + 123;
+  ASSERT_EQ(pos, file.Seek(pos, SEEK_SET));
+  ReadAndCompare(file, pos, buffer.size());
+  file.Close();
+}
+#endif
@@ -0,0 +1,124 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/CircularCache.h"
+#include "filesystem/PersistentCache.h"
+#include "settings/AdvancedSettings.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+static const char *TEST_URL = "http://example.com/movie.mkv";
+
+class TestPersistentCache : public testing::Test
+{
+protected:
+  TestPersistentCache()
+  {
+    g_advancedSettings.m_cachePersistentSize = 4 * PERSISTENT_CACHE_BLOCK_SIZE;
+    m_data.resize(PERSISTENT_CACHE_BLOCK_SIZE + 1000);
+    for (size_t i = 0; i < m_data.size(); i++)
+      m_data[i] = (char)(i * 7);
+  }
+
+  ~TestPersistentCache()
+  {
+    CPersistentCacheStore::Get().Clear();
+    g_advancedSettings.m_cachePersistentSize = 0;
+  }
+
+  void Download(const CStdString &validator)
+  {
+    CPersistentCache cache(new CCircularCache(2 * m_data.size(), 0));
+    ASSERT_EQ(CACHE_RC_OK, cache.Open());
+    ASSERT_TRUE(cache.SetSource(TEST_URL, m_data.size(), validator));
+    size_t written = 0;
+    while (written < m_data.size())
+    {
+      int ret = cache.WriteToCache(&m_data[written], m_data.size() - written);
+      ASSERT_GT(ret, 0);
+      written += ret;
+    }
+    cache.EndOfInput();
+    cache.Close();
+  }
+
+  std::vector<char> m_data;
+};
+
+TEST_F(TestPersistentCache, ServeFromPreviousSession)
+{
+  Download("\"etag1\"");
+
+  uint64_t readBefore, fromCacheBefore, stored;
+  CPersistentCacheStore::Get().GetStats(readBefore, fromCacheBefore, stored);
+  EXPECT_LE((uint64_t)m_data.size(), stored);
+
+  CPersistentCache cache(new CCircularCache(2 * m_data.size(), 0));
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  ASSERT_TRUE(cache.SetSource(TEST_URL, m_data.size(), "\"etag1\""));
+  EXPECT_EQ((int64_t)m_data.size(), cache.CachedDataEndPosIfSeekTo(0));
+  cache.Reset(0, false);
+  EXPECT_EQ((int64_t)m_data.size(), cache.CachedDataEndPos());
+  EXPECT_TRUE(cache.IsCachedPosition(PERSISTENT_CACHE_BLOCK_SIZE + 10));
+
+  std::vector<char> buf(m_data.size());
+  size_t read = 0;
+  while (read < buf.size())
+  {
+    int ret = cache.ReadFromCache(&buf[read], buf.size() - read);
+    ASSERT_GT(ret, 0);
+    read += ret;
+  }
+  EXPECT_TRUE(buf == m_data);
+
+  EXPECT_EQ(PERSISTENT_CACHE_BLOCK_SIZE + 10, cache.Seek(PERSISTENT_CACHE_BLOCK_SIZE + 10));
+  char c;
+  EXPECT_EQ(1, cache.ReadFromCache(&c, 1));
+  EXPECT_EQ(m_data[PERSISTENT_CACHE_BLOCK_SIZE + 10], c);
+  cache.Close();
+
+  uint64_t readAfter, fromCacheAfter;
+  CPersistentCacheStore::Get().GetStats(readAfter, fromCacheAfter, stored);
+  EXPECT_EQ(m_data.size() + 1, fromCacheAfter - fromCacheBefore);
+  EXPECT_EQ(readAfter - readBefore, fromCacheAfter - fromCacheBefore);
+}
+
+TEST_F(TestPersistentCache, ChangedContentIsNotServed)
+{
+  Download("\"etag1\"");
+
+  CPersistentCache cache(new CCircularCache(2 * m_data.size(), 0));
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  ASSERT_TRUE(cache.SetSource(TEST_URL, m_data.size(), "\"etag2\""));
+  EXPECT_EQ(0, cache.CachedDataEndPosIfSeekTo(0));
+  EXPECT_EQ(100, cache.CachedDataEndPosIfSeekTo(100));
+}
+
+TEST_F(TestPersistentCache, UnidentifiableSource)
+{
+  CPersistentCache cache(new CCircularCache(2 * m_data.size(), 0));
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  EXPECT_FALSE(cache.SetSource(TEST_URL, m_data.size(), ""));
+  EXPECT_FALSE(cache.SetSource(TEST_URL, 0, "\"etag1\""));
+}
@@ -0,0 +1,168 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "filesystem/StatCache.h"
+#include "FileItem.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+class TestStatCache : public testing::Test
+{
+protected:
+  TestStatCache()
+  {
+    g_advancedSettings.m_statCacheTTL.clear();
+    g_advancedSettings.m_statCacheTTL["smb"] = 1;
+    g_advancedSettings.m_statCacheSize = 5000;
+  }
+
+  ~TestStatCache()
+  {
+    g_advancedSettings.OnSettingsUnloaded();
+    g_advancedSettings.Initialize();
+  }
+
+  XFILE::CStatCache cache;
+};
+
+TEST_F(TestStatCache, Exists)
+{
+  bool exists = false;
+  EXPECT_FALSE(cache.Exists("smb://server/share/movie.avi", exists));
+
+  cache.SetExists("smb://server/share/movie.avi", true);
+  cache.SetExists("smb://server/share/missing.avi", false);
+  EXPECT_TRUE(cache.Exists("smb://server/share/movie.avi", exists));
+  EXPECT_TRUE(exists);
+  EXPECT_TRUE(cache.Exists("smb://server/share/missing.avi", exists));
+  EXPECT_FALSE(exists);
+
+  // a missing file fails to stat
+  int result = 0;
+  EXPECT_FALSE(cache.Stat("smb://server/share/movie.avi", NULL, result));
+  EXPECT_TRUE(cache.Stat("smb://server/share/missing.avi", NULL, result));
+  EXPECT_EQ(-1, result);
+
+  // protocols without a ttl aren't cached
+  cache.SetExists("nfs://server/share/movie.avi", true);
+  cache.SetExists("/home/user/movie.avi", true);
+  EXPECT_FALSE(cache.Exists("nfs://server/share/movie.avi", exists));
+  EXPECT_FALSE(cache.Exists("/home/user/movie.avi", exists));
+
+  unsigned int hits, misses;
+  cache.GetStats(hits, misses);
+  EXPECT_EQ(3U, hits);
+  EXPECT_EQ(4U, misses);
+}
+
+TEST_F(TestStatCache, Stat)
+{
+  struct __stat64 st;
+  memset(&st, 0, sizeof(st));
+  st.st_size = 1234;
+  st.st_mtime = 5678;
+  cache.SetStat("smb://server/share/movie.avi", &st, 0);
+  cache.SetStat("smb://server/share/other.avi", NULL, -1);
+
+  struct __stat64 cached;
+  memset(&cached, 0, sizeof(cached));
+  int result = -1;
+  EXPECT_TRUE(cache.Stat("smb://server/share/movie.avi", &cached, result));
+  EXPECT_EQ(0, result);
+  EXPECT_EQ(1234, cached.st_size);
+  EXPECT_EQ(5678, cached.st_mtime);
+
+  bool exists = false;
+  EXPECT_TRUE(cache.Exists("smb://server/share/movie.avi", exists));
+  EXPECT_TRUE(exists);
+
+  // a failed stat doesn't tell whether the file exists
+  EXPECT_TRUE(cache.Stat("smb://server/share/other.avi", &cached, result));
+  EXPECT_EQ(-1, result);
+  EXPECT_FALSE(cache.Exists("smb://server/share/other.avi", exists));
+}
+
+TEST_F(TestStatCache, Directory)
+{
+  CFileItemList items;
+  items.Add(CFileItemPtr(new CFileItem("smb://server/share/movies/movie.avi", false)));
+  items.Add(CFileItemPtr(new CFileItem("smb://server/share/movies/extras/", true)));
+  cache.AddDirectory("smb://server/share/movies/", items);
+
+  bool exists = false;
+  EXPECT_TRUE(cache.Exists("smb://server/share/movies", exists));
+  EXPECT_TRUE(exists);
+  EXPECT_TRUE(cache.Exists("smb://server/share/movies/movie.avi", exists));
+  EXPECT_TRUE(exists);
+  EXPECT_TRUE(cache.Exists("smb://server/share/movies/extras/", exists));
+  EXPECT_TRUE(exists);
+  EXPECT_FALSE(cache.Exists("smb://server/share/movies/movie.nfo", exists));
+
+  // listings don't give a stat
+  int result;
+  EXPECT_FALSE(cache.Stat("smb://server/share/movies/movie.avi", NULL, result));
+}
+
+TEST_F(TestStatCache, Remove)
+{
+  cache.SetExists("smb://server/share/movies", true);
+  cache.SetExists("smb://server/share/movies/movie.avi", true);
+  cache.SetExists("smb://server/share/movies-old", true);
+  cache.SetExists("smb://server/share/music", true);
+
+  cache.Remove("smb://server/share/movies/");
+
+  bool exists;
+  EXPECT_FALSE(cache.Exists("smb://server/share/movies", exists));
+  EXPECT_FALSE(cache.Exists("smb://server/share/movies/movie.avi", exists));
+  EXPECT_TRUE(cache.Exists("smb://server/share/movies-old", exists));
+  EXPECT_TRUE(cache.Exists("smb://server/share/music", exists));
+
+  cache.Clear();
+  EXPECT_FALSE(cache.Exists("smb://server/share/music", exists));
+}
+
+TEST_F(TestStatCache, Expire)
+{
+  cache.SetExists("smb://server/share/movie.avi", true);
+  bool exists;
+  EXPECT_TRUE(cache.Exists("smb://server/share/movie.avi", exists));
+  XbmcThreads::ThreadSleep(1100);
+  EXPECT_FALSE(cache.Exists("smb://server/share/movie.avi", exists));
+}
+
+TEST_F(TestStatCache, Size)
+{
+  g_advancedSettings.m_statCacheSize = 2;
+  cache.SetExists("smb://server/share/1.avi", true);
+  cache.SetExists("smb://server/share/2.avi", true);
+  cache.SetExists("smb://server/share/1.avi", false);
+  cache.SetExists("smb://server/share/3.avi", true);
+
+  // the least recently set path is dropped
+  bool exists;
+  EXPECT_FALSE(cache.Exists("smb://server/share/2.avi", exists));
+  EXPECT_TRUE(cache.Exists("smb://server/share/1.avi", exists));
+  EXPECT_FALSE(exists);
+  EXPECT_TRUE(cache.Exists("smb://server/share/3.avi", exists));
+}
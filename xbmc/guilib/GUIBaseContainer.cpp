@@ -64,6 +64,8 @@ CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, fl
 
 CGUIBaseContainer::~CGUIBaseContainer(void)
 {
+  // the items may outlive us, so don't leave them our layouts
+  m_layoutPool.ReleaseAll(m_layout, m_focusedLayout);
 }
 
 void CGUIBaseContainer::DoProcess(unsigned int currentTime, CDirtyRegionList &dirtyregions)
@@ -91,10 +93,6 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   int cacheBefore, cacheAfter;
   GetCacheOffsets(cacheBefore, cacheAfter);
 
-  // Free memory not used on screen
-  if ((int)m_items.size() > m_itemsPerPage + cacheBefore + cacheAfter)
-    FreeMemory(CorrectOffset(offset - cacheBefore, 0), CorrectOffset(offset + m_itemsPerPage + 1 + cacheAfter, 0));
-
   CPoint origin = CPoint(m_posX, m_posY) + m_renderOffset;
   float pos = (m_orientation == VERTICAL) ? origin.y : origin.x;
   float end = (m_orientation == VERTICAL) ? m_posY + m_height : m_posX + m_width;
@@ -128,6 +126,9 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
     current++;
   }
 
+  // hand the layouts of the items no longer shown to the items scrolled in
+  m_layoutPool.ReleaseUnused(m_layout, m_focusedLayout);
+
   // when we are scrolling up, offset will become lower (integer division, see offset calc)
   // to have same behaviour when scrolling down, we need to set page control to offset+1
   UpdatePageControl(offset + (m_scroller.IsScrollingDown() ? 1 : 0));
@@ -144,11 +145,15 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
 
   if (m_bInvalidated)
     item->SetInvalid();
+  if ((item->GetLayout() && !item->GetLayout()->IsCopyOf(m_layout)) ||
+      (item->GetFocusedLayout() && !item->GetFocusedLayout()->IsCopyOf(m_focusedLayout)))
+    item->FreeMemory(); // layouts of another container
+  m_layoutPool.Use(item);
   if (focused)
   {
     if (!item->GetFocusedLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_focusedLayout);
+      CGUIListItemLayout *layout = m_layoutPool.Create(m_focusedLayout);
       item->SetFocusedLayout(layout);
     }
     if (item->GetFocusedLayout())
@@ -175,7 +180,7 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
       item->GetFocusedLayout()->SetFocusedItem(0);  // focus is not set
     if (!item->GetLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_layout);
+      CGUIListItemLayout *layout = m_layoutPool.Create(m_layout);
       item->SetLayout(layout);
     }
     if (item->GetFocusedLayout())
@@ -806,9 +811,8 @@ void CGUIBaseContainer::FreeResources(bool immediately)
 void CGUIBaseContainer::UpdateLayout(bool updateAllItems)
 {
   if (updateAllItems)
-  { // free memory of items
-    for (iItems it = m_items.begin(); it != m_items.end(); ++it)
-      (*it)->FreeMemory();
+  { // items only have layouts while they're shown
+    m_layoutPool.ReleaseAll(m_layout, m_focusedLayout);
   }
   // and recalculate the layout
   CalculateLayout();
@@ -1010,6 +1014,7 @@ int CGUIBaseContainer::CorrectOffset(int offset, int cursor) const
 void CGUIBaseContainer::Reset()
 {
   m_wasReset = true;
+  m_layoutPool.ReleaseAll(m_layout, m_focusedLayout);
   m_items.clear();
   m_lastItem.reset();
 }
@@ -1069,22 +1074,6 @@ void CGUIBaseContainer::SetRenderOffset(const CPoint &offset)
   m_renderOffset = offset;
 }
 
-void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
-{
-  if (keepStart < keepEnd)
-  { // remove before keepStart and after keepEnd
-    for (int i = 0; i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
-    for (int i = std::max(keepEnd + 1, 0); i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
-  }
-  else
-  { // wrapping
-    for (int i = std::max(keepEnd + 1, 0); i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
-  }
-}
-
 bool CGUIBaseContainer::InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const
 {
   if (!layout) return false;
@@ -1135,6 +1124,9 @@ bool CGUIBaseContainer::GetCondition(int condition, int data) const
 
 void CGUIBaseContainer::GetCurrentLayouts()
 {
+  CGUIListItemLayout *oldLayout = m_layout;
+  CGUIListItemLayout *oldFocusedLayout = m_focusedLayout;
+
   m_layout = NULL;
   for (unsigned int i = 0; i < m_layouts.size(); i++)
   {
@@ -1158,6 +1150,12 @@ void CGUIBaseContainer::GetCurrentLayouts()
   }
   if (!m_focusedLayout && m_focusedLayouts.size())
     m_focusedLayout = &m_focusedLayouts[0];  // failsafe
+
+  if (oldLayout != m_layout || oldFocusedLayout != m_focusedLayout)
+  { // copies of the old templates can't be reused
+    m_layoutPool.ReleaseAll(oldLayout, oldFocusedLayout);
+    m_layoutPool.Clear();
+  }
 }
 
 bool CGUIBaseContainer::HasNextPage() const
@@ -1265,3 +1263,89 @@ void CGUIBaseContainer::OnFocus()
 
   CGUIControl::OnFocus();
 }
+
+CGUIListItemLayoutPool::~CGUIListItemLayoutPool()
+{
+  Clear();
+}
+
+CGUIListItemLayout *CGUIListItemLayoutPool::Create(const CGUIListItemLayout *from)
+{
+  for (vector<CGUIListItemLayout *>::reverse_iterator it = m_free.rbegin(); it != m_free.rend(); ++it)
+  {
+    if ((*it)->IsCopyOf(from))
+    {
+      CGUIListItemLayout *layout = *it;
+      m_free.erase((it + 1).base());
+      return layout;
+    }
+  }
+  return new CGUIListItemLayout(*from);
+}
+
+void CGUIListItemLayoutPool::Use(const CGUIListItemPtr &item)
+{
+  // wrapping lists may show an item more than once
+  if (find(m_used.begin(), m_used.end(), item) == m_used.end())
+    m_used.push_back(item);
+}
+
+void CGUIListItemLayoutPool::ReleaseUnused(const CGUIListItemLayout *layout, const CGUIListItemLayout *focusedLayout)
+{
+  // keep as many layouts as are shown, plus the focused one
+  size_t keep = m_used.size() + 1;
+  for (vector<CGUIListItemPtr>::iterator it = m_items.begin(); it != m_items.end(); ++it)
+  {
+    if (find(m_used.begin(), m_used.end(), *it) == m_used.end())
+      Release(it->get(), layout, focusedLayout, keep);
+  }
+  m_items.swap(m_used);
+  m_used.clear();
+
+  while (m_free.size() > keep)
+  {
+    delete m_free.back();
+    m_free.pop_back();
+  }
+}
+
+void CGUIListItemLayoutPool::ReleaseAll(const CGUIListItemLayout *layout, const CGUIListItemLayout *focusedLayout)
+{
+  size_t keep = std::max(m_items.size(), m_used.size()) + 1;
+  for (vector<CGUIListItemPtr>::iterator it = m_items.begin(); it != m_items.end(); ++it)
+    Release(it->get(), layout, focusedLayout, keep);
+  for (vector<CGUIListItemPtr>::iterator it = m_used.begin(); it != m_used.end(); ++it)
+    Release(it->get(), layout, focusedLayout, keep);
+  m_items.clear();
+  m_used.clear();
+}
+
+void CGUIListItemLayoutPool::Clear()
+{
+  for (vector<CGUIListItemLayout *>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+    delete *it;
+  m_free.clear();
+}
+
+void CGUIListItemLayoutPool::Release(CGUIListItem *item, const CGUIListItemLayout *layout, const CGUIListItemLayout *focusedLayout, size_t keep)
+{
+  // the item may have been given the layouts of another container since
+  if (item->GetLayout() && item->GetLayout()->IsCopyOf(layout))
+    Release(item->DetachLayout(), keep);
+  if (item->GetFocusedLayout() && item->GetFocusedLayout()->IsCopyOf(focusedLayout))
+    Release(item->DetachFocusedLayout(), keep);
+}
+
+void CGUIListItemLayoutPool::Release(CGUIListItemLayout *layout, size_t keep)
+{
+  if (m_free.size() < keep)
+  {
+    layout->Recycle();
+    m_free.push_back(layout);
+  }
+  else
+  {
+    layout->FreeResources();
+    delete layout;
+  }
+}
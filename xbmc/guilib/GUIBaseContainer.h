@@ -29,6 +29,46 @@
 #include "GUIListItemLayout.h"
 #include "utils/Stopwatch.h"
 
+/*!
+ \brief The layouts a container has given to the items it shows.
+
+ Only the items on screen and the cached items around them have layouts. When an item is no longer
+ shown its layouts are kept for the items scrolled in, instead of copying the templates again. No
+ more layouts are kept than were shown, so memory doesn't grow with the size of the list.
+ A copy of the pool is empty, as each layout belongs to one container.
+ */
+class CGUIListItemLayoutPool
+{
+public:
+  CGUIListItemLayoutPool() {};
+  CGUIListItemLayoutPool(const CGUIListItemLayoutPool &from) {};
+  CGUIListItemLayoutPool &operator=(const CGUIListItemLayoutPool &from) { return *this; };
+  ~CGUIListItemLayoutPool();
+
+  /*! \brief A copy of a template, reusing a layout released by another item if there is one */
+  CGUIListItemLayout *Create(const CGUIListItemLayout *from);
+
+  /*! \brief Mark an item as shown since the last call to ReleaseUnused() */
+  void Use(const CGUIListItemPtr &item);
+
+  /*! \brief Release the layouts of the items that weren't shown since the last call */
+  void ReleaseUnused(const CGUIListItemLayout *layout, const CGUIListItemLayout *focusedLayout);
+
+  /*! \brief Release the layouts of all items, for when the items or the templates change */
+  void ReleaseAll(const CGUIListItemLayout *layout, const CGUIListItemLayout *focusedLayout);
+
+  /*! \brief Delete the released layouts */
+  void Clear();
+
+private:
+  void Release(CGUIListItem *item, const CGUIListItemLayout *layout, const CGUIListItemLayout *focusedLayout, size_t keep);
+  void Release(CGUIListItemLayout *layout, size_t keep);
+
+  std::vector<CGUIListItemPtr> m_items;    ///< with layouts, shown before the last call to ReleaseUnused()
+  std::vector<CGUIListItemPtr> m_used;     ///< shown since the last call to ReleaseUnused()
+  std::vector<CGUIListItemLayout *> m_free;
+};
+
 /*!
  \ingroup controls
  \brief
@@ -120,7 +160,6 @@ protected:
   int ScrollCorrectionRange() const;
   inline float Size() const;
   void MoveToRow(int row);
-  void FreeMemory(int keepStart, int keepEnd);
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -143,6 +182,7 @@ protected:
 
   CGUIListItemLayout *m_layout;
   CGUIListItemLayout *m_focusedLayout;
+  CGUIListItemLayoutPool m_layoutPool;
 
   void ScrollToOffset(int offset);
   void SetContainerMoving(int direction);
@@ -145,6 +145,10 @@ public:
   void SetFocusedLayout(CGUIListItemLayout *layout);
   CGUIListItemLayout *GetFocusedLayout();
 
+  /*! \brief Remove a layout from the item without deleting it, so it can show another item */
+  CGUIListItemLayout *DetachLayout();
+  CGUIListItemLayout *DetachFocusedLayout();
+
   void FreeIcons();
   void FreeMemory(bool immediately = false);
   void SetInvalid();
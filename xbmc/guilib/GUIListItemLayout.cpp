@@ -37,6 +37,8 @@ CGUIListItemLayout::CGUIListItemLayout()
   m_condition = 0;
   m_focused = false;
   m_invalidated = true;
+  m_recycled = false;
+  m_template = NULL;
   m_group.SetPushUpdates(true);
 }
 
@@ -48,6 +50,8 @@ CGUIListItemLayout::CGUIListItemLayout(const CGUIListItemLayout &from)
   m_focused = from.m_focused;
   m_condition = from.m_condition;
   m_invalidated = true;
+  m_recycled = false;
+  m_template = &from;
 }
 
 CGUIListItemLayout::~CGUIListItemLayout()
@@ -87,6 +91,11 @@ void CGUIListItemLayout::Process(CGUIListItem *item, int parentID, unsigned int
 
   // update visibility, and render
   m_group.SetState(item->IsSelected() || m_isPlaying, m_focused);
+  if (m_recycled)
+  { // don't transition from the visibility of the previous item
+    m_recycled = false;
+    m_group.SetInitialVisibility(item);
+  }
   m_group.UpdateVisibility(item);
   m_group.DoProcess(currentTime, dirtyregions);
 }
@@ -226,6 +235,14 @@ void CGUIListItemLayout::FreeResources(bool immediately)
   m_group.FreeResources(immediately);
 }
 
+void CGUIListItemLayout::Recycle()
+{
+  FreeResources();
+  SetFocusedItem(0);
+  SetInvalid();
+  m_recycled = true;
+}
+
 #ifdef _DEBUG
 void CGUIListItemLayout::DumpTextureUse()
 {
@@ -45,6 +45,15 @@ public:
   void SetInvalid() { m_invalidated = true; };
   void FreeResources(bool immediately = false);
 
+  /*! \brief Free the resources of the item the layout showed so it can show another
+   The visibility and conditional animations are set up for the next item without any
+   transitions, as if the layout were a fresh copy of its template.
+   */
+  void Recycle();
+
+  /*! \brief Whether the layout was copied from the given template */
+  bool IsCopyOf(const CGUIListItemLayout *layout) const { return m_template == layout; };
+
 //#ifdef PRE_SKIN_VERSION_9_10_COMPATIBILITY
   void CreateListControlLayouts(float width, float height, bool focused, const CLabelInfo &labelInfo, const CLabelInfo &labelInfo2, const CTextureInfo &texture, const CTextureInfo &textureFocus, float texHeight, float iconWidth, float iconHeight, const CStdString &nofocusCondition, const CStdString &focusCondition);
 //#endif
@@ -69,6 +78,8 @@ protected:
   float m_height;
   bool m_focused;
   bool m_invalidated;
+  bool m_recycled;
+  const CGUIListItemLayout *m_template;
 
   unsigned int m_condition;
   CGUIInfoBool m_isPlaying;
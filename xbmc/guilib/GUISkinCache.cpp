@@ -0,0 +1,398 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "GUISkinCache.h"
+#include "GUIInfoManager.h"
+#include "addons/Skin.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/XBMCTinyXML.h"
+
+using namespace XFILE;
+
+#define SKINCACHE_PATH    "special://temp/skincache/"
+#define SKINCACHE_MAGIC   0x43534258 // "XBSC"
+#define SKINCACHE_VERSION 1
+
+// node records of the serialized tree
+#define NODE_ELEMENT 'E'
+#define NODE_TEXT    'T'
+#define NODE_CDATA   'C'
+
+/* Entry layout, all integers in host byte order as the cache never leaves the box:
+     magic, version, skin id, skin version, window xml path
+     dependencies: count, { path, mtime, size }
+     include conditions: count, { expression, value }
+     string table: count, { string }
+     tree of nodes, referring to the string table by index */
+
+class CGUISkinCache::CWriter
+{
+public:
+  void PutU8(unsigned char value) { m_data.push_back((char)value); }
+  void PutU32(uint32_t value)     { m_data.append((const char *)&value, sizeof(value)); }
+  void PutU64(uint64_t value)     { m_data.append((const char *)&value, sizeof(value)); }
+  void PutString(const std::string &str)
+  {
+    PutU32(str.size());
+    m_data.append(str);
+  }
+
+  // tree strings are repeated a lot (tag names, attributes, textures), store each once
+  uint32_t GetStringIndex(const std::string &str)
+  {
+    std::map<std::string, uint32_t>::const_iterator it = m_index.find(str);
+    if (it != m_index.end())
+      return it->second;
+    m_strings.push_back(str);
+    return m_index[str] = m_strings.size() - 1;
+  }
+
+  std::string                     m_data;
+  std::vector<std::string>        m_strings;
+  std::map<std::string, uint32_t> m_index;
+};
+
+class CGUISkinCache::CReader
+{
+public:
+  CReader(const char *data, size_t size) : m_pos(data), m_end(data + size) {}
+
+  bool GetU8(unsigned char &value)  { return Get(&value, sizeof(value)); }
+  bool GetU32(uint32_t &value)      { return Get(&value, sizeof(value)); }
+  bool GetU64(uint64_t &value)      { return Get(&value, sizeof(value)); }
+  bool GetString(std::string &str)
+  {
+    uint32_t size;
+    if (!GetU32(size) || (size_t)(m_end - m_pos) < size)
+      return false;
+    str.assign(m_pos, size);
+    m_pos += size;
+    return true;
+  }
+
+  // a string of the string table
+  const std::string *GetIndexedString()
+  {
+    uint32_t index;
+    if (!GetU32(index) || index >= m_strings.size())
+      return NULL;
+    return &m_strings[index];
+  }
+
+  std::vector<std::string> m_strings;
+
+private:
+  bool Get(void *value, size_t size)
+  {
+    if ((size_t)(m_end - m_pos) < size)
+      return false;
+    memcpy(value, m_pos, size);
+    m_pos += size;
+    return true;
+  }
+
+  const char *m_pos;
+  const char *m_end;
+};
+
+CGUISkinCache::CGUISkinCache()
+  : m_hits(0)
+  , m_misses(0)
+{
+}
+
+CGUISkinCache &CGUISkinCache::Get()
+{
+  static CGUISkinCache cache;
+  return cache;
+}
+
+CStdString CGUISkinCache::GetCachePath(const CStdString &xmlFile) const
+{
+  Crc32 crc;
+  crc.Compute(xmlFile);
+  CStdString path;
+  path.Format(SKINCACHE_PATH "%08x.bin", (uint32_t)crc);
+  return path;
+}
+
+TiXmlElement *CGUISkinCache::Load(const CStdString &xmlFile, std::map<int, bool> &includeConditions)
+{
+  if (!g_SkinInfo)
+    return NULL;
+
+  TiXmlElement *root = LoadEntry(xmlFile, includeConditions);
+  if (root)
+  {
+    m_hits++;
+    CLog::Log(LOGDEBUG, "%s - using compiled %s (%u hits, %u misses)", __FUNCTION__, xmlFile.c_str(), m_hits, m_misses);
+  }
+  else
+    m_misses++;
+  return root;
+}
+
+TiXmlElement *CGUISkinCache::LoadEntry(const CStdString &xmlFile, std::map<int, bool> &includeConditions)
+{
+  CFile file;
+  CStdString cachePath = GetCachePath(xmlFile);
+  if (!file.Open(cachePath))
+    return NULL;
+
+  int64_t length = file.GetLength();
+  std::vector<char> data((size_t)std::max<int64_t>(length, 1));
+  bool read = length > 0 && file.Read(&data[0], length) == length;
+  file.Close();
+  if (!read)
+    return NULL;
+
+  CReader reader(&data[0], data.size());
+  uint32_t magic = 0, version = 0;
+  std::string skinId, skinVersion, path;
+  if (!reader.GetU32(magic) || magic != SKINCACHE_MAGIC ||
+      !reader.GetU32(version) || version != SKINCACHE_VERSION ||
+      !reader.GetString(skinId) || skinId != g_SkinInfo->ID() ||
+      !reader.GetString(skinVersion) || skinVersion != g_SkinInfo->Version().c_str() ||
+      !reader.GetString(path) || path != xmlFile)
+    return NULL;
+
+  // the window and every include file have to be unchanged
+  uint32_t count;
+  if (!reader.GetU32(count))
+    return NULL;
+  std::vector<std::string> includeFiles;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    std::string dependency;
+    uint64_t mtime, size;
+    if (!reader.GetString(dependency) || !reader.GetU64(mtime) || !reader.GetU64(size))
+      return NULL;
+
+    struct __stat64 buffer;
+    if (CFile::Stat(dependency, &buffer) != 0 ||
+        (uint64_t)buffer.st_mtime != mtime || (uint64_t)buffer.st_size != size)
+    {
+      CLog::Log(LOGDEBUG, "%s - %s changed, resolving %s again", __FUNCTION__, dependency.c_str(), xmlFile.c_str());
+      return NULL;
+    }
+    if (i > 0)
+      includeFiles.push_back(dependency);
+  }
+
+  // and the include conditions have to evaluate the same way as when the window was resolved
+  std::map<int, bool> conditions;
+  if (!reader.GetU32(count))
+    return NULL;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    std::string expression;
+    unsigned char value;
+    if (!reader.GetString(expression) || !reader.GetU8(value))
+      return NULL;
+
+    int conditionID = g_infoManager.Register(expression);
+    if (g_infoManager.GetBoolValue(conditionID) != (value != 0))
+      return NULL;
+    conditions[conditionID] = value != 0;
+  }
+
+  if (!reader.GetU32(count))
+    return NULL;
+  reader.m_strings.resize(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (!reader.GetString(reader.m_strings[i]))
+      return NULL;
+  }
+
+  TiXmlNode *root = ReadNode(reader);
+  if (!root || !root->ToElement())
+  {
+    CLog::Log(LOGERROR, "%s - %s is corrupt", __FUNCTION__, cachePath.c_str());
+    delete root;
+    return NULL;
+  }
+
+  // includes loaded from other files on the way can provide skin variables
+  for (std::vector<std::string>::const_iterator it = includeFiles.begin(); it != includeFiles.end(); ++it)
+    g_SkinInfo->LoadIncludes(*it);
+
+  includeConditions = conditions;
+  return root->ToElement();
+}
+
+void CGUISkinCache::Store(const CStdString &xmlFile, const TiXmlElement *root, const std::map<int, bool> &includeConditions,
+                          const CStdString &loadedFile /* = "" */)
+{
+  if (!g_SkinInfo || !root)
+    return;
+
+  CWriter writer;
+  writer.PutU32(SKINCACHE_MAGIC);
+  writer.PutU32(SKINCACHE_VERSION);
+  writer.PutString(g_SkinInfo->ID());
+  writer.PutString(g_SkinInfo->Version().c_str());
+  writer.PutString(xmlFile);
+
+  std::vector<CStdString> dependencies;
+  dependencies.push_back(loadedFile.IsEmpty() ? xmlFile : loadedFile);
+  const std::vector<CStdString> &includeFiles = g_SkinInfo->GetIncludeFiles();
+  dependencies.insert(dependencies.end(), includeFiles.begin(), includeFiles.end());
+  writer.PutU32(dependencies.size());
+  for (std::vector<CStdString>::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it)
+  {
+    struct __stat64 buffer;
+    if (CFile::Stat(*it, &buffer) != 0)
+      return; // can't tell when it changes, don't cache
+    writer.PutString(*it);
+    writer.PutU64(buffer.st_mtime);
+    writer.PutU64(buffer.st_size);
+  }
+
+  writer.PutU32(includeConditions.size());
+  for (std::map<int, bool>::const_iterator it = includeConditions.begin(); it != includeConditions.end(); ++it)
+  {
+    writer.PutString(g_infoManager.GetBoolExpression(it->first));
+    writer.PutU8(it->second ? 1 : 0);
+  }
+
+  // the tree goes to a separate writer, the string table has to come first
+  CWriter tree;
+  WriteNode(tree, root);
+  writer.PutU32(tree.m_strings.size());
+  for (std::vector<std::string>::const_iterator it = tree.m_strings.begin(); it != tree.m_strings.end(); ++it)
+    writer.PutString(*it);
+  writer.m_data.append(tree.m_data);
+
+  if (!CDirectory::Exists(SKINCACHE_PATH) && !CDirectory::Create(SKINCACHE_PATH))
+    return;
+
+  CFile file;
+  CStdString cachePath = GetCachePath(xmlFile);
+  if (!file.OpenForWrite(cachePath, true) ||
+      file.Write(writer.m_data.c_str(), writer.m_data.size()) != (int)writer.m_data.size())
+  {
+    CLog::Log(LOGERROR, "%s - unable to write %s", __FUNCTION__, cachePath.c_str());
+    file.Close();
+    CFile::Delete(cachePath);
+    return;
+  }
+  file.Close();
+}
+
+void CGUISkinCache::WriteNode(CWriter &writer, const TiXmlNode *node)
+{
+  const TiXmlText *text = node->ToText();
+  if (text)
+  {
+    writer.PutU8(text->CDATA() ? NODE_CDATA : NODE_TEXT);
+    writer.PutU32(writer.GetStringIndex(text->ValueStr()));
+    return;
+  }
+
+  const TiXmlElement *element = node->ToElement();
+  writer.PutU8(NODE_ELEMENT);
+  writer.PutU32(writer.GetStringIndex(element->ValueStr()));
+
+  uint32_t attributes = 0;
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    attributes++;
+  writer.PutU32(attributes);
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+  {
+    writer.PutU32(writer.GetStringIndex(attribute->NameTStr()));
+    writer.PutU32(writer.GetStringIndex(attribute->ValueStr()));
+  }
+
+  // comments and the like don't matter to the controls
+  uint32_t children = 0;
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->ToElement() || child->ToText())
+      children++;
+  }
+  writer.PutU32(children);
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->ToElement() || child->ToText())
+      WriteNode(writer, child);
+  }
+}
+
+TiXmlNode *CGUISkinCache::ReadNode(CReader &reader)
+{
+  unsigned char type;
+  if (!reader.GetU8(type))
+    return NULL;
+
+  const std::string *value = reader.GetIndexedString();
+  if (!value)
+    return NULL;
+
+  if (type == NODE_TEXT || type == NODE_CDATA)
+  {
+    TiXmlText *text = new TiXmlText(*value);
+    text->SetCDATA(type == NODE_CDATA);
+    return text;
+  }
+  else if (type != NODE_ELEMENT)
+    return NULL;
+
+  TiXmlElement *element = new TiXmlElement(*value);
+  uint32_t count;
+  if (!reader.GetU32(count))
+  {
+    delete element;
+    return NULL;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const std::string *name = reader.GetIndexedString();
+    const std::string *attribute = name ? reader.GetIndexedString() : NULL;
+    if (!attribute)
+    {
+      delete element;
+      return NULL;
+    }
+    element->SetAttribute(*name, *attribute);
+  }
+
+  if (!reader.GetU32(count))
+  {
+    delete element;
+    return NULL;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    TiXmlNode *child = ReadNode(reader);
+    if (!child)
+    {
+      delete element;
+      return NULL;
+    }
+    element->LinkEndChild(child);
+  }
+  return element;
+}
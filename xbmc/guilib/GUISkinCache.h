@@ -0,0 +1,75 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+
+#include "utils/StdString.h"
+
+class TiXmlElement;
+class TiXmlNode;
+
+/*!
+ \brief On-disk cache of window xml files with their includes resolved.
+
+ Windows are stored in a compact binary form in special://temp/skincache/, together with
+ what their resolution depended on: the skin version, the modification times of the window
+ and include files, and the values of the include conditions. An entry is only used while
+ all of these are unchanged, and is read back with a single read and without parsing xml
+ or resolving includes again.
+ */
+class CGUISkinCache
+{
+public:
+  static CGUISkinCache &Get();
+
+  /*! \brief Load the resolved window of the given xml file
+   \param xmlFile the path of the window xml file.
+   \param includeConditions [out] the include conditions the window depends on, registered with the info manager.
+   \return the root element of the resolved window, owned by the caller, or NULL if there's no valid entry.
+   */
+  TiXmlElement *Load(const CStdString &xmlFile, std::map<int, bool> &includeConditions);
+
+  /*! \brief Store a resolved window
+   \param xmlFile the path of the window xml file, as it will be passed to Load().
+   \param root the root element of the window, with includes resolved.
+   \param includeConditions the include conditions used to resolve it.
+   \param loadedFile the file the window was actually read from, if it differs from xmlFile.
+   */
+  void Store(const CStdString &xmlFile, const TiXmlElement *root, const std::map<int, bool> &includeConditions,
+             const CStdString &loadedFile = "");
+
+private:
+  CGUISkinCache();
+  CGUISkinCache(const CGUISkinCache&);
+  CGUISkinCache const& operator=(CGUISkinCache const&);
+
+  CStdString    GetCachePath(const CStdString &xmlFile) const;
+  TiXmlElement *LoadEntry(const CStdString &xmlFile, std::map<int, bool> &includeConditions);
+
+  class CWriter;
+  class CReader;
+  static void       WriteNode(CWriter &writer, const TiXmlNode *node);
+  static TiXmlNode *ReadNode(CReader &reader);
+
+  unsigned int m_hits;
+  unsigned int m_misses;
+};
@@ -30,8 +30,10 @@
 #include "GUIEditControl.h"
 #endif
 
+#include "GUISkinCache.h"
 #include "addons/Skin.h"
 #include "GUIInfoManager.h"
+#include "settings/AdvancedSettings.h"
 #include "utils/log.h"
 #include "threads/SingleLock.h"
 #include "utils/TimeUtils.h"
@@ -129,25 +131,48 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
 
 bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPath)
 {
+  CStdString xmlFile;
   // load window xml if we don't have it stored yet
   if (!m_windowXMLRootElement)
   {
+    // a compiled copy with the includes already resolved saves parsing and resolving
+    if (g_advancedSettings.m_guiSkinCache)
+    {
+      TiXmlElement *resolved = CGUISkinCache::Get().Load(strPath, m_xmlIncludeConditions);
+      if (resolved)
+      {
+        bool ret = LoadResolved(resolved);
+        delete resolved;
+        return ret;
+      }
+    }
+
     CXBMCTinyXML xmlDoc;
-    if ( !xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(CStdString(strPath).ToLower()) && !xmlDoc.LoadFile(strLowerPath))
+    xmlFile = strPath;
+    if (!xmlDoc.LoadFile(xmlFile))
     {
-      CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
-      SetID(WINDOW_INVALID);
-      return false;
+      xmlFile = CStdString(strPath).ToLower();
+      if (!xmlDoc.LoadFile(xmlFile))
+      {
+        xmlFile = strLowerPath;
+        if (!xmlDoc.LoadFile(xmlFile))
+        {
+          CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
+          SetID(WINDOW_INVALID);
+          return false;
+        }
+      }
     }
     m_windowXMLRootElement = (TiXmlElement*)xmlDoc.RootElement()->Clone();
   }
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
 
-  return Load(m_windowXMLRootElement);
+  // the skin cache is keyed by the path asked for, whichever spelling of it was found
+  return Load(m_windowXMLRootElement, xmlFile.IsEmpty() ? xmlFile : strPath, xmlFile);
 }
 
-bool CGUIWindow::Load(TiXmlElement* pRootElement)
+bool CGUIWindow::Load(TiXmlElement* pRootElement, const CStdString &xmlFile, const CStdString &loadedFile)
 {
   if (!pRootElement)
     return false;
@@ -162,12 +187,22 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
   // and we don't want original root element to change
   pRootElement = (TiXmlElement*)pRootElement->Clone();
 
+  // Resolve any includes that may be present and save conditions used to do it
+  g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+  if (!xmlFile.IsEmpty() && g_advancedSettings.m_guiSkinCache)
+    CGUISkinCache::Get().Store(xmlFile, pRootElement, m_xmlIncludeConditions, loadedFile);
+
+  bool ret = LoadResolved(pRootElement);
+  delete pRootElement;
+  return ret;
+}
+
+bool CGUIWindow::LoadResolved(TiXmlElement* pRootElement)
+{
   // set the scaling resolution so that any control creation or initialisation can
   // be done with respect to the correct aspect ratio
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
-  // Resolve any includes that may be present and save conditions used to do it
-  g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
   // now load in the skin file
   SetDefaults();
 
@@ -263,7 +298,6 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
 
   m_windowLoaded = true;
   OnWindowLoaded();
-  delete pRootElement;
   return true;
 }
 
@@ -799,11 +833,11 @@ bool CGUIWindow::Initialize()
   return m_windowLoaded;
 }
 
-void CGUIWindow::SetInitialVisibility()
+void CGUIWindow::SetInitialVisibility(const CGUIListItem *item)
 {
   // reset our info manager caches
   g_infoManager.ResetCache();
-  CGUIControlGroup::SetInitialVisibility();
+  CGUIControlGroup::SetInitialVisibility(item);
 }
 
 bool CGUIWindow::IsActive() const
@@ -20,6 +20,7 @@
 
 #include "system.h"
 #include "LocalizeStrings.h"
+#include "StringCatalog.h"
 #include "utils/CharsetConverter.h"
 #include "utils/log.h"
 #include "filesystem/SpecialProtocol.h"
@@ -28,6 +29,9 @@
 #include "utils/POUtils.h"
 #include "filesystem/Directory.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
+
+#include <algorithm>
 
 CLocalizeStrings::CLocalizeStrings(void)
 {
@@ -36,7 +40,7 @@ CLocalizeStrings::CLocalizeStrings(void)
 
 CLocalizeStrings::~CLocalizeStrings(void)
 {
-
+  Clear();
 }
 
 CStdString CLocalizeStrings::ToUTF8(const CStdString& strEncoding, const CStdString& str)
@@ -52,11 +56,13 @@ CStdString CLocalizeStrings::ToUTF8(const CStdString& strEncoding, const CStdStr
 void CLocalizeStrings::ClearSkinStrings()
 {
   // clear the skin strings
+  CSingleLock lock(m_critSection);
   Clear(31000, 31999);
 }
 
 bool CLocalizeStrings::LoadSkinStrings(const CStdString& path, const CStdString& language)
 {
+  CSingleLock lock(m_critSection);
   ClearSkinStrings();
   // load the skin strings in.
   CStdString encoding;
@@ -97,55 +103,61 @@ bool CLocalizeStrings::LoadStr2Mem(const CStdString &pathname_in, const CStdStri
 bool CLocalizeStrings::LoadPO(const CStdString &filename, CStdString &encoding,
                               uint32_t offset /* = 0 */, bool bSourceLanguage)
 {
-  CPODocument PODoc;
-  if (!PODoc.LoadFile(filename))
-    return false;
-
-  int counter = 0;
-
-  while ((PODoc.GetNextEntry()))
+  CStringCatalog *catalog = NULL;
+  iCatalogs it = m_catalogs.find(filename);
+  if (it != m_catalogs.end())
   {
-    uint32_t id;
-    if (PODoc.GetEntryType() == ID_FOUND)
+    if (it->second.catalog->IsCurrent(filename))
+      catalog = it->second.catalog;
+    else
     {
-      bool bStrInMem = m_strings.find((id = PODoc.GetEntryID()) + offset) != m_strings.end();
-      PODoc.ParseEntry(bSourceLanguage);
+      // updated since, strings of the old one may still be loaded
+      m_staleCatalogs.push_back(it->second.catalog);
+      m_catalogs.erase(it);
+    }
+  }
+  if (!catalog)
+  {
+    catalog = CStringCatalog::Load(filename);
+    if (!catalog)
+      return false;
+    LoadedCatalog loaded = { catalog, offset };
+    m_catalogs.insert(make_pair(filename, loaded));
+  }
 
-      if (bSourceLanguage && !PODoc.GetMsgid().empty())
-      {
-        if (bStrInMem && (m_strings[id + offset].strOriginal.IsEmpty() ||
-            PODoc.GetMsgid() == m_strings[id + offset].strOriginal))
-          continue;
-        else if (bStrInMem)
-          CLog::Log(LOGDEBUG,
-                    "POParser: id:%i was recently re-used in the English string file, which is not yet "
-                    "changed in the translated file. Using the English string instead", id);
-        m_strings[id + offset].strTranslated = PODoc.GetMsgid();
-        counter++;
-      }
-      else if (!bSourceLanguage && !bStrInMem && !PODoc.GetMsgstr().empty())
+  std::vector<LocStr> added;
+  for (unsigned int i = 0; i < catalog->Size(); i++)
+  {
+    uint32_t id = catalog->GetId(i);
+    iStrings str = m_strings.begin() + (Find(id + offset) - m_strings.begin()); // Find() is const
+    bool bStrInMem = str != m_strings.end();
+
+    if (bSourceLanguage && *catalog->GetMsgId(i))
+    {
+      const char *msgid = catalog->GetMsgId(i);
+      if (bStrInMem && (!str->original || !*str->original || strcmp(msgid, str->original) == 0))
+        continue;
+      else if (bStrInMem)
       {
-        m_strings[id + offset].strTranslated = PODoc.GetMsgstr();
-        m_strings[id + offset].strOriginal = PODoc.GetMsgid();
-        counter++;
+        CLog::Log(LOGDEBUG,
+                  "POParser: id:%i was recently re-used in the English string file, which is not yet "
+                  "changed in the translated file. Using the English string instead", id);
+        Free(*str);
+        str->translated = msgid;
+        continue;
       }
+      LocStr entry = { id + offset, msgid, NULL, NULL };
+      added.push_back(entry);
     }
-    else if (PODoc.GetEntryType() == MSGID_FOUND)
-    {
-      // TODO: implement reading of non-id based string entries from the PO files.
-      // These entries would go into a separate memory map, using hash codes for fast look-up.
-      // With this memory map we can implement using gettext(), ngettext(), pgettext() calls,
-      // so that we don't have to use new IDs for new strings. Even we can start converting
-      // the ID based calls to normal gettext calls.
-    }
-    else if (PODoc.GetEntryType() == MSGID_PLURAL_FOUND)
+    else if (!bSourceLanguage && !bStrInMem && *catalog->GetMsgStr(i))
     {
-      // TODO: implement reading of non-id based pluralized string entries from the PO files.
-      // We can store the pluralforms for each language, in the langinfo.xml files.
+      LocStr entry = { id + offset, catalog->GetMsgStr(i), catalog->GetMsgId(i), NULL };
+      added.push_back(entry);
     }
   }
+  Merge(added, false);
 
-  CLog::Log(LOGDEBUG, "POParser: loaded %i strings from file %s", counter, filename.c_str());
+  CLog::Log(LOGDEBUG, "POParser: loaded %u strings from file %s", (unsigned int)added.size(), filename.c_str());
   return true;
 }
 
@@ -168,6 +180,7 @@ bool CLocalizeStrings::LoadXML(const CStdString &filename, CStdString &encoding,
     return false;
   }
 
+  std::vector<LocStr> added;
   const TiXmlElement *pChild = pRootElement->FirstChildElement("string");
   while (pChild)
   {
@@ -175,15 +188,60 @@ bool CLocalizeStrings::LoadXML(const CStdString &filename, CStdString &encoding,
     const char* attrId=pChild->Attribute("id");
     if (attrId && !pChild->NoChildren())
     {
-      int id = atoi(attrId) + offset;
-      if (m_strings.find(id) == m_strings.end())
-        m_strings[id].strTranslated = ToUTF8(encoding, pChild->FirstChild()->Value());
+      uint32_t id = atoi(attrId) + offset;
+      if (Find(id) == m_strings.end())
+      {
+        LocStr entry = { id, NULL, NULL, new CStdString(ToUTF8(encoding, pChild->FirstChild()->Value())) };
+        added.push_back(entry);
+      }
     }
     pChild = pChild->NextSiblingElement("string");
   }
+
+  // the first string of an id wins
+  std::stable_sort(added.begin(), added.end());
+  std::vector<LocStr> unique;
+  for (std::vector<LocStr>::iterator it = added.begin(); it != added.end(); ++it)
+  {
+    if (!unique.empty() && unique.back().id == it->id)
+      Free(*it);
+    else
+      unique.push_back(*it);
+  }
+  Merge(unique, false);
   return true;
 }
 
+static const struct
+{
+  uint32_t    id;
+  const char *str;
+} constantStrings[] =
+{
+  { 20022, "" },
+  { 20027, "°F" },
+  { 20028, "K" },
+  { 20029, "°C" },
+  { 20030, "°Ré" },
+  { 20031, "°Ra" },
+  { 20032, "°Rø" },
+  { 20033, "°De" },
+  { 20034, "°N" },
+
+  { 20200, "km/h" },
+  { 20201, "m/min" },
+  { 20202, "m/s" },
+  { 20203, "ft/h" },
+  { 20204, "ft/min" },
+  { 20205, "ft/s" },
+  { 20206, "mph" },
+  { 20207, "kts" },
+  { 20208, "Beaufort" },
+  { 20209, "inch/s" },
+  { 20210, "yard/s" },
+  { 20211, "Furlong/Fortnight" }
+};
+
 bool CLocalizeStrings::Load(const CStdString& strPathName, const CStdString& strLanguage)
 {
   bool bLoadFallback = !strLanguage.Equals(SOURCE_LANGUAGE);
@@ -205,28 +263,13 @@ bool CLocalizeStrings::Load(const CStdString& strPathName, const CStdString& str
     LoadStr2Mem(strPathName, SOURCE_LANGUAGE, encoding);
 
   // fill in the constant strings
-  m_strings[20022].strTranslated = "";
-  m_strings[20027].strTranslated = "°F";
-  m_strings[20028].strTranslated = "K";
-  m_strings[20029].strTranslated = "°C";
-  m_strings[20030].strTranslated = "°Ré";
-  m_strings[20031].strTranslated = "°Ra";
-  m_strings[20032].strTranslated = "°Rø";
-  m_strings[20033].strTranslated = "°De";
-  m_strings[20034].strTranslated = "°N";
-
-  m_strings[20200].strTranslated = "km/h";
-  m_strings[20201].strTranslated = "m/min";
-  m_strings[20202].strTranslated = "m/s";
-  m_strings[20203].strTranslated = "ft/h";
-  m_strings[20204].strTranslated = "ft/min";
-  m_strings[20205].strTranslated = "ft/s";
-  m_strings[20206].strTranslated = "mph";
-  m_strings[20207].strTranslated = "kts";
-  m_strings[20208].strTranslated = "Beaufort";
-  m_strings[20209].strTranslated = "inch/s";
-  m_strings[20210].strTranslated = "yard/s";
-  m_strings[20211].strTranslated = "Furlong/Fortnight";
+  std::vector<LocStr> constants;
+  for (unsigned int i = 0; i < sizeof(constantStrings) / sizeof(constantStrings[0]); i++)
+  {
+    LocStr entry = { constantStrings[i].id, constantStrings[i].str, NULL, NULL };
+    constants.push_back(entry);
+  }
+  Merge(constants, true);
 
   return true;
 }
@@ -235,33 +278,97 @@ static CStdString szEmptyString = "";
 
 const CStdString& CLocalizeStrings::Get(uint32_t dwCode) const
 {
-  ciStrings i = m_strings.find(dwCode);
+  // m_strings only changes while loading, like before. The string is created on first use and
+  // published with cas(), so a reader never sees it half built and racing readers keep the first one
+  ciStrings i = Find(dwCode);
   if (i == m_strings.end())
   {
     return szEmptyString;
   }
-  return i->second.strTranslated;
+
+  if (!i->string)
+  {
+    CStdString *str = new CStdString(i->translated);
+    if (cas((volatile long *)&i->string, 0, (long)str) != 0)
+      delete str;
+  }
+  return *i->string;
 }
 
-void CLocalizeStrings::Clear()
+CLocalizeStrings::ciStrings CLocalizeStrings::Find(uint32_t id) const
 {
-  m_strings.clear();
+  LocStr key = { id, NULL, NULL, NULL };
+  ciStrings i = std::lower_bound(m_strings.begin(), m_strings.end(), key);
+  if (i == m_strings.end() || i->id != id)
+    return m_strings.end();
+  return i;
 }
 
-void CLocalizeStrings::Clear(uint32_t start, uint32_t end)
+void CLocalizeStrings::Merge(const std::vector<LocStr> &strings, bool replace)
 {
+  if (strings.empty())
+    return;
+
+  std::vector<LocStr> merged;
+  merged.reserve(m_strings.size() + strings.size());
   iStrings it = m_strings.begin();
-  while (it != m_strings.end())
+  for (std::vector<LocStr>::const_iterator str = strings.begin(); str != strings.end(); ++str)
   {
-    if (it->first >= start && it->first <= end)
-      m_strings.erase(it++);
-    else
+    while (it != m_strings.end() && it->id < str->id)
+      merged.push_back(*it++);
+
+    if (it != m_strings.end() && it->id == str->id)
+    {
+      LocStr unused = *str;
+      if (replace)
+      {
+        unused = *it;
+        merged.push_back(*str);
+      }
+      else
+        merged.push_back(*it);
+      Free(unused);
       ++it;
+    }
+    else
+      merged.push_back(*str);
   }
+  merged.insert(merged.end(), it, m_strings.end());
+  m_strings.swap(merged);
+}
+
+void CLocalizeStrings::Free(LocStr &str)
+{
+  delete str.string;
+  str.string = NULL;
+}
+
+void CLocalizeStrings::Clear()
+{
+  CSingleLock lock(m_critSection);
+  Clear(0, 0xffffffff);
+  for (iCatalogs it = m_catalogs.begin(); it != m_catalogs.end(); ++it)
+    delete it->second.catalog;
+  m_catalogs.clear();
+  for (std::vector<CStringCatalog*>::iterator it = m_staleCatalogs.begin(); it != m_staleCatalogs.end(); ++it)
+    delete *it;
+  m_staleCatalogs.clear();
+}
+
+void CLocalizeStrings::Clear(uint32_t start, uint32_t end)
+{
+  LocStr first = { start, NULL, NULL, NULL };
+  LocStr last  = { end, NULL, NULL, NULL };
+  iStrings from = std::lower_bound(m_strings.begin(), m_strings.end(), first);
+  iStrings to   = std::upper_bound(from, m_strings.end(), last);
+  for (iStrings it = from; it != to; ++it)
+    Free(*it);
+  m_strings.erase(from, to);
 }
 
 uint32_t CLocalizeStrings::LoadBlock(const CStdString &id, const CStdString &path, const CStdString &language)
 {
+  CSingleLock lock(m_critSection);
   iBlocks it = m_blocks.find(id);
   if (it != m_blocks.end())
     return it->second;  // already loaded
@@ -288,6 +395,7 @@ uint32_t CLocalizeStrings::LoadBlock(const CStdString &id, const CStdString &pat
 
 void CLocalizeStrings::ClearBlock(const CStdString &id)
 {
+  CSingleLock lock(m_critSection);
   iBlocks it = m_blocks.find(id);
   if (it == m_blocks.end())
   {
@@ -295,7 +403,17 @@ void CLocalizeStrings::ClearBlock(const CStdString &id)
     return; // doesn't exist
   }
 
-  // clear our block
+  // clear our block, and drop its catalogs so an updated addon is loaded from its new files
   Clear(it->second, it->second + block_size);
+  for (iCatalogs catalog = m_catalogs.begin(); catalog != m_catalogs.end(); )
+  {
+    if (catalog->second.offset == it->second)
+    {
+      delete catalog->second.catalog;
+      m_catalogs.erase(catalog++);
+    }
+    else
+      ++catalog;
+  }
   m_blocks.erase(it);
 }
@@ -32,17 +32,9 @@
 #include "threads/CriticalSection.h"
 
 #include <map>
+#include <vector>
 
-/*!
- \ingroup strings
- \brief
- */
-
-struct LocStr
-{
-CStdString strTranslated; // string to be used in xbmc GUI
-CStdString strOriginal;   // the original English string, the tranlsation is based on
-};
+class CStringCatalog;
 
 // The default fallback language is fixed to be English
 const CStdString SOURCE_LANGUAGE = "English";
@@ -94,15 +86,47 @@ protected:
   bool LoadXML(const CStdString &filename, CStdString &encoding, uint32_t offset = 0);
 
   static CStdString ToUTF8(const CStdString &encoding, const CStdString &str);
-  std::map<uint32_t, LocStr> m_strings;
-  typedef std::map<uint32_t, LocStr>::const_iterator ciStrings;
-  typedef std::map<uint32_t, LocStr>::iterator       iStrings;
+
+  /*! \brief A loaded string. The strings of .po files stay in their catalogs and a CStdString
+   is only created for the strings that are asked for.
+   */
+  struct LocStr
+  {
+    uint32_t    id;
+    const char *translated;              // string to be used in xbmc GUI, NULL if only in string
+    const char *original;                // the original English string, the translation is based on
+    mutable CStdString *string;          // created on first Get(), published with cas()
+
+    bool operator<(const LocStr &right) const { return id < right.id; };
+  };
+
+  /*! \brief Add strings to m_strings
+   \param strings the strings to add, sorted by id.
+   \param replace whether to replace strings already loaded, or to keep them.
+   */
+  void Merge(const std::vector<LocStr> &strings, bool replace);
+  static void Free(LocStr &str);
+
+  std::vector<LocStr> m_strings;  // sorted by id
+  typedef std::vector<LocStr>::const_iterator ciStrings;
+  typedef std::vector<LocStr>::iterator       iStrings;
+  ciStrings Find(uint32_t id) const;
+
+  /*! \brief A loaded catalog and the block it was loaded for, 0 if it isn't an addon's */
+  struct LoadedCatalog
+  {
+    CStringCatalog *catalog;
+    uint32_t        offset;
+  };
+  std::map<CStdString, LoadedCatalog> m_catalogs;
+  typedef std::map<CStdString, LoadedCatalog>::iterator iCatalogs;
+  std::vector<CStringCatalog*> m_staleCatalogs; ///< replaced on disk, but the strings may still point into them
 
   static const uint32_t block_start = 0xf000000;
   static const uint32_t block_size = 4096;
   std::map<CStdString, uint32_t> m_blocks;
   typedef std::map<CStdString, uint32_t>::iterator iBlocks;
-  CCriticalSection m_critSection;
+  CCriticalSection m_critSection; ///< serializes the loaders, Get() doesn't take it
 };
 
 /*!
@@ -0,0 +1,298 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "StringCatalog.h"
+
+#ifdef TARGET_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/POUtils.h"
+#include "utils/StartupTimeline.h"
+
+using namespace XFILE;
+
+#define LANGCACHE_PATH    "special://temp/langcache/"
+#define LANGCACHE_MAGIC   0x4c434258 // "XBCL"
+#define LANGCACHE_VERSION 1
+
+/* Catalog layout, all integers in host byte order as the cache never leaves the box:
+     header
+     path of the .po file, padded to 4 bytes
+     ids: count sorted uint32
+     offsets: count pairs of uint32, msgstr and msgid, into the blob
+     blob: nul terminated utf-8 strings, blobSize bytes */
+struct SCatalogHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t mtime;
+  uint64_t size;
+  uint32_t count;
+  uint32_t blobSize;
+  uint32_t pathSize;
+  uint32_t reserved;
+};
+
+struct SCompiledEntry
+{
+  uint32_t id;
+  uint32_t msgStr;
+  uint32_t msgId;
+
+  bool operator<(const SCompiledEntry &right) const { return id < right.id; };
+  bool operator==(const SCompiledEntry &right) const { return id == right.id; };
+};
+
+static inline size_t PadTo4(size_t size)
+{
+  return (size + 3) & ~(size_t)3;
+}
+
+CStringCatalog::CStringCatalog()
+  : m_data(NULL)
+  , m_size(0)
+  , m_mapped(false)
+  , m_count(0)
+  , m_ids(NULL)
+  , m_offsets(NULL)
+  , m_blob(NULL)
+  , m_mtime(0)
+  , m_fileSize(0)
+{
+}
+
+CStringCatalog::~CStringCatalog()
+{
+#ifdef TARGET_POSIX
+  if (m_mapped)
+    munmap((void *)m_data, m_size);
+#endif
+}
+
+static std::string GetCachePath(const std::string &poFile)
+{
+  Crc32 crc;
+  crc.Compute(poFile);
+  CStdString path;
+  path.Format(LANGCACHE_PATH "%08x.bin", (uint32_t)crc);
+  return path;
+}
+
+CStringCatalog *CStringCatalog::Load(const std::string &poFile)
+{
+  struct __stat64 buffer;
+  if (CFile::Stat(poFile, &buffer) != 0)
+    return NULL;
+
+  CStartupSpan span("CStringCatalog::Load", poFile.c_str());
+  CStringCatalog *catalog = new CStringCatalog;
+  catalog->m_mtime    = buffer.st_mtime;
+  catalog->m_fileSize = buffer.st_size;
+  if (catalog->Map(GetCachePath(poFile)) &&
+      catalog->Attach(catalog->m_data, catalog->m_size, poFile, buffer.st_mtime, buffer.st_size))
+    return catalog;
+
+  delete catalog;
+  catalog = new CStringCatalog;
+  catalog->m_mtime    = buffer.st_mtime;
+  catalog->m_fileSize = buffer.st_size;
+  if (catalog->Compile(poFile, buffer.st_mtime, buffer.st_size))
+    return catalog;
+
+  delete catalog;
+  return NULL;
+}
+
+bool CStringCatalog::IsCurrent(const std::string &poFile) const
+{
+  struct __stat64 buffer;
+  if (CFile::Stat(poFile, &buffer) != 0)
+    return false;
+  return (uint64_t)buffer.st_mtime == m_mtime && (uint64_t)buffer.st_size == m_fileSize;
+}
+
+unsigned int CStringCatalog::Find(uint32_t id) const
+{
+  const uint32_t *it = std::lower_bound(m_ids, m_ids + m_count, id);
+  if (it == m_ids + m_count || *it != id)
+    return m_count;
+  return it - m_ids;
+}
+
+bool CStringCatalog::Map(const std::string &cachePath)
+{
+#ifdef TARGET_POSIX
+  int fd = open(CSpecialProtocol::TranslatePath(cachePath).c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat buffer;
+  void *data = MAP_FAILED;
+  if (fstat(fd, &buffer) == 0 && buffer.st_size >= (off_t)sizeof(SCatalogHeader))
+    data = mmap(NULL, buffer.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  m_data   = (const char *)data;
+  m_size   = buffer.st_size;
+  m_mapped = true;
+#else
+  CFile file;
+  if (!file.Open(cachePath))
+    return false;
+
+  int64_t length = file.GetLength();
+  if (length < (int64_t)sizeof(SCatalogHeader))
+    return false;
+  m_buffer.resize((size_t)length);
+  if (file.Read(&m_buffer[0], m_buffer.size()) != m_buffer.size())
+    return false;
+
+  m_data = m_buffer.c_str();
+  m_size = m_buffer.size();
+#endif
+  return true;
+}
+
+bool CStringCatalog::Attach(const char *data, size_t size, const std::string &poFile, uint64_t mtime, uint64_t fileSize)
+{
+  if (size < sizeof(SCatalogHeader))
+    return false;
+
+  const SCatalogHeader *header = (const SCatalogHeader *)data;
+  if (header->magic != LANGCACHE_MAGIC || header->version != LANGCACHE_VERSION ||
+      header->mtime != mtime || header->size != fileSize)
+    return false;
+
+  size_t pathOffset = sizeof(SCatalogHeader);
+  size_t idsOffset  = pathOffset + PadTo4(header->pathSize);
+  size_t blobOffset = idsOffset + (size_t)header->count * 3 * sizeof(uint32_t);
+  if (blobOffset < idsOffset || blobOffset + header->blobSize != size ||
+      header->pathSize != poFile.size() || poFile.compare(0, poFile.size(), data + pathOffset, header->pathSize) != 0)
+    return false;
+
+  m_count   = header->count;
+  m_ids     = (const uint32_t *)(data + idsOffset);
+  m_offsets = m_ids + m_count;
+  m_blob    = data + blobOffset;
+
+  // a damaged file must not send lookups outside of it
+  if (m_count && (header->blobSize == 0 || m_blob[header->blobSize - 1] != '\0'))
+    return false;
+  for (unsigned int i = 0; i < 2 * m_count; i++)
+  {
+    if (m_offsets[i] >= header->blobSize)
+      return false;
+  }
+  return true;
+}
+
+bool CStringCatalog::Compile(const std::string &poFile, uint64_t mtime, uint64_t fileSize)
+{
+  CPODocument PODoc;
+  if (!PODoc.LoadFile(poFile))
+    return false;
+
+  std::vector<SCompiledEntry> entries;
+  std::string blob;
+  while (PODoc.GetNextEntry())
+  {
+    // non id based entries aren't used by CLocalizeStrings yet
+    if (PODoc.GetEntryType() != ID_FOUND)
+      continue;
+
+    PODoc.ParseEntry(false);
+    SCompiledEntry entry;
+    entry.id     = PODoc.GetEntryID();
+    entry.msgStr = blob.size();
+    blob.append(PODoc.GetMsgstr().c_str(), PODoc.GetMsgstr().size() + 1);
+    entry.msgId  = blob.size();
+    blob.append(PODoc.GetMsgid().c_str(), PODoc.GetMsgid().size() + 1);
+    entries.push_back(entry);
+  }
+
+  // the first entry of an id wins, as it did when the .po file was read directly
+  std::stable_sort(entries.begin(), entries.end());
+  entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+  SCatalogHeader header;
+  header.magic    = LANGCACHE_MAGIC;
+  header.version  = LANGCACHE_VERSION;
+  header.mtime    = mtime;
+  header.size     = fileSize;
+  header.count    = entries.size();
+  header.blobSize = blob.size();
+  header.pathSize = poFile.size();
+  header.reserved = 0;
+
+  m_buffer.reserve(sizeof(header) + PadTo4(poFile.size()) + entries.size() * 3 * sizeof(uint32_t) + blob.size());
+  m_buffer.append((const char *)&header, sizeof(header));
+  m_buffer.append(poFile);
+  m_buffer.append(PadTo4(poFile.size()) - poFile.size(), '\0');
+  for (std::vector<SCompiledEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    m_buffer.append((const char *)&it->id, sizeof(uint32_t));
+  for (std::vector<SCompiledEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+  {
+    m_buffer.append((const char *)&it->msgStr, sizeof(uint32_t));
+    m_buffer.append((const char *)&it->msgId, sizeof(uint32_t));
+  }
+  m_buffer.append(blob);
+
+  m_data = m_buffer.c_str();
+  m_size = m_buffer.size();
+  if (!Attach(m_data, m_size, poFile, mtime, fileSize))
+    return false;
+
+  // the catalog is used from memory this time, failing to store it only costs the next load.
+  // another CLocalizeStrings may have the old file mapped, so it's replaced rather than rewritten
+  std::string cachePath = GetCachePath(poFile);
+  std::string tempPath = cachePath + ".tmp";
+  CFile file;
+  bool stored = (CDirectory::Exists(LANGCACHE_PATH) || CDirectory::Create(LANGCACHE_PATH)) &&
+                file.OpenForWrite(tempPath, true) &&
+                file.Write(m_buffer.c_str(), m_buffer.size()) == (int)m_buffer.size();
+  file.Close();
+  if (stored && !CFile::Rename(tempPath, cachePath))
+  {
+    // no atomic replace on windows, nothing maps the file there
+    CFile::Delete(cachePath);
+    stored = CFile::Rename(tempPath, cachePath);
+  }
+  if (!stored)
+  {
+    CLog::Log(LOGDEBUG, "%s - unable to store the compiled strings of %s", __FUNCTION__, poFile.c_str());
+    CFile::Delete(tempPath);
+  }
+  return true;
+}
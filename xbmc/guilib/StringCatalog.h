@@ -0,0 +1,80 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+
+/*!
+ \ingroup strings
+ \brief The id based entries of a strings.po file in compiled form.
+
+ A catalog is a sorted array of string ids and a single blob of utf-8 strings. It is compiled
+ from the .po file the first time it is loaded and stored in special://temp/langcache/. Later
+ loads map the compiled file into memory as long as the modification time and size of the .po
+ file are unchanged, so no parsing or per string allocation takes place.
+ */
+class CStringCatalog
+{
+public:
+  ~CStringCatalog();
+
+  /*! \brief Load the catalog of a strings.po file, compiling it if needed
+   \param poFile the path of the strings.po file.
+   \return the catalog, owned by the caller, or NULL if the file doesn't exist or isn't valid.
+   */
+  static CStringCatalog *Load(const std::string &poFile);
+
+  /*! \brief Whether the strings.po file still has the modification time and size it was loaded with */
+  bool IsCurrent(const std::string &poFile) const;
+
+  unsigned int Size() const { return m_count; };
+
+  /*! \brief Index of an id, or Size() if it isn't in the catalog */
+  unsigned int Find(uint32_t id) const;
+
+  uint32_t    GetId(unsigned int index) const     { return m_ids[index]; };
+  /*! \brief The translated string, empty for untranslated entries and the source language */
+  const char *GetMsgStr(unsigned int index) const { return m_blob + m_offsets[2 * index]; };
+  /*! \brief The source language string */
+  const char *GetMsgId(unsigned int index) const  { return m_blob + m_offsets[2 * index + 1]; };
+
+private:
+  CStringCatalog();
+  CStringCatalog(const CStringCatalog&);
+  CStringCatalog const& operator=(CStringCatalog const&);
+
+  bool Compile(const std::string &poFile, uint64_t mtime, uint64_t fileSize);
+  bool Map(const std::string &cachePath);
+  bool Attach(const char *data, size_t size, const std::string &poFile, uint64_t mtime, uint64_t fileSize);
+
+  const char     *m_data;     ///< the compiled catalog, mapped or in m_buffer
+  size_t          m_size;
+  bool            m_mapped;
+  std::string     m_buffer;
+
+  uint32_t        m_count;
+  const uint32_t *m_ids;
+  const uint32_t *m_offsets;  ///< msgstr and msgid offset into the blob per entry
+  const char     *m_blob;
+
+  uint64_t        m_mtime;    ///< of the strings.po file
+  uint64_t        m_fileSize;
+};
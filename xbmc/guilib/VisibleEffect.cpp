@@ -599,9 +599,9 @@ void CAnimation::UpdateCondition(const CGUIListItem *item)
   m_lastCondition = condition;
 }
 
-void CAnimation::SetInitialCondition()
+void CAnimation::SetInitialCondition(const CGUIListItem *item)
 {
-  m_lastCondition = g_infoManager.GetBoolValue(m_condition);
+  m_lastCondition = g_infoManager.GetBoolValue(m_condition, item);
   if (m_lastCondition)
     ApplyAnimation();
   else
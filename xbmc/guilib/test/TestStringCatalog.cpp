@@ -0,0 +1,144 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/StringCatalog.h"
+#include "filesystem/File.h"
+#include "utils/Crc32.h"
+#include "utils/StdString.h"
+
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+// where CStringCatalog stores the compiled strings of a .po file
+static std::string GetCachePath(const std::string &poFile)
+{
+  Crc32 crc;
+  crc.Compute(poFile);
+  CStdString path;
+  path.Format("special://temp/langcache/%08x.bin", (uint32_t)crc);
+  return path;
+}
+
+static std::string ReadFile(const std::string &path)
+{
+  std::string data;
+  XFILE::CFile file;
+  if (file.Open(path))
+  {
+    data.resize((size_t)file.GetLength());
+    if (data.empty() || file.Read(&data[0], data.size()) != data.size())
+      data.clear();
+  }
+  return data;
+}
+
+static void WriteFile(const std::string &path, const std::string &data)
+{
+  XFILE::CFile file;
+  ASSERT_TRUE(file.OpenForWrite(path, true));
+  ASSERT_EQ((int)data.size(), file.Write(data.c_str(), data.size()));
+}
+
+static void ExpectSpanish(const CStringCatalog *catalog)
+{
+  ASSERT_TRUE(catalog != NULL);
+  ASSERT_LT(2U, catalog->Size());
+
+  unsigned int index = catalog->Find(1);
+  ASSERT_LT(index, catalog->Size());
+  EXPECT_EQ((uint32_t)1, catalog->GetId(index));
+  EXPECT_STREQ("Pictures", catalog->GetMsgId(index));
+  EXPECT_STREQ("Imágenes", catalog->GetMsgStr(index));
+
+  EXPECT_EQ(catalog->Size(), catalog->Find(0xfffffff));
+}
+
+TEST(TestStringCatalog, CompileAndMap)
+{
+  std::string poFile = XBMC_REF_FILE_PATH("/language/Spanish/strings.po");
+  std::string cachePath = GetCachePath(poFile);
+  XFILE::CFile::Delete(cachePath);
+
+  // the first load compiles and stores the catalog
+  CStringCatalog *catalog = CStringCatalog::Load(poFile);
+  ExpectSpanish(catalog);
+  delete catalog;
+
+  std::string compiled = ReadFile(cachePath);
+  ASSERT_FALSE(compiled.empty());
+
+  // the next one attaches to the stored catalog, and leaves it alone
+  catalog = CStringCatalog::Load(poFile);
+  ExpectSpanish(catalog);
+  delete catalog;
+  EXPECT_TRUE(compiled == ReadFile(cachePath));
+}
+
+TEST(TestStringCatalog, Damaged)
+{
+  std::string poFile = XBMC_REF_FILE_PATH("/language/Spanish/strings.po");
+  std::string cachePath = GetCachePath(poFile);
+
+  CStringCatalog *catalog = CStringCatalog::Load(poFile);
+  ExpectSpanish(catalog);
+  delete catalog;
+  std::string compiled = ReadFile(cachePath);
+  ASSERT_FALSE(compiled.empty());
+
+  // a blob without its terminating nul is rejected and compiled again
+  std::string damaged = compiled;
+  damaged[damaged.size() - 1] = 'x';
+  WriteFile(cachePath, damaged);
+  catalog = CStringCatalog::Load(poFile);
+  ExpectSpanish(catalog);
+  delete catalog;
+  EXPECT_TRUE(compiled == ReadFile(cachePath));
+
+  // as is a truncated file
+  WriteFile(cachePath, compiled.substr(0, compiled.size() / 2));
+  catalog = CStringCatalog::Load(poFile);
+  ExpectSpanish(catalog);
+  delete catalog;
+  EXPECT_TRUE(compiled == ReadFile(cachePath));
+
+  XFILE::CFile::Delete(cachePath);
+}
+
+TEST(TestStringCatalog, IsCurrent)
+{
+  std::string poFile = XBMC_REF_FILE_PATH("/language/Spanish/strings.po");
+  std::string copy = "special://temp/TestStringCatalog.po";
+  std::string data = ReadFile(poFile);
+  ASSERT_FALSE(data.empty());
+  WriteFile(copy, data);
+
+  CStringCatalog *catalog = CStringCatalog::Load(copy);
+  ExpectSpanish(catalog);
+  EXPECT_TRUE(catalog->IsCurrent(copy));
+
+  // an updated file no longer matches the loaded catalog
+  WriteFile(copy, data + "\n");
+  EXPECT_FALSE(catalog->IsCurrent(copy));
+  delete catalog;
+
+  XFILE::CFile::Delete(copy);
+  XFILE::CFile::Delete(GetCachePath(copy));
+}
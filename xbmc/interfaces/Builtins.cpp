@@ -47,6 +47,7 @@
 #include "interfaces/generic/ScriptInvocationManager.h"
 #include "network/NetworkServices.h"
 #include "utils/log.h"
+#include "utils/PlaybackTrace.h"
 #include "storage/MediaManager.h"
 #include "utils/RssManager.h"
 #include "PartyModeManager.h"
@@ -220,6 +221,7 @@ const BUILT_IN commands[] = {
   { "ToggleDebug",                false,  "Enables/disables debug mode" },
   { "StartPVRManager",            false,  "(Re)Starts the PVR manager" },
   { "StopPVRManager",             false,  "Stops the PVR manager" },
+  { "PlaybackTrace",              true,   "Start, stop or save tracing of the playback threads (start|stop|save[,file])" },
 #if defined(TARGET_ANDROID)
   { "StartAndroidActivity",       true,   "Launch an Android native app with the given package name.  Optional parms (in order): intent, dataType, dataURI." },
 #endif
@@ -1711,6 +1713,19 @@ int CBuiltins::Execute(const CStdString& execString)
   {
     g_application.StopPVRManager();
   }
+  else if (execute.Equals("playbacktrace") && params.size() > 0)
+  {
+    CStdString file = params.size() > 1 ? params[1] : "";
+    if (params[0].Equals("start"))
+      CPlaybackTrace::Enable(true);
+    else if (params[0].Equals("stop"))
+    {
+      CPlaybackTrace::Enable(false);
+      CPlaybackTrace::Save(file);
+    }
+    else if (params[0].Equals("save"))
+      CPlaybackTrace::Save(file);
+  }
   else if (execute.Equals("StartAndroidActivity") && params.size() > 0)
   {
     CApplicationMessenger::Get().StartAndroidActivity(params);
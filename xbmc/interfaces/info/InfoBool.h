@@ -73,6 +73,8 @@ public:
    */
   virtual void Update(const CGUIListItem *item) {};
 
+  const CStdString &GetExpression() const { return m_expression; };
+
 protected:
 
   bool m_value;                ///< current value
@@ -43,6 +43,7 @@
 #include "dialogs/GUIDialogYesNo.h"
 #include "dialogs/GUIDialogSelect.h"
 #include "filesystem/File.h"
+#include "filesystem/FileExistenceChecker.h"
 #include "profiles/ProfilesManager.h"
 #include "settings/AdvancedSettings.h"
 #include "FileItem.h"
@@ -75,6 +76,12 @@ using ADDON::AddonPtr;
 
 #define RECENTLY_PLAYED_LIMIT 25
 #define MIN_FULL_SEARCH_LENGTH 3
+#define SEARCH_LIMIT 1000
+
+// indexed columns of the full-text search indexes
+#define SONGSEARCH_COLUMNS   "strTitle, strArtists, strAlbum, strGenres"
+#define ALBUMSEARCH_COLUMNS  "strAlbum, strArtists, strGenres"
+#define ARTISTSEARCH_COLUMNS "strArtist"
 
 #ifdef HAS_DVD_DRIVE
 using namespace CDDB;
@@ -221,6 +228,8 @@ bool CMusicDatabase::CreateTables()
     m_pDS->exec("CREATE TRIGGER delete_album AFTER DELETE ON album FOR EACH ROW BEGIN DELETE FROM art WHERE media_id=old.idAlbum AND media_type='album'; END");
     m_pDS->exec("CREATE TRIGGER delete_artist AFTER DELETE ON artist FOR EACH ROW BEGIN DELETE FROM art WHERE media_id=old.idArtist AND media_type='artist'; END");
 
+    CreateSearchIndexes();
+
     // we create views last to ensure all indexes are rolled in
     CreateViews();
 
@@ -237,6 +246,78 @@ bool CMusicDatabase::CreateTables()
   return true;
 }
 
+void CMusicDatabase::CreateSearchIndexes()
+{
+  CLog::Log(LOGINFO, "create search indexes");
+  /* before delete triggers, as mysql only allows one trigger per table and event before 5.7 and
+     there are after delete triggers already */
+  if (CreateSearchIndex("songsearch", SONGSEARCH_COLUMNS))
+  {
+    m_pDS->exec("INSERT INTO songsearch (docid, " SONGSEARCH_COLUMNS ") "
+                "SELECT idSong, strTitle, song.strArtists, strAlbum, song.strGenres FROM song LEFT JOIN album ON album.idAlbum=song.idAlbum");
+    m_pDS->exec("CREATE TRIGGER insert_songsearch AFTER INSERT ON song FOR EACH ROW BEGIN "
+                "INSERT INTO songsearch (docid, " SONGSEARCH_COLUMNS ") VALUES (new.idSong, new.strTitle, new.strArtists, (SELECT strAlbum FROM album WHERE album.idAlbum=new.idAlbum), new.strGenres); "
+                "END");
+    m_pDS->exec("CREATE TRIGGER delete_songsearch BEFORE DELETE ON song FOR EACH ROW BEGIN "
+                "DELETE FROM songsearch WHERE docid=old.idSong; "
+                "END");
+  }
+
+  if (CreateSearchIndex("albumsearch", ALBUMSEARCH_COLUMNS))
+  {
+    m_pDS->exec("INSERT INTO albumsearch (docid, " ALBUMSEARCH_COLUMNS ") SELECT idAlbum, " ALBUMSEARCH_COLUMNS " FROM album");
+    m_pDS->exec("CREATE TRIGGER insert_albumsearch AFTER INSERT ON album FOR EACH ROW BEGIN "
+                "INSERT INTO albumsearch (docid, " ALBUMSEARCH_COLUMNS ") VALUES (new.idAlbum, new.strAlbum, new.strArtists, new.strGenres); "
+                "END");
+    m_pDS->exec("CREATE TRIGGER delete_albumsearch BEFORE DELETE ON album FOR EACH ROW BEGIN "
+                "DELETE FROM albumsearch WHERE docid=old.idAlbum; "
+                "END");
+  }
+
+  if (CreateSearchIndex("artistsearch", ARTISTSEARCH_COLUMNS))
+  {
+    m_pDS->exec("INSERT INTO artistsearch (docid, " ARTISTSEARCH_COLUMNS ") SELECT idArtist, " ARTISTSEARCH_COLUMNS " FROM artist");
+    m_pDS->exec("CREATE TRIGGER insert_artistsearch AFTER INSERT ON artist FOR EACH ROW BEGIN "
+                "INSERT INTO artistsearch (docid, " ARTISTSEARCH_COLUMNS ") VALUES (new.idArtist, new.strArtist); "
+                "END");
+    m_pDS->exec("CREATE TRIGGER delete_artistsearch BEFORE DELETE ON artist FOR EACH ROW BEGIN "
+                "DELETE FROM artistsearch WHERE docid=old.idArtist; "
+                "END");
+  }
+
+  CreateSearchUpdateTriggers();
+}
+
+void CMusicDatabase::CreateSearchUpdateTriggers()
+{
+  // only on the indexed columns, updating play counts mustn't rewrite the indexes
+  if (HasSearchIndex("songsearch"))
+  {
+    m_pDS->exec("DROP TRIGGER IF EXISTS update_songsearch");
+    CreateUpdateTrigger("update_songsearch", "song", "strTitle, strArtists, idAlbum, strGenres",
+                        "DELETE FROM songsearch WHERE docid=old.idSong; "
+                        "INSERT INTO songsearch (docid, " SONGSEARCH_COLUMNS ") VALUES (new.idSong, new.strTitle, new.strArtists, (SELECT strAlbum FROM album WHERE album.idAlbum=new.idAlbum), new.strGenres);");
+  }
+
+  if (HasSearchIndex("albumsearch"))
+  {
+    // songs are indexed with the title of their album too
+    m_pDS->exec("DROP TRIGGER IF EXISTS update_albumsearch");
+    CreateUpdateTrigger("update_albumsearch", "album", ALBUMSEARCH_COLUMNS,
+                        "DELETE FROM albumsearch WHERE docid=old.idAlbum; "
+                        "INSERT INTO albumsearch (docid, " ALBUMSEARCH_COLUMNS ") VALUES (new.idAlbum, new.strAlbum, new.strArtists, new.strGenres); "
+                        "UPDATE songsearch SET strAlbum=new.strAlbum WHERE docid IN (SELECT idSong FROM song WHERE song.idAlbum=new.idAlbum);");
+  }
+
+  if (HasSearchIndex("artistsearch"))
+  {
+    m_pDS->exec("DROP TRIGGER IF EXISTS update_artistsearch");
+    CreateUpdateTrigger("update_artistsearch", "artist", ARTISTSEARCH_COLUMNS,
+                        "DELETE FROM artistsearch WHERE docid=old.idArtist; "
+                        "INSERT INTO artistsearch (docid, " ARTISTSEARCH_COLUMNS ") VALUES (new.idArtist, new.strArtist);");
+  }
+}
+
 void CMusicDatabase::CreateViews()
 {
   CLog::Log(LOGINFO, "create song view");
@@ -1270,7 +1351,13 @@ bool CMusicDatabase::SearchArtists(const CStdString& search, CFileItemList &arti
 
     CStdString strVariousArtists = g_localizeStrings.Get(340).c_str();
     CStdString strSQL;
-    if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
+    if (CanSearchIndex("artistsearch", search))
+      strSQL = "select artist.* from artistsearch join artist on artist.idArtist=artistsearch.docid "
+               "where " + PrepareSearchMatch("artistsearch", ARTISTSEARCH_COLUMNS, search) +
+               PrepareSQL(" and strArtist <> '%s'", strVariousArtists.c_str()) +
+               " order by " + PrepareSearchRank("artistsearch", ARTISTSEARCH_COLUMNS, search) +
+               PrepareSQL(" desc limit %i", SEARCH_LIMIT);
+    else if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
       strSQL=PrepareSQL("select * from artist "
                                 "where (strArtist like '%s%%' or strArtist like '%% %s%%') and strArtist <> '%s' "
                                 , search.c_str(), search.c_str(), strVariousArtists.c_str() );
@@ -1758,6 +1845,7 @@ void CMusicDatabase::IncrementPlayCount(const CFileItem& item)
 
     CStdString sql=PrepareSQL("UPDATE song SET iTimesPlayed=iTimesPlayed+1, lastplayed=CURRENT_TIMESTAMP where idSong=%i", idSong);
     m_pDS->exec(sql.c_str());
+    AnnounceUpdate("song", idSong);
   }
   catch (...)
   {
@@ -1816,7 +1904,8 @@ void CMusicDatabase::EmptyCache()
 
 bool CMusicDatabase::Search(const CStdString& search, CFileItemList &items)
 {
-  unsigned int time = XbmcThreads::SystemClockMillis();
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  unsigned int time = start;
   // first grab all the artists that match
   SearchArtists(search, items);
   CLog::Log(LOGDEBUG, "%s Artist search in %i ms",
@@ -1831,6 +1920,9 @@ bool CMusicDatabase::Search(const CStdString& search, CFileItemList &items)
   SearchSongs(search, items);
   CLog::Log(LOGDEBUG, "%s Songs search in %i ms",
             __FUNCTION__, XbmcThreads::SystemClockMillis() - time); time = XbmcThreads::SystemClockMillis();
+
+  CLog::Log(LOGDEBUG, "%s Search for '%s' in %i ms, %i results", __FUNCTION__, search.c_str(),
+            XbmcThreads::SystemClockMillis() - start, items.Size());
   return true;
 }
 
@@ -1842,7 +1934,12 @@ bool CMusicDatabase::SearchSongs(const CStdString& search, CFileItemList &items)
     if (NULL == m_pDS.get()) return false;
 
     CStdString strSQL;
-    if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
+    if (CanSearchIndex("songsearch", search))
+      strSQL = "select songview.* from songsearch join songview on songview.idSong=songsearch.docid "
+               "where " + PrepareSearchMatch("songsearch", SONGSEARCH_COLUMNS, search) +
+               " order by " + PrepareSearchRank("songsearch", SONGSEARCH_COLUMNS, search) +
+               PrepareSQL(" desc limit %i", SEARCH_LIMIT);
+    else if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
       strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' or strTitle like '%% %s%%' limit 1000", search.c_str(), search.c_str());
     else
       strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' limit 1000", search.c_str());
@@ -1878,7 +1975,12 @@ bool CMusicDatabase::SearchAlbums(const CStdString& search, CFileItemList &album
     if (NULL == m_pDS.get()) return false;
 
     CStdString strSQL;
-    if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
+    if (CanSearchIndex("albumsearch", search))
+      strSQL = "select albumview.* from albumsearch join albumview on albumview.idAlbum=albumsearch.docid "
+               "where " + PrepareSearchMatch("albumsearch", ALBUMSEARCH_COLUMNS, search) +
+               " order by " + PrepareSearchRank("albumsearch", ALBUMSEARCH_COLUMNS, search) +
+               PrepareSQL(" desc limit %i", SEARCH_LIMIT);
+    else if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
       strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%' or strAlbum like '%% %s%%'", search.c_str(), search.c_str());
     else
       strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%'", search.c_str());
@@ -2043,50 +2145,25 @@ bool CMusicDatabase::SetAlbumInfoSongs(int idAlbumInfo, const VECSONGS& songs)
   return false;
 }
 
-bool CMusicDatabase::CleanupSongsByIds(const CStdString &strSongIds)
+bool CMusicDatabase::CleanupSongsByIds(const std::vector<int> &idSongs)
 {
   try
   {
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
-    // ok, now find all idSong's
-    CStdString strSQL=PrepareSQL("select * from song join path on song.idPath = path.idPath where song.idSong in %s", strSongIds.c_str());
-    if (!m_pDS->query(strSQL.c_str())) return false;
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound == 0)
-    {
-      m_pDS->close();
-      return true;
-    }
-    CStdString strSongsToDelete = "";
-    while (!m_pDS->eof())
-    { // get the full song path
-      CStdString strFileName = URIUtils::AddFileToFolder(m_pDS->fv("path.strPath").get_asString(), m_pDS->fv("song.strFileName").get_asString());
 
-      //  Special case for streams inside an ogg file. (oggstream)
-      //  The last dir in the path is the ogg file that
-      //  contains the stream, so test if its there
-      if (URIUtils::HasExtension(strFileName, ".oggstream|.nsfstream"))
-      {
-        CStdString strFileAndPath=strFileName;
-        URIUtils::GetDirectory(strFileAndPath, strFileName);
-        // we are dropping back to a file, so remove the slash at end
-        URIUtils::RemoveSlashAtEnd(strFileName);
-      }
-
-      if (!CFile::Exists(strFileName))
-      { // file no longer exists, so add to deletion list
-        strSongsToDelete += m_pDS->fv("song.idSong").get_asString() + ",";
-      }
-      m_pDS->next();
-    }
-    m_pDS->close();
-
-    if ( ! strSongsToDelete.IsEmpty() )
+    // delete in batches, each in its own transaction so the library isn't locked for the whole clean
+    const unsigned int iLIMIT = 1000;
+    for (unsigned int i = 0; i < idSongs.size(); i += iLIMIT)
     {
+      CStdString strSongsToDelete;
+      for (unsigned int j = i; j < idSongs.size() && j < i + iLIMIT; j++)
+        strSongsToDelete.AppendFormat("%i,", idSongs[j]);
       strSongsToDelete = "(" + strSongsToDelete.TrimRight(",") + ")";
+
+      BeginTransaction();
       // ok, now delete these songs + all references to them from the linked tables
-      strSQL = "delete from song where idSong in " + strSongsToDelete;
+      CStdString strSQL = "delete from song where idSong in " + strSongsToDelete;
       m_pDS->exec(strSQL.c_str());
       strSQL = "delete from song_artist where idSong in " + strSongsToDelete;
       m_pDS->exec(strSQL.c_str());
@@ -2094,13 +2171,14 @@ bool CMusicDatabase::CleanupSongsByIds(const CStdString &strSongIds)
       m_pDS->exec(strSQL.c_str());
       strSQL = "delete from karaokedata where idSong in " + strSongsToDelete;
       m_pDS->exec(strSQL.c_str());
-      m_pDS->close();
+      CommitTransaction();
     }
     return true;
   }
   catch (...)
   {
-    CLog::Log(LOGERROR, "Exception in CMusicDatabase::CleanupSongsFromPaths()");
+    CLog::Log(LOGERROR, "Exception in CMusicDatabase::CleanupSongsByIds()");
+    RollbackTransaction();
   }
   return false;
 }
@@ -2109,32 +2187,34 @@ bool CMusicDatabase::CleanupSongs()
 {
   try
   {
-    // run through all songs and get all unique path ids
-    int iLIMIT = 1000;
-    for (int i=0;;i+=iLIMIT)
-    {
-      CStdString strSQL=PrepareSQL("select song.idSong from song order by song.idSong limit %i offset %i",iLIMIT,i);
-      if (!m_pDS->query(strSQL.c_str())) return false;
-      int iRowsFound = m_pDS->num_rows();
-      // keep going until no rows are left!
-      if (iRowsFound == 0)
-      {
-        m_pDS->close();
-        return true;
-      }
-      CStdString strSongIds = "(";
-      while (!m_pDS->eof())
+    // run through all songs and check which ones no longer exist
+    CStdString strSQL = "select song.idSong, path.strPath, song.strFileName from song join path on song.idPath = path.idPath";
+    if (!m_pDS->query(strSQL.c_str())) return false;
+    CFileExistenceChecker checker;
+    while (!m_pDS->eof())
+    { // get the full song path
+      CStdString strFileName = URIUtils::AddFileToFolder(m_pDS->fv("path.strPath").get_asString(), m_pDS->fv("song.strFileName").get_asString());
+
+      //  Special case for streams inside an ogg file. (oggstream)
+      //  The last dir in the path is the ogg file that
+      //  contains the stream, so test if its there
+      if (URIUtils::HasExtension(strFileName, ".oggstream|.nsfstream"))
       {
-        strSongIds += m_pDS->fv("song.idSong").get_asString() + ",";
-        m_pDS->next();
+        CStdString strFileAndPath=strFileName;
+        URIUtils::GetDirectory(strFileAndPath, strFileName);
+        // we are dropping back to a file, so remove the slash at end
+        URIUtils::RemoveSlashAtEnd(strFileName);
       }
-      m_pDS->close();
-      strSongIds.TrimRight(",");
-      strSongIds += ")";
-      CLog::Log(LOGDEBUG,"Checking songs from song ID list: %s",strSongIds.c_str());
-      if (!CleanupSongsByIds(strSongIds)) return false;
+
+      checker.Add(m_pDS->fv("song.idSong").get_asInt(), strFileName);
+      m_pDS->next();
     }
-    return true;
+    m_pDS->close();
+
+    std::vector<int> idSongs;
+    checker.Check(idSongs);
+    CLog::Log(LOGDEBUG, "%s: %u of %u songs no longer exist", __FUNCTION__, (unsigned int)idSongs.size(), checker.Size());
+    return CleanupSongsByIds(idSongs);
   }
   catch(...)
   {
@@ -3832,6 +3912,12 @@ bool CMusicDatabase::UpdateOldVersion(int version)
     m_pDS->exec("DROP INDEX idxSong6 ON song");
     m_pDS->exec("CREATE INDEX idxSong6 on song( idPath, strFileName(255) )");
   }
+
+  if (version < 38)
+    CreateSearchIndexes();
+
+  if (version < 39)
+    CreateSearchUpdateTriggers();
     
   // always recreate the views after any table change
   CreateViews();
@@ -3841,7 +3927,7 @@ bool CMusicDatabase::UpdateOldVersion(int version)
 
 int CMusicDatabase::GetMinVersion() const
 {
-  return 37;
+  return 39;
 }
 
 unsigned int CMusicDatabase::GetSongIDs(const Filter &filter, vector<pair<int,int> > &songIDs)
@@ -4379,6 +4465,7 @@ bool CMusicDatabase::SetSongRating(const CStdString &filePath, char rating)
 
     CStdString sql = PrepareSQL("update song set rating='%c' where idSong = %i", rating, songID);
     m_pDS->exec(sql.c_str());
+    AnnounceUpdate("song", songID);
     return true;
   }
   catch (...)
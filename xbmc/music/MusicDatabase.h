@@ -427,6 +427,14 @@ private:
    */
   virtual void CreateViews();
 
+  /*! \brief Create the full-text indexes of songs, albums and artists, with the triggers keeping them up to date
+   */
+  void CreateSearchIndexes();
+
+  /*! \brief (Re)create the triggers updating the full-text indexes, they only run on updates of indexed columns
+   */
+  void CreateSearchUpdateTriggers();
+
   void SplitString(const CStdString &multiString, std::vector<std::string> &vecStrings, CStdString &extraStrings);
   CSong GetSongFromDataset(bool bWithMusicDbPath=false);
   CArtist GetArtistFromDataset(dbiplus::Dataset* pDS, bool needThumb = true);
@@ -437,7 +445,7 @@ private:
   void GetFileItemFromDataset(CFileItem* item, const CStdString& strMusicDBbasePath);
   void GetFileItemFromDataset(const dbiplus::sql_record* const record, CFileItem* item, const CStdString& strMusicDBbasePath);
   bool CleanupSongs();
-  bool CleanupSongsByIds(const CStdString &strSongIds);
+  bool CleanupSongsByIds(const std::vector<int> &idSongs);
   bool CleanupPaths();
   bool CleanupAlbums();
   bool CleanupArtists();
@@ -705,7 +705,6 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
       break;
 
     album->strPath = strDirectory;
-    m_musicDatabase.BeginTransaction();
 
     // Check if the album has already been downloaded or failed
     map<CAlbum, CAlbum>::iterator cachedAlbum = m_albumCache.find(*album);
@@ -816,6 +815,10 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
     if (m_bStop)
       break;
 
+    // the songs of an album are written in one go, but the album and artist lookups above
+    // aren't, so other writers don't wait for the scrapers
+    m_musicDatabase.BeginTransaction();
+
     for (VECSONGS::iterator song = album->songs.begin(); song != album->songs.end(); ++song)
     {
       song->idAlbum = cachedAlbum->second.idAlbum;
@@ -848,7 +851,11 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
           CMusicArtistInfo artistInfo;
           INFO_RET artistDownloadStatus = INFO_NOT_FOUND;
           if ((m_flags & SCAN_ONLINE) && artistScraper)
+          {
+            m_musicDatabase.CommitTransaction();
             artistDownloadStatus = DownloadArtistInfo(artistTmp, artistScraper, artistInfo);
+            m_musicDatabase.BeginTransaction();
+          }
 
           if (artistDownloadStatus == INFO_ADDED || artistDownloadStatus == INFO_HAVE_ALREADY)
           {
@@ -0,0 +1,140 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "music/MusicDatabase.h"
+#include "FileItem.h"
+#include "dbwrappers/dataset.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+/* An empty music library in special://temp */
+class CTestMusicDatabase : public CMusicDatabase
+{
+public:
+  CTestMusicDatabase()
+  {
+    m_settings.type = "sqlite3";
+    m_settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    m_settings.name = "TestMusicDatabase";
+  }
+
+  bool Create()
+  {
+    return Update(m_settings);
+  }
+
+  /*! \brief Close the database and open it again, which reuses the pooled connection */
+  bool Reopen()
+  {
+    Close();
+    return CDatabase::Open(m_settings);
+  }
+
+  /*! \brief Number of rows of a full-text index matching a search */
+  int Search(const std::string &table, const std::string &columns, const std::string &search)
+  {
+    CStdString count = GetSingleValue(CStdString("SELECT COUNT(1) FROM " + table + " WHERE " + PrepareSearchMatch(table, columns, search)));
+    return count.empty() ? -1 : atoi(count.c_str());
+  }
+
+  void Exec(const std::string &sql)
+  {
+    m_pDS->exec(sql.c_str());
+  }
+
+  /*! \brief Close and remove the database, as Update() opens an existing one */
+  void Delete()
+  {
+    Close();
+    CFileItemList items;
+    XFILE::CDirectory::GetDirectory("special://temp/", items, ".db", XFILE::DIR_FLAG_NO_FILE_DIRS);
+    for (int i = 0; i < items.Size(); i++)
+    {
+      if (StringUtils::StartsWith(URIUtils::GetFileName(items[i]->GetPath()), "TestMusicDatabase"))
+        XFILE::CFile::Delete(items[i]->GetPath());
+    }
+  }
+
+private:
+  DatabaseSettings m_settings;
+};
+
+class TestMusicDatabase : public testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    m_db.Delete(); // left by an earlier run
+    ASSERT_TRUE(m_db.Create());
+  }
+
+  virtual void TearDown()
+  {
+    m_db.Delete();
+  }
+
+  CTestMusicDatabase m_db;
+};
+
+TEST_F(TestMusicDatabase, CleanOnReusedConnection)
+{
+  // cleaning leaves temporary tables behind on some paths
+  EXPECT_EQ(ERROR_OK, m_db.Cleanup(NULL));
+  ASSERT_TRUE(m_db.Reopen());
+  EXPECT_EQ(ERROR_OK, m_db.Cleanup(NULL));
+}
+
+#define SONGSEARCH "strTitle, strArtists, strAlbum, strGenres"
+
+TEST_F(TestMusicDatabase, SearchIndex)
+{
+  m_db.Exec("INSERT INTO album (idAlbum, strAlbum, strArtists, strGenres) VALUES (1, 'Abbey Road', 'The Beatles', 'Rock')");
+  m_db.Exec("INSERT INTO song (idSong, idAlbum, idPath, strTitle, strArtists, strGenres, strFileName) "
+            "VALUES (1, 1, 1, 'Something', 'The Beatles', 'Rock', 'something.mp3')");
+  EXPECT_EQ(1, m_db.Search("songsearch", SONGSEARCH, "some"));
+  EXPECT_EQ(1, m_db.Search("songsearch", SONGSEARCH, "abbey beatles")); // the album title is indexed with the song
+  EXPECT_EQ(1, m_db.Search("albumsearch", "strAlbum, strArtists, strGenres", "abbey"));
+  EXPECT_EQ(0, m_db.Search("songsearch", "strTitle", "abbey"));
+
+  m_db.Exec("UPDATE song SET strTitle='Here Comes The Sun' WHERE idSong=1");
+  EXPECT_EQ(0, m_db.Search("songsearch", SONGSEARCH, "something"));
+  EXPECT_EQ(1, m_db.Search("songsearch", "strTitle", "sun"));
+
+  m_db.Exec("UPDATE album SET strAlbum='Let It Be' WHERE idAlbum=1");
+  EXPECT_EQ(0, m_db.Search("songsearch", SONGSEARCH, "abbey"));
+  EXPECT_EQ(1, m_db.Search("songsearch", "strAlbum", "let"));
+  EXPECT_EQ(1, m_db.Search("albumsearch", "strAlbum", "let"));
+
+  // playing a song leaves the index alone, the marker would be gone if it was rewritten
+  m_db.Exec("UPDATE songsearch SET strTitle='Marker' WHERE docid=1");
+  m_db.Exec("UPDATE song SET iTimesPlayed=iTimesPlayed+1, lastplayed='2013-01-01 00:00:00' WHERE idSong=1");
+  EXPECT_EQ(1, m_db.Search("songsearch", "strTitle", "marker"));
+
+  m_db.Exec("DELETE FROM song WHERE idSong=1");
+  m_db.Exec("DELETE FROM album WHERE idAlbum=1");
+  EXPECT_EQ(0, m_db.Search("songsearch", SONGSEARCH, "marker"));
+  EXPECT_EQ(0, m_db.Search("albumsearch", "strAlbum, strArtists, strGenres", "let"));
+}
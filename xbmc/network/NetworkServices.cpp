@@ -78,6 +78,7 @@
 #include "settings/Settings.h"
 #include "utils/log.h"
 #include "utils/RssManager.h"
+#include "utils/StartupTimeline.h"
 
 using namespace std;
 #ifdef HAS_JSONRPC
@@ -394,6 +395,7 @@ void CNetworkServices::OnSettingChanged(const CSetting *setting)
 
 void CNetworkServices::Start()
 {
+  CStartupSpan span("CNetworkServices::Start");
   StartZeroconf();
   if (CSettings::Get().GetBool("services.webserver") && !StartWebserver())
     CGUIDialogKaiToast::QueueNotification(CGUIDialogKaiToast::Warning, g_localizeStrings.Get(33101), g_localizeStrings.Get(33100));
@@ -425,6 +427,7 @@ void CNetworkServices::Stop(bool bWait)
 
 bool CNetworkServices::StartWebserver()
 {
+  CStartupSpan span("CNetworkServices::StartWebserver");
 #ifdef HAS_WEB_SERVER
   if (!g_application.getNetwork().IsAvailable())
     return false;
@@ -500,6 +503,7 @@ bool CNetworkServices::StopWebserver()
 
 bool CNetworkServices::StartAirPlayServer()
 {
+  CStartupSpan span("CNetworkServices::StartAirPlayServer");
 #ifdef HAS_AIRPLAY
   if (!g_application.getNetwork().IsAvailable() || !CSettings::Get().GetBool("services.airplay"))
     return false;
@@ -556,6 +560,7 @@ bool CNetworkServices::StopAirPlayServer(bool bWait)
 
 bool CNetworkServices::StartAirTunesServer()
 {
+  CStartupSpan span("CNetworkServices::StartAirTunesServer");
 #ifdef HAS_AIRTUNES
   if (!g_application.getNetwork().IsAvailable() || !CSettings::Get().GetBool("services.airplay"))
     return false;
@@ -598,6 +603,7 @@ bool CNetworkServices::StopAirTunesServer(bool bWait)
 
 bool CNetworkServices::StartJSONRPCServer()
 {
+  CStartupSpan span("CNetworkServices::StartJSONRPCServer");
 #ifdef HAS_JSONRPC
   if (!CSettings::Get().GetBool("services.esenabled"))
     return false;
@@ -645,6 +651,7 @@ bool CNetworkServices::StopJSONRPCServer(bool bWait)
 
 bool CNetworkServices::StartEventServer()
 {
+  CStartupSpan span("CNetworkServices::StartEventServer");
 #ifdef HAS_EVENT_SERVER
   if (!CSettings::Get().GetBool("services.esenabled"))
     return false;
@@ -760,6 +767,7 @@ bool CNetworkServices::StopUPnP(bool bWait)
 
 bool CNetworkServices::StartUPnPClient()
 {
+  CStartupSpan span("CNetworkServices::StartUPnPClient");
 #ifdef HAS_UPNP
   if (!CSettings::Get().GetBool("services.upnpcontroller"))
     return false;
@@ -795,6 +803,7 @@ bool CNetworkServices::StopUPnPClient()
 
 bool CNetworkServices::StartUPnPRenderer()
 {
+  CStartupSpan span("CNetworkServices::StartUPnPRenderer");
 #ifdef HAS_UPNP
   if (!CSettings::Get().GetBool("services.upnprenderer"))
     return false;
@@ -829,6 +838,7 @@ bool CNetworkServices::StopUPnPRenderer()
 
 bool CNetworkServices::StartUPnPServer()
 {
+  CStartupSpan span("CNetworkServices::StartUPnPServer");
 #ifdef HAS_UPNP
   if (!CSettings::Get().GetBool("services.upnpserver"))
     return false;
@@ -863,6 +873,7 @@ bool CNetworkServices::StopUPnPServer()
   
 bool CNetworkServices::StartRss()
 {
+  CStartupSpan span("CNetworkServices::StartRss");
   if (IsRssRunning())
     return true;
 
@@ -886,6 +897,7 @@ bool CNetworkServices::StopRss()
 
 bool CNetworkServices::StartZeroconf()
 {
+  CStartupSpan span("CNetworkServices::StartZeroconf");
 #ifdef HAS_ZEROCONF
   if (!CSettings::Get().GetBool("services.zeroconf"))
     return false;
@@ -22,6 +22,8 @@
 #include "PictureInfoTag.h"
 #include "settings/Settings.h"
 #include "FileItem.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
 
 CPictureInfoLoader::CPictureInfoLoader()
 {
@@ -79,7 +81,10 @@ bool CPictureInfoLoader::LoadItemCached(CFileItem* pItem)
 bool CPictureInfoLoader::LoadItemLookup(CFileItem* pItem)
 {
   if (m_pProgressCallback && !pItem->m_bIsFolder)
+  {
+    CSingleLock lock(m_lock);
     m_pProgressCallback->SetProgressAdvance();
+  }
 
   if (!pItem->IsPicture() || pItem->IsZIP() || pItem->IsRAR() || pItem->IsCBR() || pItem->IsCBZ() || pItem->IsInternetStream() || pItem->IsVideo())
     return false;
@@ -90,7 +95,7 @@ bool CPictureInfoLoader::LoadItemLookup(CFileItem* pItem)
   if (m_loadTags)
   { // Nothing found, load tag from file
     pItem->GetPictureInfoTag()->Load(pItem->GetPath());
-    m_tagReads++;
+    AtomicIncrement(&m_tagReads);
   }
 
   return true;
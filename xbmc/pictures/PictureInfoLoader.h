@@ -36,9 +36,10 @@ public:
 protected:
   virtual void OnLoaderStart();
   virtual void OnLoaderFinish();
+  virtual bool CanLoadConcurrently() const { return true; };
 
   CFileItemList* m_mapFileItems;
-  unsigned int m_tagReads;
+  volatile long m_tagReads;
   bool m_loadTags;
 };
 
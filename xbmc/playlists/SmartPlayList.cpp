@@ -766,7 +766,7 @@ void CSmartPlaylistRule::SetParameter(const std::vector<CStdString> &values)
 
 CStdString CSmartPlaylistRule::GetVideoResolutionQuery(const CStdString &parameter) const
 {
-  CStdString retVal(" in (select distinct idFile from streamdetails where iVideoWidth ");
+  CStdString retVal;
   int iRes = (int)strtol(parameter.c_str(), NULL, 10);
 
   int min, max;
@@ -778,24 +778,41 @@ CStdString CSmartPlaylistRule::GetVideoResolutionQuery(const CStdString &paramet
   switch (m_operator)
   {
     case OPERATOR_EQUALS:
-      retVal.AppendFormat(">= %i and iVideoWidth <= %i)", min, max);
+      retVal.Format("iVideoWidth >= %i and iVideoWidth <= %i", min, max);
       break;
     case OPERATOR_DOES_NOT_EQUAL:
-      retVal.AppendFormat("< %i or iVideoWidth > %i)", min, max);
+      retVal.Format("(iVideoWidth < %i or iVideoWidth > %i)", min, max);
       break;
     case OPERATOR_LESS_THAN:
-      retVal.AppendFormat("< %i)", min);
+      retVal.Format("iVideoWidth < %i", min);
       break;
     case OPERATOR_GREATER_THAN:
-      retVal.AppendFormat("> %i)", max);
+      retVal.Format("iVideoWidth > %i", max);
       break;
     default:
-      retVal += ")";
+      retVal = "0";
       break;
   }
   return retVal;
 }
 
+/*! \brief Condition that a row has a matching row in a link table.
+ A correlated EXISTS is looked up through the index of the link table on the media id for each
+ row, where an IN (SELECT ...) subquery is evaluated for the whole library first, usually by
+ scanning the link table.
+ \param negate " NOT" or empty
+ \param id the id column of the rows to check
+ \param from the link table, joined to the tables the condition refers to
+ \param linkId the column of the link table matching id
+ \param condition the condition on the joined tables
+ */
+static CStdString FormatExistsQuery(const CStdString &negate, const CStdString &id, const CStdString &from, const CStdString &linkId, const CStdString &condition)
+{
+  CStdString query = negate.IsEmpty() ? "EXISTS" : "NOT EXISTS";
+  query += " (SELECT 1 FROM " + from + " WHERE " + linkId + " = " + id + " AND " + condition + ")";
+  return query;
+}
+
 CStdString CSmartPlaylistRule::GetWhereClause(const CDatabase &db, const CStdString& strType) const
 {
   SEARCH_OPERATOR op = m_operator;
@@ -875,14 +892,14 @@ CStdString CSmartPlaylistRule::GetWhereClause(const CDatabase &db, const CStdStr
     if (strType == "movies")
     {
       if (m_field == FieldInProgress)
-        return "movieview.idFile " + negate + " IN (select idFile from bookmark where type = 1)";
+        return FormatExistsQuery(negate, "movieview.idFile", "bookmark", "bookmark.idFile", "bookmark.type = 1");
       else if (m_field == FieldTrailer)
         return negate + GetField(m_field, strType) + "!= ''";
     }
     else if (strType == "episodes")
     {
       if (m_field == FieldInProgress)
-        return "episodeview.idFile " + negate + " IN (select idFile from bookmark where type = 1)";
+        return FormatExistsQuery(negate, "episodeview.idFile", "bookmark", "bookmark.idFile", "bookmark.type = 1");
     }
     else if (strType == "tvshows")
     {
@@ -953,11 +970,11 @@ CStdString CSmartPlaylistRule::GetWhereClause(const CDatabase &db, const CStdStr
       table = "songview";
 
       if (m_field == FieldGenre)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idSong FROM song_genre, genre WHERE song_genre.idGenre = genre.idGenre AND genre.strGenre" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "song_genre JOIN genre ON genre.idGenre = song_genre.idGenre", "song_genre.idSong", "genre.strGenre" + parameter);
       else if (m_field == FieldArtist)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idSong FROM song_artist, artist WHERE song_artist.idArtist = artist.idArtist AND artist.strArtist" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "song_artist JOIN artist ON artist.idArtist = song_artist.idArtist", "song_artist.idSong", "artist.strArtist" + parameter);
       else if (m_field == FieldAlbumArtist)
-        query = table + ".idAlbum" + negate + " IN (SELECT idAlbum FROM album_artist, artist WHERE album_artist.idArtist = artist.idArtist AND artist.strArtist" + parameter + ")";
+        query = FormatExistsQuery(negate, table + ".idAlbum", "album_artist JOIN artist ON artist.idArtist = album_artist.idArtist", "album_artist.idAlbum", "artist.strArtist" + parameter);
       else if (m_field == FieldLastPlayed && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
         query = GetField(m_field, strType) + " is NULL or " + GetField(m_field, strType) + parameter;
     }
@@ -966,111 +983,111 @@ CStdString CSmartPlaylistRule::GetWhereClause(const CDatabase &db, const CStdStr
       table = "albumview";
 
       if (m_field == FieldGenre)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT song.idAlbum FROM song, song_genre, genre WHERE song.idSong = song_genre.idSong AND song_genre.idGenre = genre.idGenre AND genre.strGenre" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "song JOIN song_genre ON song_genre.idSong = song.idSong JOIN genre ON genre.idGenre = song_genre.idGenre", "song.idAlbum", "genre.strGenre" + parameter);
       else if (m_field == FieldArtist)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT song.idAlbum FROM song, song_artist, artist WHERE song.idSong = song_artist.idSong AND song_artist.idArtist = artist.idArtist AND artist.strArtist" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "song JOIN song_artist ON song_artist.idSong = song.idSong JOIN artist ON artist.idArtist = song_artist.idArtist", "song.idAlbum", "artist.strArtist" + parameter);
       else if (m_field == FieldAlbumArtist)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT album_artist.idAlbum FROM album_artist, artist WHERE album_artist.idArtist = artist.idArtist AND artist.strArtist" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "album_artist JOIN artist ON artist.idArtist = album_artist.idArtist", "album_artist.idAlbum", "artist.strArtist" + parameter);
     }
     else if (strType == "artists")
     {
       table = "artistview";
 
       if (m_field == FieldGenre)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT song_artist.idArtist FROM song_artist, song_genre, genre WHERE song_artist.idSong = song_genre.idSong AND song_genre.idGenre = genre.idGenre AND genre.strGenre" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "song_artist JOIN song_genre ON song_genre.idSong = song_artist.idSong JOIN genre ON genre.idGenre = song_genre.idGenre", "song_artist.idArtist", "genre.strGenre" + parameter);
     }
     else if (strType == "movies")
     {
       table = "movieview";
 
       if (m_field == FieldGenre)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMovie FROM genrelinkmovie JOIN genre ON genre.idGenre=genrelinkmovie.idGenre WHERE genre.strGenre" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "genrelinkmovie JOIN genre ON genre.idGenre = genrelinkmovie.idGenre", "genrelinkmovie.idMovie", "genre.strGenre" + parameter);
       else if (m_field == FieldDirector)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMovie FROM directorlinkmovie JOIN actors ON actors.idActor=directorlinkmovie.idDirector WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "directorlinkmovie JOIN actors ON actors.idActor = directorlinkmovie.idDirector", "directorlinkmovie.idMovie", "actors.strActor" + parameter);
       else if (m_field == FieldActor)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMovie FROM actorlinkmovie JOIN actors ON actors.idActor=actorlinkmovie.idActor WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "actorlinkmovie JOIN actors ON actors.idActor = actorlinkmovie.idActor", "actorlinkmovie.idMovie", "actors.strActor" + parameter);
       else if (m_field == FieldWriter)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMovie FROM writerlinkmovie JOIN actors ON actors.idActor=writerlinkmovie.idWriter WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "writerlinkmovie JOIN actors ON actors.idActor = writerlinkmovie.idWriter", "writerlinkmovie.idMovie", "actors.strActor" + parameter);
       else if (m_field == FieldStudio)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMovie FROM studiolinkmovie JOIN studio ON studio.idStudio=studiolinkmovie.idStudio WHERE studio.strStudio" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "studiolinkmovie JOIN studio ON studio.idStudio = studiolinkmovie.idStudio", "studiolinkmovie.idMovie", "studio.strStudio" + parameter);
       else if (m_field == FieldCountry)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMovie FROM countrylinkmovie JOIN country ON country.idCountry=countrylinkmovie.idCountry WHERE country.strCountry" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "countrylinkmovie JOIN country ON country.idCountry = countrylinkmovie.idCountry", "countrylinkmovie.idMovie", "country.strCountry" + parameter);
       else if ((m_field == FieldLastPlayed || m_field == FieldDateAdded) && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
         query = GetField(m_field, strType) + " IS NULL OR " + GetField(m_field, strType) + parameter;
       else if (m_field == FieldTag)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMedia FROM taglinks JOIN tag ON tag.idTag = taglinks.idTag WHERE tag.strTag" + parameter + " AND taglinks.media_type = 'movie')";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "taglinks JOIN tag ON tag.idTag = taglinks.idTag", "taglinks.idMedia", "tag.strTag" + parameter + " AND taglinks.media_type = 'movie'");
     }
     else if (strType == "musicvideos")
     {
       table = "musicvideoview";
 
       if (m_field == FieldGenre)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMVideo FROM genrelinkmusicvideo JOIN genre ON genre.idGenre=genrelinkmusicvideo.idGenre WHERE genre.strGenre" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "genrelinkmusicvideo JOIN genre ON genre.idGenre = genrelinkmusicvideo.idGenre", "genrelinkmusicvideo.idMVideo", "genre.strGenre" + parameter);
       else if (m_field == FieldArtist)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMVideo FROM artistlinkmusicvideo JOIN actors ON actors.idActor=artistlinkmusicvideo.idArtist WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "artistlinkmusicvideo JOIN actors ON actors.idActor = artistlinkmusicvideo.idArtist", "artistlinkmusicvideo.idMVideo", "actors.strActor" + parameter);
       else if (m_field == FieldStudio)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMVideo FROM studiolinkmusicvideo JOIN studio ON studio.idStudio=studiolinkmusicvideo.idStudio WHERE studio.strStudio" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "studiolinkmusicvideo JOIN studio ON studio.idStudio = studiolinkmusicvideo.idStudio", "studiolinkmusicvideo.idMVideo", "studio.strStudio" + parameter);
       else if (m_field == FieldDirector)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMVideo FROM directorlinkmusicvideo JOIN actors ON actors.idActor=directorlinkmusicvideo.idDirector WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "directorlinkmusicvideo JOIN actors ON actors.idActor = directorlinkmusicvideo.idDirector", "directorlinkmusicvideo.idMVideo", "actors.strActor" + parameter);
       else if ((m_field == FieldLastPlayed || m_field == FieldDateAdded) && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
         query = GetField(m_field, strType) + " IS NULL OR " + GetField(m_field, strType) + parameter;
       else if (m_field == FieldTag)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMedia FROM taglinks JOIN tag ON tag.idTag = taglinks.idTag WHERE tag.strTag" + parameter + " AND taglinks.media_type = 'musicvideo')";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "taglinks JOIN tag ON tag.idTag = taglinks.idTag", "taglinks.idMedia", "tag.strTag" + parameter + " AND taglinks.media_type = 'musicvideo'");
     }
     else if (strType == "tvshows")
     {
       table = "tvshowview";
 
       if (m_field == FieldGenre)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idShow FROM genrelinktvshow JOIN genre ON genre.idGenre=genrelinktvshow.idGenre WHERE genre.strGenre" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "genrelinktvshow JOIN genre ON genre.idGenre = genrelinktvshow.idGenre", "genrelinktvshow.idShow", "genre.strGenre" + parameter);
       else if (m_field == FieldDirector)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idShow FROM directorlinktvshow JOIN actors ON actors.idActor=directorlinktvshow.idDirector WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "directorlinktvshow JOIN actors ON actors.idActor = directorlinktvshow.idDirector", "directorlinktvshow.idShow", "actors.strActor" + parameter);
       else if (m_field == FieldActor)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idShow FROM actorlinktvshow JOIN actors ON actors.idActor=actorlinktvshow.idActor WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "actorlinktvshow JOIN actors ON actors.idActor = actorlinktvshow.idActor", "actorlinktvshow.idShow", "actors.strActor" + parameter);
       else if (m_field == FieldStudio)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idShow FROM tvshowview WHERE " + GetField(m_field, strType) + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "tvshow", "tvshow.idShow", StringUtils::Format("tvshow.c%02d", VIDEODB_ID_TV_STUDIOS) + parameter);
       else if (m_field == FieldMPAA)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idShow FROM tvshowview WHERE " + GetField(m_field, strType) + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "tvshow", "tvshow.idShow", StringUtils::Format("tvshow.c%02d", VIDEODB_ID_TV_MPAA) + parameter);
       else if ((m_field == FieldLastPlayed || m_field == FieldDateAdded) && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
         query = GetField(m_field, strType) + " IS NULL OR " + GetField(m_field, strType) + parameter;
       else if (m_field == FieldPlaycount)
         query = "CASE WHEN COALESCE(" + GetField(FieldNumberOfEpisodes, strType) + " - " + GetField(FieldNumberOfWatchedEpisodes, strType) + ", 0) > 0 THEN 0 ELSE 1 END " + parameter;
       else if (m_field == FieldTag)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idMedia FROM taglinks JOIN tag ON tag.idTag = taglinks.idTag WHERE tag.strTag" + parameter + " AND taglinks.media_type = 'tvshow')";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "taglinks JOIN tag ON tag.idTag = taglinks.idTag", "taglinks.idMedia", "tag.strTag" + parameter + " AND taglinks.media_type = 'tvshow'");
     }
     else if (strType == "episodes")
     {
       table = "episodeview";
 
       if (m_field == FieldGenre)
-        query = table + ".idShow" + negate + " IN (SELECT idShow FROM genrelinktvshow JOIN genre ON genre.idGenre=genrelinktvshow.idGenre WHERE genre.strGenre" + parameter + ")";
+        query = FormatExistsQuery(negate, table + ".idShow", "genrelinktvshow JOIN genre ON genre.idGenre = genrelinktvshow.idGenre", "genrelinktvshow.idShow", "genre.strGenre" + parameter);
       else if (m_field == FieldDirector)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idEpisode FROM directorlinkepisode JOIN actors ON actors.idActor=directorlinkepisode.idDirector WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "directorlinkepisode JOIN actors ON actors.idActor = directorlinkepisode.idDirector", "directorlinkepisode.idEpisode", "actors.strActor" + parameter);
       else if (m_field == FieldActor)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idEpisode FROM actorlinkepisode JOIN actors ON actors.idActor=actorlinkepisode.idActor WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "actorlinkepisode JOIN actors ON actors.idActor = actorlinkepisode.idActor", "actorlinkepisode.idEpisode", "actors.strActor" + parameter);
       else if (m_field == FieldWriter)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idEpisode FROM writerlinkepisode JOIN actors ON actors.idActor=writerlinkepisode.idWriter WHERE actors.strActor" + parameter + ")";
+        query = FormatExistsQuery(negate, GetField(FieldId, strType), "writerlinkepisode JOIN actors ON actors.idActor = writerlinkepisode.idWriter", "writerlinkepisode.idEpisode", "actors.strActor" + parameter);
       else if ((m_field == FieldLastPlayed || m_field == FieldDateAdded) && (m_operator == OPERATOR_LESS_THAN || m_operator == OPERATOR_BEFORE || m_operator == OPERATOR_NOT_IN_THE_LAST))
         query = GetField(m_field, strType) + " IS NULL OR " + GetField(m_field, strType) + parameter;
       else if (m_field == FieldStudio)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idEpisode FROM episodeview WHERE strStudio" + parameter + ")";
+        query = FormatExistsQuery(negate, table + ".idShow", "tvshow", "tvshow.idShow", StringUtils::Format("tvshow.c%02d", VIDEODB_ID_TV_STUDIOS) + parameter);
       else if (m_field == FieldMPAA)
-        query = GetField(FieldId, strType) + negate + " IN (SELECT idEpisode FROM episodeview WHERE mpaa" + parameter + ")";
+        query = FormatExistsQuery(negate, table + ".idShow", "tvshow", "tvshow.idShow", StringUtils::Format("tvshow.c%02d", VIDEODB_ID_TV_MPAA) + parameter);
     }
     if (m_field == FieldVideoResolution)
-      query = table + ".idFile" + negate + GetVideoResolutionQuery(*it);
+      query = FormatExistsQuery(negate, table + ".idFile", "streamdetails", "streamdetails.idFile", GetVideoResolutionQuery(*it));
     else if (m_field == FieldAudioChannels)
-      query = table + ".idFile" + negate + " IN (SELECT DISTINCT idFile FROM streamdetails WHERE iAudioChannels " + parameter + ")";
+      query = FormatExistsQuery(negate, table + ".idFile", "streamdetails", "streamdetails.idFile", "iAudioChannels " + parameter);
     else if (m_field == FieldVideoCodec)
-      query = table + ".idFile" + negate + " IN (SELECT DISTINCT idFile FROM streamdetails WHERE strVideoCodec " + parameter + ")";
+      query = FormatExistsQuery(negate, table + ".idFile", "streamdetails", "streamdetails.idFile", "strVideoCodec " + parameter);
     else if (m_field == FieldAudioCodec)
-      query = table + ".idFile" + negate + " IN (SELECT DISTINCT idFile FROM streamdetails WHERE strAudioCodec " + parameter + ")";
+      query = FormatExistsQuery(negate, table + ".idFile", "streamdetails", "streamdetails.idFile", "strAudioCodec " + parameter);
     else if (m_field == FieldAudioLanguage)
-      query = table + ".idFile" + negate + " IN (SELECT DISTINCT idFile FROM streamdetails WHERE strAudioLanguage " + parameter + ")";
+      query = FormatExistsQuery(negate, table + ".idFile", "streamdetails", "streamdetails.idFile", "strAudioLanguage " + parameter);
     else if (m_field == FieldSubtitleLanguage)
-      query = table + ".idFile" + negate + " IN (SELECT DISTINCT idFile FROM streamdetails WHERE strSubtitleLanguage " + parameter + ")";
+      query = FormatExistsQuery(negate, table + ".idFile", "streamdetails", "streamdetails.idFile", "strSubtitleLanguage " + parameter);
     else if (m_field == FieldVideoAspectRatio)
-      query = table + ".idFile" + negate + " IN (SELECT DISTINCT idFile FROM streamdetails WHERE fVideoAspect " + parameter + ")";
+      query = FormatExistsQuery(negate, table + ".idFile", "streamdetails", "streamdetails.idFile", "fVideoAspect " + parameter);
     if (m_field == FieldPlaycount && strType != "songs" && strType != "albums" && strType != "tvshows")
     { // playcount IS stored as NULL OR number IN video db
       if ((m_operator == OPERATOR_EQUALS && it->Equals("0")) ||
@@ -0,0 +1,231 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "playlists/SmartPlayList.h"
+#include "FileItem.h"
+#include "dbwrappers/dataset.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+#include "video/VideoDatabase.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+#define MOVIE_COUNT 300
+
+/* A video library of MOVIE_COUNT movies in special://temp. Every third movie is an action movie,
+   every fifth one is tagged and every other one is 1080p. */
+class CTestVideoDatabase : public CVideoDatabase
+{
+public:
+  bool Create()
+  {
+    DatabaseSettings settings;
+    settings.type = "sqlite3";
+    settings.host = CSpecialProtocol::TranslatePath("special://temp/");
+    settings.name = "TestSmartPlayList";
+    if (!Update(settings))
+      return false;
+
+    BeginTransaction();
+    m_pDS->exec("INSERT INTO path (idPath, strPath) VALUES (1, '/movies/')");
+    m_pDS->exec("INSERT INTO genre (idGenre, strGenre) VALUES (1, 'Action')");
+    m_pDS->exec("INSERT INTO genre (idGenre, strGenre) VALUES (2, 'Drama')");
+    m_pDS->exec("INSERT INTO actors (idActor, strActor) VALUES (1, 'Some Actor')");
+    m_pDS->exec("INSERT INTO tag (idTag, strTag) VALUES (1, 'Favourite')");
+    for (int i = 1; i <= MOVIE_COUNT; i++)
+    {
+      m_pDS->exec(PrepareSQL("INSERT INTO files (idFile, idPath, strFilename) VALUES (%i, 1, 'movie%i.mkv')", i, i));
+      m_pDS->exec(PrepareSQL("INSERT INTO movie (idMovie, idFile, c%02d) VALUES (%i, %i, 'Movie %i')", VIDEODB_ID_TITLE, i, i, i));
+      m_pDS->exec(PrepareSQL("INSERT INTO genrelinkmovie (idGenre, idMovie) VALUES (%i, %i)", i % 3 == 0 ? 1 : 2, i));
+      m_pDS->exec(PrepareSQL("INSERT INTO actorlinkmovie (idActor, idMovie) VALUES (1, %i)", i));
+      m_pDS->exec(PrepareSQL("INSERT INTO streamdetails (idFile, iStreamType, iVideoWidth) VALUES (%i, 0, %i)", i, i % 2 ? 1920 : 720));
+      if (i % 5 == 0)
+        m_pDS->exec(PrepareSQL("INSERT INTO taglinks (idTag, idMedia, media_type) VALUES (1, %i, 'movie')", i));
+    }
+    CommitTransaction();
+    return true;
+  }
+
+  /*! \brief Close and remove the database, as Update() opens an existing one */
+  void Delete()
+  {
+    Close();
+    CFileItemList items;
+    XFILE::CDirectory::GetDirectory("special://temp/", items, ".db", XFILE::DIR_FLAG_NO_FILE_DIRS);
+    for (int i = 0; i < items.Size(); i++)
+    {
+      if (StringUtils::StartsWith(URIUtils::GetFileName(items[i]->GetPath()), "TestSmartPlayList"))
+        XFILE::CFile::Delete(items[i]->GetPath());
+    }
+  }
+
+  int Count(const std::string &where)
+  {
+    CStdString count = GetSingleValue(CStdString("SELECT COUNT(1) FROM movieview WHERE " + where));
+    return count.empty() ? -1 : atoi(count.c_str());
+  }
+
+  /*! \brief Number of rows of a full-text index matching a search */
+  int Search(const std::string &table, const std::string &columns, const std::string &search)
+  {
+    CStdString count = GetSingleValue(CStdString("SELECT COUNT(1) FROM " + table + " WHERE " + PrepareSearchMatch(table, columns, search)));
+    return count.empty() ? -1 : atoi(count.c_str());
+  }
+
+  void Exec(const std::string &sql)
+  {
+    m_pDS->exec(sql.c_str());
+  }
+
+  /*! \brief Tables the query plan of the movies matching a where clause reads in full */
+  std::vector<std::string> GetScannedTables(const std::string &where)
+  {
+    std::vector<std::string> tables;
+    if (!m_pDS->query(("EXPLAIN QUERY PLAN SELECT * FROM movieview WHERE " + where).c_str()))
+      return tables;
+    while (!m_pDS->eof())
+    {
+      // "SCAN TABLE movie" or "SCAN movie" in newer sqlite versions
+      std::vector<std::string> words = StringUtils::Split(m_pDS->fv("detail").get_asString(), " ");
+      if (words.size() > 1 && words[0] == "SCAN")
+        tables.push_back(words[1] == "TABLE" && words.size() > 2 ? words[2] : words[1]);
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return tables;
+  }
+};
+
+class TestSmartPlayList : public testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    m_db = new CTestVideoDatabase;
+    m_db->Delete(); // left by an earlier run
+    if (!m_db->Create())
+    {
+      delete m_db;
+      m_db = NULL;
+    }
+  }
+
+  static void TearDownTestCase()
+  {
+    if (m_db)
+      m_db->Delete();
+    delete m_db;
+    m_db = NULL;
+  }
+
+  std::string GetWhereClause(Field field, CSmartPlaylistRule::SEARCH_OPERATOR op, const std::string &parameter)
+  {
+    CSmartPlaylistRule rule;
+    rule.m_field = field;
+    rule.m_operator = op;
+    rule.SetParameter(parameter);
+    return rule.GetWhereClause(*m_db, "movies");
+  }
+
+  static CTestVideoDatabase *m_db;
+};
+
+CTestVideoDatabase *TestSmartPlayList::m_db = NULL;
+
+static bool Contains(const std::vector<std::string> &tables, const std::string &table)
+{
+  return std::find(tables.begin(), tables.end(), table) != tables.end();
+}
+
+TEST_F(TestSmartPlayList, LinkTables)
+{
+  ASSERT_TRUE(m_db != NULL);
+
+  std::string where = GetWhereClause(FieldGenre, CSmartPlaylistRule::OPERATOR_EQUALS, "Action");
+  EXPECT_EQ(MOVIE_COUNT / 3, m_db->Count(where));
+  EXPECT_FALSE(Contains(m_db->GetScannedTables(where), "genrelinkmovie"));
+
+  where = GetWhereClause(FieldGenre, CSmartPlaylistRule::OPERATOR_DOES_NOT_EQUAL, "Action");
+  EXPECT_EQ(MOVIE_COUNT - MOVIE_COUNT / 3, m_db->Count(where));
+  EXPECT_FALSE(Contains(m_db->GetScannedTables(where), "genrelinkmovie"));
+
+  where = GetWhereClause(FieldActor, CSmartPlaylistRule::OPERATOR_CONTAINS, "actor");
+  EXPECT_EQ(MOVIE_COUNT, m_db->Count(where));
+  EXPECT_FALSE(Contains(m_db->GetScannedTables(where), "actorlinkmovie"));
+
+  where = GetWhereClause(FieldTag, CSmartPlaylistRule::OPERATOR_EQUALS, "Favourite");
+  EXPECT_EQ(MOVIE_COUNT / 5, m_db->Count(where));
+  EXPECT_FALSE(Contains(m_db->GetScannedTables(where), "taglinks"));
+}
+
+TEST_F(TestSmartPlayList, StreamDetails)
+{
+  ASSERT_TRUE(m_db != NULL);
+
+  std::string where = GetWhereClause(FieldVideoResolution, CSmartPlaylistRule::OPERATOR_EQUALS, "1080");
+  EXPECT_EQ(MOVIE_COUNT / 2, m_db->Count(where));
+  EXPECT_FALSE(Contains(m_db->GetScannedTables(where), "streamdetails"));
+
+  where = GetWhereClause(FieldVideoResolution, CSmartPlaylistRule::OPERATOR_LESS_THAN, "720");
+  EXPECT_EQ(MOVIE_COUNT / 2, m_db->Count(where));
+  EXPECT_FALSE(Contains(m_db->GetScannedTables(where), "streamdetails"));
+}
+
+TEST_F(TestSmartPlayList, InProgress)
+{
+  ASSERT_TRUE(m_db != NULL);
+
+  std::string where = GetWhereClause(FieldInProgress, CSmartPlaylistRule::OPERATOR_FALSE, "");
+  EXPECT_EQ(MOVIE_COUNT, m_db->Count(where));
+  EXPECT_FALSE(Contains(m_db->GetScannedTables(where), "bookmark"));
+}
+
+TEST_F(TestSmartPlayList, SearchIndex)
+{
+  ASSERT_TRUE(m_db != NULL);
+  EXPECT_EQ(MOVIE_COUNT, m_db->Search("moviesearch", "strTitle, strPlot", "movie"));
+
+  // words are matched by their start
+  m_db->Exec(StringUtils::Format("INSERT INTO movie (idMovie, idFile, c%02d, c%02d) VALUES (1000, 1000, 'Zebra Crossing', 'A walrus')", VIDEODB_ID_TITLE, VIDEODB_ID_PLOT));
+  EXPECT_EQ(1, m_db->Search("moviesearch", "strTitle, strPlot", "zebra cross"));
+  EXPECT_EQ(1, m_db->Search("moviesearch", "strPlot", "walrus"));
+  EXPECT_EQ(0, m_db->Search("moviesearch", "strTitle", "walrus"));
+
+  m_db->Exec(StringUtils::Format("UPDATE movie SET c%02d='Yak Attack' WHERE idMovie=1000", VIDEODB_ID_TITLE));
+  EXPECT_EQ(0, m_db->Search("moviesearch", "strTitle, strPlot", "zebra"));
+  EXPECT_EQ(1, m_db->Search("moviesearch", "strTitle, strPlot", "yak"));
+  EXPECT_EQ(1, m_db->Search("moviesearch", "strPlot", "walrus"));
+
+  // columns that aren't indexed leave the index alone, the marker would be gone if it was rewritten
+  m_db->Exec("UPDATE moviesearch SET strTitle='Marker' WHERE docid=1000");
+  m_db->Exec(StringUtils::Format("UPDATE movie SET c%02d='8.5', idFile=1001 WHERE idMovie=1000", VIDEODB_ID_RATING));
+  EXPECT_EQ(1, m_db->Search("moviesearch", "strTitle", "marker"));
+
+  m_db->Exec("DELETE FROM movie WHERE idMovie=1000");
+  EXPECT_EQ(0, m_db->Search("moviesearch", "strTitle, strPlot", "marker"));
+  EXPECT_EQ(0, m_db->Search("moviesearch", "strTitle, strPlot", "walrus"));
+  EXPECT_EQ(MOVIE_COUNT, m_db->Search("moviesearch", "strTitle, strPlot", "movie"));
+}
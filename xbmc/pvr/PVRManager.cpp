@@ -38,6 +38,7 @@
 #include "windows/GUIWindowPVR.h"
 #include "utils/log.h"
 #include "utils/Stopwatch.h"
+#include "utils/StartupTimeline.h"
 #include "utils/StringUtils.h"
 #include "threads/Atomics.h"
 #include "windows/GUIWindowPVRCommon.h"
@@ -409,6 +410,7 @@ void CPVRManager::SetState(ManagerState state)
 void CPVRManager::Process(void)
 {
   /* load the pvr data from the db and clients if it's not already loaded */
+  CStartupSpan loadSpan("CPVRManager::Load");
   while (!Load() && GetState() == ManagerStateStarting)
   {
     CLog::Log(LOGERROR, "PVRManager - %s - failed to load PVR data, retrying", __FUNCTION__);
@@ -417,6 +419,7 @@ void CPVRManager::Process(void)
     Cleanup();
     Sleep(1000);
   }
+  loadSpan.End();
 
   if (GetState() == ManagerStateStarting)
     SetState(ManagerStateStarted);
@@ -647,13 +647,50 @@ bool CPVRChannel::ClearEPG() const
 
 bool CPVRChannel::GetEPGNow(CEpgInfoTag &tag) const
 {
-  CEpg *epg = GetEPG();
+  int iEpgId(-1);
+  {
+    CSingleLock lock(m_critSection);
+    if (!m_bIsHidden && m_bEPGEnabled && m_iEpgId > 0)
+      iEpgId = m_iEpgId;
+  }
+  if (iEpgId <= 0)
+    return false;
+
+  /* look it up in the index first, so the container and the table don't get locked */
+  CEpgInfoTagPtr now, next;
+  if (g_EpgContainer.GetNowNext(iEpgId, now, next))
+  {
+    if (!now)
+      return false;
+    tag = *now;
+    return true;
+  }
+
+  CEpg *epg = g_EpgContainer.GetById(iEpgId);
   return epg ? epg->InfoTagNow(tag) : false;
 }
 
 bool CPVRChannel::GetEPGNext(CEpgInfoTag &tag) const
 {
-  CEpg *epg = GetEPG();
+  int iEpgId(-1);
+  {
+    CSingleLock lock(m_critSection);
+    if (!m_bIsHidden && m_bEPGEnabled && m_iEpgId > 0)
+      iEpgId = m_iEpgId;
+  }
+  if (iEpgId <= 0)
+    return false;
+
+  CEpgInfoTagPtr now, next;
+  if (g_EpgContainer.GetNowNext(iEpgId, now, next))
+  {
+    if (!next)
+      return false;
+    tag = *next;
+    return true;
+  }
+
+  CEpg *epg = g_EpgContainer.GetById(iEpgId);
   return epg ? epg->InfoTagNext(tag) : false;
 }
 
@@ -1048,12 +1048,11 @@ int CPVRChannelGroup::GetEPGNow(CFileItemList &results)
   for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
   {
     CPVRChannelPtr channel = m_members.at(iChannelPtr).channel;
-    CEpg *epg = channel->GetEPG();
-    if (!epg || !epg->HasValidEntries() || m_members.at(iChannelPtr).channel->IsHidden())
+    if (channel->IsHidden())
       continue;
 
     CEpgInfoTag epgNow;
-    if (!epg->InfoTagNow(epgNow))
+    if (!channel->GetEPGNow(epgNow))
       continue;
 
     CFileItemPtr entry(new CFileItem(epgNow));
@@ -1074,12 +1073,11 @@ int CPVRChannelGroup::GetEPGNext(CFileItemList &results)
   for (unsigned int iChannelPtr = 0; iChannelPtr < m_members.size(); iChannelPtr++)
   {
     CPVRChannelPtr channel = m_members.at(iChannelPtr).channel;
-    CEpg *epg = channel->GetEPG();
-    if (!epg || !epg->HasValidEntries() || m_members.at(iChannelPtr).channel->IsHidden())
+    if (channel->IsHidden())
       continue;
 
     CEpgInfoTag epgNow;
-    if (!epg->InfoTagNext(epgNow))
+    if (!channel->GetEPGNext(epgNow))
       continue;
 
     CFileItemPtr entry(new CFileItem(epgNow));
@@ -125,6 +125,11 @@ namespace PVR
      */
     void UpdateMetadata(void);
 
+    /*!
+     * @brief Read the resume point and play count from the database again the next time UpdateMetadata() is called.
+     */
+    void ResetMetadata(void) { m_bGotMetaData = false; }
+
     /*!
      * @brief Update this tag with the contents of the given tag.
      * @param tag The new tag info.
@@ -36,7 +36,8 @@
 using namespace PVR;
 
 CPVRRecordings::CPVRRecordings(void) :
-    m_bIsUpdating(false)
+    m_bIsUpdating(false),
+    m_iChanged(0)
 {
 
 }
@@ -44,8 +45,37 @@ CPVRRecordings::CPVRRecordings(void) :
 void CPVRRecordings::UpdateFromClients(void)
 {
   CSingleLock lock(m_critSection);
-  Clear();
-  g_PVRClients->GetRecordings(this);
+  m_updated.clear();
+  m_iChanged = 0;
+  size_t iPrevious = m_recordings.size();
+
+  /* the clients call UpdateEntry() for each of their recordings, which applies them in place */
+  PVR_ERROR error = g_PVRClients->GetRecordings(this);
+  unsigned int iAdded = m_recordings.size() - iPrevious;
+
+  /* remove what the clients didn't return, unless one of them failed to return its list */
+  unsigned int iRemoved(0);
+  if (error == PVR_ERROR_NO_ERROR)
+  {
+    for (PVR_RECORDINGMAP_ITR it = m_recordings.begin(); it != m_recordings.end();)
+    {
+      if (m_updated.find(it->first) == m_updated.end())
+      {
+        delete it->second;
+        m_recordings.erase(it++);
+        iRemoved++;
+      }
+      else
+        it++;
+    }
+  }
+  m_updated.clear();
+
+  CLog::Log(LOGDEBUG, "CPVRRecordings - %s - %u recordings, %u added, %u removed, %u changed",
+      __FUNCTION__, (unsigned int)m_recordings.size(), iAdded, iRemoved, m_iChanged);
+
+  if (iAdded > 0 || iRemoved > 0 || m_iChanged > 0)
+    SetChanged();
 }
 
 CStdString CPVRRecordings::TrimSlashes(const CStdString &strOrig) const
@@ -95,9 +125,9 @@ bool CPVRRecordings::IsDirectoryMember(const CStdString &strDirectory, const CSt
 
 void CPVRRecordings::GetContents(const CStdString &strDirectory, CFileItemList *results)
 {
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  for (PVR_RECORDINGMAP_CITR it = m_recordings.begin(); it != m_recordings.end(); it++)
   {
-    CPVRRecording *current = m_recordings.at(iRecordingPtr);
+    CPVRRecording *current = it->second;
     bool directMember = !HasAllRecordingsPathExtension(strDirectory);
     if (!IsDirectoryMember(RemoveAllRecordingsPathExtension(strDirectory), current->m_strDirectory, directMember))
       continue;
@@ -129,9 +159,9 @@ void CPVRRecordings::GetSubDirectories(const CStdString &strBase, CFileItemList
 
   std::set<CStdString> unwatchedFolders;
 
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  for (PVR_RECORDINGMAP_CITR it = m_recordings.begin(); it != m_recordings.end(); it++)
   {
-    CPVRRecording *current = m_recordings.at(iRecordingPtr);
+    CPVRRecording *current = it->second;
     const CStdString strCurrent = GetDirectoryFromPath(current->m_strDirectory, strUseBase);
     if (strCurrent.IsEmpty())
       continue;
@@ -281,9 +311,9 @@ void CPVRRecordings::Update(void)
 
   lock.Enter();
   m_bIsUpdating = false;
-  SetChanged();
   lock.Leave();
 
+  /* only sent when a recording was added, removed or changed, so the windows keep their lists otherwise */
   NotifyObservers(ObservableMessageRecordings);
 }
 
@@ -297,9 +327,9 @@ int CPVRRecordings::GetRecordings(CFileItemList* results)
 {
   CSingleLock lock(m_critSection);
 
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  for (PVR_RECORDINGMAP_CITR it = m_recordings.begin(); it != m_recordings.end(); it++)
   {
-    CFileItemPtr pFileItem(new CFileItem(*m_recordings.at(iRecordingPtr)));
+    CFileItemPtr pFileItem(new CFileItem(*it->second));
     results->Add(pFileItem);
   }
 
@@ -377,6 +407,7 @@ bool CPVRRecordings::SetRecordingsPlayCount(const CFileItemPtr &item, int count)
       }
 
       database.SetPlayCount(*pItem, count);
+      ResetMetadata(*pItem->GetPVRRecordingInfoTag());
     }
 
     database.Close();
@@ -414,23 +445,25 @@ void CPVRRecordings::SetPlayCount(const CFileItem &item, int iPlayCount)
 
   const CPVRRecording *recording = item.GetPVRRecordingInfoTag();
   CSingleLock lock(m_critSection);
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
-  {
-    CPVRRecording *current = m_recordings.at(iRecordingPtr);
-    if (current->m_iClientId == recording->m_iClientId && current->m_strRecordingId.Equals(recording->m_strRecordingId))
-    {
-      current->SetPlayCount(iPlayCount);
-      break;
-    }
-  }
+  PVR_RECORDINGMAP_ITR it = m_recordings.find(CPVRRecordingKey(recording->m_iClientId, recording->m_strRecordingId));
+  if (it != m_recordings.end())
+    it->second->SetPlayCount(iPlayCount);
+}
+
+void CPVRRecordings::ResetMetadata(const CPVRRecording &recording)
+{
+  CSingleLock lock(m_critSection);
+  PVR_RECORDINGMAP_ITR it = m_recordings.find(CPVRRecordingKey(recording.m_iClientId, recording.m_strRecordingId));
+  if (it != m_recordings.end())
+    it->second->ResetMetadata();
 }
 
 void CPVRRecordings::GetAll(CFileItemList &items)
 {
   CSingleLock lock(m_critSection);
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  for (PVR_RECORDINGMAP_CITR it = m_recordings.begin(); it != m_recordings.end(); it++)
   {
-    CPVRRecording *current = m_recordings.at(iRecordingPtr);
+    CPVRRecording *current = it->second;
     current->UpdateMetadata();
 
     CFileItemPtr pFileItem(new CFileItem(*current));
@@ -453,11 +486,11 @@ CFileItemPtr CPVRRecordings::GetByPath(const CStdString &path)
 
   if (fileName.Left(11) == "recordings/")
   {
-    for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+    for (PVR_RECORDINGMAP_CITR it = m_recordings.begin(); it != m_recordings.end(); it++)
     {
-      if(path.Equals(m_recordings.at(iRecordingPtr)->m_strFileNameAndPath))
+      if(path.Equals(it->second->m_strFileNameAndPath))
       {
-        CFileItemPtr fileItem(new CFileItem(*m_recordings.at(iRecordingPtr)));
+        CFileItemPtr fileItem(new CFileItem(*it->second));
         return fileItem;
       }
     }
@@ -471,32 +504,37 @@ void CPVRRecordings::Clear()
 {
   CSingleLock lock(m_critSection);
 
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
-    delete m_recordings.at(iRecordingPtr);
-  m_recordings.erase(m_recordings.begin(), m_recordings.end());
+  for (PVR_RECORDINGMAP_ITR it = m_recordings.begin(); it != m_recordings.end(); it++)
+    delete it->second;
+  m_recordings.clear();
 }
 
 void CPVRRecordings::UpdateEntry(const CPVRRecording &tag)
 {
-  bool bFound = false;
   CSingleLock lock(m_critSection);
+  CPVRRecordingKey key(tag.m_iClientId, tag.m_strRecordingId);
+  if (m_bIsUpdating)
+    m_updated.insert(key);
 
-  for (unsigned int iRecordingPtr = 0; iRecordingPtr < m_recordings.size(); iRecordingPtr++)
+  PVR_RECORDINGMAP_ITR it = m_recordings.find(key);
+  if (it == m_recordings.end())
   {
-    CPVRRecording *currentTag = m_recordings.at(iRecordingPtr);
-    if (currentTag->m_iClientId == tag.m_iClientId &&
-        currentTag->m_strRecordingId.Equals(tag.m_strRecordingId))
-    {
-      currentTag->Update(tag);
-      bFound = true;
-      break;
-    }
+    CPVRRecording *newTag = new CPVRRecording();
+    newTag->Update(tag);
+    m_recordings.insert(std::make_pair(key, newTag));
+    return;
   }
 
-  if (!bFound)
+  /* apply the update to a copy first, as Update() rewrites some of the values. unchanged
+     recordings are left alone, keeping the play count and resume point read from the database */
+  CPVRRecording *currentTag = it->second;
+  CPVRRecording updatedTag(*currentTag);
+  updatedTag.Update(tag);
+  if (updatedTag != *currentTag ||
+      updatedTag.m_playCount != currentTag->m_playCount ||
+      updatedTag.m_resumePoint.timeInSeconds != currentTag->m_resumePoint.timeInSeconds)
   {
-    CPVRRecording *newTag = new CPVRRecording();
-    newTag->Update(tag);
-    m_recordings.push_back(newTag);
+    currentTag->Update(tag);
+    m_iChanged++;
   }
 }
@@ -25,16 +25,27 @@
 #include "utils/Observer.h"
 #include "video/VideoThumbLoader.h"
 
+#include <map>
+#include <set>
+
 #define PVR_ALL_RECORDINGS_PATH_EXTENSION "-1"
 
 namespace PVR
 {
+  /* recordings are identified by the id of their client and their id on that client */
+  typedef std::pair<int, CStdString>                  CPVRRecordingKey;
+  typedef std::map<CPVRRecordingKey, CPVRRecording *> PVR_RECORDINGMAP;
+  typedef PVR_RECORDINGMAP::iterator                  PVR_RECORDINGMAP_ITR;
+  typedef PVR_RECORDINGMAP::const_iterator            PVR_RECORDINGMAP_CITR;
+
   class CPVRRecordings : public Observable
   {
   private:
     CCriticalSection             m_critSection;
     bool                         m_bIsUpdating;
-    std::vector<CPVRRecording *> m_recordings;
+    PVR_RECORDINGMAP             m_recordings;
+    std::set<CPVRRecordingKey>   m_updated;   /*!< the recordings the clients returned during the running update */
+    unsigned int                 m_iChanged;  /*!< the number of recordings that changed during the running update */
 
     virtual void UpdateFromClients(void);
     virtual CStdString TrimSlashes(const CStdString &strOrig) const;
@@ -58,6 +69,9 @@ namespace PVR
 
     /**
      * @brief refresh the recordings list from the clients.
+     *
+     * Recordings are added, removed and updated in place, observers are only notified when
+     * anything changed.
      */
     void Update(void);
 
@@ -70,6 +84,11 @@ namespace PVR
     bool GetDirectory(const CStdString& strPath, CFileItemList &items);
     CFileItemPtr GetByPath(const CStdString &path);
     void SetPlayCount(const CFileItem &item, int iPlayCount);
+
+    /**
+     * @brief drop the cached play count and resume point of a recording after they were changed in the database.
+     */
+    void ResetMetadata(const CPVRRecording &recording);
     void GetAll(CFileItemList &items);
 
     bool HasAllRecordingsPathExtension(const CStdString &strDirectory);
@@ -257,6 +257,7 @@ void CAdvancedSettings::Initialize()
   m_fanartRes = 1080;
   m_imageRes = 720;
   m_useDDSFanart = false;
+  m_bgInfoLoaderMaxThreads = 4;
 
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
@@ -371,8 +372,21 @@ void CAdvancedSettings::Initialize()
   m_iPVRNumericChannelSwitchTimeout = 1000;
 
   m_measureRefreshrate = false;
+  m_databaseWAL = true;
 
   m_cacheMemBufferSize = 1024 * 1024 * 20;
+  m_cachePersistentSize = 0;
+  m_curlParallelRanges = 0;
+  m_curlRangeChunkSize = 1024 * 1024;
+  m_nfsReadAheadDepth = 0;
+  m_statCacheTTL.clear();
+  m_statCacheTTL["smb"] = 10;
+  m_statCacheTTL["nfs"] = 10;
+  m_statCacheTTL["ftp"] = 30;
+  m_statCacheTTL["ftps"] = 30;
+  m_statCacheTTL["dav"] = 30;
+  m_statCacheTTL["davs"] = 30;
+  m_statCacheSize = 5000;
   m_alwaysForceBuffer = false;
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
@@ -388,6 +402,9 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  m_guiSkinCache = true;
+  m_startupTrace = false;
+  m_playbackTrace = false;
   m_logEnableAirtunes = false;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
@@ -403,6 +420,7 @@ void CAdvancedSettings::Initialize()
   m_musicExtensions += "|.sidstream|.oggstream|.nsfstream|.asapstream|.cdda";
   // internal video extensions
   m_videoExtensions += "|.pvr";
+  UpdateMediaExtensions();
 
   m_stereoscopicflags_sbs = "3DSBS|3D.SBS|HSBS|H.SBS|H-SBS| SBS |FULL-SBS|FULL.SBS|FULLSBS|FSBS|HALF-SBS";
   m_stereoscopicflags_tab = "3DTAB|3D.TAB|HTAB|H.TAB|3DOU|3D.OU|3D.HOU| HOU | OU |HALF-TAB";
@@ -798,9 +816,32 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
+    XMLUtils::GetUInt(pElement, "curlparallelranges", m_curlParallelRanges, 0, 16);
+    XMLUtils::GetUInt(pElement, "curlrangechunksize", m_curlRangeChunkSize, 64 * 1024, 16 * 1024 * 1024);
+    XMLUtils::GetUInt(pElement, "nfsreadahead", m_nfsReadAheadDepth, 0, 32);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
+    double persistentSize;
+    if (XMLUtils::GetDouble(pElement, "cachepersistentsize", persistentSize) && persistentSize >= 0)
+      m_cachePersistentSize = (uint64_t)persistentSize;
     XMLUtils::GetBoolean(pElement, "alwaysforcebuffer", m_alwaysForceBuffer);
     XMLUtils::GetFloat(pElement, "readbufferfactor", m_readBufferFactor);
+    XMLUtils::GetUInt(pElement, "statcachesize", m_statCacheSize, 1, 1000000);
+
+    // <statcache><smb>10</smb></statcache> keeps results for smb:// paths for 10 seconds, 0 disables it
+    TiXmlElement *pStatCache = pElement->FirstChildElement("statcache");
+    if (pStatCache)
+    {
+      for (TiXmlElement *pProtocol = pStatCache->FirstChildElement(); pProtocol; pProtocol = pProtocol->NextSiblingElement())
+      {
+        std::string protocol = pProtocol->Value();
+        unsigned int ttl;
+        if (XMLUtils::GetUInt(pStatCache, protocol.c_str(), ttl, 0, 3600))
+        {
+          StringUtils::ToLower(protocol);
+          m_statCacheTTL[protocol] = ttl;
+        }
+      }
+    }
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -852,6 +893,8 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetInt(pRootElement,     "airplayport", m_airPlayPort);  
 
   XMLUtils::GetBoolean(pRootElement, "handlemounting", m_handleMounting);
+  XMLUtils::GetBoolean(pRootElement, "startuptrace", m_startupTrace);
+  XMLUtils::GetBoolean(pRootElement, "playbacktrace", m_playbackTrace);
 
 #if defined(HAS_SDL) || defined(TARGET_WINDOWS)
   XMLUtils::GetBoolean(pRootElement, "fullscreen", m_startFullScreen);
@@ -955,6 +998,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   // Add the list of disc stub extensions (if any) to the list of video extensions
   if (!m_discStubExtensions.IsEmpty())
     m_videoExtensions += "|" + m_discStubExtensions;
+  UpdateMediaExtensions();
 
   m_vecTokens.clear();
   CLangInfo::LoadTokens(pRootElement->FirstChild("sorttokens"),m_vecTokens);
@@ -1039,6 +1083,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetUInt(pRootElement, "fanartres", m_fanartRes, 0, 1080);
   XMLUtils::GetUInt(pRootElement, "imageres", m_imageRes, 0, 1080);
   XMLUtils::GetBoolean(pRootElement, "useddsfanart", m_useDDSFanart);
+  XMLUtils::GetInt(pRootElement, "bginfoloadermaxthreads", m_bgInfoLoaderMaxThreads, 1, 16);
 
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", m_detectAsUdf);
@@ -1103,6 +1148,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   }
 
   XMLUtils::GetBoolean(pRootElement, "measurerefreshrate", m_measureRefreshrate);
+  XMLUtils::GetBoolean(pRootElement, "sqlitewal", m_databaseWAL);
 
   TiXmlElement* pDatabase = pRootElement->FirstChildElement("videodatabase");
   if (pDatabase)
@@ -1161,6 +1207,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetBoolean(pElement, "skincache",             m_guiSkinCache);
   }
 
   // load in the settings overrides
@@ -1183,6 +1230,7 @@ void CAdvancedSettings::Clear()
   m_musicExtensions.clear();
   m_videoExtensions.clear();
   m_discStubExtensions.clear();
+  m_mediaExtensions.Clear();
 
   m_logFolder.clear();
   m_userAgent.clear();
@@ -1304,6 +1352,16 @@ void CAdvancedSettings::GetCustomExtensions(TiXmlElement *pRootElement, CStdStri
   }
 }
 
+void CAdvancedSettings::UpdateMediaExtensions()
+{
+  m_mediaExtensions.Clear();
+  m_mediaExtensions.Add(m_videoExtensions, MEDIA_EXTENSION_VIDEO);
+  m_mediaExtensions.Add(m_musicExtensions, MEDIA_EXTENSION_MUSIC);
+  m_mediaExtensions.Add(m_pictureExtensions, MEDIA_EXTENSION_PICTURE);
+  m_mediaExtensions.Add(".tbn|.dds", MEDIA_EXTENSION_THUMB);
+  m_mediaExtensions.Add(m_discStubExtensions, MEDIA_EXTENSION_DISCSTUB);
+}
+
 void CAdvancedSettings::AddSettingsFile(const CStdString &filename)
 {
   m_settingsFiles.push_back(filename);
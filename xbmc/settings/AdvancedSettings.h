@@ -19,12 +19,14 @@
  *
  */
 
+#include <map>
 #include <vector>
 
 #include "settings/ISettingCallback.h"
 #include "settings/ISettingsHandler.h"
 #include "utils/StdString.h"
 #include "utils/GlobalsHandling.h"
+#include "utils/FileExtensions.h"
 
 class TiXmlElement;
 namespace ADDON
@@ -98,6 +100,16 @@ struct StagefrightConfig
 
 typedef std::vector<TVShowRegexp> SETTINGS_TVSHOWLIST;
 
+/*! \brief Types of the extensions in CAdvancedSettings::m_mediaExtensions */
+enum MEDIA_EXTENSION_TYPE
+{
+  MEDIA_EXTENSION_VIDEO    = 0x01,
+  MEDIA_EXTENSION_MUSIC    = 0x02,
+  MEDIA_EXTENSION_PICTURE  = 0x04,
+  MEDIA_EXTENSION_THUMB    = 0x08, ///< .tbn and .dds, pictures that aren't in m_pictureExtensions
+  MEDIA_EXTENSION_DISCSTUB = 0x10
+};
+
 class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 {
   public:
@@ -243,6 +255,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
      */
     unsigned int GetThumbSize() const { return m_imageRes / 2; };
     bool m_useDDSFanart;
+    int m_bgInfoLoaderMaxThreads; ///< \brief the number of threads loading the info of items, for loaders that can use more than one
 
     int m_sambaclienttimeout;
     CStdString m_sambadoscodepage;
@@ -366,15 +379,25 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 
     DatabaseSettings m_databaseMusic; // advanced music database setup
     DatabaseSettings m_databaseVideo; // advanced video database setup
+    bool m_databaseWAL; ///< use write-ahead logging for local sqlite databases
     DatabaseSettings m_databaseTV;    // advanced tv database setup
     DatabaseSettings m_databaseEpg;   /*!< advanced EPG database setup */
 
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    bool m_guiSkinCache; ///< keep windows with resolved includes in a compiled cache
+    bool m_startupTrace; ///< write the startup timeline as a Chrome trace once the first frame is shown
+    bool m_playbackTrace; ///< trace the playback threads and save the trace when the player stops
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
+    uint64_t m_cachePersistentSize; ///< bytes of downloaded data kept on disk across sessions, 0 disables
+    unsigned int m_curlParallelRanges;
+    unsigned int m_curlRangeChunkSize;
+    unsigned int m_nfsReadAheadDepth;
+    std::map<std::string, unsigned int> m_statCacheTTL; ///< seconds exists and stat results are kept, by protocol
+    unsigned int m_statCacheSize; ///< paths kept at most
     bool m_alwaysForceBuffer;
     float m_readBufferFactor;
 
@@ -384,6 +407,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_enableMultimediaKeys;
     std::vector<CStdString> m_settingsFiles;
     void ParseSettingsFile(const CStdString &file);
+    void UpdateMediaExtensions();
 
     float GetDisplayLatency(float refreshrate);
     bool m_initialized;
@@ -396,6 +420,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     CStdString m_musicExtensions;
     CStdString m_videoExtensions;
     CStdString m_discStubExtensions;
+    CFileExtensions m_mediaExtensions; ///< all of the above by type, rebuilt whenever they change
 
     CStdString m_stereoscopicflags_sbs;
     CStdString m_stereoscopicflags_tab;
@@ -25,6 +25,7 @@
 #include "threads/ThreadLocal.h"
 #include "threads/SingleLock.h"
 #include "commons/Exception.h"
+#include "utils/PlaybackTrace.h"
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -129,6 +130,9 @@ THREADFUNC CThread::staticThread(void* data)
 
   pThread->Action();
 
+  // hand the trace ring back for the threads to come
+  CPlaybackTrace::ReleaseThread();
+
   // lock during termination
   CSingleLock lock(pThread->m_CriticalSection);
 
@@ -24,6 +24,7 @@
 #include "LangInfo.h"
 #include "guilib/LocalizeStrings.h"
 #include "settings/Setting.h"
+#include "threads/Atomics.h"
 #include "threads/SingleLock.h"
 #include "log.h"
 
@@ -37,6 +38,8 @@
   #define WCHAR_CHARSET "UTF-32LE"
 #endif
   #define UTF8_SOURCE "UTF-8-MAC"
+  // UTF-8-MAC also composes decomposed sequences, so only ASCII skips iconv
+  #define UTF8_SOURCE_COMPOSES
 #elif defined(TARGET_WINDOWS)
   #define WCHAR_CHARSET "UTF-16LE"
   #define UTF8_SOURCE "UTF-8"
@@ -55,18 +58,37 @@
 #endif
 
 
-static iconv_t m_iconvStringCharsetToFontCharset = (iconv_t)-1;
-static iconv_t m_iconvSubtitleCharsetToW         = (iconv_t)-1;
-static iconv_t m_iconvUtf8ToStringCharset        = (iconv_t)-1;
-static iconv_t m_iconvStringCharsetToUtf8        = (iconv_t)-1;
-static iconv_t m_iconvUcs2CharsetToStringCharset = (iconv_t)-1;
-static iconv_t m_iconvUtf32ToStringCharset       = (iconv_t)-1;
-static iconv_t m_iconvWtoUtf8                    = (iconv_t)-1;
-static iconv_t m_iconvUtf16LEtoW                 = (iconv_t)-1;
-static iconv_t m_iconvUtf16BEtoUtf8              = (iconv_t)-1;
-static iconv_t m_iconvUtf16LEtoUtf8              = (iconv_t)-1;
-static iconv_t m_iconvUtf8toW                    = (iconv_t)-1;
-static iconv_t m_iconvUcs2CharsetToUtf8          = (iconv_t)-1;
+enum ConverterType
+{
+  Utf8ToStringCharset = 0,
+  StringCharsetToUtf8,
+  Ucs2CharsetToStringCharset,
+  SubtitleCharsetToW,
+  WtoUtf8,
+  Utf16BEtoUtf8,
+  Utf16LEtoUtf8,
+  Utf16LEtoW,
+  Utf32ToStringCharset,
+  Utf8toW,
+  Ucs2CharsetToUtf8,
+  NumberOfConverters
+};
+
+/* An iconv_t can only be used by one thread at a time. Instead of serializing
+   every conversion on a single set of handles, a converting thread claims one
+   of a few handle sets for the duration of the call. reset() bumps the
+   generation, which makes a set close its handles the next time it's claimed. */
+#define ICONV_SETS 8
+
+struct SIconvSet
+{
+  volatile long busy;
+  long          generation;
+  iconv_t       handles[NumberOfConverters];
+};
+
+static SIconvSet     g_iconvSets[ICONV_SETS];
+static volatile long g_iconvGeneration = 1;
 
 #if defined(FRIBIDI_CHAR_SET_NOT_FOUND)
 static FriBidiCharSet m_stringFribidiCharset     = FRIBIDI_CHAR_SET_NOT_FOUND;
@@ -273,6 +295,383 @@ static void convert(iconv_t& type, int multiplier, const CStdString& strFromChar
     strDest = strSource;
 }
 
+/* Claims an iconv handle set for the lifetime of the object. When all shared
+   sets are busy the conversion uses private handles that are closed afterwards. */
+class CIconvLease
+{
+public:
+  CIconvLease() : m_set(NULL)
+  {
+    for (int i = 0; i < ICONV_SETS && !m_set; i++)
+    {
+      if (cas(&g_iconvSets[i].busy, 0, 1) == 0)
+        m_set = &g_iconvSets[i];
+    }
+    if (!m_set)
+    {
+      m_private.generation = 0;
+      m_set = &m_private;
+    }
+
+    long generation = g_iconvGeneration;
+    if (m_set->generation != generation)
+    {
+      for (int i = 0; i < NumberOfConverters; i++)
+      {
+        if (m_set->generation != 0)
+          ICONV_SAFE_CLOSE(m_set->handles[i]);
+        ICONV_PREPARE(m_set->handles[i]);
+      }
+      m_set->generation = generation;
+    }
+  }
+
+  ~CIconvLease()
+  {
+    if (m_set == &m_private)
+    {
+      for (int i = 0; i < NumberOfConverters; i++)
+        ICONV_SAFE_CLOSE(m_private.handles[i]);
+    }
+    else
+      AtomicDecrement(&m_set->busy);
+  }
+
+  iconv_t& operator[](ConverterType type) { return m_set->handles[type]; }
+
+private:
+  SIconvSet *m_set;
+  SIconvSet  m_private;
+};
+
+/* Native conversions between the unicode encodings. These match what
+   convert_checked() produces with iconv: invalid UTF-8 bytes are skipped one
+   at a time and the output ends at the first NUL. Invalid UTF-16/UTF-32 code
+   units are skipped as a whole. */
+
+static inline bool IsAscii(const char *str, size_t len)
+{
+  const char *end = str + len;
+  for (; str + sizeof(uint64_t) <= end; str += sizeof(uint64_t))
+  {
+    uint64_t word;
+    memcpy(&word, str, sizeof(word));
+    if (word & 0x8080808080808080ULL)
+      return false;
+  }
+  for (; str < end; str++)
+  {
+    if (*str & 0x80)
+      return false;
+  }
+  return true;
+}
+
+// returns the length of the sequence or 0 if it isn't valid UTF-8
+static inline size_t DecodeUtf8(const unsigned char *str, const unsigned char *end, uint32_t &cp)
+{
+  unsigned char c = *str;
+  size_t   len;
+  uint32_t min;
+  if (c < 0x80)
+  {
+    cp = c;
+    return 1;
+  }
+  else if ((c & 0xe0) == 0xc0)
+  {
+    len = 2; min = 0x80; cp = c & 0x1f;
+  }
+  else if ((c & 0xf0) == 0xe0)
+  {
+    len = 3; min = 0x800; cp = c & 0x0f;
+  }
+  else if ((c & 0xf8) == 0xf0)
+  {
+    len = 4; min = 0x10000; cp = c & 0x07;
+  }
+  else
+    return 0;
+
+  if ((size_t)(end - str) < len)
+    return 0;
+
+  for (size_t i = 1; i < len; i++)
+  {
+    if ((str[i] & 0xc0) != 0x80)
+      return 0;
+    cp = (cp << 6) | (str[i] & 0x3f);
+  }
+
+  // overlong forms, surrogates and anything beyond unicode
+  if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))
+    return 0;
+  return len;
+}
+
+static inline size_t EncodeUtf8(uint32_t cp, char *out)
+{
+  if (cp < 0x80)
+  {
+    out[0] = (char)cp;
+    return 1;
+  }
+  else if (cp < 0x800)
+  {
+    out[0] = (char)(0xc0 | (cp >> 6));
+    out[1] = (char)(0x80 | (cp & 0x3f));
+    return 2;
+  }
+  else if (cp < 0x10000)
+  {
+    out[0] = (char)(0xe0 | (cp >> 12));
+    out[1] = (char)(0x80 | ((cp >> 6) & 0x3f));
+    out[2] = (char)(0x80 | (cp & 0x3f));
+    return 3;
+  }
+  out[0] = (char)(0xf0 | (cp >> 18));
+  out[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+  out[2] = (char)(0x80 | ((cp >> 6) & 0x3f));
+  out[3] = (char)(0x80 | (cp & 0x3f));
+  return 4;
+}
+
+// code units of explicit byte order, independent of the host byte order
+static inline uint16_t ToUnit16(uint32_t value, bool bigEndian)
+{
+  uint16_t unit;
+  unsigned char *b = (unsigned char *)&unit;
+  b[bigEndian ? 0 : 1] = (unsigned char)(value >> 8);
+  b[bigEndian ? 1 : 0] = (unsigned char)value;
+  return unit;
+}
+
+static inline uint32_t FromUnit16(uint16_t unit, bool bigEndian)
+{
+  const unsigned char *b = (const unsigned char *)&unit;
+  return bigEndian ? (b[0] << 8) | b[1] : (b[1] << 8) | b[0];
+}
+
+static inline uint32_t ToUnit32(uint32_t value, bool bigEndian)
+{
+  uint32_t unit;
+  unsigned char *b = (unsigned char *)&unit;
+  for (int i = 0; i < 4; i++)
+    b[bigEndian ? 3 - i : i] = (unsigned char)(value >> (8 * i));
+  return unit;
+}
+
+struct SWideWriter
+{
+  size_t operator()(uint32_t cp, wchar_t *out) const
+  {
+    if (sizeof(wchar_t) == 2 && cp >= 0x10000)
+    {
+      out[0] = (wchar_t)(0xd800 + ((cp - 0x10000) >> 10));
+      out[1] = (wchar_t)(0xdc00 + (cp & 0x3ff));
+      return 2;
+    }
+    out[0] = (wchar_t)cp;
+    return 1;
+  }
+};
+
+struct SUtf16Writer
+{
+  SUtf16Writer(bool bigEndian) : bigEndian(bigEndian) {}
+  size_t operator()(uint32_t cp, uint16_t *out) const
+  {
+    if (cp >= 0x10000)
+    {
+      out[0] = ToUnit16(0xd800 + ((cp - 0x10000) >> 10), bigEndian);
+      out[1] = ToUnit16(0xdc00 + (cp & 0x3ff), bigEndian);
+      return 2;
+    }
+    out[0] = ToUnit16(cp, bigEndian);
+    return 1;
+  }
+  bool bigEndian;
+};
+
+struct SUtf32Writer
+{
+  SUtf32Writer(bool bigEndian) : bigEndian(bigEndian) {}
+  size_t operator()(uint32_t cp, uint32_t *out) const
+  {
+    out[0] = ToUnit32(cp, bigEndian);
+    return 1;
+  }
+  bool bigEndian;
+};
+
+// a UTF-8 sequence never yields more code units than it has bytes
+template<class CHAR, class WRITER>
+static void Utf8ToUnicode(const CStdStringA& strSource, CStdStr<CHAR>& strDest, const WRITER& write)
+{
+  if (strSource.empty())
+  {
+    strDest.clear();
+    return;
+  }
+
+  const unsigned char *str = (const unsigned char *)strSource.c_str();
+  const unsigned char *end = str + strSource.length();
+  CHAR *out = strDest.GetBuffer(strSource.length());
+  size_t len = 0;
+  while (str < end)
+  {
+    uint32_t cp = *str;
+    if (cp < 0x80)
+      str++;
+    else
+    {
+      size_t seq = DecodeUtf8(str, end, cp);
+      if (!seq)
+      {
+        str++;
+        continue;
+      }
+      str += seq;
+    }
+    if (cp == 0)
+      break;
+    len += write(cp, out + len);
+  }
+  strDest.ReleaseBuffer(len);
+}
+
+struct SWideReader
+{
+  size_t operator()(const wchar_t *str, const wchar_t *end, uint32_t &cp) const
+  {
+    cp = (uint32_t)str[0];
+    if (sizeof(wchar_t) == 2 && cp >= 0xd800 && cp <= 0xdfff)
+    {
+      if (cp >= 0xdc00 || str + 1 >= end)
+        return 0;
+      uint32_t low = (uint32_t)str[1];
+      if (low < 0xdc00 || low > 0xdfff)
+        return 0;
+      cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+      return 2;
+    }
+    if (cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))
+      return 0;
+    return 1;
+  }
+};
+
+struct SUtf16Reader
+{
+  SUtf16Reader(bool bigEndian) : bigEndian(bigEndian) {}
+  size_t operator()(const uint16_t *str, const uint16_t *end, uint32_t &cp) const
+  {
+    cp = FromUnit16(str[0], bigEndian);
+    if (cp < 0xd800 || cp > 0xdfff)
+      return 1;
+    if (cp >= 0xdc00 || str + 1 >= end)
+      return 0;
+    uint32_t low = FromUnit16(str[1], bigEndian);
+    if (low < 0xdc00 || low > 0xdfff)
+      return 0;
+    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+    return 2;
+  }
+  bool bigEndian;
+};
+
+// a code unit never takes more than 4 bytes of UTF-8
+template<class CHAR, class READER>
+static void UnicodeToUtf8(const CStdStr<CHAR>& strSource, CStdStringA& strDest, const READER& read)
+{
+  if (strSource.empty())
+  {
+    strDest.clear();
+    return;
+  }
+
+  const CHAR *str = strSource.c_str();
+  const CHAR *end = str + strSource.length();
+  char *out = strDest.GetBuffer(strSource.length() * 4);
+  size_t len = 0;
+  while (str < end)
+  {
+    uint32_t cp;
+    size_t units = read(str, end, cp);
+    if (!units)
+    {
+      str++;
+      continue;
+    }
+    if (cp == 0)
+      break;
+    str += units;
+    len += EncodeUtf8(cp, out + len);
+  }
+  strDest.ReleaseBuffer(len);
+}
+
+template<class CHAR, class READER>
+static void UnicodeToWide(const CStdStr<CHAR>& strSource, CStdStringW& strDest, const READER& read)
+{
+  if (strSource.empty())
+  {
+    strDest.clear();
+    return;
+  }
+
+  const CHAR *str = strSource.c_str();
+  const CHAR *end = str + strSource.length();
+  wchar_t *out = strDest.GetBuffer(strSource.length() * 2);
+  size_t len = 0;
+  while (str < end)
+  {
+    uint32_t cp;
+    size_t units = read(str, end, cp);
+    if (!units)
+    {
+      str++;
+      continue;
+    }
+    if (cp == 0)
+      break;
+    str += units;
+    len += SWideWriter()(cp, out + len);
+  }
+  strDest.ReleaseBuffer(len);
+}
+
+// whether the 7 bit range of the charset is ASCII, so ASCII text passes unchanged
+static bool IsAsciiCompatible(const CStdString& charset)
+{
+  static const char *names[] = { "UTF-8", "UTF8", "ASCII", "US-ASCII", "CP874", "BIG5", "BIG5-HKSCS", "GBK", "CP949", NULL };
+  static const char *prefixes[] = { "ISO-8859-", "CP125", "WINDOWS-125", NULL };
+
+  for (const char **name = names; *name; name++)
+  {
+    if (charset.Equals(*name))
+      return true;
+  }
+  for (const char **prefix = prefixes; *prefix; prefix++)
+  {
+    if (charset.Left(strlen(*prefix)).Equals(*prefix))
+      return true;
+  }
+  return false;
+}
+
+static bool IsUtf8Charset(const CStdString& charset)
+{
+  return charset.Equals("UTF-8") || charset.Equals("UTF8");
+}
+
+// copies ASCII text up to the first NUL, like a conversion would
+static inline void CopyAscii(const CStdStringA& strSource, CStdStringA& strDest)
+{
+  if (&strSource != &strDest)
+    strDest = strSource.c_str();
+}
+
 using namespace std;
 
 static void logicalToVisualBiDi(const CStdStringA& strSource, CStdStringA& strDest, FriBidiCharSet fribidiCharset, FriBidiCharType base = FRIBIDI_TYPE_LTR, bool* bWasFlipped =NULL)
@@ -403,18 +802,8 @@ void CCharsetConverter::reset(void)
 {
   CSingleLock lock(m_critSection);
 
-  ICONV_SAFE_CLOSE(m_iconvStringCharsetToFontCharset);
-  ICONV_SAFE_CLOSE(m_iconvUtf8ToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvStringCharsetToUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUcs2CharsetToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvSubtitleCharsetToW);
-  ICONV_SAFE_CLOSE(m_iconvWtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf16BEtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf16LEtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf32ToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvUtf8toW);
-  ICONV_SAFE_CLOSE(m_iconvUcs2CharsetToUtf8);
-
+  // handle sets reopen their iconv handles with the new charsets when next claimed
+  AtomicIncrement(&g_iconvGeneration);
 
   m_stringFribidiCharset = FRIBIDI_NOTFOUND;
 
@@ -426,55 +815,100 @@ void CCharsetConverter::reset(void)
   }
 }
 
+static void utf8ToWide(const CStdStringA& strSource, CStdStringW& strDest)
+{
+#if defined(UTF8_SOURCE_COMPOSES)
+  if (!IsAscii(strSource.c_str(), strSource.length()))
+  {
+    CIconvLease lease;
+    convert(lease[Utf8toW],sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,strSource,strDest);
+    return;
+  }
+#endif
+  Utf8ToUnicode(strSource, strDest, SWideWriter());
+}
+
 // The bVisualBiDiFlip forces a flip of characters for hebrew/arabic languages, only set to false if the flipping
 // of the string is already made or the string is not displayed in the GUI
 void CCharsetConverter::utf8ToW(const CStdStringA& utf8String, CStdStringW &wString, bool bVisualBiDiFlip/*=true*/, bool forceLTRReadingOrder /*=false*/, bool* bWasFlipped/*=NULL*/)
 {
   // Try to flip hebrew/arabic characters, if any
-  if (bVisualBiDiFlip)
+  if (bVisualBiDiFlip && !IsAscii(utf8String.c_str(), utf8String.length()))
   {
     CStdStringA strFlipped;
     FriBidiCharType charset = forceLTRReadingOrder ? FRIBIDI_TYPE_LTR : FRIBIDI_TYPE_PDF;
     logicalToVisualBiDi(utf8String, strFlipped, FRIBIDI_UTF8, charset, bWasFlipped);
-    CSingleLock lock(m_critSection);
-    convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,strFlipped,wString);
+    utf8ToWide(strFlipped, wString);
   }
-  else
+  else if (bVisualBiDiFlip)
   {
-    CSingleLock lock(m_critSection);
-    convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,utf8String,wString);
+    // ASCII has nothing to flip, only drop the line breaks like logicalToVisualBiDi() does
+    if (bWasFlipped)
+      *bWasFlipped = false;
+    if (utf8String.find('\n') != std::string::npos)
+    {
+      CStdStringA strJoined(utf8String);
+      strJoined.Remove('\n');
+      utf8ToWide(strJoined, wString);
+    }
+    else
+      utf8ToWide(utf8String, wString);
   }
+  else
+    utf8ToWide(utf8String, wString);
 }
 
 void CCharsetConverter::subtitleCharsetToW(const CStdStringA& strSource, CStdStringW& strDest)
 {
   // No need to flip hebrew/arabic as mplayer does the flipping
-  CSingleLock lock(m_critSection);
-  convert(m_iconvSubtitleCharsetToW,sizeof(wchar_t),g_langInfo.GetSubtitleCharSet(),WCHAR_CHARSET,strSource,strDest);
+  CStdString strCharset = g_langInfo.GetSubtitleCharSet();
+  if (IsAsciiCompatible(strCharset) && IsAscii(strSource.c_str(), strSource.length()))
+  {
+    Utf8ToUnicode(strSource, strDest, SWideWriter());
+    return;
+  }
+  CIconvLease lease;
+  convert(lease[SubtitleCharsetToW],sizeof(wchar_t),strCharset,WCHAR_CHARSET,strSource,strDest);
 }
 
 void CCharsetConverter::fromW(const CStdStringW& strSource,
                               CStdStringA& strDest, const CStdString& enc)
 {
+  if (IsUtf8Charset(enc))
+  {
+    UnicodeToUtf8(strSource, strDest, SWideReader());
+    return;
+  }
   iconv_t iconvString;
   ICONV_PREPARE(iconvString);
   convert(iconvString,4,WCHAR_CHARSET,enc,strSource,strDest);
-  iconv_close(iconvString);
+  ICONV_SAFE_CLOSE(iconvString);
 }
 
 void CCharsetConverter::toW(const CStdStringA& strSource,
                             CStdStringW& strDest, const CStdString& enc)
 {
+  if (IsUtf8Charset(enc))
+  {
+    utf8ToWide(strSource, strDest);
+    return;
+  }
   iconv_t iconvString;
   ICONV_PREPARE(iconvString);
   convert(iconvString,sizeof(wchar_t),enc,WCHAR_CHARSET,strSource,strDest);
-  iconv_close(iconvString);
+  ICONV_SAFE_CLOSE(iconvString);
 }
 
 void CCharsetConverter::utf8ToStringCharset(const CStdStringA& strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
-  convert(m_iconvUtf8ToStringCharset,1,UTF8_SOURCE,g_langInfo.GetGuiCharSet(),strSource,strDest);
+  CStdString strCharset = g_langInfo.GetGuiCharSet();
+  if (IsAsciiCompatible(strCharset) && IsAscii(strSource.c_str(), strSource.length()))
+  {
+    CopyAscii(strSource, strDest);
+    return;
+  }
+  CIconvLease lease;
+  convert(lease[Utf8ToStringCharset],1,UTF8_SOURCE,strCharset,strSource,strDest);
 }
 
 void CCharsetConverter::utf8ToStringCharset(CStdStringA& strSourceDest)
@@ -486,10 +920,15 @@ void CCharsetConverter::utf8ToStringCharset(CStdStringA& strSourceDest)
 
 void CCharsetConverter::stringCharsetToUtf8(const CStdStringA& strSourceCharset, const CStdStringA& strSource, CStdStringA& strDest)
 {
+  if (IsAsciiCompatible(strSourceCharset) && IsAscii(strSource.c_str(), strSource.length()))
+  {
+    CopyAscii(strSource, strDest);
+    return;
+  }
   iconv_t iconvString;
   ICONV_PREPARE(iconvString);
   convert(iconvString,UTF8_DEST_MULTIPLIER,strSourceCharset,"UTF-8",strSource,strDest);
-  iconv_close(iconvString);
+  ICONV_SAFE_CLOSE(iconvString);
 }
 
 void CCharsetConverter::utf8To(const CStdStringA& strDestCharset, const CStdStringA& strSource, CStdStringA& strDest)
@@ -499,28 +938,51 @@ void CCharsetConverter::utf8To(const CStdStringA& strDestCharset, const CStdStri
     strDest = strSource;
     return;
   }
+  if (IsAsciiCompatible(strDestCharset) && IsAscii(strSource.c_str(), strSource.length()))
+  {
+    CopyAscii(strSource, strDest);
+    return;
+  }
   iconv_t iconvString;
   ICONV_PREPARE(iconvString);
   convert(iconvString,UTF8_DEST_MULTIPLIER,UTF8_SOURCE,strDestCharset,strSource,strDest);
-  iconv_close(iconvString);
+  ICONV_SAFE_CLOSE(iconvString);
 }
 
 void CCharsetConverter::utf8To(const CStdStringA& strDestCharset, const CStdStringA& strSource, CStdString16& strDest)
 {
+  bool native = strDestCharset.Equals("UTF-16LE") || strDestCharset.Equals("UTF-16BE");
+#if defined(UTF8_SOURCE_COMPOSES)
+  native = native && IsAscii(strSource.c_str(), strSource.length());
+#endif
+  if (native)
+  {
+    Utf8ToUnicode(strSource, strDest, SUtf16Writer(strDestCharset.Equals("UTF-16BE")));
+    return;
+  }
   iconv_t iconvString;
   ICONV_PREPARE(iconvString);
   if(!convert_checked(iconvString,UTF8_DEST_MULTIPLIER,UTF8_SOURCE,strDestCharset,strSource,strDest))
     strDest.clear();
-  iconv_close(iconvString);
+  ICONV_SAFE_CLOSE(iconvString);
 }
 
 void CCharsetConverter::utf8To(const CStdStringA& strDestCharset, const CStdStringA& strSource, CStdString32& strDest)
 {
+  bool native = strDestCharset.Equals("UTF-32LE") || strDestCharset.Equals("UTF-32BE");
+#if defined(UTF8_SOURCE_COMPOSES)
+  native = native && IsAscii(strSource.c_str(), strSource.length());
+#endif
+  if (native)
+  {
+    Utf8ToUnicode(strSource, strDest, SUtf32Writer(strDestCharset.Equals("UTF-32BE")));
+    return;
+  }
   iconv_t iconvString;
   ICONV_PREPARE(iconvString);
   if(!convert_checked(iconvString,UTF8_DEST_MULTIPLIER,UTF8_SOURCE,strDestCharset,strSource,strDest))
     strDest.clear();
-  iconv_close(iconvString);
+  ICONV_SAFE_CLOSE(iconvString);
 }
 
 void CCharsetConverter::unknownToUTF8(CStdStringA &sourceAndDest)
@@ -536,44 +998,37 @@ void CCharsetConverter::unknownToUTF8(const CStdStringA &source, CStdStringA &de
     dest = source;
   else
   {
-    CSingleLock lock(m_critSection);
-    convert(m_iconvStringCharsetToUtf8, UTF8_DEST_MULTIPLIER, g_langInfo.GetGuiCharSet(), "UTF-8", source, dest);
+    CIconvLease lease;
+    convert(lease[StringCharsetToUtf8], UTF8_DEST_MULTIPLIER, g_langInfo.GetGuiCharSet(), "UTF-8", source, dest);
   }
 }
 
 void CCharsetConverter::wToUTF8(const CStdStringW& strSource, CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
-  convert(m_iconvWtoUtf8,UTF8_DEST_MULTIPLIER,WCHAR_CHARSET,"UTF-8",strSource,strDest);
+  UnicodeToUtf8(strSource, strDest, SWideReader());
 }
 
 void CCharsetConverter::utf16BEtoUTF8(const CStdString16& strSource, CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUtf16BEtoUtf8,UTF8_DEST_MULTIPLIER,"UTF-16BE","UTF-8",strSource,strDest))
-    strDest.clear();
+  UnicodeToUtf8(strSource, strDest, SUtf16Reader(true));
 }
 
 void CCharsetConverter::utf16LEtoUTF8(const CStdString16& strSource,
                                       CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUtf16LEtoUtf8,UTF8_DEST_MULTIPLIER,"UTF-16LE","UTF-8",strSource,strDest))
-    strDest.clear();
+  UnicodeToUtf8(strSource, strDest, SUtf16Reader(false));
 }
 
 void CCharsetConverter::ucs2ToUTF8(const CStdString16& strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUcs2CharsetToUtf8,UTF8_DEST_MULTIPLIER,"UCS-2LE","UTF-8",strSource,strDest))
+  CIconvLease lease;
+  if(!convert_checked(lease[Ucs2CharsetToUtf8],UTF8_DEST_MULTIPLIER,"UCS-2LE","UTF-8",strSource,strDest))
     strDest.clear();
 }
 
 void CCharsetConverter::utf16LEtoW(const CStdString16& strSource, CStdStringW &strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUtf16LEtoW,sizeof(wchar_t),"UTF-16LE",WCHAR_CHARSET,strSource,strDest))
-    strDest.clear();
+  UnicodeToWide(strSource, strDest, SUtf16Reader(false));
 }
 
 void CCharsetConverter::ucs2CharsetToStringCharset(const CStdStringW& strSource, CStdStringA& strDest, bool swap)
@@ -593,22 +1048,23 @@ void CCharsetConverter::ucs2CharsetToStringCharset(const CStdStringW& strSource,
       s++;
     }
   }
-  CSingleLock lock(m_critSection);
-  convert(m_iconvUcs2CharsetToStringCharset,4,"UTF-16LE",
+  CIconvLease lease;
+  convert(lease[Ucs2CharsetToStringCharset],4,"UTF-16LE",
           g_langInfo.GetGuiCharSet(),strCopy,strDest);
 }
 
 void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
+  CIconvLease lease;
+  iconv_t &handle = lease[Utf32ToStringCharset];
 
-  if (m_iconvUtf32ToStringCharset == (iconv_t) - 1)
+  if (handle == (iconv_t) - 1)
   {
     CStdString strCharset=g_langInfo.GetGuiCharSet();
-    m_iconvUtf32ToStringCharset = iconv_open(strCharset.c_str(), "UTF-32LE");
+    handle = iconv_open(strCharset.c_str(), "UTF-32LE");
   }
 
-  if (m_iconvUtf32ToStringCharset != (iconv_t) - 1)
+  if (handle != (iconv_t) - 1)
   {
     const unsigned long* ptr=strSource;
     while (*ptr) ptr++;
@@ -618,7 +1074,7 @@ void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CSt
     char *dst = strDest.GetBuffer(inBytes);
     size_t outBytes = inBytes;
 
-    if (iconv_const(m_iconvUtf32ToStringCharset, &src, &inBytes, &dst, &outBytes) == (size_t)-1)
+    if (iconv_const(handle, &src, &inBytes, &dst, &outBytes) == (size_t)-1)
     {
       CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
       strDest.ReleaseBuffer();
@@ -626,7 +1082,7 @@ void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CSt
       return;
     }
 
-    if (iconv(m_iconvUtf32ToStringCharset, NULL, NULL, &dst, &outBytes) == (size_t)-1)
+    if (iconv(handle, NULL, NULL, &dst, &outBytes) == (size_t)-1)
     {
       CLog::Log(LOGERROR, "%s failed cleanup", __FUNCTION__);
       strDest.ReleaseBuffer();
@@ -0,0 +1,91 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "FileExtensions.h"
+#include "URL.h"
+#include "utils/StringUtils.h"
+
+CFileExtensions::CFileExtensions()
+  : m_maxLength(0)
+{
+}
+
+CFileExtensions::CFileExtensions(const std::string &extensions)
+  : m_maxLength(0)
+{
+  Add(extensions);
+}
+
+void CFileExtensions::Add(const std::string &extensions, unsigned int type /* = 1 */)
+{
+  std::vector<std::string> list = StringUtils::Split(extensions, "|");
+  for (std::vector<std::string>::iterator it = list.begin(); it != list.end(); ++it)
+  {
+    // URIUtils::HasExtension() matches up to the last '.' of an extension, so do the same
+    size_t dot = it->rfind('.');
+    if (dot == std::string::npos)
+      continue;
+    std::string extension = it->substr(dot);
+    StringUtils::ToLower(extension);
+    m_extensions[extension] |= type;
+    m_maxLength = std::max(m_maxLength, extension.size());
+  }
+}
+
+void CFileExtensions::Clear()
+{
+  m_extensions.clear();
+  m_maxLength = 0;
+}
+
+unsigned int CFileExtensions::GetTypes(const std::string &path) const
+{
+  if (m_extensions.empty())
+    return 0;
+
+  size_t protocol = path.find("://");
+  if (protocol != std::string::npos)
+  {
+    // the file name of a url ends the path, unless there's no file name or there are options,
+    // which may contain slashes themselves
+    size_t slash = path.find_last_of("/\\");
+    if (slash < protocol + 3 || path.find_first_of("?;#|@", protocol + 3) != std::string::npos)
+    {
+      CURL url(path);
+      return GetFileNameTypes(url.GetFileName());
+    }
+  }
+
+  return GetFileNameTypes(path);
+}
+
+unsigned int CFileExtensions::GetFileNameTypes(const std::string &path) const
+{
+  size_t dot = path.find_last_of("./\\");
+  if (dot == std::string::npos || path[dot] != '.' || path.size() - dot > m_maxLength)
+    return 0;
+
+  std::string extension = path.substr(dot);
+  StringUtils::ToLower(extension);
+  std::map<std::string, unsigned int>::const_iterator it = m_extensions.find(extension);
+  return it != m_extensions.end() ? it->second : 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+
+/*!
+ \brief A list of file extensions like ".avi|.mkv", compiled for fast lookups.
+
+ URIUtils::HasExtension() walks the whole '|' separated list for every path it checks, and
+ parses urls with CURL. Here the extensions are kept in a map, each with a bitmask of types, so
+ a lookup is a single map search for the extension of the path, and only urls with options or
+ without a file name are parsed.
+ */
+class CFileExtensions
+{
+public:
+  CFileExtensions();
+  CFileExtensions(const std::string &extensions);
+
+  /*! \brief Add the extensions in a '|' separated list
+   \param extensions the extensions, each starting with a '.'
+   \param type bits returned by GetTypes() for these extensions.
+   */
+  void Add(const std::string &extensions, unsigned int type = 1);
+  void Clear();
+  bool IsEmpty() const { return m_extensions.empty(); };
+
+  /*! \brief The types of the extension of the file name in a path, 0 if it isn't in the list */
+  unsigned int GetTypes(const std::string &path) const;
+  bool Has(const std::string &path) const { return GetTypes(path) != 0; };
+
+private:
+  unsigned int GetFileNameTypes(const std::string &path) const;
+
+  std::map<std::string, unsigned int> m_extensions;
+  size_t m_maxLength; ///< of the extensions, longer ones aren't looked up
+};
@@ -150,6 +150,18 @@ public:
     return false;
   }
 
+  /*!
+   \brief Hint for the CJobManager which worker should run this job.
+
+   Jobs returning the same non-zero value are queued on the same worker, which keeps related
+   work (e.g. on the same database or share) together. It is only a hint, idle workers
+   may still take the job.
+
+   \return the affinity of this job, 0 for none.
+   \sa CJobManager
+   */
+  virtual unsigned int GetAffinity() const { return 0; };
+
   /*!
    \brief Function for longer jobs to report progress and check whether they have been cancelled.
    
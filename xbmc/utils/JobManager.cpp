@@ -21,6 +21,8 @@
 #include "JobManager.h"
 #include <algorithm>
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 
 #include "system.h"
@@ -35,9 +37,10 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+CJobWorker::CJobWorker(CJobManager *manager, unsigned int slot) : CThread("JobWorker")
 {
   m_jobManager = manager;
+  m_slot = slot;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -174,6 +177,10 @@ CJobManager &CJobManager::GetInstance()
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
+  m_nextSlot = 0;
+  m_queued = 0;
+  m_processing = 0;
+  m_idle = 0;
   m_running = true;
   
   for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
@@ -185,109 +192,197 @@ void CJobManager::CancelJobs()
   CSingleLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+  for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
-    m_jobQueue[priority].clear();
-  }
+    CSingleLock slotLock(m_slots[slot].m_section);
+
+    // clear any pending jobs
+    for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      AtomicSubtract(&m_queued, m_slots[slot].m_jobQueue[priority].size());
+      for_each(m_slots[slot].m_jobQueue[priority].begin(), m_slots[slot].m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
+      m_slots[slot].m_jobQueue[priority].clear();
+    }
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
+    // cancel any callbacks on jobs still processing
+    m_slots[slot].m_current.Cancel();
+  }
 
   // tell our workers to finish
-  while (m_workers.size())
+  for (;;)
   {
+    bool running = false;
+    for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
+      running |= m_slots[slot].m_worker != NULL;
+    if (!running)
+      break;
+
     lock.Leave();
     m_jobEvent.Set();
     Sleep(0); // yield after setting the event to give the workers some time to die
     lock.Enter();
   }
+
+  JobStats stats = GetJobStats();
+  for (JobStats::const_iterator it = stats.begin(); it != stats.end(); ++it)
+  {
+    if (!it->second.count)
+      continue;
+    CLog::Log(LOGDEBUG, "%s - '%s': %u jobs, avg %u ms, max %u ms, avg wait %u ms, %u stolen", __FUNCTION__,
+              it->first.c_str(), it->second.count, (unsigned int)(it->second.totalTime / it->second.count),
+              it->second.maxTime, (unsigned int)(it->second.totalWait / it->second.count), it->second.stolen);
+  }
 }
 
 CJobManager::~CJobManager()
 {
+  // jobs that came in while we were cancelling
+  for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
+  {
+    for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+      for_each(m_slots[slot].m_jobQueue[priority].begin(), m_slots[slot].m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
+  }
 }
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   if (!m_running)
     return 0;
 
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id;
+  do
+  {
+    id = (unsigned int)AtomicIncrement(&m_jobCounter);
+  } while (id == 0);
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem work(job, id, priority, callback);
+  work.m_queued = XbmcThreads::SystemClockMillis();
+
+  unsigned int affinity = job->GetAffinity();
+  unsigned int slot = (affinity ? affinity : (unsigned int)AtomicIncrement(&m_nextSlot)) % MAX_WORKERS;
+  {
+    CSingleLock lock(m_slots[slot].m_section);
+    m_slots[slot].m_jobQueue[priority].push_back(work);
+  }
+  AtomicIncrement(&m_queued);
+
+  // wake a sleeping worker, we only need the manager lock if all are busy
+  if (AtomicAdd(&m_idle, 0) > 0)
+    m_jobEvent.Set();
+  else
+    StartWorkers(priority);
 
-  StartWorkers(priority);
   return work.m_id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
+  // a job being stolen moves from the victim's queue to the thief under both their locks.
+  // holding all slots (in slot order, like PopJob()) makes sure we see it in one of them
+  for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
+    m_slots[slot].m_section.lock();
 
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+  bool found = false;
+  for (unsigned int slot = 0; slot < MAX_WORKERS && !found; slot++)
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
+    // check whether we have this job in the queue
+    for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH && !found; ++priority)
     {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
-      return;
+      JobQueue &queue = m_slots[slot].m_jobQueue[priority];
+      JobQueue::iterator i = find(queue.begin(), queue.end(), jobID);
+      if (i != queue.end())
+      {
+        delete i->m_job;
+        queue.erase(i);
+        AtomicDecrement(&m_queued);
+        found = true;
+      }
+    }
+    // or if we're processing it
+    if (!found && m_slots[slot].m_busy && m_slots[slot].m_current == jobID)
+    {
+      m_slots[slot].m_current.m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+      found = true;
     }
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+
+  for (unsigned int slot = MAX_WORKERS; slot > 0; slot--)
+    m_slots[slot - 1].m_section.unlock();
 }
 
 void CJobManager::StartWorkers(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  if ((unsigned long)AtomicAdd(&m_processing, 0) >= GetMaxWorkers(priority))
     return;
 
-  // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
-  {
-    m_jobEvent.Set();
+  CSingleLock lock(m_section);
+  if (!m_running)
     return;
-  }
 
   // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+  for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
+  {
+    if (!m_slots[slot].m_worker)
+    {
+      m_slots[slot].m_worker = new CJobWorker(this, slot);
+      return;
+    }
+  }
+
+  // all workers exist, one is about to sleep
+  m_jobEvent.Set();
 }
 
-CJob *CJobManager::PopJob()
+bool CJobManager::ReserveWorker(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
+  for (;;)
+  {
+    long processing = AtomicAdd(&m_processing, 0);
+    if ((unsigned long)processing >= GetMaxWorkers(priority))
+      return false;
+    if (cas(&m_processing, processing, processing + 1) == processing)
+      return true;
+  }
+}
+
+CJob *CJobManager::PopJob(unsigned int slot)
+{
+  CWorkerSlot &own = m_slots[slot];
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW; --priority)
   {
     if (m_jobPause[priority]) // In case this priority is paused, skip it
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    if (!ReserveWorker(CJob::PRIORITY(priority)))
+      continue;
+
+    for (unsigned int i = 0; i < MAX_WORKERS; i++)
     {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      // our own queue first, then steal. The job moves under both locks and
+      // CancelJob() holds all of them, take them in slot order to not deadlock
+      unsigned int other = (slot + i) % MAX_WORKERS;
+      CWorkerSlot &victim = m_slots[other];
+      CSingleLock first(m_slots[std::min(slot, other)].m_section);
+      CSingleLock second(m_slots[std::max(slot, other)].m_section);
+      if (victim.m_jobQueue[priority].empty())
+        continue;
+
+      // pop the job off the queue and make it our running job
+      own.m_current = victim.m_jobQueue[priority].front();
+      own.m_busy = true;
+      victim.m_jobQueue[priority].pop_front();
+      AtomicDecrement(&m_queued);
+
+      own.m_current.m_started = XbmcThreads::SystemClockMillis();
+      own.m_current.m_job->m_callback = this;
+      if (i > 0)
+        own.m_stats[own.m_current.m_job->GetType()].stolen++;
+      return own.m_current.m_job;
     }
+    AtomicDecrement(&m_processing);
   }
   return NULL;
 }
@@ -300,8 +395,14 @@ void CJobManager::Pause(const CJob::PRIORITY &priority)
 
 void CJobManager::UnPause(const CJob::PRIORITY &priority)
 {
-  CSingleLock lock(m_section);
-  m_jobPause[priority] = false;
+  {
+    CSingleLock lock(m_section);
+    m_jobPause[priority] = false;
+  }
+
+  // pick up what was queued in the meantime
+  if (AtomicAdd(&m_queued, 0) > 0)
+    StartWorkers(priority);
 }
 
 bool CJobManager::IsPaused(const CJob::PRIORITY &priority) const
@@ -312,11 +413,10 @@ bool CJobManager::IsPaused(const CJob::PRIORITY &priority) const
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); it++)
+  for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
   {
-    if (priority == it->m_priority)
+    CSingleLock lock(m_slots[slot].m_section);
+    if (m_slots[slot].m_busy && priority == m_slots[slot].m_current.m_priority)
       return true;
   }
   return false;
@@ -325,10 +425,10 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 int CJobManager::IsProcessing(const std::string &pausedType) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); it++)
+  for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
   {
-    if (pausedType == std::string(it->m_job->GetType()))
+    CSingleLock lock(m_slots[slot].m_section);
+    if (m_slots[slot].m_busy && pausedType == std::string(m_slots[slot].m_current.m_job->GetType()))
       jobsMatched++;
   }
   return jobsMatched;
@@ -336,43 +436,56 @@ int CJobManager::IsProcessing(const std::string &pausedType) const
 
 CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
-  while (m_running)
+  unsigned int slot = worker->GetSlot();
+  do
   {
-    // grab a job off the queue if we have one
-    CJob *job = PopJob();
-    if (job)
-      return job;
-    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
-      break;
-  }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
-  // have no jobs
-  RemoveWorker(worker);
+    while (m_running)
+    {
+      // grab a job off the queue if we have one
+      CJob *job = PopJob(slot);
+      if (job)
+      {
+        // more waiting - get a sleeping colleague going too
+        if (AtomicAdd(&m_queued, 0) > 0 && AtomicAdd(&m_idle, 0) > 0)
+          m_jobEvent.Set();
+        return job;
+      }
+      // no jobs are left - sleep for 30 seconds to allow new jobs to come in
+      AtomicIncrement(&m_idle);
+      bool newJob = m_jobEvent.WaitMSec(30000);
+      AtomicDecrement(&m_idle);
+      if (!newJob)
+        break;
+    }
+    // ensure no jobs have come in during the period after
+    // timeout and before we stopped counting as idle
+    if (m_running)
+    {
+      CJob *job = PopJob(slot);
+      if (job)
+        return job;
+    }
+    // have no jobs, unless one was queued while we were leaving
+  } while (!RemoveWorker(worker));
   return NULL;
 }
 
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  // find the job in the processing slots, and check whether it's cancelled (no callback)
+  for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
+    CSingleLock lock(m_slots[slot].m_section);
+    if (m_slots[slot].m_busy && m_slots[slot].m_current == job)
     {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
-      return false;
+      CWorkItem item(m_slots[slot].m_current);
+      lock.Leave(); // leave section prior to call
+      if (item.m_callback)
+      {
+        item.m_callback->OnJobProgress(item.m_id, progress, total, job);
+        return false;
+      }
+      break;
     }
   }
   return true; // couldn't find the job, or it's been cancelled
@@ -380,13 +493,15 @@ bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const
 
 void CJobManager::OnJobComplete(bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
-  // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
   {
+    CWorkerSlot &processing = m_slots[slot];
+    CSingleLock lock(processing.m_section);
+    if (!processing.m_busy || !(processing.m_current == job))
+      continue;
+
     // tell any listeners we're done with the job, then delete it
-    CWorkItem item(*i);
+    CWorkItem item(processing.m_current);
     lock.Leave();
     try
     {
@@ -398,25 +513,57 @@ void CJobManager::OnJobComplete(bool success, CJob *job)
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
     }
     lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
+
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    JobTypeStats &stats = processing.m_stats[item.m_job->GetType()];
+    stats.count++;
+    stats.totalTime += now - item.m_started;
+    stats.totalWait += item.m_started - item.m_queued;
+    stats.maxTime = std::max(stats.maxTime, now - item.m_started);
+
+    processing.m_busy = false;
+    processing.m_current = CWorkItem(NULL, 0, CJob::PRIORITY_LOW, NULL);
     lock.Leave();
+    AtomicDecrement(&m_processing);
     item.FreeJob();
+    return;
   }
 }
 
-void CJobManager::RemoveWorker(const CJobWorker *worker)
+CJobManager::JobStats CJobManager::GetJobStats() const
+{
+  JobStats result;
+  for (unsigned int slot = 0; slot < MAX_WORKERS; slot++)
+  {
+    CSingleLock lock(m_slots[slot].m_section);
+    for (JobStats::const_iterator it = m_slots[slot].m_stats.begin(); it != m_slots[slot].m_stats.end(); ++it)
+    {
+      JobTypeStats &stats = result[it->first];
+      stats.count     += it->second.count;
+      stats.totalTime += it->second.totalTime;
+      stats.maxTime    = std::max(stats.maxTime, it->second.maxTime);
+      stats.totalWait += it->second.totalWait;
+      stats.stolen    += it->second.stolen;
+    }
+  }
+  return result;
+}
+
+bool CJobManager::RemoveWorker(const CJobWorker *worker)
 {
   CSingleLock lock(m_section);
+  // AddJob() only starts a worker under our lock when it finds no idle one, so
+  // a job queued since our last look would be stranded if all slots stay taken
+  if (m_running && AtomicAdd(&m_queued, 0) > 0 && m_slots[worker->GetSlot()].m_worker == worker)
+    return false;
+
   // remove our worker
-  Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
-  if (i != m_workers.end())
-    m_workers.erase(i); // workers auto-delete
+  if (m_slots[worker->GetSlot()].m_worker == worker)
+    m_slots[worker->GetSlot()].m_worker = NULL; // workers auto-delete
+  return true;
 }
 
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority) const
 {
-  static const unsigned int max_workers = 5;
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  return MAX_WORKERS - (CJob::PRIORITY_HIGH - priority);
 }
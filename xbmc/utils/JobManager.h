@@ -22,6 +22,7 @@
 #include <queue>
 #include <vector>
 #include <string>
+#include <map>
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
@@ -31,12 +32,14 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  CJobWorker(CJobManager *manager);
+  CJobWorker(CJobManager *manager, unsigned int slot);
   virtual ~CJobWorker();
 
   void Process();
+  unsigned int GetSlot() const { return m_slot; }
 private:
   CJobManager  *m_jobManager;
+  unsigned int  m_slot;
 };
 
 /*!
@@ -165,6 +168,11 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Every worker owns a slot with its own queues and lock. Jobs are spread over the
+ slots (or put into the slot given by CJob::GetAffinity()), a worker runs jobs from
+ its own slot first and steals from the others when it runs dry, so adding and
+ fetching jobs doesn't serialize on a single lock.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
@@ -178,6 +186,8 @@ class CJobManager
       m_id = id;
       m_callback = callback;
       m_priority = priority;
+      m_queued = 0;
+      m_started = 0;
     }
     bool operator==(unsigned int jobID) const
     {
@@ -200,9 +210,25 @@ class CJobManager
     unsigned int  m_id;
     IJobCallback *m_callback;
     CJob::PRIORITY m_priority;
+    unsigned int  m_queued;  ///< time the job was added
+    unsigned int  m_started; ///< time a worker picked it up
   };
 
 public:
+  /*!
+   \brief Timing statistics of a job type, as returned by GetJobStats()
+   */
+  struct JobTypeStats
+  {
+    JobTypeStats() : count(0), totalTime(0), maxTime(0), totalWait(0), stolen(0) {}
+    unsigned int count;     ///< number of completed jobs
+    uint64_t     totalTime; ///< ms spent in DoWork() and the completion callback
+    unsigned int maxTime;   ///< longest job in ms
+    uint64_t     totalWait; ///< ms the jobs spent queued
+    unsigned int stolen;    ///< jobs run by a worker other than the one they were queued on
+  };
+  typedef std::map<std::string, JobTypeStats> JobStats;
+
   /*!
    \brief The only way through which the global instance of the CJobManager should be accessed.
    \return the global instance.
@@ -233,6 +259,12 @@ public:
    */
   void CancelJobs();
 
+  /*!
+   \brief Retrieve the timing statistics per job type since startup
+   \return statistics keyed by CJob::GetType()
+   */
+  JobStats GetJobStats() const;
+
   /*!
    \brief Checks to see if any jobs of a specific type are currently processing.
    \param pausedType Job type to search for
@@ -310,27 +342,49 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  enum { MAX_WORKERS = 5 };
+
+  typedef std::deque<CWorkItem>    JobQueue;
+
+  /*! \brief Queues and the running job of one worker, all guarded by the slot's own lock */
+  class CWorkerSlot
+  {
+  public:
+    CWorkerSlot() : m_current(NULL, 0, CJob::PRIORITY_LOW, NULL), m_busy(false), m_worker(NULL) {}
+    JobQueue          m_jobQueue[CJob::PRIORITY_HIGH+1];
+    CWorkItem         m_current;
+    bool              m_busy;
+    JobStats          m_stats;
+    CJobWorker       *m_worker; ///< guarded by CJobManager::m_section
+    CCriticalSection  m_section;
+  };
+
+  /*! \brief Pop a job off the job queues and make it the running job of the given slot
+   Looks at the slot's own queues first and steals from the other slots otherwise.
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CJob *PopJob(unsigned int slot);
+
+  /*! \brief Account for a job of the given priority starting, if a worker may take it */
+  bool ReserveWorker(CJob::PRIORITY priority);
 
   void StartWorkers(CJob::PRIORITY priority);
-  void RemoveWorker(const CJobWorker *worker);
+  /*! \brief Remove the worker from its slot
+   \return false if jobs are waiting and the worker should stay, true if it was removed
+   */
+  bool RemoveWorker(const CJobWorker *worker);
   unsigned int GetMaxWorkers(CJob::PRIORITY priority) const;
 
-  unsigned int m_jobCounter;
+  volatile long m_jobCounter;
+  volatile long m_nextSlot;   ///< round robin for jobs without affinity
+  volatile long m_queued;     ///< jobs waiting in any slot
+  volatile long m_processing; ///< jobs running
+  volatile long m_idle;       ///< workers waiting for m_jobEvent
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
-  typedef std::vector<CJobWorker*> Workers;
+  CWorkerSlot m_slots[MAX_WORKERS];
+  volatile bool m_jobPause[CJob::PRIORITY_HIGH+1];
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
-  bool       m_jobPause[CJob::PRIORITY_HIGH+1];
-  Processing m_processing;
-  Workers    m_workers;
-
-  CCriticalSection m_section;
+  CCriticalSection m_section; ///< guards starting and stopping workers
   CEvent           m_jobEvent;
-  bool             m_running;
+  volatile bool    m_running;
 };
@@ -0,0 +1,233 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "PlaybackTrace.h"
+#include "filesystem/File.h"
+#include "threads/Atomics.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "threads/ThreadLocal.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+
+#define PLAYBACK_TRACE_FILE "special://temp/playbacktrace.json"
+// events kept per thread, power of two. a few seconds of playback on the busiest threads
+#define TRACE_RING_SIZE     8192
+// threads beyond this aren't traced, rings of exited threads are reused
+#define TRACE_MAX_RINGS     64
+
+namespace
+{
+  enum EventType
+  {
+    EVENT_SPAN,
+    EVENT_COUNTER,
+    EVENT_INSTANT
+  };
+
+  struct SEvent
+  {
+    const char *name;
+    int64_t     time;  ///< host counter, start of spans
+    int64_t     value; ///< end of spans, value of counters
+    int         type;
+  };
+
+  /* Written by a single thread without locking: an event is filled in, then head is advanced
+     with a barrier. Readers copy what they need and drop what the writer may have overwritten
+     meanwhile. */
+  struct SRing
+  {
+    SEvent        events[TRACE_RING_SIZE];
+    volatile long head;  ///< number of events written
+    long          base;  ///< events before this belong to a previous thread
+    bool          used;
+    int           id;
+    std::string   name;
+  };
+}
+
+volatile bool CPlaybackTrace::m_enabled = false;
+
+static CCriticalSection                  g_ringsSection;
+static std::vector<SRing*>               g_rings;
+static XbmcThreads::ThreadLocal<SRing>   g_currentRing;
+static int                               g_lastRingId = 0;
+static int64_t                           g_enableTime = 0;
+
+static SRing *GetRing()
+{
+  SRing *ring = g_currentRing.get();
+  if (ring)
+    return ring;
+
+  CSingleLock lock(g_ringsSection);
+  for (std::vector<SRing*>::iterator it = g_rings.begin(); it != g_rings.end() && !ring; ++it)
+  {
+    if (!(*it)->used)
+      ring = *it;
+  }
+  if (!ring)
+  {
+    if (g_rings.size() >= TRACE_MAX_RINGS)
+      return NULL;
+    ring = new SRing;
+    ring->head = 0;
+    g_rings.push_back(ring);
+  }
+
+  ring->base = ring->head;
+  ring->used = true;
+  ring->id   = ++g_lastRingId;
+  CThread *thread = CThread::GetCurrentThread();
+  if (thread && !thread->GetName().empty())
+    ring->name = thread->GetName();
+  else
+    ring->name = StringUtils::Format("thread %d", ring->id);
+  g_currentRing.set(ring);
+  return ring;
+}
+
+static inline void AddEvent(int type, const char *name, int64_t time, int64_t value)
+{
+  SRing *ring = GetRing();
+  if (!ring)
+    return;
+
+  SEvent &event = ring->events[(unsigned long)ring->head & (TRACE_RING_SIZE - 1)];
+  event.name  = name;
+  event.time  = time;
+  event.value = value;
+  event.type  = type;
+  AtomicIncrement(&ring->head);
+}
+
+void CPlaybackTrace::Enable(bool enable)
+{
+  CSingleLock lock(g_ringsSection);
+  if (enable && !m_enabled)
+    g_enableTime = CurrentHostCounter();
+  m_enabled = enable;
+  CLog::Log(LOGDEBUG, "%s - playback tracing %s", __FUNCTION__, enable ? "enabled" : "disabled");
+}
+
+void CPlaybackTrace::AddSpan(const char *name, int64_t start, int64_t end)
+{
+  AddEvent(EVENT_SPAN, name, start, end);
+}
+
+void CPlaybackTrace::AddCounter(const char *name, int64_t value)
+{
+  if (m_enabled)
+    AddEvent(EVENT_COUNTER, name, CurrentHostCounter(), value);
+}
+
+void CPlaybackTrace::AddInstant(const char *name)
+{
+  if (m_enabled)
+    AddEvent(EVENT_INSTANT, name, CurrentHostCounter(), 0);
+}
+
+void CPlaybackTrace::ReleaseThread()
+{
+  SRing *ring = g_currentRing.get();
+  if (!ring)
+    return;
+
+  CSingleLock lock(g_ringsSection);
+  ring->used = false;
+  g_currentRing.set(NULL);
+}
+
+std::string CPlaybackTrace::GetTrace()
+{
+  CSingleLock lock(g_ringsSection);
+  int64_t frequency = CurrentHostFrequency();
+
+  std::string json = "{\"traceEvents\":[";
+  bool first = true;
+  for (std::vector<SRing*>::const_iterator it = g_rings.begin(); it != g_rings.end(); ++it)
+  {
+    SRing *ring = *it;
+    unsigned long head  = (unsigned long)AtomicAdd(&ring->head, 0);
+    unsigned long start = std::max((unsigned long)ring->base,
+                                   head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0UL);
+    std::vector<SEvent> events;
+    events.reserve(head - start);
+    for (unsigned long i = start; i != head; i++)
+      events.push_back(ring->events[i & (TRACE_RING_SIZE - 1)]);
+
+    // the slot the writer is at, and all it went through while we copied, can't be trusted
+    unsigned long now = (unsigned long)AtomicAdd(&ring->head, 0);
+    unsigned long skip = 0;
+    if (now + 1 > start + TRACE_RING_SIZE)
+      skip = std::min<unsigned long>(now + 1 - TRACE_RING_SIZE - start, events.size());
+
+    if (events.size() == skip)
+      continue;
+
+    // thread names come from anywhere, let the writer quote them
+    std::string name = CJSONVariantWriter::Write(CVariant(ring->name), true);
+    json += StringUtils::Format("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":%s}}",
+                                first ? "" : ",", ring->id, name.c_str());
+    first = false;
+
+    for (std::vector<SEvent>::const_iterator event = events.begin() + skip; event != events.end(); ++event)
+    {
+      if (event->time < g_enableTime)
+        continue;
+
+      int64_t ts = (event->time - g_enableTime) * 1000000 / frequency;
+      if (event->type == EVENT_SPAN)
+        json += StringUtils::Format(",{\"name\":\"%s\",\"cat\":\"playback\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%"PRId64",\"dur\":%"PRId64"}",
+                                    event->name, ring->id, ts, (event->value - event->time) * 1000000 / frequency);
+      else if (event->type == EVENT_COUNTER)
+        json += StringUtils::Format(",{\"name\":\"%s\",\"cat\":\"playback\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%"PRId64",\"args\":{\"value\":%"PRId64"}}",
+                                    event->name, ring->id, ts, event->value);
+      else
+        json += StringUtils::Format(",{\"name\":\"%s\",\"cat\":\"playback\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%"PRId64"}",
+                                    event->name, ring->id, ts);
+    }
+  }
+  json += "],\"displayTimeUnit\":\"ms\"}";
+  return json;
+}
+
+bool CPlaybackTrace::Save(const std::string &file)
+{
+  std::string path = file.empty() ? PLAYBACK_TRACE_FILE : file;
+  std::string trace = GetTrace();
+
+  XFILE::CFile output;
+  if (!output.OpenForWrite(path, true) ||
+      output.Write(trace.c_str(), trace.size()) != (int)trace.size())
+  {
+    CLog::Log(LOGERROR, "%s - unable to write the playback trace to %s", __FUNCTION__, path.c_str());
+    return false;
+  }
+  CLog::Log(LOGNOTICE, "Playback trace written to %s", path.c_str());
+  return true;
+}
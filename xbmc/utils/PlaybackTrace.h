@@ -0,0 +1,95 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+
+#include "utils/TimeUtils.h"
+
+/*!
+ \brief Low overhead tracing of the playback pipeline across threads.
+
+ While enabled, every thread records spans, counters and instant events into a ring buffer
+ of its own, without taking locks, so the most recent few seconds of demuxing, decoding,
+ rendering and audio output are kept. The rings can be saved at any time in Chrome trace
+ event format, to line up frame drops against I/O and decoder stalls in chrome://tracing or
+ Perfetto.
+
+ Enabled with the PlaybackTrace(start) builtin, or with <playbacktrace> in
+ advancedsettings.xml, in which case a trace is saved each time the player stops.
+ Event names have to be string literals, only the pointer is recorded.
+ */
+class CPlaybackTrace
+{
+public:
+  static bool IsEnabled() { return m_enabled; };
+  static void Enable(bool enable);
+
+  /*! \brief Save the recorded events as Chrome trace event json
+   \param file path to write to, special://temp/playbacktrace.json if empty.
+   */
+  static bool Save(const std::string &file = "");
+
+  /*! \brief Get the recorded events as Chrome trace event json */
+  static std::string GetTrace();
+
+  static void AddSpan(const char *name, int64_t start, int64_t end);
+  static void AddCounter(const char *name, int64_t value);
+  static void AddInstant(const char *name);
+
+  /*! \brief Give up the ring of the calling thread before it exits, so the ring can be
+   reused by a later thread. Its events stay available until then.
+   CThread calls this when its thread exits, other threads have to do it themselves.
+   */
+  static void ReleaseThread();
+
+private:
+  static volatile bool m_enabled;
+};
+
+/*!
+ \brief Records a span of the playback trace from construction until End() or destruction.
+ */
+class CPlaybackTraceSpan
+{
+public:
+  CPlaybackTraceSpan(const char *name)
+    : m_name(CPlaybackTrace::IsEnabled() ? name : NULL)
+    , m_start(m_name ? CurrentHostCounter() : 0)
+  {
+  }
+
+  ~CPlaybackTraceSpan() { End(); }
+
+  void End()
+  {
+    if (m_name)
+      CPlaybackTrace::AddSpan(m_name, m_start, CurrentHostCounter());
+    m_name = NULL;
+  }
+
+private:
+  CPlaybackTraceSpan(const CPlaybackTraceSpan&);
+  CPlaybackTraceSpan const& operator=(CPlaybackTraceSpan const&);
+
+  const char *m_name;
+  int64_t     m_start;
+};
@@ -0,0 +1,112 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <stdlib.h>
+
+#include "RandomPicker.h"
+
+// random picks tried before falling back to a scan of the ids not in the history
+#define MAX_PICK_TRIES 32
+
+CRandomPicker::CRandomPicker()
+  : m_historySize(0)
+{
+}
+
+void CRandomPicker::SetIds(const std::vector<int> &ids)
+{
+  m_ids = ids;
+}
+
+void CRandomPicker::Clear()
+{
+  m_ids.clear();
+  m_history.clear();
+  m_recent.clear();
+}
+
+void CRandomPicker::SetHistorySize(unsigned int size)
+{
+  m_historySize = size;
+  while (m_history.size() > m_historySize)
+  {
+    m_recent.erase(m_recent.find(m_history.front()));
+    m_history.pop_front();
+  }
+}
+
+unsigned int CRandomPicker::GetRandomIndex(unsigned int size)
+{
+  // RAND_MAX can be as low as 32767, too few for large libraries
+  unsigned int random = ((unsigned int)rand() << 15) ^ (unsigned int)rand();
+  return random % size;
+}
+
+bool CRandomPicker::Pick(int &id)
+{
+  if (m_ids.empty())
+    return false;
+
+  bool found = false;
+  for (int tries = 0; tries < MAX_PICK_TRIES && !found; tries++)
+  {
+    id = m_ids[GetRandomIndex(m_ids.size())];
+    found = !InHistory(id);
+  }
+
+  if (!found)
+  {
+    // the history covers most of the ids, eg. after they were replaced by fewer
+    std::vector<int> left;
+    for (std::vector<int>::const_iterator it = m_ids.begin(); it != m_ids.end(); ++it)
+    {
+      if (!InHistory(*it))
+        left.push_back(*it);
+    }
+    if (left.empty())
+      id = m_ids[GetRandomIndex(m_ids.size())];
+    else
+      id = left[GetRandomIndex(left.size())];
+  }
+
+  AddToHistory(id);
+  return true;
+}
+
+void CRandomPicker::Remove(int id)
+{
+  std::vector<int>::iterator it = std::find(m_ids.begin(), m_ids.end(), id);
+  if (it == m_ids.end())
+    return;
+
+  *it = m_ids.back();
+  m_ids.pop_back();
+}
+
+void CRandomPicker::AddToHistory(int id)
+{
+  if (m_historySize == 0)
+    return;
+
+  m_history.push_back(id);
+  m_recent.insert(id);
+  SetHistorySize(m_historySize);
+}
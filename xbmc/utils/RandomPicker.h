@@ -0,0 +1,66 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <deque>
+#include <set>
+#include <vector>
+
+/*!
+ \brief Picks random database ids out of a cached set without repeating recent picks.
+
+ The ids matching a filter are fetched once, after which each pick is a random index into
+ them, retried while it hits an id in the history. As the history is kept smaller than the
+ set, a pick takes a couple of tries instead of sorting the filtered table on every pick like
+ ORDER BY RANDOM() does. The owner replaces the ids with SetIds() when the library changes.
+ */
+class CRandomPicker
+{
+public:
+  CRandomPicker();
+
+  /*! \brief Replace the ids to pick from, the history is kept */
+  void SetIds(const std::vector<int> &ids);
+  void Clear();
+  unsigned int Size() const { return m_ids.size(); };
+
+  /*! \brief Number of recent picks that won't be picked again, 0 for no history */
+  void SetHistorySize(unsigned int size);
+
+  /*! \brief Pick a random id that isn't in the history and add it to the history
+   \param id the picked id.
+   \return false if there are no ids.
+   */
+  bool Pick(int &id);
+
+  /*! \brief Drop an id that no longer exists */
+  void Remove(int id);
+
+  void AddToHistory(int id);
+  bool InHistory(int id) const { return m_recent.find(id) != m_recent.end(); };
+
+private:
+  static unsigned int GetRandomIndex(unsigned int size);
+
+  std::vector<int>    m_ids;
+  unsigned int        m_historySize;
+  std::deque<int>     m_history;  ///< recent picks, oldest first
+  std::multiset<int>  m_recent;   ///< the same, for lookups
+};
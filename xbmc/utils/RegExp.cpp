@@ -23,17 +23,124 @@
 #include "RegExp.h"
 #include "StdString.h"
 #include "log.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
 
 using namespace PCRE;
 
+// compiled patterns only referenced by the cache are dropped beyond this
+#define REGEXP_CACHE_SIZE 256
+
+struct CRegExp::CCompiled
+{
+  pcre*         re;
+  pcre_extra*   extra;
+  volatile long refs;
+};
+
+CRegExp::CompiledCache CRegExp::m_cache;
+static CCriticalSection g_cacheSection;
+
+static void FreeCompiled(pcre *re, pcre_extra *extra)
+{
+  if (extra)
+  {
+#ifdef PCRE_STUDY_JIT_COMPILE
+    pcre_free_study(extra);
+#else
+    pcre_free(extra);
+#endif
+  }
+  pcre_free(re);
+}
+
+CRegExp::CCompiled* CRegExp::Acquire(const char *re, int options)
+{
+  std::pair<std::string, int> key(re, options);
+  CSingleLock lock(g_cacheSection);
+  CompiledCache::iterator it = m_cache.find(key);
+  if (it != m_cache.end())
+  {
+    AtomicIncrement(&it->second->refs);
+    return it->second;
+  }
+  lock.Leave();
+
+  // compile outside of the lock, matching in other threads goes on meanwhile
+  const char *errMsg = NULL;
+  int errOffset      = 0;
+  pcre *compiled = pcre_compile(re, options, &errMsg, &errOffset, NULL);
+  if (!compiled)
+  {
+    CLog::Log(LOGERROR, "PCRE: %s. Compilation failed at offset %d in expression '%s'",
+              errMsg, errOffset, re);
+    return NULL;
+  }
+
+  int studyOptions = 0;
+#ifdef PCRE_STUDY_JIT_COMPILE
+  studyOptions |= PCRE_STUDY_JIT_COMPILE;
+#endif
+  pcre_extra *extra = pcre_study(compiled, studyOptions, &errMsg);
+  if (errMsg)
+    CLog::Log(LOGWARNING, "PCRE: %s. Studying expression '%s' failed", errMsg, re);
+
+  lock.Enter();
+  it = m_cache.find(key);
+  if (it != m_cache.end())
+  { // someone else was faster
+    FreeCompiled(compiled, extra);
+    AtomicIncrement(&it->second->refs);
+    return it->second;
+  }
+
+  if (m_cache.size() >= REGEXP_CACHE_SIZE)
+    Trim();
+
+  CCompiled *entry = new CCompiled;
+  entry->re    = compiled;
+  entry->extra = extra;
+  entry->refs  = 2; // the cache and the caller
+  m_cache.insert(std::make_pair(key, entry));
+  return entry;
+}
+
+void CRegExp::Release(CCompiled *compiled)
+{
+  if (compiled && AtomicDecrement(&compiled->refs) == 0)
+  {
+    FreeCompiled(compiled->re, compiled->extra);
+    delete compiled;
+  }
+}
+
+void CRegExp::Trim()
+{
+  // called with g_cacheSection held. Entries only the cache refers to can't
+  // gain a reference meanwhile, as Acquire() needs the lock for that
+  for (CompiledCache::iterator it = m_cache.begin(); it != m_cache.end();)
+  {
+    if (it->second->refs == 1)
+    {
+      Release(it->second);
+      m_cache.erase(it++);
+    }
+    else
+      ++it;
+  }
+}
+
 CRegExp::CRegExp(bool caseless)
 {
+  m_compiled    = NULL;
   m_re          = NULL;
+  m_extra       = NULL;
   m_iOptions    = PCRE_DOTALL;
   if(caseless)
     m_iOptions |= PCRE_CASELESS;
 
   m_bMatched    = false;
+  m_bSubject    = false;
   m_iMatchCount = 0;
 
   memset(m_iOvector, 0, sizeof(m_iOvector));
@@ -41,30 +148,32 @@ CRegExp::CRegExp(bool caseless)
 
 CRegExp::CRegExp(const CRegExp& re)
 {
-  m_re = NULL;
+  m_compiled = NULL;
+  m_re       = NULL;
+  m_extra    = NULL;
   m_iOptions = re.m_iOptions;
   *this = re;
 }
 
 const CRegExp& CRegExp::operator=(const CRegExp& re)
 {
-  size_t size;
+  if (this == &re)
+    return *this;
+
   Cleanup();
   m_pattern = re.m_pattern;
-  if (re.m_re)
+  if (re.m_compiled)
   {
-    if (pcre_fullinfo(re.m_re, NULL, PCRE_INFO_SIZE, &size) >= 0)
-    {
-      if ((m_re = (pcre*)malloc(size)))
-      {
-        memcpy(m_re, re.m_re, size);
-        memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
-        m_iMatchCount = re.m_iMatchCount;
-        m_bMatched = re.m_bMatched;
-        m_subject = re.m_subject;
-        m_iOptions = re.m_iOptions;
-      }
-    }
+    AtomicIncrement(&re.m_compiled->refs);
+    m_compiled = re.m_compiled;
+    m_re       = re.m_re;
+    m_extra    = re.m_extra;
+    memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
+    m_iMatchCount = re.m_iMatchCount;
+    m_bMatched = re.m_bMatched;
+    m_bSubject = re.m_bSubject;
+    m_subject = re.m_subject;
+    m_iOptions = re.m_iOptions;
   }
   return *this;
 }
@@ -74,6 +183,14 @@ CRegExp::~CRegExp()
   Cleanup();
 }
 
+void CRegExp::Cleanup()
+{
+  Release(m_compiled);
+  m_compiled = NULL;
+  m_re       = NULL;
+  m_extra    = NULL;
+}
+
 CRegExp* CRegExp::RegComp(const char *re)
 {
   if (!re)
@@ -81,26 +198,24 @@ CRegExp* CRegExp::RegComp(const char *re)
 
   m_bMatched         = false;
   m_iMatchCount      = 0;
-  const char *errMsg = NULL;
-  int errOffset      = 0;
 
   Cleanup();
 
-  m_re = pcre_compile(re, m_iOptions, &errMsg, &errOffset, NULL);
-  if (!m_re)
+  m_compiled = Acquire(re, m_iOptions);
+  if (!m_compiled)
   {
     m_pattern.clear();
-    CLog::Log(LOGERROR, "PCRE: %s. Compilation failed at offset %d in expression '%s'",
-              errMsg, errOffset, re);
     return NULL;
   }
 
+  m_re      = m_compiled->re;
+  m_extra   = m_compiled->extra;
   m_pattern = re;
 
   return this;
 }
 
-int CRegExp::RegFind(const char* str, int startoffset)
+int CRegExp::Exec(const char *str, int startoffset)
 {
   m_bMatched    = false;
   m_iMatchCount = 0;
@@ -117,8 +232,17 @@ int CRegExp::RegFind(const char* str, int startoffset)
     return -1;
   }
 
-  m_subject = str;
-  int rc = pcre_exec(m_re, NULL, str, strlen(str), startoffset, 0, m_iOvector, OVECCOUNT);
+  int len = strlen(str);
+  int rc = pcre_exec(m_re, m_extra, str, len, startoffset, 0, m_iOvector, OVECCOUNT);
+
+#ifdef PCRE_ERROR_JIT_STACKLIMIT
+  if (rc == PCRE_ERROR_JIT_STACKLIMIT)
+  { // the default JIT stack is small, let the interpreter handle deep recursion
+    pcre_extra extra = *m_extra;
+    extra.flags &= ~PCRE_EXTRA_EXECUTABLE_JIT;
+    rc = pcre_exec(m_re, &extra, str, len, startoffset, 0, m_iOvector, OVECCOUNT);
+  }
+#endif
 
   if (rc<1)
   {
@@ -141,6 +265,20 @@ int CRegExp::RegFind(const char* str, int startoffset)
   return m_iOvector[0];
 }
 
+int CRegExp::RegFind(const char* str, int startoffset)
+{
+  if (str)
+    m_subject = str;
+  m_bSubject = str != NULL;
+  return Exec(str, startoffset);
+}
+
+int CRegExp::RegMatch(const char* str, int startoffset)
+{
+  m_bSubject = false;
+  return Exec(str, startoffset);
+}
+
 int CRegExp::GetCaptureTotal()
 {
   int c = -1;
@@ -157,7 +295,7 @@ std::string CRegExp::GetReplaceString( const char* sReplaceExp )
   int no;
   size_t len;
 
-  if( sReplaceExp == NULL || !m_bMatched )
+  if( sReplaceExp == NULL || !m_bMatched || !m_bSubject )
     return std::string();
 
   // First compute the length of the string
@@ -231,7 +369,7 @@ std::string CRegExp::GetReplaceString( const char* sReplaceExp )
 
 std::string CRegExp::GetMatch(int iSub /* = 0 */)
 {
-  if (iSub < 0 || iSub > m_iMatchCount)
+  if (iSub < 0 || iSub > m_iMatchCount || !m_bSubject)
     return "";
 
   int pos = m_iOvector[(iSub*2)];
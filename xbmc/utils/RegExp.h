@@ -22,6 +22,7 @@
 #ifndef REGEXP_H
 #define REGEXP_H
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -49,6 +50,12 @@ public:
   CRegExp* RegComp(const std::string& re) { return RegComp(re.c_str()); }
   int RegFind(const char *str, int startoffset = 0);
   int RegFind(const std::string& str, int startoffset = 0) { return RegFind(str.c_str(), startoffset); }
+  /*! \brief Like RegFind() but without keeping a copy of the subject, so matching doesn't allocate.
+   Only the positions of the match (GetFindLen(), GetSubStart(), GetSubLength()) are available
+   afterwards, GetMatch() and GetReplaceString() return empty strings.
+   */
+  int RegMatch(const char *str, int startoffset = 0);
+  int RegMatch(const std::string& str, int startoffset = 0) { return RegMatch(str.c_str(), startoffset); }
   std::string GetReplaceString( const char* sReplaceExp );
   int GetFindLen()
   {
@@ -68,16 +75,31 @@ public:
   const CRegExp& operator= (const CRegExp& re);
 
 private:
-  void Cleanup() { if (m_re) { PCRE::pcre_free(m_re); m_re = NULL; } }
+  /* compiled and studied patterns are shared by every CRegExp using the
+     same pattern and options, see Acquire() */
+  struct CCompiled;
+  typedef std::map<std::pair<std::string, int>, CCompiled*> CompiledCache;
+
+  static CCompiled* Acquire(const char *re, int options);
+  static void       Release(CCompiled *compiled);
+  static void       Trim();
+
+  int  Exec(const char *str, int startoffset);
+  void Cleanup();
+
+  static CompiledCache m_cache;
 
 private:
-  PCRE::pcre* m_re;
-  int         m_iOvector[OVECCOUNT];
-  int         m_iMatchCount;
-  int         m_iOptions;
-  bool        m_bMatched;
-  std::string m_subject;
-  std::string m_pattern;
+  CCompiled*        m_compiled;
+  PCRE::pcre*       m_re;
+  PCRE::pcre_extra* m_extra;
+  int               m_iOvector[OVECCOUNT];
+  int               m_iMatchCount;
+  int               m_iOptions;
+  bool              m_bMatched;
+  bool              m_bSubject; ///< m_subject holds the subject of the last match
+  std::string       m_subject;
+  std::string       m_pattern;
 };
 
 typedef std::vector<CRegExp> VECCREGEXP;
@@ -160,6 +160,10 @@ bool CSaveFileStateJob::DoWork()
 
         if (updateListing)
         {
+          // PVR: recordings keep the play count and resume point they read from the database
+          if (m_item.HasPVRRecordingInfoTag() && g_PVRRecordings)
+            g_PVRRecordings->ResetMetadata(*m_item.GetPVRRecordingInfoTag());
+
           CUtil::DeleteVideoDatabaseDirectoryCache();
           CFileItemPtr msgItem(new CFileItem(m_item));
           if (m_item.HasProperty("original_listitem_url"))
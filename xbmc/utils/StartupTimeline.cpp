@@ -0,0 +1,250 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "StartupTimeline.h"
+
+#ifdef TARGET_POSIX
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/log.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+
+#define STARTUP_TRACE_FILE "special://temp/startuptrace.json"
+// startup records a few hundred spans, this only guards against a span in a loop
+#define STARTUP_MAX_SPANS  16384
+
+CStartupTimeline::CStartupTimeline()
+  : m_recording(true)
+  , m_output(false)
+  , m_start(CurrentHostCounter())
+  , m_frequency(CurrentHostFrequency())
+{
+}
+
+CStartupTimeline::~CStartupTimeline()
+{
+  for (std::vector<SThread*>::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+    delete *it;
+}
+
+CStartupTimeline &CStartupTimeline::Get()
+{
+  static CStartupTimeline timeline;
+  return timeline;
+}
+
+void CStartupTimeline::SetOutput(const std::string &file)
+{
+  CSingleLock lock(m_section);
+  m_output = true;
+  m_outputFile = file;
+}
+
+CStartupTimeline::SThread *CStartupTimeline::GetThread()
+{
+  SThread *thread = m_currentThread.get();
+  if (!thread)
+  {
+    thread = new SThread;
+    thread->fileOpens = 0;
+    CThread *current = CThread::GetCurrentThread();
+    if (current)
+      thread->name = current->GetName();
+
+    CSingleLock lock(m_section);
+    // the application thread is the first one to record and isn't a CThread
+    if (thread->name.empty())
+      thread->name = m_threads.empty() ? "main" : "unnamed";
+    thread->id = m_threads.size() + 1;
+    m_threads.push_back(thread);
+    m_currentThread.set(thread);
+  }
+  return thread;
+}
+
+void CStartupTimeline::CountFileOpen()
+{
+  CStartupTimeline &timeline = Get();
+  if (timeline.m_recording)
+    timeline.GetThread()->fileOpens++;
+}
+
+void CStartupTimeline::Sample(SSample &sample)
+{
+  sample.wall      = CurrentHostCounter();
+  sample.cpu       = 0;
+  sample.fileOpens = GetThread()->fileOpens;
+  sample.blocksIn  = 0;
+  sample.blocksOut = 0;
+
+#if defined(TARGET_WINDOWS)
+  FILETIME creation, exit, kernel, user;
+  if (GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+  {
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+    sample.cpu = (int64_t)(k.QuadPart + u.QuadPart) / 10;
+  }
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+    sample.cpu = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+
+#if defined(TARGET_POSIX)
+  struct rusage usage;
+#if defined(RUSAGE_THREAD)
+  if (getrusage(RUSAGE_THREAD, &usage) == 0)
+#else
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+#endif
+  {
+    sample.blocksIn  = usage.ru_inblock;
+    sample.blocksOut = usage.ru_oublock;
+  }
+#endif
+}
+
+void CStartupTimeline::AddSpan(const char *name, const std::string &detail, int thread, const SSample &begin, const SSample &end)
+{
+  CSingleLock lock(m_section);
+  if (!m_recording || m_spans.size() >= STARTUP_MAX_SPANS)
+    return;
+
+  SSpan span;
+  span.name   = name;
+  span.detail = detail;
+  span.thread = thread;
+  span.begin  = begin;
+  span.end    = end;
+  m_spans.push_back(span);
+}
+
+std::string CStartupTimeline::GetTrace()
+{
+  CSingleLock lock(m_section);
+
+  CVariant events(CVariant::VariantTypeArray);
+  for (std::vector<SThread*>::const_iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+  {
+    CVariant event;
+    event["name"] = "thread_name";
+    event["ph"]   = "M";
+    event["pid"]  = 1;
+    event["tid"]  = (*it)->id;
+    event["args"]["name"] = (*it)->name;
+    events.push_back(event);
+  }
+
+  for (std::vector<SSpan>::const_iterator it = m_spans.begin(); it != m_spans.end(); ++it)
+  {
+    CVariant event;
+    event["name"] = it->name;
+    event["cat"]  = "startup";
+    event["ph"]   = "X";
+    event["pid"]  = 1;
+    event["tid"]  = it->thread;
+    event["ts"]   = (it->begin.wall - m_start) * 1000000 / m_frequency;
+    event["dur"]  = (it->end.wall - it->begin.wall) * 1000000 / m_frequency;
+    event["args"]["cpu_us"]     = it->end.cpu - it->begin.cpu;
+    event["args"]["file_opens"] = it->end.fileOpens - it->begin.fileOpens;
+    event["args"]["blocks_in"]  = it->end.blocksIn - it->begin.blocksIn;
+    event["args"]["blocks_out"] = it->end.blocksOut - it->begin.blocksOut;
+    if (!it->detail.empty())
+      event["args"]["detail"] = it->detail;
+    events.push_back(event);
+  }
+
+  CVariant trace;
+  trace["traceEvents"]     = events;
+  trace["displayTimeUnit"] = "ms";
+  return CJSONVariantWriter::Write(trace, true);
+}
+
+void CStartupTimeline::Finish()
+{
+  unsigned int spans;
+  {
+    CSingleLock lock(m_section);
+    if (!m_recording)
+      return;
+    m_recording = false;
+    spans = m_spans.size();
+  }
+
+  CLog::Log(LOGNOTICE, "Startup took %.0f ms, %u phases recorded",
+            1000.0 * (CurrentHostCounter() - m_start) / m_frequency, spans);
+
+  if (!m_output && !g_advancedSettings.m_startupTrace)
+    return;
+
+  std::string file = m_outputFile.empty() ? STARTUP_TRACE_FILE : m_outputFile;
+  std::string trace = GetTrace();
+  XFILE::CFile output;
+  if (!output.OpenForWrite(file, true) ||
+      output.Write(trace.c_str(), trace.size()) != (int)trace.size())
+  {
+    CLog::Log(LOGERROR, "%s - unable to write the startup trace to %s", __FUNCTION__, file.c_str());
+    return;
+  }
+  CLog::Log(LOGNOTICE, "Startup trace written to %s", file.c_str());
+}
+
+CStartupSpan::CStartupSpan(const char *name, const char *detail /* = NULL */)
+  : m_name(NULL)
+  , m_thread(0)
+{
+  CStartupTimeline &timeline = CStartupTimeline::Get();
+  if (!timeline.m_recording)
+    return;
+
+  m_name = name;
+  if (detail)
+    m_detail = detail;
+  m_thread = timeline.GetThread()->id;
+  timeline.Sample(m_begin);
+}
+
+CStartupSpan::~CStartupSpan()
+{
+  End();
+}
+
+void CStartupSpan::End()
+{
+  if (!m_name)
+    return;
+
+  CStartupTimeline &timeline = CStartupTimeline::Get();
+  CStartupTimeline::SSample end;
+  timeline.Sample(end);
+  timeline.AddSpan(m_name, m_detail, m_thread, m_begin, end);
+  m_name = NULL;
+}
@@ -0,0 +1,135 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/ThreadLocal.h"
+
+/*!
+ \brief Records where the time goes while XBMC starts up.
+
+ Phases are recorded as nested spans per thread, see CStartupSpan, with their wall clock
+ and cpu time, the number of files opened and the blocks read and written. Recording stops
+ once the first frame has been presented. If requested by --trace-startup on the command
+ line or <startuptrace> in advancedsettings.xml the spans are then written as Chrome trace
+ event json, which can be viewed in chrome://tracing or Perfetto.
+ */
+class CStartupTimeline
+{
+public:
+  static CStartupTimeline &Get();
+
+  /*! \brief Request the trace to be written when startup finishes
+   \param file path of the json file, special://temp/startuptrace.json if empty.
+   */
+  void SetOutput(const std::string &file);
+
+  bool IsRecording() const { return m_recording; };
+
+  /*! \brief Stop recording, log the startup time and write the trace if requested
+   */
+  void Finish();
+
+  /*! \brief Get the spans recorded so far in Chrome trace event format
+   */
+  std::string GetTrace();
+
+  /*! \brief Count a file being opened by the calling thread, called by XFILE::CFile
+   */
+  static void CountFileOpen();
+
+private:
+  friend class CStartupSpan;
+
+  CStartupTimeline();
+  CStartupTimeline(const CStartupTimeline&);
+  CStartupTimeline const& operator=(CStartupTimeline const&);
+  ~CStartupTimeline();
+
+  struct SThread
+  {
+    int         id;
+    std::string name;
+    int64_t     fileOpens;
+  };
+
+  struct SSample
+  {
+    int64_t wall;      ///< host counter
+    int64_t cpu;       ///< thread cpu time in us
+    int64_t fileOpens;
+    int64_t blocksIn;
+    int64_t blocksOut;
+  };
+
+  struct SSpan
+  {
+    const char *name;
+    std::string detail;
+    int         thread;
+    SSample     begin;
+    SSample     end;
+  };
+
+  SThread *GetThread();
+  void     Sample(SSample &sample);
+  void     AddSpan(const char *name, const std::string &detail, int thread, const SSample &begin, const SSample &end);
+
+  volatile bool                    m_recording;
+  bool                             m_output;
+  std::string                      m_outputFile;
+  int64_t                          m_start;
+  int64_t                          m_frequency;
+
+  CCriticalSection                 m_section;
+  std::vector<SSpan>               m_spans;
+  std::vector<SThread*>            m_threads;
+  XbmcThreads::ThreadLocal<SThread> m_currentThread;
+};
+
+/*!
+ \brief A named phase of the startup, recorded from construction until End() or destruction.
+ Does nothing once the startup timeline has finished, so it can stay in code that runs later on.
+ */
+class CStartupSpan
+{
+public:
+  /*!
+   \param name a string literal, kept stable so traces can be compared between builds.
+   \param detail optional detail, e.g. the name of the database being updated.
+   */
+  CStartupSpan(const char *name, const char *detail = NULL);
+  ~CStartupSpan();
+
+  void End();
+
+private:
+  CStartupSpan(const CStartupSpan&);
+  CStartupSpan const& operator=(CStartupSpan const&);
+
+  const char                *m_name;
+  std::string                m_detail;
+  int                        m_thread;
+  CStartupTimeline::SSample  m_begin;
+};
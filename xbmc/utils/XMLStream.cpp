@@ -0,0 +1,320 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "XMLStream.h"
+#include "utils/XMLUtils.h"
+#include "utils/log.h"
+
+using namespace XFILE;
+
+#define XML_STREAM_CHUNK 65536
+
+CXMLStreamWriter::CXMLStreamWriter()
+  : m_open(false), m_error(false)
+{
+}
+
+CXMLStreamWriter::~CXMLStreamWriter()
+{
+  Discard();
+}
+
+bool CXMLStreamWriter::Open(const std::string &path, const std::string &root)
+{
+  if (m_open)
+    Close();
+
+  m_path = path;
+  m_tempPath = path + ".tmp";
+  m_open = m_file.OpenForWrite(m_tempPath, true);
+  if (!m_open)
+    return false;
+
+  m_root = root;
+  m_error = false;
+  std::string header = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\" ?>\n<" + m_root + ">\n";
+  return Write(header.c_str(), header.size());
+}
+
+bool CXMLStreamWriter::Write(const TiXmlNode &node)
+{
+  TiXmlPrinter printer;
+  node.Accept(&printer);
+  return Write(printer.CStr(), printer.Size());
+}
+
+bool CXMLStreamWriter::Close()
+{
+  if (!m_open)
+    return false;
+
+  std::string footer = "</" + m_root + ">\n";
+  Write(footer.c_str(), footer.size());
+  m_file.Close();
+  m_open = false;
+  if (m_error)
+  {
+    CFile::Delete(m_tempPath);
+    return false;
+  }
+
+  if (!CFile::Rename(m_tempPath, m_path))
+  {
+    // no atomic replace on windows
+    CFile::Delete(m_path);
+    if (!CFile::Rename(m_tempPath, m_path))
+    {
+      CLog::Log(LOGERROR, "%s - unable to move %s in place", __FUNCTION__, m_path.c_str());
+      CFile::Delete(m_tempPath);
+      return false;
+    }
+  }
+  return true;
+}
+
+void CXMLStreamWriter::Discard()
+{
+  if (!m_open)
+    return;
+
+  m_file.Close();
+  m_open = false;
+  CFile::Delete(m_tempPath);
+}
+
+bool CXMLStreamWriter::Write(const char *data, size_t size)
+{
+  if (!m_open)
+    return false;
+
+  if (m_file.Write(data, size) != (int)size)
+  {
+    if (!m_error)
+      CLog::Log(LOGERROR, "%s - failed writing to the file", __FUNCTION__);
+    m_error = true;
+  }
+  return !m_error;
+}
+
+CXMLStreamReader::CXMLStreamReader()
+  : m_position(0), m_length(0), m_encoding(TIXML_DEFAULT_ENCODING), m_eof(true), m_ended(true)
+{
+}
+
+bool CXMLStreamReader::Open(const std::string &path)
+{
+  Close();
+  if (!m_file.Open(path))
+    return false;
+
+  m_length = m_file.GetLength();
+  m_eof = false;
+
+  Fill(3);
+  if (m_buffer.compare(0, 3, "\xEF\xBB\xBF") == 0)
+  {
+    m_encoding = TIXML_ENCODING_UTF8;
+    Consume(3);
+  }
+
+  // skip the declaration and anything else in front of the root element
+  size_t pos;
+  while ((pos = Find("<", 0)) != std::string::npos)
+  {
+    size_t end;
+    TagType type = ReadTag(pos, end);
+    if (type == TAG_NONE || type == TAG_END)
+      break;
+    if (type == TAG_OTHER)
+    {
+      if (XMLUtils::HasUTF8Declaration(m_buffer.substr(pos, end - pos)))
+        m_encoding = TIXML_ENCODING_UTF8;
+      Consume(end);
+      continue;
+    }
+
+    m_ended = type == TAG_EMPTY;
+    Consume(end);
+    return true;
+  }
+
+  CLog::Log(LOGERROR, "%s - %s has no root element", __FUNCTION__, path.c_str());
+  Close();
+  return false;
+}
+
+void CXMLStreamReader::Close()
+{
+  m_file.Close();
+  m_buffer.clear();
+  m_position = 0;
+  m_length = 0;
+  m_encoding = TIXML_DEFAULT_ENCODING;
+  m_eof = true;
+  m_ended = true;
+}
+
+bool CXMLStreamReader::Next(CXBMCTinyXML &doc)
+{
+  size_t start = std::string::npos;
+  size_t pos = 0;
+  int depth = 0;
+  while (!m_ended && (pos = Find("<", pos)) != std::string::npos)
+  {
+    size_t end;
+    TagType type = ReadTag(pos, end);
+    if (type == TAG_NONE)
+      break;
+
+    if (type == TAG_START || type == TAG_EMPTY)
+    {
+      if (depth == 0)
+        start = pos;
+      if (type == TAG_START)
+        depth++;
+    }
+    else if (type == TAG_END)
+    {
+      if (depth == 0)
+      { // the closing tag of the root element
+        m_ended = true;
+        Consume(end);
+        return false;
+      }
+      depth--;
+    }
+
+    if (start == std::string::npos)
+    { // comments and text between the children
+      Consume(end);
+      pos = 0;
+    }
+    else if (depth == 0)
+    {
+      CStdString child = m_buffer.substr(start, end - start);
+      Consume(end);
+      doc.Clear();
+      doc.Parse(child, NULL, m_encoding);
+      if (doc.Error() || !doc.RootElement())
+      {
+        CLog::Log(LOGERROR, "%s - error parsing element at %"PRId64": %s", __FUNCTION__, m_position, doc.ErrorDesc());
+        return false;
+      }
+      return true;
+    }
+    else
+      pos = end;
+  }
+
+  if (!m_ended)
+    CLog::Log(LOGERROR, "%s - unexpected end of file at %"PRId64, __FUNCTION__, m_position + (int64_t)m_buffer.size());
+  return false;
+}
+
+CXMLStreamReader::TagType CXMLStreamReader::ReadTag(size_t pos, size_t &end)
+{
+  // enough for the longest prefix, <![CDATA[
+  Fill(pos + 9);
+  if (m_buffer.size() < pos + 2)
+    return TAG_NONE;
+
+  const char *close = NULL;
+  TagType type = TAG_OTHER;
+  if (m_buffer[pos + 1] == '?')
+    close = "?>";
+  else if (m_buffer.compare(pos, 4, "<!--") == 0)
+    close = "-->";
+  else if (m_buffer.compare(pos, 9, "<![CDATA[") == 0)
+    close = "]]>";
+  else if (m_buffer[pos + 1] == '!')
+    close = ">";
+  else if (m_buffer[pos + 1] == '/')
+  {
+    close = ">";
+    type = TAG_END;
+  }
+
+  if (close)
+  {
+    size_t found = Find(close, pos + 2);
+    if (found == std::string::npos)
+      return TAG_NONE;
+    end = found + strlen(close);
+    return type;
+  }
+
+  // a start tag, whose attribute values may contain '>'
+  char quote = 0;
+  for (size_t i = pos + 1; i < m_buffer.size() || Fill(i + 1); i++)
+  {
+    char c = m_buffer[i];
+    if (quote)
+    {
+      if (c == quote)
+        quote = 0;
+    }
+    else if (c == '"' || c == '\'')
+      quote = c;
+    else if (c == '>')
+    {
+      end = i + 1;
+      return m_buffer[i - 1] == '/' ? TAG_EMPTY : TAG_START;
+    }
+  }
+  return TAG_NONE;
+}
+
+size_t CXMLStreamReader::Find(const char *token, size_t pos)
+{
+  size_t length = strlen(token);
+  while (true)
+  {
+    size_t found = m_buffer.find(token, pos);
+    if (found != std::string::npos)
+      return found;
+    // a token split over two reads is found in the next search
+    if (m_buffer.size() >= pos + length)
+      pos = m_buffer.size() - length + 1;
+    if (!Fill(m_buffer.size() + 1))
+      return std::string::npos;
+  }
+}
+
+bool CXMLStreamReader::Fill(size_t size)
+{
+  while (m_buffer.size() < size && !m_eof)
+  {
+    size_t used = m_buffer.size();
+    m_buffer.resize(used + XML_STREAM_CHUNK);
+    unsigned int read = m_file.Read(&m_buffer[used], XML_STREAM_CHUNK);
+    m_buffer.resize(used + read);
+    if (read == 0)
+      m_eof = true;
+  }
+  return m_buffer.size() >= size;
+}
+
+void CXMLStreamReader::Consume(size_t size)
+{
+  m_buffer.erase(0, size);
+  m_position += size;
+}
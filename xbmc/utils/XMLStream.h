@@ -0,0 +1,113 @@
+#pragma once
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include "filesystem/File.h"
+#include "utils/XBMCTinyXML.h"
+
+/*!
+ \brief Writes an xml document one child of the root element at a time.
+
+ Each child is built as a small document and written out before the next one is built, so a
+ document as large as an exported library is never held in memory at once.
+
+ The document is written next to its destination and only replaces it once Close() succeeded.
+ A writer destroyed without Close(), e.g. when an export is cancelled, leaves an existing file
+ untouched.
+ */
+class CXMLStreamWriter
+{
+public:
+  CXMLStreamWriter();
+  ~CXMLStreamWriter();
+
+  /*! \brief Create the temporary file and write the declaration and the opening tag of the root element */
+  bool Open(const std::string &path, const std::string &root);
+
+  /*! \brief Append a node to the root element, a document appends all its children */
+  bool Write(const TiXmlNode &node);
+
+  /*! \brief Write the closing tag of the root element, close the file and move it in place
+   \return false if any of the writes failed, the destination is left untouched then.
+   */
+  bool Close();
+
+private:
+  bool Write(const char *data, size_t size);
+  void Discard();
+
+  XFILE::CFile m_file;
+  std::string  m_path;
+  std::string  m_tempPath;
+  std::string  m_root;
+  bool         m_open;
+  bool         m_error;
+};
+
+/*!
+ \brief Reads an xml document one child of the root element at a time.
+
+ Only the text of the current child is kept in memory, which is parsed as a document of its
+ own. The rest of the file is scanned for the tags that start and end the children.
+ */
+class CXMLStreamReader
+{
+public:
+  CXMLStreamReader();
+
+  /*! \brief Open the file and read up to the opening tag of the root element */
+  bool Open(const std::string &path);
+  void Close();
+
+  /*! \brief Read the next child of the root element
+   \param doc receives the child as its root element.
+   \return false at the end of the root element, or if the file is truncated or malformed.
+   */
+  bool Next(CXBMCTinyXML &doc);
+
+  /*! \brief Bytes read so far and in total, for progress */
+  int64_t GetPosition() const { return m_position; };
+  int64_t GetLength() const { return m_length; };
+
+private:
+  enum TagType
+  {
+    TAG_NONE,  ///< the file ended in the tag
+    TAG_START,
+    TAG_END,
+    TAG_EMPTY, ///< <tag/>
+    TAG_OTHER  ///< declarations, comments, CDATA
+  };
+
+  TagType ReadTag(size_t pos, size_t &end);
+  size_t Find(const char *token, size_t pos);
+  bool Fill(size_t size);
+  void Consume(size_t size);
+
+  XFILE::CFile  m_file;
+  std::string   m_buffer;   ///< read from the file and not consumed yet
+  int64_t       m_position; ///< of the start of m_buffer in the file
+  int64_t       m_length;
+  TiXmlEncoding m_encoding;
+  bool          m_eof;      ///< the whole file is read
+  bool          m_ended;    ///< the root element is closed
+};
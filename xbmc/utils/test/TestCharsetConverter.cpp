@@ -19,10 +19,16 @@
  */
 
 #include "settings/Settings.h"
+#include "threads/SystemClock.h"
+#include "threads/test/TestHelpers.h"
 #include "utils/CharsetConverter.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <errno.h>
+#include <iconv.h>
+
 static const uint16_t refutf16LE1[] = { 0xff54, 0xff45, 0xff53, 0xff54,
                                         0xff3f, 0xff55, 0xff54, 0xff46,
                                         0xff11, 0xff16, 0xff2c, 0xff25,
@@ -395,3 +401,169 @@ TEST_F(TestCharsetConverter, fromW)
   g_charsetConverter.fromW(refstrw1, varstra1, "UTF-16LE");
   EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
 }
+
+/* UTF-8 fragments the native conversions are checked against iconv with:
+   ASCII, 2, 3 and 4 byte sequences and invalid input (surrogate, overlong,
+   truncated and stray bytes) */
+static const char *utf8Fragments[] = {
+  "a", "Z", " ", "\n", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x90\xad",
+  "\xef\xbf\xbf", "\xc2\x80", "\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf",
+  "\xed\xa0\x80", "\xc0\xaf", "\xe0\x9f\xbf", "\xe2\x82", "\x80", "\xff",
+  NULL
+};
+
+// converts like convert_checked() does, straight through iconv
+template<class INPUT, class OUTPUT>
+static void iconvReference(const char *from, const char *to, const INPUT& source, OUTPUT& dest)
+{
+  iconv_t cd = iconv_open(to, from);
+  ASSERT_NE((iconv_t)-1, cd);
+
+  size_t inSize = (source.length() + 1) * sizeof(source[0]);
+  const char *in = (const char *)source.c_str();
+  std::vector<char> out(inSize * 4 + 16);
+  char *outPtr = &out[0];
+  size_t outSize = out.size();
+  while (iconv_const(cd, &in, &inSize, &outPtr, &outSize) == (size_t)-1 && errno == EILSEQ)
+  {
+    in++;
+    inSize--;
+  }
+  iconv_close(cd);
+
+  size_t written = out.size() - outSize;
+  dest.clear();
+  memcpy(dest.GetBuffer(written), &out[0], written);
+  dest.ReleaseBuffer();
+}
+
+TEST_F(TestCharsetConverter, NativeMatchesIconv)
+{
+  unsigned int count = 0;
+  while (utf8Fragments[count])
+    count++;
+
+  // every pair and a few longer mixes of the fragments
+  for (unsigned int i = 0; i < count * count + 500; i++)
+  {
+    CStdStringA utf8;
+    if (i < count * count)
+      utf8 = CStdStringA("x") + utf8Fragments[i / count] + utf8Fragments[i % count];
+    else
+    {
+      for (unsigned int j = 0; j < 12; j++)
+        utf8 += utf8Fragments[(i * 7 + j * 13) % count];
+    }
+
+    CStdStringW wide, wideRef;
+    g_charsetConverter.utf8ToW(utf8, wide, false);
+    iconvReference("UTF-8", "WCHAR_T", utf8, wideRef);
+    EXPECT_TRUE(wide == wideRef) << "utf8ToW, input " << i;
+
+    CStdString16 utf16, utf16Ref;
+    g_charsetConverter.utf8To("UTF-16LE", utf8, utf16);
+    iconvReference("UTF-8", "UTF-16LE", utf8, utf16Ref);
+    EXPECT_TRUE(utf16 == utf16Ref) << "utf8To UTF-16LE, input " << i;
+
+    g_charsetConverter.utf8To("UTF-16BE", utf8, utf16);
+    iconvReference("UTF-8", "UTF-16BE", utf8, utf16Ref);
+    EXPECT_TRUE(utf16 == utf16Ref) << "utf8To UTF-16BE, input " << i;
+
+    CStdString32 utf32, utf32Ref;
+    g_charsetConverter.utf8To("UTF-32LE", utf8, utf32);
+    iconvReference("UTF-8", "UTF-32LE", utf8, utf32Ref);
+    EXPECT_TRUE(utf32 == utf32Ref) << "utf8To UTF-32LE, input " << i;
+
+    g_charsetConverter.utf8To("UTF-32BE", utf8, utf32);
+    iconvReference("UTF-8", "UTF-32BE", utf8, utf32Ref);
+    EXPECT_TRUE(utf32 == utf32Ref) << "utf8To UTF-32BE, input " << i;
+
+    // and back from the (valid) unicode strings
+    CStdStringA back, backRef;
+    g_charsetConverter.wToUTF8(wideRef, back);
+    iconvReference("WCHAR_T", "UTF-8", wideRef, backRef);
+    EXPECT_STREQ(backRef.c_str(), back.c_str()) << "wToUTF8, input " << i;
+
+    iconvReference("UTF-8", "UTF-16LE", utf8, utf16Ref);
+    g_charsetConverter.utf16LEtoUTF8(utf16Ref, back);
+    iconvReference("UTF-16LE", "UTF-8", utf16Ref, backRef);
+    EXPECT_STREQ(backRef.c_str(), back.c_str()) << "utf16LEtoUTF8, input " << i;
+
+    g_charsetConverter.utf16LEtoW(utf16Ref, wide);
+    iconvReference("UTF-16LE", "WCHAR_T", utf16Ref, wideRef);
+    EXPECT_TRUE(wide == wideRef) << "utf16LEtoW, input " << i;
+
+    iconvReference("UTF-8", "UTF-16BE", utf8, utf16Ref);
+    g_charsetConverter.utf16BEtoUTF8(utf16Ref, back);
+    iconvReference("UTF-16BE", "UTF-8", utf16Ref, backRef);
+    EXPECT_STREQ(backRef.c_str(), back.c_str()) << "utf16BEtoUTF8, input " << i;
+  }
+}
+
+TEST_F(TestCharsetConverter, utf8ToW_ASCII)
+{
+  bool flipped = true;
+  refstra1 = "line one\nline two\n";
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, true, false, &flipped);
+  EXPECT_STREQ(L"line oneline two", varstrw1.c_str());
+  EXPECT_FALSE(flipped);
+
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, false);
+  EXPECT_STREQ(L"line one\nline two\n", varstrw1.c_str());
+}
+
+class CCharsetConversions : public IRunnable
+{
+public:
+  CCharsetConversions(unsigned int conversions) : m_conversions(conversions), m_failures(0) {}
+
+  virtual void Run()
+  {
+    CStdStringA utf8 = "Ｔｅｓｔ ｃｏｎｖｅｒｓｉｏｎ - Grüße aus Köln \xf0\x9f\x90\xad";
+    CStdStringA ascii = "The.Show.S01E02.720p.HDTV.x264.mkv";
+    for (unsigned int i = 0; i < m_conversions; i++)
+    {
+      CStdStringW wide;
+      CStdStringA back;
+      g_charsetConverter.utf8ToW(i & 1 ? utf8 : ascii, wide, false);
+      g_charsetConverter.wToUTF8(wide, back);
+      if (back != (i & 1 ? utf8 : ascii))
+        m_failures++;
+    }
+  }
+
+  unsigned int m_conversions;
+  unsigned int m_failures;
+};
+
+TEST_F(TestCharsetConverter, ThreadedBenchmark)
+{
+  const unsigned int threads = 4;
+  const unsigned int conversions = 50000;
+
+  std::vector<CCharsetConversions*> runners;
+  std::vector<thread> workers;
+  workers.reserve(threads);
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    runners.push_back(new CCharsetConversions(conversions));
+    workers.push_back(thread(*runners.back()));
+  }
+  for (unsigned int i = 0; i < threads; i++)
+    workers[i].join();
+  unsigned int elapsed = std::max(1U, XbmcThreads::SystemClockMillis() - start);
+
+  RecordProperty("elapsedMs", (int)elapsed);
+  RecordProperty("roundTripsPerSecond", (int)((int64_t)threads * conversions * 1000 / elapsed));
+
+  // a generous bound, conversions stalling on each other would exceed it
+  EXPECT_GT(30000U, elapsed);
+
+  for (unsigned int i = 0; i < threads; i++)
+  {
+    EXPECT_EQ(0U, runners[i]->m_failures);
+    delete runners[i];
+  }
+}
@@ -21,9 +21,168 @@
 #include "utils/JobManager.h"
 #include "settings/Settings.h"
 #include "utils/SystemInfo.h"
+#include "threads/SystemClock.h"
+#include "threads/test/TestHelpers.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
+class CCountingJob : public CJob
+{
+public:
+  CCountingJob(volatile long &counter, unsigned int affinity = 0) : m_counter(counter), m_affinity(affinity) {}
+  virtual bool DoWork()
+  {
+    AtomicIncrement(&m_counter);
+    return true;
+  }
+  virtual const char *GetType() const { return "counting"; }
+  virtual unsigned int GetAffinity() const { return m_affinity; }
+private:
+  volatile long &m_counter;
+  unsigned int m_affinity;
+};
+
+class CCountingCallback : public IJobCallback
+{
+public:
+  CCountingCallback() : completed(0) {}
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    AtomicIncrement(&completed);
+  }
+  volatile long completed;
+};
+
+/* Counts callbacks of jobs that were cancelled before they completed. */
+class CCancelCheckCallback : public IJobCallback
+{
+public:
+  CCancelCheckCallback() : completed(0), m_afterCancel(0) {}
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    CSingleLock lock(m_section);
+    if (m_cancelled.find(jobID) != m_cancelled.end())
+      m_afterCancel++;
+    AtomicIncrement(&completed);
+  }
+  void Cancel(unsigned int jobID)
+  {
+    CJobManager::GetInstance().CancelJob(jobID);
+    CSingleLock lock(m_section);
+    m_cancelled.insert(jobID);
+  }
+  int AfterCancel()
+  {
+    CSingleLock lock(m_section);
+    return m_afterCancel;
+  }
+  volatile long completed;
+private:
+  int m_afterCancel;
+  CCriticalSection m_section;
+  std::set<unsigned int> m_cancelled;
+};
+
+class job_producer : public IRunnable
+{
+  IJobCallback &callback;
+  volatile long &counter;
+  int count;
+public:
+  job_producer(IJobCallback &cb, volatile long &c, int n) : callback(cb), counter(c), count(n) {}
+
+  void Run()
+  {
+    for (int i = 0; i < count; i++)
+      CJobManager::GetInstance().AddJob(new CCountingJob(counter), &callback);
+  }
+};
+
+/* CancelJobs() shuts the manager down for good, so these run before the
+   TestJobManager cases and only the last one cancels. */
+TEST(TestJobManagerQueue, PauseHoldsJobs)
+{
+  volatile long counter = 0;
+  CCountingCallback callback;
+
+  CJobManager::GetInstance().Pause(CJob::PRIORITY_LOW);
+  CJobManager::GetInstance().AddJob(new CCountingJob(counter), &callback);
+  SleepMillis(100);
+  EXPECT_EQ(0, counter);
+
+  CJobManager::GetInstance().UnPause(CJob::PRIORITY_LOW);
+  EXPECT_TRUE(waitForThread(callback.completed, 1, 5000));
+  EXPECT_EQ(1, counter);
+}
+
+TEST(TestJobManagerQueue, AffinityAndStats)
+{
+  volatile long counter = 0;
+  CCountingCallback callback;
+
+  unsigned int before = CJobManager::GetInstance().GetJobStats()["counting"].count;
+  for (int i = 0; i < 100; i++)
+    CJobManager::GetInstance().AddJob(new CCountingJob(counter, 1 + i % 3), &callback);
+  EXPECT_TRUE(waitForThread(callback.completed, 100, 10000));
+  EXPECT_EQ(100, counter);
+
+  // the callback runs before the stats are updated
+  SleepMillis(100);
+  EXPECT_EQ(before + 100, CJobManager::GetInstance().GetJobStats()["counting"].count);
+}
+
+TEST(TestJobManagerQueue, CancelWhileStealing)
+{
+  volatile long counter = 0;
+  CCancelCheckCallback callback;
+
+  // everything is queued on the last slot, so the other workers steal from it
+  std::vector<unsigned int> ids;
+  for (int i = 0; i < 2000; i++)
+    ids.push_back(CJobManager::GetInstance().AddJob(new CCountingJob(counter, 4), &callback));
+  for (size_t i = 0; i < ids.size(); i++)
+    callback.Cancel(ids[i]);
+
+  // whatever wasn't cancelled in time completes, but no callback may follow a cancel
+  SleepMillis(500);
+  EXPECT_EQ(0, callback.AfterCancel());
+}
+
+TEST(TestJobManagerQueue, ContentionBenchmark)
+{
+  const int producers = 4;
+  const int jobsPerProducer = 5000;
+  volatile long counter = 0;
+  CCountingCallback callback;
+
+  job_producer producer(callback, counter, jobsPerProducer);
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
+  thread* threads[producers];
+  for (int i = 0; i < producers; i++)
+    threads[i] = new thread(producer);
+  for (int i = 0; i < producers; i++)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  EXPECT_TRUE(waitForThread(callback.completed, producers * jobsPerProducer, 60000));
+  unsigned int elapsed = std::max(1U, XbmcThreads::SystemClockMillis() - start);
+  RecordProperty("elapsedMs", (int)elapsed);
+  RecordProperty("jobsPerSecond", (int)((int64_t)producers * jobsPerProducer * 1000 / elapsed));
+
+  // well below the wait above, producers serialized on the queues would come close to it
+  EXPECT_GT(20000U, elapsed);
+  EXPECT_EQ(producers * jobsPerProducer, counter);
+
+  CJobManager::GetInstance().CancelJobs();
+}
+
 /* CSysInfoJob::GetInternetState() will test for network connectivity. */
 class TestJobManager : public testing::Test
 {
@@ -0,0 +1,154 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/PlaybackTrace.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/Variant.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+static int CountEvents(const CVariant &trace, const std::string &name, const CVariant **last = NULL)
+{
+  int count = 0;
+  const CVariant &events = trace["traceEvents"];
+  for (CVariant::const_iterator_array it = events.begin_array(); it != events.end_array(); ++it)
+  {
+    if ((*it)["name"].asString() == name)
+    {
+      count++;
+      if (last)
+        *last = &(*it);
+    }
+  }
+  return count;
+}
+
+static CVariant GetTrace()
+{
+  std::string json = CPlaybackTrace::GetTrace();
+  return CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size());
+}
+
+class CPlaybackTraceThread : public CThread
+{
+public:
+  CPlaybackTraceThread(const char *name = "PlaybackTraceTest") : CThread(name) {}
+protected:
+  virtual void Process()
+  {
+    CPlaybackTraceSpan span("TestPlaybackTrace::Thread");
+    XbmcThreads::ThreadSleep(2);
+  }
+};
+
+TEST(TestPlaybackTrace, General)
+{
+  CPlaybackTrace::Enable(true);
+  {
+    CPlaybackTraceSpan span("TestPlaybackTrace::Span");
+    XbmcThreads::ThreadSleep(5);
+  }
+  CPlaybackTrace::AddCounter("TestPlaybackTrace::Counter", 42);
+  CPlaybackTrace::AddInstant("TestPlaybackTrace::Instant");
+
+  CPlaybackTraceThread thread;
+  thread.Create();
+  thread.StopThread(true);
+
+  CVariant trace = GetTrace();
+  ASSERT_TRUE(trace["traceEvents"].isArray());
+
+  const CVariant *span = NULL, *counter = NULL, *instant = NULL, *other = NULL;
+  EXPECT_EQ(1, CountEvents(trace, "TestPlaybackTrace::Span", &span));
+  EXPECT_EQ(1, CountEvents(trace, "TestPlaybackTrace::Counter", &counter));
+  EXPECT_EQ(1, CountEvents(trace, "TestPlaybackTrace::Instant", &instant));
+  EXPECT_EQ(1, CountEvents(trace, "TestPlaybackTrace::Thread", &other));
+  ASSERT_TRUE(span && counter && instant && other);
+
+  EXPECT_STREQ("X", (*span)["ph"].asString().c_str());
+  EXPECT_GE((*span)["dur"].asInteger(), 5000);
+  EXPECT_STREQ("C", (*counter)["ph"].asString().c_str());
+  EXPECT_EQ(42, (*counter)["args"]["value"].asInteger());
+  EXPECT_STREQ("i", (*instant)["ph"].asString().c_str());
+  EXPECT_EQ((*span)["tid"].asInteger(), (*instant)["tid"].asInteger());
+  EXPECT_NE((*span)["tid"].asInteger(), (*other)["tid"].asInteger());
+
+  CPlaybackTrace::Enable(false);
+  {
+    CPlaybackTraceSpan span("TestPlaybackTrace::Disabled");
+  }
+  CPlaybackTrace::AddInstant("TestPlaybackTrace::Disabled");
+  EXPECT_EQ(0, CountEvents(GetTrace(), "TestPlaybackTrace::Disabled"));
+  CPlaybackTrace::ReleaseThread();
+}
+
+TEST(TestPlaybackTrace, Wrap)
+{
+  // re-enabling drops what was recorded before
+  CPlaybackTrace::Enable(true);
+  for (int i = 0; i < 10000; i++)
+    CPlaybackTrace::AddCounter("TestPlaybackTrace::Wrap", i);
+
+  const CVariant *last = NULL;
+  CVariant trace = GetTrace();
+  EXPECT_EQ(0, CountEvents(trace, "TestPlaybackTrace::Span"));
+  // the oldest slot of a full ring is the one the writer fills next, so it is left out
+  EXPECT_EQ(8191, CountEvents(trace, "TestPlaybackTrace::Wrap", &last));
+  ASSERT_TRUE(last != NULL);
+  EXPECT_EQ(9999, (*last)["args"]["value"].asInteger());
+
+  CPlaybackTrace::Enable(false);
+  CPlaybackTrace::ReleaseThread();
+}
+
+TEST(TestPlaybackTrace, ThreadExit)
+{
+  // more threads than there are rings, each gives its ring back on exit
+  CPlaybackTrace::Enable(true);
+  for (int i = 0; i < 100; i++)
+  {
+    CPlaybackTraceThread thread(i == 99 ? "Playback \"Trace\" \\ Test" : "PlaybackTraceTest");
+    thread.Create();
+    thread.StopThread(true);
+  }
+
+  CVariant trace = GetTrace();
+  ASSERT_TRUE(trace["traceEvents"].isArray());
+
+  // the last thread still got a ring, and its name survived the quoting
+  const CVariant *last = NULL;
+  EXPECT_GE(CountEvents(trace, "TestPlaybackTrace::Thread", &last), 1);
+  ASSERT_TRUE(last != NULL);
+
+  bool found = false;
+  const CVariant &events = trace["traceEvents"];
+  for (CVariant::const_iterator_array it = events.begin_array(); it != events.end_array(); ++it)
+  {
+    if ((*it)["name"].asString() == "thread_name" && (*it)["tid"].asInteger() == (*last)["tid"].asInteger())
+    {
+      EXPECT_STREQ("Playback \"Trace\" \\ Test", (*it)["args"]["name"].asString().c_str());
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+
+  CPlaybackTrace::Enable(false);
+}
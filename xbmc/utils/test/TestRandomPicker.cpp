@@ -0,0 +1,125 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/RandomPicker.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <set>
+
+static std::vector<int> GetIds(int count)
+{
+  std::vector<int> ids;
+  for (int i = 1; i <= count; i++)
+    ids.push_back(i);
+  return ids;
+}
+
+TEST(TestRandomPicker, Empty)
+{
+  CRandomPicker picker;
+  int id;
+  EXPECT_FALSE(picker.Pick(id));
+
+  picker.SetIds(GetIds(1));
+  picker.Remove(1);
+  EXPECT_EQ(0u, picker.Size());
+  EXPECT_FALSE(picker.Pick(id));
+}
+
+TEST(TestRandomPicker, History)
+{
+  CRandomPicker picker;
+  picker.SetIds(GetIds(100));
+  picker.SetHistorySize(50);
+
+  // no id comes up again within the history
+  std::vector<int> picks;
+  for (int i = 0; i < 1000; i++)
+  {
+    int id;
+    ASSERT_TRUE(picker.Pick(id));
+    EXPECT_LE(1, id);
+    EXPECT_GE(100, id);
+    for (unsigned int j = picks.size() >= 50 ? picks.size() - 50 : 0; j < picks.size(); j++)
+      EXPECT_NE(picks[j], id);
+    picks.push_back(id);
+  }
+  EXPECT_TRUE(picker.InHistory(picks.back()));
+}
+
+TEST(TestRandomPicker, HistoryCoversIds)
+{
+  CRandomPicker picker;
+  picker.SetHistorySize(10);
+  for (int i = 1; i <= 9; i++)
+    picker.AddToHistory(i);
+
+  // the only id left is found even though random picks keep hitting the history
+  picker.SetIds(GetIds(10));
+  int id;
+  ASSERT_TRUE(picker.Pick(id));
+  EXPECT_EQ(10, id);
+
+  // with all of them in the history the history is ignored
+  ASSERT_TRUE(picker.Pick(id));
+  EXPECT_LE(1, id);
+  EXPECT_GE(10, id);
+}
+
+TEST(TestRandomPicker, Remove)
+{
+  CRandomPicker picker;
+  picker.SetIds(GetIds(10));
+  for (int i = 1; i <= 9; i++)
+    picker.Remove(i);
+  EXPECT_EQ(1u, picker.Size());
+
+  int id;
+  ASSERT_TRUE(picker.Pick(id));
+  EXPECT_EQ(10, id);
+}
+
+TEST(TestRandomPicker, LargeLibrary)
+{
+  // party mode on a library of 300k songs, with the largest history it uses
+  CRandomPicker picker;
+  picker.SetIds(GetIds(300000));
+  picker.SetHistorySize(200);
+
+  std::set<int> seen;
+  int64_t slowest = 0;
+  for (int i = 0; i < 10000; i++)
+  {
+    int id;
+    int64_t start = CurrentHostCounter();
+    ASSERT_TRUE(picker.Pick(id));
+    slowest = std::max(slowest, CurrentHostCounter() - start);
+    seen.insert(id);
+  }
+  int64_t slowestUs = slowest * 1000000 / CurrentHostFrequency();
+  RecordProperty("slowestPickUs", (int)slowestUs);
+
+  // picks are spread over the whole library
+  EXPECT_LT(9500u, seen.size());
+  EXPECT_GT(10000, slowestUs);
+}
@@ -27,6 +27,10 @@
 #include "utils/log.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SystemClock.h"
+
+#include <algorithm>
 
 TEST(TestRegExp, RegFind)
 {
@@ -132,6 +136,120 @@ TEST(TestRegExp, operatorEqual)
   EXPECT_STREQ("string", match.c_str());
 }
 
+TEST(TestRegExp, SharedPattern)
+{
+  CRegExp first(true), second(true);
+
+  EXPECT_TRUE(first.RegComp("s([0-9]+)e([0-9]+)"));
+  EXPECT_TRUE(second.RegComp("s([0-9]+)e([0-9]+)"));
+  EXPECT_EQ(5, first.RegFind("show.S01E02.mkv"));
+  EXPECT_EQ(4, second.RegFind("foo.s10e20.avi"));
+  EXPECT_STREQ("01", first.GetMatch(1).c_str());
+  EXPECT_STREQ("20", second.GetMatch(2).c_str());
+
+  // a copy outlives the original
+  CRegExp *original = new CRegExp(true);
+  EXPECT_TRUE(original->RegComp("^(part)([0-9])$"));
+  CRegExp copy(*original);
+  delete original;
+  EXPECT_EQ(0, copy.RegFind("part3"));
+  EXPECT_STREQ("3", copy.GetMatch(2).c_str());
+}
+
+TEST(TestRegExp, RegMatch)
+{
+  CRegExp regex;
+
+  EXPECT_TRUE(regex.RegComp("^(Test)\\s*(.*)\\."));
+  EXPECT_EQ(0, regex.RegMatch("Test string."));
+  EXPECT_EQ(12, regex.GetFindLen());
+  EXPECT_EQ(5, regex.GetSubStart(2));
+  EXPECT_EQ(6, regex.GetSubLength(2));
+  EXPECT_STREQ("", regex.GetMatch(2).c_str());
+  EXPECT_STREQ("", regex.GetReplaceString("\\2").c_str());
+  EXPECT_EQ(-1, regex.RegMatch("No test string."));
+
+  EXPECT_EQ(0, regex.RegFind("Test string."));
+  EXPECT_STREQ("string", regex.GetMatch(2).c_str());
+}
+
+TEST(TestRegExp, TVShowBenchmark)
+{
+  const SETTINGS_TVSHOWLIST &expressions = g_advancedSettings.m_tvshowEnumRegExps;
+  ASSERT_FALSE(expressions.empty());
+
+  // generated file names in the usual naming schemes, plus some that don't match at all
+  std::vector<std::string> corpus;
+  for (int show = 0; show < 40; show++)
+  {
+    for (int season = 1; season <= 5; season++)
+    {
+      for (int episode = 1; episode <= 25; episode++)
+      {
+        CStdString name;
+        switch ((show + episode) % 6)
+        {
+        case 0: name.Format("/tv/show %d/season %d/show.%d.s%02de%02d.720p.hdtv.x264.mkv", show, season, show, season, episode); break;
+        case 1: name.Format("/tv/show %d/show_%d_%dx%02d_title.avi", show, show, season, episode); break;
+        case 2: name.Format("/tv/show %d/show %d - %d%02d - title.mkv", show, show, season, episode); break;
+        case 3: name.Format("/tv/show %d/show.%d.20%02d.%02d.%02d.ts", show, show, season + 8, episode % 12 + 1, episode); break;
+        case 4: name.Format("/tv/show %d/show.%d.ep%02d.mp4", show, show, episode); break;
+        default: name.Format("/movies/some movie %d (19%02d)/movie.%d.bluray.1080p.mkv", show * 100 + episode, season + 80, episode); break;
+        }
+        corpus.push_back(name);
+      }
+    }
+  }
+
+  // the scanner compiles the expressions for every file, which now hits the cache
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  unsigned int matches = 0;
+  for (std::vector<std::string>::const_iterator it = corpus.begin(); it != corpus.end(); ++it)
+  {
+    for (SETTINGS_TVSHOWLIST::const_iterator exp = expressions.begin(); exp != expressions.end(); ++exp)
+    {
+      CRegExp reg(true);
+      if (reg.RegComp(exp->regexp) && reg.RegFind(*it) > -1)
+      {
+        matches++;
+        break;
+      }
+    }
+  }
+  unsigned int elapsed = std::max(1U, XbmcThreads::SystemClockMillis() - start);
+  RecordProperty("compiledPerFileMs", (int)elapsed);
+  // compiling every expression for every file again would take far longer
+  EXPECT_GT(10000U, elapsed);
+
+  // precompiled and without copying the subject
+  std::vector<CRegExp> compiled;
+  for (SETTINGS_TVSHOWLIST::const_iterator exp = expressions.begin(); exp != expressions.end(); ++exp)
+  {
+    CRegExp reg(true);
+    ASSERT_TRUE(reg.RegComp(exp->regexp));
+    compiled.push_back(reg);
+  }
+  start = XbmcThreads::SystemClockMillis();
+  unsigned int matches2 = 0;
+  for (std::vector<std::string>::const_iterator it = corpus.begin(); it != corpus.end(); ++it)
+  {
+    for (std::vector<CRegExp>::iterator reg = compiled.begin(); reg != compiled.end(); ++reg)
+    {
+      if (reg->RegMatch(*it) > -1)
+      {
+        matches2++;
+        break;
+      }
+    }
+  }
+  elapsed = std::max(1U, XbmcThreads::SystemClockMillis() - start);
+  RecordProperty("precompiledMs", (int)elapsed);
+  EXPECT_GT(10000U, elapsed);
+
+  EXPECT_EQ(matches, matches2);
+  EXPECT_LT(corpus.size() / 2, matches);
+}
+
 class TestRegExpLog : public testing::Test
 {
 protected:
@@ -0,0 +1,99 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/StartupTimeline.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/Variant.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+static const CVariant *FindEvent(const CVariant &trace, const std::string &name)
+{
+  const CVariant &events = trace["traceEvents"];
+  for (CVariant::const_iterator_array it = events.begin_array(); it != events.end_array(); ++it)
+  {
+    if ((*it)["name"].asString() == name)
+      return &(*it);
+  }
+  return NULL;
+}
+
+class CStartupSpanThread : public CThread
+{
+public:
+  CStartupSpanThread() : CThread("StartupSpanTest") {}
+protected:
+  virtual void Process()
+  {
+    CStartupSpan span("TestStartupTimeline::Thread");
+  }
+};
+
+// the timeline is process wide and stops for good on Finish(), so everything is checked in one go
+TEST(TestStartupTimeline, General)
+{
+  ASSERT_TRUE(CStartupTimeline::Get().IsRecording());
+
+  {
+    CStartupSpan outer("TestStartupTimeline::Outer");
+    {
+      CStartupSpan inner("TestStartupTimeline::Inner", "detail");
+      XbmcThreads::ThreadSleep(5);
+    }
+    CStartupSpan ended("TestStartupTimeline::Ended");
+    ended.End();
+  }
+
+  CStartupSpanThread thread;
+  thread.Create();
+  thread.StopThread(true);
+
+  std::string json = CStartupTimeline::Get().GetTrace();
+  CVariant trace = CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size());
+  ASSERT_TRUE(trace["traceEvents"].isArray());
+
+  const CVariant *outer = FindEvent(trace, "TestStartupTimeline::Outer");
+  const CVariant *inner = FindEvent(trace, "TestStartupTimeline::Inner");
+  const CVariant *other = FindEvent(trace, "TestStartupTimeline::Thread");
+  ASSERT_TRUE(outer != NULL);
+  ASSERT_TRUE(inner != NULL);
+  ASSERT_TRUE(other != NULL);
+  ASSERT_TRUE(FindEvent(trace, "TestStartupTimeline::Ended") != NULL);
+
+  EXPECT_STREQ("X", (*outer)["ph"].asString().c_str());
+  EXPECT_STREQ("detail", (*inner)["args"]["detail"].asString().c_str());
+  EXPECT_GE((*inner)["dur"].asInteger(), 5000);
+  // nesting in the viewer comes from the inner span lying within the outer one
+  EXPECT_LE((*outer)["ts"].asInteger(), (*inner)["ts"].asInteger());
+  EXPECT_GE((*outer)["ts"].asInteger() + (*outer)["dur"].asInteger(),
+            (*inner)["ts"].asInteger() + (*inner)["dur"].asInteger());
+  EXPECT_EQ((*outer)["tid"].asInteger(), (*inner)["tid"].asInteger());
+  EXPECT_NE((*outer)["tid"].asInteger(), (*other)["tid"].asInteger());
+
+  CStartupTimeline::Get().Finish();
+  EXPECT_FALSE(CStartupTimeline::Get().IsRecording());
+  {
+    CStartupSpan late("TestStartupTimeline::Late");
+  }
+  json = CStartupTimeline::Get().GetTrace();
+  trace = CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size());
+  EXPECT_TRUE(FindEvent(trace, "TestStartupTimeline::Late") == NULL);
+}
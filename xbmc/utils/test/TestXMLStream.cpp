@@ -0,0 +1,154 @@
+/*
+ *      Copyright (C) 2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/XMLStream.h"
+#include "utils/XMLUtils.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+TEST(TestXMLStream, WriteAndRead)
+{
+  XFILE::CFile *file;
+  ASSERT_TRUE((file = XBMC_CREATETEMPFILE(".xml")));
+  file->Close();
+
+  CXMLStreamWriter writer;
+  ASSERT_TRUE(writer.Open(XBMC_TEMPFILEPATH(file), "videodb"));
+  for (int i = 0; i < 1000; i++)
+  {
+    CXBMCTinyXML doc;
+    TiXmlElement movie("movie");
+    TiXmlNode *node = doc.InsertEndChild(movie);
+    XMLUtils::SetInt(node, "id", i);
+    XMLUtils::SetString(node, "title", "<a> & \"b\"");
+    EXPECT_TRUE(writer.Write(doc));
+  }
+  EXPECT_TRUE(writer.Close());
+
+  // the whole file is also a valid document
+  CXBMCTinyXML whole;
+  EXPECT_TRUE(whole.LoadFile(XBMC_TEMPFILEPATH(file)));
+
+  CXMLStreamReader reader;
+  ASSERT_TRUE(reader.Open(XBMC_TEMPFILEPATH(file)));
+  CXBMCTinyXML doc;
+  int count = 0;
+  while (reader.Next(doc))
+  {
+    TiXmlElement *movie = doc.RootElement();
+    EXPECT_STREQ("movie", movie->Value());
+    int id = -1;
+    CStdString title;
+    EXPECT_TRUE(XMLUtils::GetInt(movie, "id", id));
+    EXPECT_TRUE(XMLUtils::GetString(movie, "title", title));
+    EXPECT_EQ(count, id);
+    EXPECT_STREQ("<a> & \"b\"", title.c_str());
+    count++;
+  }
+  EXPECT_EQ(1000, count);
+  EXPECT_EQ(reader.GetLength(), reader.GetPosition());
+  reader.Close();
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+TEST(TestXMLStream, Abandoned)
+{
+  XFILE::CFile *file;
+  ASSERT_TRUE((file = XBMC_CREATETEMPFILE(".xml")));
+  EXPECT_EQ(4, file->Write("old\n", 4));
+  file->Close();
+
+  // a writer that isn't closed leaves the previous file alone
+  {
+    CXMLStreamWriter writer;
+    ASSERT_TRUE(writer.Open(XBMC_TEMPFILEPATH(file), "videodb"));
+    CXBMCTinyXML doc;
+    TiXmlElement movie("movie");
+    doc.InsertEndChild(movie);
+    EXPECT_TRUE(writer.Write(doc));
+  }
+  XFILE::CFile old;
+  char buffer[16];
+  ASSERT_TRUE(old.Open(XBMC_TEMPFILEPATH(file)));
+  EXPECT_EQ(4U, old.Read(buffer, sizeof(buffer)));
+  EXPECT_EQ(0, memcmp("old\n", buffer, 4));
+  old.Close();
+  EXPECT_FALSE(XFILE::CFile::Exists(XBMC_TEMPFILEPATH(file) + ".tmp"));
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+TEST(TestXMLStream, Read)
+{
+  static const char xml[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\" ?>\n"
+    "<!-- <comment> -->\n"
+    "<videodb>\n"
+    "  <version>1</version>\n"
+    "  <!-- </videodb> -->\n"
+    "  <path url=\"a>b\" />\n"
+    "  <movie><plot><![CDATA[</movie>]]></plot><empty/></movie>\n"
+    "</videodb>\n";
+
+  XFILE::CFile *file;
+  ASSERT_TRUE((file = XBMC_CREATETEMPFILE(".xml")));
+  EXPECT_EQ((int)strlen(xml), file->Write(xml, strlen(xml)));
+  file->Close();
+
+  CXMLStreamReader reader;
+  ASSERT_TRUE(reader.Open(XBMC_TEMPFILEPATH(file)));
+  CXBMCTinyXML doc;
+  ASSERT_TRUE(reader.Next(doc));
+  EXPECT_STREQ("version", doc.RootElement()->Value());
+  ASSERT_TRUE(reader.Next(doc));
+  EXPECT_STREQ("path", doc.RootElement()->Value());
+  EXPECT_STREQ("a>b", doc.RootElement()->Attribute("url"));
+  ASSERT_TRUE(reader.Next(doc));
+  EXPECT_STREQ("movie", doc.RootElement()->Value());
+  CStdString plot;
+  EXPECT_TRUE(XMLUtils::GetString(doc.RootElement(), "plot", plot));
+  EXPECT_STREQ("</movie>", plot.c_str());
+  EXPECT_FALSE(reader.Next(doc));
+  reader.Close();
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
+TEST(TestXMLStream, Truncated)
+{
+  static const char xml[] = "<videodb><movie><title>a</title></movie><movie><title>";
+
+  XFILE::CFile *file;
+  ASSERT_TRUE((file = XBMC_CREATETEMPFILE(".xml")));
+  EXPECT_EQ((int)strlen(xml), file->Write(xml, strlen(xml)));
+  file->Close();
+
+  CXMLStreamReader reader;
+  ASSERT_TRUE(reader.Open(XBMC_TEMPFILEPATH(file)));
+  CXBMCTinyXML doc;
+  EXPECT_TRUE(reader.Next(doc));
+  EXPECT_FALSE(reader.Next(doc));
+  reader.Close();
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
@@ -34,6 +34,7 @@
 #include "guilib/GUIWindowManager.h"
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
+#include "filesystem/FileExistenceChecker.h"
 #include "filesystem/SpecialProtocol.h"
 #include "dialogs/GUIDialogExtendedProgressBar.h"
 #include "dialogs/GUIDialogProgress.h"
@@ -58,6 +59,12 @@
 #include "video/VideoDbUrl.h"
 #include "playlists/SmartPlayList.h"
 #include "utils/GroupUtils.h"
+#include "utils/JobManager.h"
+#include "utils/XMLStream.h"
+
+#if defined(TARGET_POSIX)
+#include <sys/resource.h>
+#endif
 
 using namespace std;
 using namespace dbiplus;
@@ -65,6 +72,9 @@ using namespace XFILE;
 using namespace VIDEO;
 using namespace ADDON;
 
+// most full-text matches a search turns into conditions
+#define SEARCH_LIMIT 1000
+
 //********************************************************************************************************************************
 CVideoDatabase::CVideoDatabase(void)
 {
@@ -354,6 +364,8 @@ bool CVideoDatabase::CreateTables()
                 "DELETE FROM tag WHERE idTag=old.idTag AND idTag NOT IN (SELECT DISTINCT idTag FROM taglinks); "
                 "END");
 
+    CreateSearchIndexes();
+
     // we create views last to ensure all indexes are rolled in
     CreateViews();
   }
@@ -367,6 +379,155 @@ bool CVideoDatabase::CreateTables()
   return true;
 }
 
+static std::string GetMoviePlot(bool sqlite, const std::string &row)
+{
+  // plot, outline and tagline are searched as one
+  std::string plot    = StringUtils::Format("%s.c%02d", row.c_str(), VIDEODB_ID_PLOT);
+  std::string outline = StringUtils::Format("%s.c%02d", row.c_str(), VIDEODB_ID_PLOTOUTLINE);
+  std::string tagline = StringUtils::Format("%s.c%02d", row.c_str(), VIDEODB_ID_TAGLINE);
+  if (sqlite)
+    return "ifnull(" + plot + ",'') || ' ' || ifnull(" + outline + ",'') || ' ' || ifnull(" + tagline + ",'')";
+  return "CONCAT_WS(' ', " + plot + ", " + outline + ", " + tagline + ")";
+}
+
+void CVideoDatabase::CreateSearchIndexes()
+{
+  CLog::Log(LOGINFO, "create search indexes");
+  /* before delete triggers, as mysql only allows one trigger per table and event before 5.7 and
+     there are after delete triggers already */
+  if (CreateSearchIndex("moviesearch", "strTitle, strPlot"))
+  {
+    m_pDS->exec(PrepareSQL("INSERT INTO moviesearch (docid, strTitle, strPlot) SELECT idMovie, c%02d, ", VIDEODB_ID_TITLE) + GetMoviePlot(m_sqlite, "movie") + " FROM movie");
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER insert_moviesearch AFTER INSERT ON movie FOR EACH ROW BEGIN "
+                           "INSERT INTO moviesearch (docid, strTitle, strPlot) VALUES (new.idMovie, new.c%02d, ", VIDEODB_ID_TITLE) + GetMoviePlot(m_sqlite, "new") + "); "
+                "END");
+    m_pDS->exec("CREATE TRIGGER delete_moviesearch BEFORE DELETE ON movie FOR EACH ROW BEGIN "
+                "DELETE FROM moviesearch WHERE docid=old.idMovie; "
+                "END");
+  }
+
+  if (CreateSearchIndex("tvshowsearch", "strTitle"))
+  {
+    m_pDS->exec(PrepareSQL("INSERT INTO tvshowsearch (docid, strTitle) SELECT idShow, c%02d FROM tvshow", VIDEODB_ID_TV_TITLE));
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER insert_tvshowsearch AFTER INSERT ON tvshow FOR EACH ROW BEGIN "
+                           "INSERT INTO tvshowsearch (docid, strTitle) VALUES (new.idShow, new.c%02d); "
+                           "END", VIDEODB_ID_TV_TITLE));
+    m_pDS->exec("CREATE TRIGGER delete_tvshowsearch BEFORE DELETE ON tvshow FOR EACH ROW BEGIN "
+                "DELETE FROM tvshowsearch WHERE docid=old.idShow; "
+                "END");
+  }
+
+  if (CreateSearchIndex("episodesearch", "strTitle, strPlot"))
+  {
+    m_pDS->exec(PrepareSQL("INSERT INTO episodesearch (docid, strTitle, strPlot) SELECT idEpisode, c%02d, c%02d FROM episode", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_PLOT));
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER insert_episodesearch AFTER INSERT ON episode FOR EACH ROW BEGIN "
+                           "INSERT INTO episodesearch (docid, strTitle, strPlot) VALUES (new.idEpisode, new.c%02d, new.c%02d); "
+                           "END", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_PLOT));
+    m_pDS->exec("CREATE TRIGGER delete_episodesearch BEFORE DELETE ON episode FOR EACH ROW BEGIN "
+                "DELETE FROM episodesearch WHERE docid=old.idEpisode; "
+                "END");
+  }
+
+  if (CreateSearchIndex("musicvideosearch", "strTitle"))
+  {
+    m_pDS->exec(PrepareSQL("INSERT INTO musicvideosearch (docid, strTitle) SELECT idMVideo, c%02d FROM musicvideo", VIDEODB_ID_MUSICVIDEO_TITLE));
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER insert_musicvideosearch AFTER INSERT ON musicvideo FOR EACH ROW BEGIN "
+                           "INSERT INTO musicvideosearch (docid, strTitle) VALUES (new.idMVideo, new.c%02d); "
+                           "END", VIDEODB_ID_MUSICVIDEO_TITLE));
+    m_pDS->exec("CREATE TRIGGER delete_musicvideosearch BEFORE DELETE ON musicvideo FOR EACH ROW BEGIN "
+                "DELETE FROM musicvideosearch WHERE docid=old.idMVideo; "
+                "END");
+  }
+
+  // actors, directors, writers and music video artists
+  if (CreateSearchIndex("actorsearch", "strActor"))
+  {
+    m_pDS->exec("INSERT INTO actorsearch (docid, strActor) SELECT idActor, strActor FROM actors");
+    m_pDS->exec("CREATE TRIGGER insert_actorsearch AFTER INSERT ON actors FOR EACH ROW BEGIN "
+                "INSERT INTO actorsearch (docid, strActor) VALUES (new.idActor, new.strActor); "
+                "END");
+    m_pDS->exec("CREATE TRIGGER delete_actorsearch BEFORE DELETE ON actors FOR EACH ROW BEGIN "
+                "DELETE FROM actorsearch WHERE docid=old.idActor; "
+                "END");
+  }
+
+  CreateSearchUpdateTriggers();
+}
+
+void CVideoDatabase::CreateSearchUpdateTriggers()
+{
+  // only on the indexed columns, updating ratings or files mustn't rewrite the indexes
+  if (HasSearchIndex("moviesearch"))
+  {
+    m_pDS->exec("DROP TRIGGER IF EXISTS update_moviesearch");
+    CreateUpdateTrigger("update_moviesearch", "movie",
+                        PrepareSQL("c%02d, c%02d, c%02d, c%02d", VIDEODB_ID_TITLE, VIDEODB_ID_PLOT, VIDEODB_ID_PLOTOUTLINE, VIDEODB_ID_TAGLINE),
+                        PrepareSQL("DELETE FROM moviesearch WHERE docid=old.idMovie; "
+                                   "INSERT INTO moviesearch (docid, strTitle, strPlot) VALUES (new.idMovie, new.c%02d, ", VIDEODB_ID_TITLE) + GetMoviePlot(m_sqlite, "new") + ");");
+  }
+
+  if (HasSearchIndex("tvshowsearch"))
+  {
+    m_pDS->exec("DROP TRIGGER IF EXISTS update_tvshowsearch");
+    CreateUpdateTrigger("update_tvshowsearch", "tvshow", PrepareSQL("c%02d", VIDEODB_ID_TV_TITLE),
+                        PrepareSQL("DELETE FROM tvshowsearch WHERE docid=old.idShow; "
+                                   "INSERT INTO tvshowsearch (docid, strTitle) VALUES (new.idShow, new.c%02d);", VIDEODB_ID_TV_TITLE));
+  }
+
+  if (HasSearchIndex("episodesearch"))
+  {
+    m_pDS->exec("DROP TRIGGER IF EXISTS update_episodesearch");
+    CreateUpdateTrigger("update_episodesearch", "episode", PrepareSQL("c%02d, c%02d", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_PLOT),
+                        PrepareSQL("DELETE FROM episodesearch WHERE docid=old.idEpisode; "
+                                   "INSERT INTO episodesearch (docid, strTitle, strPlot) VALUES (new.idEpisode, new.c%02d, new.c%02d);", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_PLOT));
+  }
+
+  if (HasSearchIndex("musicvideosearch"))
+  {
+    m_pDS->exec("DROP TRIGGER IF EXISTS update_musicvideosearch");
+    CreateUpdateTrigger("update_musicvideosearch", "musicvideo", PrepareSQL("c%02d", VIDEODB_ID_MUSICVIDEO_TITLE),
+                        PrepareSQL("DELETE FROM musicvideosearch WHERE docid=old.idMVideo; "
+                                   "INSERT INTO musicvideosearch (docid, strTitle) VALUES (new.idMVideo, new.c%02d);", VIDEODB_ID_MUSICVIDEO_TITLE));
+  }
+
+  if (HasSearchIndex("actorsearch"))
+  {
+    m_pDS->exec("DROP TRIGGER IF EXISTS update_actorsearch");
+    CreateUpdateTrigger("update_actorsearch", "actors", "strActor",
+                        "DELETE FROM actorsearch WHERE docid=old.idActor; "
+                        "INSERT INTO actorsearch (docid, strActor) VALUES (new.idActor, new.strActor);");
+  }
+}
+
+CStdString CVideoDatabase::GetSearchCondition(const std::string &table, const std::string &column, const std::string &idColumn,
+                                              const CStdString &search, const CStdString &fallback)
+{
+  if (!CanSearchIndex(table, search))
+    return fallback;
+
+  // the best matches are looked up first, MySQL before 5.6 would run a subquery once per row
+  auto_ptr<Dataset> pDS(m_pDB->CreateDataset());
+  if (NULL == pDS.get())
+    return fallback;
+
+  CStdString sql = "SELECT docid FROM " + table + " WHERE " + PrepareSearchMatch(table, column, search) +
+                   " ORDER BY " + PrepareSearchRank(table, column, search) + PrepareSQL(" DESC LIMIT %i", SEARCH_LIMIT);
+  if (!pDS->query(sql.c_str()))
+    return fallback;
+
+  CStdString ids;
+  while (!pDS->eof())
+  {
+    ids += (ids.IsEmpty() ? "" : ",") + pDS->fv(0).get_asString();
+    pDS->next();
+  }
+  pDS->close();
+
+  if (ids.IsEmpty())
+    return "0 = 1";
+  return idColumn + " IN (" + ids + ")";
+}
+
 void CVideoDatabase::CreateViews()
 {
   CLog::Log(LOGINFO, "create episodeview");
@@ -4425,6 +4586,10 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
     m_pDS->exec("ALTER TABLE settings ADD StereoMode integer");
     m_pDS->exec("ALTER TABLE settings ADD StereoInvert bool");
   }
+  if (iVersion < 77)
+    CreateSearchIndexes();
+  if (iVersion < 78)
+    CreateSearchUpdateTriggers();
   // always recreate the view after any table change
   CreateViews();
   return true;
@@ -4432,7 +4597,7 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
 
 int CVideoDatabase::GetMinVersion() const
 {
-  return 76;
+  return 78;
 }
 
 bool CVideoDatabase::LookupByFolders(const CStdString &path, bool shows)
@@ -7069,10 +7234,13 @@ void CVideoDatabase::GetMovieActorsByName(const CStdString& strSearch, CFileItem
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("actorsearch", "strActor", "actors.idActor", strSearch,
+                                             PrepareSQL("actors.strActor like '%%%s%%'", strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL=PrepareSQL("select actors.idActor,actors.strActor,path.strPath from actorlinkmovie,actors,movie,files,path where actors.idActor=actorlinkmovie.idActor and actorlinkmovie.idMovie=movie.idMovie and files.idFile=movie.idFile and files.idPath=path.idPath and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL=PrepareSQL("select actors.idActor,actors.strActor,path.strPath from actorlinkmovie,actors,movie,files,path where actors.idActor=actorlinkmovie.idActor and actorlinkmovie.idMovie=movie.idMovie and files.idFile=movie.idFile and files.idPath=path.idPath and ") + strWhere;
     else
-      strSQL=PrepareSQL("select distinct actors.idActor,actors.strActor from actorlinkmovie,actors,movie where actors.idActor=actorlinkmovie.idActor and actorlinkmovie.idMovie=movie.idMovie and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL=PrepareSQL("select distinct actors.idActor,actors.strActor from actorlinkmovie,actors,movie where actors.idActor=actorlinkmovie.idActor and actorlinkmovie.idMovie=movie.idMovie and ") + strWhere;
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -7109,10 +7277,13 @@ void CVideoDatabase::GetTvShowsActorsByName(const CStdString& strSearch, CFileIt
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("actorsearch", "strActor", "actors.idActor", strSearch,
+                                             PrepareSQL("actors.strActor like '%%%s%%'", strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL=PrepareSQL("select actors.idActor,actors.strActor,path.strPath from actorlinktvshow,actors,tvshow,path,tvshowlinkpath where actors.idActor=actorlinktvshow.idActor and actorlinktvshow.idShow=tvshow.idShow and tvshowlinkpath.idPath=tvshow.idShow and tvshowlinkpath.idPath=path.idPath and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL=PrepareSQL("select actors.idActor,actors.strActor,path.strPath from actorlinktvshow,actors,tvshow,path,tvshowlinkpath where actors.idActor=actorlinktvshow.idActor and actorlinktvshow.idShow=tvshow.idShow and tvshowlinkpath.idPath=tvshow.idShow and tvshowlinkpath.idPath=path.idPath and ") + strWhere;
     else
-      strSQL=PrepareSQL("select distinct actors.idActor,actors.strActor from actorlinktvshow,actors,tvshow where actors.idActor=actorlinktvshow.idActor and actorlinktvshow.idShow=tvshow.idShow and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL=PrepareSQL("select distinct actors.idActor,actors.strActor from actorlinktvshow,actors,tvshow where actors.idActor=actorlinktvshow.idActor and actorlinktvshow.idShow=tvshow.idShow and ") + strWhere;
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -7151,11 +7322,12 @@ void CVideoDatabase::GetMusicVideoArtistsByName(const CStdString& strSearch, CFi
 
     CStdString strLike;
     if (!strSearch.IsEmpty())
-      strLike = "and actors.strActor like '%%%s%%'";
+      strLike = "and " + GetSearchCondition("actorsearch", "strActor", "actors.idActor", strSearch,
+                                            PrepareSQL("actors.strActor like '%%%s%%'", strSearch.c_str()));
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL=PrepareSQL("select actors.idActor,actors.strActor,path.strPath from artistlinkmusicvideo,actors,musicvideo,files,path where actors.idActor=artistlinkmusicvideo.idArtist and artistlinkmusicvideo.idMVideo=musicvideo.idMVideo and files.idFile=musicvideo.idFile and files.idPath=path.idPath "+strLike,strSearch.c_str());
+      strSQL=PrepareSQL("select actors.idActor,actors.strActor,path.strPath from artistlinkmusicvideo,actors,musicvideo,files,path where actors.idActor=artistlinkmusicvideo.idArtist and artistlinkmusicvideo.idMVideo=musicvideo.idMVideo and files.idFile=musicvideo.idFile and files.idPath=path.idPath ") + strLike;
     else
-      strSQL=PrepareSQL("select distinct actors.idActor,actors.strActor from artistlinkmusicvideo,actors where actors.idActor=artistlinkmusicvideo.idArtist "+strLike,strSearch.c_str());
+      strSQL=PrepareSQL("select distinct actors.idActor,actors.strActor from artistlinkmusicvideo,actors where actors.idActor=artistlinkmusicvideo.idArtist ") + strLike;
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -7524,10 +7696,13 @@ void CVideoDatabase::GetMoviesByName(const CStdString& strSearch, CFileItemList&
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("moviesearch", "strTitle", "movie.idMovie", strSearch,
+                                             PrepareSQL("movie.c%02d like '%%%s%%'", VIDEODB_ID_TITLE, strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("select movie.idMovie,movie.c%02d,path.strPath, movie.idSet from movie,files,path where files.idFile=movie.idFile and files.idPath=path.idPath and movie.c%02d like '%%%s%%'",VIDEODB_ID_TITLE,VIDEODB_ID_TITLE,strSearch.c_str());
+      strSQL = PrepareSQL("select movie.idMovie,movie.c%02d,path.strPath, movie.idSet from movie,files,path where files.idFile=movie.idFile and files.idPath=path.idPath and ",VIDEODB_ID_TITLE) + strWhere;
     else
-      strSQL = PrepareSQL("select movie.idMovie,movie.c%02d, movie.idSet from movie where movie.c%02d like '%%%s%%'",VIDEODB_ID_TITLE,VIDEODB_ID_TITLE,strSearch.c_str());
+      strSQL = PrepareSQL("select movie.idMovie,movie.c%02d, movie.idSet from movie where ",VIDEODB_ID_TITLE) + strWhere;
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -7569,10 +7744,13 @@ void CVideoDatabase::GetTvShowsByName(const CStdString& strSearch, CFileItemList
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("tvshowsearch", "strTitle", "tvshow.idShow", strSearch,
+                                             PrepareSQL("tvshow.c%02d like '%%%s%%'", VIDEODB_ID_TV_TITLE, strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("select tvshow.idShow,tvshow.c%02d,path.strPath from tvshow,path,tvshowlinkpath where tvshowlinkpath.idPath=path.idPath and tvshowlinkpath.idShow=tvshow.idShow and tvshow.c%02d like '%%%s%%'",VIDEODB_ID_TV_TITLE,VIDEODB_ID_TV_TITLE,strSearch.c_str());
+      strSQL = PrepareSQL("select tvshow.idShow,tvshow.c%02d,path.strPath from tvshow,path,tvshowlinkpath where tvshowlinkpath.idPath=path.idPath and tvshowlinkpath.idShow=tvshow.idShow and ",VIDEODB_ID_TV_TITLE) + strWhere;
     else
-      strSQL = PrepareSQL("select tvshow.idShow,tvshow.c%02d from tvshow where tvshow.c%02d like '%%%s%%'",VIDEODB_ID_TV_TITLE,VIDEODB_ID_TV_TITLE,strSearch.c_str());
+      strSQL = PrepareSQL("select tvshow.idShow,tvshow.c%02d from tvshow where ",VIDEODB_ID_TV_TITLE) + strWhere;
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -7611,10 +7789,13 @@ void CVideoDatabase::GetEpisodesByName(const CStdString& strSearch, CFileItemLis
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("episodesearch", "strTitle", "episode.idEpisode", strSearch,
+                                             PrepareSQL("episode.c%02d like '%%%s%%'", VIDEODB_ID_EPISODE_TITLE, strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d,path.strPath from episode,files,path,tvshow where files.idFile=episode.idFile and episode.idShow=tvshow.idShow and files.idPath=path.idPath and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_TITLE,strSearch.c_str());
+      strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d,path.strPath from episode,files,path,tvshow where files.idFile=episode.idFile and episode.idShow=tvshow.idShow and files.idPath=path.idPath and ",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE) + strWhere;
     else
-      strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d from episode,tvshow where tvshow.idShow=episode.idShow and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_TITLE,strSearch.c_str());
+      strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d from episode,tvshow where tvshow.idShow=episode.idShow and ",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE) + strWhere;
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -7654,10 +7835,13 @@ void CVideoDatabase::GetMusicVideosByName(const CStdString& strSearch, CFileItem
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("musicvideosearch", "strTitle", "musicvideo.idMVideo", strSearch,
+                                             PrepareSQL("musicvideo.c%02d like '%%%s%%'", VIDEODB_ID_MUSICVIDEO_TITLE, strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("select musicvideo.idMVideo,musicvideo.c%02d,path.strPath from musicvideo,files,path where files.idFile=musicvideo.idFile and files.idPath=path.idPath and musicvideo.c%02d like '%%%s%%'",VIDEODB_ID_MUSICVIDEO_TITLE,VIDEODB_ID_MUSICVIDEO_TITLE,strSearch.c_str());
+      strSQL = PrepareSQL("select musicvideo.idMVideo,musicvideo.c%02d,path.strPath from musicvideo,files,path where files.idFile=musicvideo.idFile and files.idPath=path.idPath and ",VIDEODB_ID_MUSICVIDEO_TITLE) + strWhere;
     else
-      strSQL = PrepareSQL("select musicvideo.idMVideo,musicvideo.c%02d from musicvideo where musicvideo.c%02d like '%%%s%%'",VIDEODB_ID_MUSICVIDEO_TITLE,VIDEODB_ID_MUSICVIDEO_TITLE,strSearch.c_str());
+      strSQL = PrepareSQL("select musicvideo.idMVideo,musicvideo.c%02d from musicvideo where ",VIDEODB_ID_MUSICVIDEO_TITLE) + strWhere;
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -7702,10 +7886,13 @@ void CVideoDatabase::GetEpisodesByPlot(const CStdString& strSearch, CFileItemLis
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("episodesearch", "strPlot", "episode.idEpisode", strSearch,
+                                             PrepareSQL("episode.c%02d like '%%%s%%'", VIDEODB_ID_EPISODE_PLOT, strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d,path.strPath from episode,files,path,tvshow where files.idFile=episode.idFile and files.idPath=path.idPath and tvshow.idShow=episode.idShow and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_PLOT,strSearch.c_str());
+      strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d,path.strPath from episode,files,path,tvshow where files.idFile=episode.idFile and files.idPath=path.idPath and tvshow.idShow=episode.idShow and ",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE) + strWhere;
     else
-      strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d from episode,tvshow where tvshow.idShow=episode.idShow and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_PLOT,strSearch.c_str());
+      strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d from episode,tvshow where tvshow.idShow=episode.idShow and ",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE) + strWhere;
     m_pDS->query( strSQL.c_str() );
 
     while (!m_pDS->eof())
@@ -7741,10 +7928,13 @@ void CVideoDatabase::GetMoviesByPlot(const CStdString& strSearch, CFileItemList&
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("moviesearch", "strPlot", "movie.idMovie", strSearch,
+                                             PrepareSQL("(movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%')",VIDEODB_ID_PLOT,strSearch.c_str(),VIDEODB_ID_PLOTOUTLINE,strSearch.c_str(),VIDEODB_ID_TAGLINE,strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("select movie.idMovie, movie.c%02d, path.strPath from movie,files,path where files.idFile=movie.idFile and files.idPath=path.idPath and (movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%')",VIDEODB_ID_TITLE,VIDEODB_ID_PLOT,strSearch.c_str(),VIDEODB_ID_PLOTOUTLINE,strSearch.c_str(),VIDEODB_ID_TAGLINE,strSearch.c_str());
+      strSQL = PrepareSQL("select movie.idMovie, movie.c%02d, path.strPath from movie,files,path where files.idFile=movie.idFile and files.idPath=path.idPath and ",VIDEODB_ID_TITLE) + strWhere;
     else
-      strSQL = PrepareSQL("select movie.idMovie, movie.c%02d from movie where (movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%')",VIDEODB_ID_TITLE,VIDEODB_ID_PLOT,strSearch.c_str(),VIDEODB_ID_PLOTOUTLINE,strSearch.c_str(),VIDEODB_ID_TAGLINE,strSearch.c_str());
+      strSQL = PrepareSQL("select movie.idMovie, movie.c%02d from movie where ",VIDEODB_ID_TITLE) + strWhere;
 
     m_pDS->query( strSQL.c_str() );
 
@@ -7783,10 +7973,13 @@ void CVideoDatabase::GetMovieDirectorsByName(const CStdString& strSearch, CFileI
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("actorsearch", "strActor", "actors.idActor", strSearch,
+                                             PrepareSQL("actors.strActor like '%%%s%%'", strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("select distinct directorlinkmovie.idDirector,actors.strActor,path.strPath from movie,files,path,actors,directorlinkmovie where files.idFile=movie.idFile and files.idPath=path.idPath and directorlinkmovie.idMovie=movie.idMovie and directorlinkmovie.idDirector=actors.idActor and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL = PrepareSQL("select distinct directorlinkmovie.idDirector,actors.strActor,path.strPath from movie,files,path,actors,directorlinkmovie where files.idFile=movie.idFile and files.idPath=path.idPath and directorlinkmovie.idMovie=movie.idMovie and directorlinkmovie.idDirector=actors.idActor and ") + strWhere;
     else
-      strSQL = PrepareSQL("select distinct directorlinkmovie.idDirector,actors.strActor from movie,actors,directorlinkmovie where directorlinkmovie.idMovie=movie.idMovie and directorlinkmovie.idDirector=actors.idActor and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL = PrepareSQL("select distinct directorlinkmovie.idDirector,actors.strActor from movie,actors,directorlinkmovie where directorlinkmovie.idMovie=movie.idMovie and directorlinkmovie.idDirector=actors.idActor and ") + strWhere;
 
     m_pDS->query( strSQL.c_str() );
 
@@ -7825,10 +8018,13 @@ void CVideoDatabase::GetTvShowsDirectorsByName(const CStdString& strSearch, CFil
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("actorsearch", "strActor", "actors.idActor", strSearch,
+                                             PrepareSQL("actors.strActor like '%%%s%%'", strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("select distinct directorlinktvshow.idDirector,actors.strActor,path.strPath from tvshow,path,actors,directorlinktvshow,tvshowlinkpath where tvshowlinkpath.idPath=path.idPath and tvshowlinkpath.idShow=tvshow.idShow and directorlinktvshow.idShow=tvshow.idShow and directorlinktvshow.idDirector=actors.idActor and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL = PrepareSQL("select distinct directorlinktvshow.idDirector,actors.strActor,path.strPath from tvshow,path,actors,directorlinktvshow,tvshowlinkpath where tvshowlinkpath.idPath=path.idPath and tvshowlinkpath.idShow=tvshow.idShow and directorlinktvshow.idShow=tvshow.idShow and directorlinktvshow.idDirector=actors.idActor and ") + strWhere;
     else
-      strSQL = PrepareSQL("select distinct directorlinktvshow.idDirector,actors.strActor from tvshow,actors,directorlinktvshow where directorlinktvshow.idShow=tvshow.idShow and directorlinktvshow.idDirector=actors.idActor and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL = PrepareSQL("select distinct directorlinktvshow.idDirector,actors.strActor from tvshow,actors,directorlinktvshow where directorlinktvshow.idShow=tvshow.idShow and directorlinktvshow.idDirector=actors.idActor and ") + strWhere;
 
     m_pDS->query( strSQL.c_str() );
 
@@ -7867,10 +8063,13 @@ void CVideoDatabase::GetMusicVideoDirectorsByName(const CStdString& strSearch, C
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
+    CStdString strWhere = GetSearchCondition("actorsearch", "strActor", "actors.idActor", strSearch,
+                                             PrepareSQL("actors.strActor like '%%%s%%'", strSearch.c_str()));
+
     if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
-      strSQL = PrepareSQL("select distinct directorlinkmusicvideo.idDirector,actors.strActor,path.strPath from musicvideo,files,path,actors,directorlinkmusicvideo where files.idFile=musicvideo.idFile and files.idPath=path.idPath and directorlinkmusicvideo.idMVideo=musicvideo.idMVideo and directorlinkmusicvideo.idDirector=actors.idActor and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL = PrepareSQL("select distinct directorlinkmusicvideo.idDirector,actors.strActor,path.strPath from musicvideo,files,path,actors,directorlinkmusicvideo where files.idFile=musicvideo.idFile and files.idPath=path.idPath and directorlinkmusicvideo.idMVideo=musicvideo.idMVideo and directorlinkmusicvideo.idDirector=actors.idActor and ") + strWhere;
     else
-      strSQL = PrepareSQL("select distinct directorlinkmusicvideo.idDirector,actors.strActor from musicvideo,actors,directorlinkmusicvideo where directorlinkmusicvideo.idMVideo=musicvideo.idMVideo and directorlinkmusicvideo.idDirector=actors.idActor and actors.strActor like '%%%s%%'",strSearch.c_str());
+      strSQL = PrepareSQL("select distinct directorlinkmusicvideo.idDirector,actors.strActor from musicvideo,actors,directorlinkmusicvideo where directorlinkmusicvideo.idMVideo=musicvideo.idMVideo and directorlinkmusicvideo.idDirector=actors.idActor and ") + strWhere;
 
     m_pDS->query( strSQL.c_str() );
 
@@ -7900,6 +8099,34 @@ void CVideoDatabase::GetMusicVideoDirectorsByName(const CStdString& strSearch, C
   }
 }
 
+namespace
+{
+/*! \brief Shows the progress of checking for missing files while cleaning on the handle or dialog, if any */
+class CCleanProgress : public CFileExistenceChecker::IProgress
+{
+public:
+  CCleanProgress(CGUIDialogProgressBarHandle *handle, CGUIDialogProgress *progress)
+    : m_handle(handle), m_progress(progress) {};
+
+  virtual bool OnProgress(unsigned int checked, unsigned int total)
+  {
+    if (m_handle)
+      m_handle->SetPercentage(checked/(float)total*100);
+    else if (m_progress)
+    {
+      m_progress->SetPercentage(checked * 100 / total);
+      m_progress->Progress();
+      return !m_progress->IsCanceled();
+    }
+    return true;
+  }
+
+private:
+  CGUIDialogProgressBarHandle *m_handle;
+  CGUIDialogProgress          *m_progress;
+};
+}
+
 void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const set<int>* paths, bool showProgress)
 {
   CGUIDialogProgress *progress=NULL;
@@ -7912,15 +8139,12 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const se
     CLog::Log(LOGNOTICE, "%s: Starting videodatabase cleanup ..", __FUNCTION__);
     ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnCleanStarted");
 
-    BeginTransaction();
-
     // find all the files
     CStdString sql;
     if (paths)
     {
       if (paths->size() == 0)
       {
-        RollbackTransaction();
         ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnCleanFinished");
         return;
       }
@@ -7965,11 +8189,9 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const se
     std::vector<int> episodeIDs;
     std::vector<int> musicVideoIDs;
 
-    int total = m_pDS->num_rows();
-    int current = 0;
-
     bool bIsSource;
     VECSOURCES *pShares = CMediaSourceSettings::Get().GetSources("video");
+    CFileExistenceChecker checker;
 
     while (!m_pDS->eof())
     {
@@ -7988,37 +8210,34 @@ void CVideoDatabase::CleanDatabase(CGUIDialogProgressBarHandle* handle, const se
         if (!CFile::Exists(fullPath, false))
           filesToDelete += m_pDS->fv("files.idFile").get_asString() + ",";
       }
+      // remove optical and internet related files
+      // note: this will also remove entries from previously existing media sources
+      else if (URIUtils::IsOnDVD(fullPath) || URIUtils::IsInternetStream(fullPath, true))
+        filesToDelete += m_pDS->fv("files.idFile").get_asString() + ",";
+      // and non-existing files, checked all at once below
       else
-      {
-        // remove optical, internet related and non-existing files
-        // note: this will also remove entries from previously existing media sources
-        if (URIUtils::IsOnDVD(fullPath) || URIUtils::IsInternetStream(fullPath, true) || !CFile::Exists(fullPath, false))
-          filesToDelete += m_pDS->fv("files.idFile").get_asString() + ",";
-      }
-
-      if (!handle)
-      {
-        if (progress)
-        {
-          progress->SetPercentage(current * 100 / total);
-          progress->Progress();
-          if (progress->IsCanceled())
-          {
-            progress->Close();
-            m_pDS->close();
-            ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnCleanFinished");
-            return;
-          }
-        }
-      }
-      else
-        handle->SetPercentage(current/(float)total*100);
+        checker.Add(m_pDS->fv("files.idFile").get_asInt(), fullPath);
 
       m_pDS->next();
-      current++;
     }
     m_pDS->close();
 
+    std::vector<int> missing;
+    CCleanProgress cleanProgress(handle, progress);
+    if (!checker.Check(missing, &cleanProgress))
+    {
+      if (progress)
+        progress->Close();
+      ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnCleanFinished");
+      return;
+    }
+    for (std::vector<int>::const_iterator it = missing.begin(); it != missing.end(); ++it)
+      filesToDelete.AppendFormat("%i,", *it);
+
+    // the library is only locked for writing once the files have been checked, which can take
+    // minutes on network shares
+    BeginTransaction();
+
     // Add any files that don't have a valid idPath entry to the filesToDelete list.
     sql = "select files.idFile from files where idPath not in (select idPath from path)";
     m_pDS->query(sql.c_str());
@@ -8358,6 +8577,111 @@ void CVideoDatabase::DumpToDummyFiles(const CStdString &path)
   }
 }
 
+// art exported at the same time, and queued at most
+#define ART_EXPORT_JOBS   4
+#define ART_EXPORT_QUEUED 64
+
+/*! \brief Exports art on a few job workers while the export moves on to the next items */
+class CArtExportQueue : public CJobQueue
+{
+public:
+  CArtExportQueue();
+  virtual ~CArtExportQueue();
+
+  void Export(const CStdString &image, const CStdString &destination, bool overwrite);
+
+  /*! \brief Wait until all queued art has been exported */
+  void Wait();
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+private:
+  unsigned int GetPending();
+
+  CCriticalSection m_pendingSection;
+  CEvent           m_done;
+  unsigned int     m_pending;
+  std::set<CStdString> m_destinations; ///< queued or exported, actors are shared by many items
+};
+
+class CArtExportJob : public CJob
+{
+public:
+  CArtExportJob(const CStdString &image, const CStdString &destination, bool overwrite)
+    : m_image(image), m_destination(destination), m_overwrite(overwrite) {};
+
+  virtual const char *GetType() const { return "artexport"; };
+  virtual bool DoWork() { return CTextureCache::Get().Export(m_image, m_destination, m_overwrite); };
+
+private:
+  CStdString m_image;
+  CStdString m_destination;
+  bool       m_overwrite;
+};
+
+CArtExportQueue::CArtExportQueue()
+  : CJobQueue(false, ART_EXPORT_JOBS, CJob::PRIORITY_LOW), m_pending(0)
+{
+}
+
+CArtExportQueue::~CArtExportQueue()
+{
+  // before the members OnJobComplete() uses are gone
+  CancelJobs();
+}
+
+void CArtExportQueue::Export(const CStdString &image, const CStdString &destination, bool overwrite)
+{
+  // only a few exports are queued at a time, so memory doesn't grow with the size of the library
+  while (GetPending() >= ART_EXPORT_QUEUED)
+    m_done.WaitMSec(100);
+
+  {
+    // two jobs writing the same file would corrupt it
+    CSingleLock lock(m_pendingSection);
+    if (!m_destinations.insert(destination).second)
+      return;
+    m_pending++;
+  }
+  AddJob(new CArtExportJob(image, destination, overwrite));
+}
+
+void CArtExportQueue::Wait()
+{
+  while (GetPending() > 0)
+    m_done.WaitMSec(100);
+}
+
+void CArtExportQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CJobQueue::OnJobComplete(jobID, success, job);
+
+  CSingleLock lock(m_pendingSection);
+  m_pending--;
+  m_done.Set();
+}
+
+unsigned int CArtExportQueue::GetPending()
+{
+  CSingleLock lock(m_pendingSection);
+  return m_pending;
+}
+
+/*! \brief The peak resident memory of the process in kB, 0 where it's unknown */
+static long GetPeakMemory()
+{
+#if defined(TARGET_POSIX)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+#if defined(TARGET_DARWIN)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+  return 0;
+}
+
 void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = false */, bool images /* = false */, bool actorThumbs /* false */, bool overwrite /*=false*/)
 {
   CGUIDialogProgress *progress=NULL;
@@ -8396,6 +8720,52 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
       CDirectory::Create(tvshowsDir);
     }
 
+    unsigned int time = XbmcThreads::SystemClockMillis();
+    int items = 0;
+
+    // create our xml document, which only holds the item being exported. Unless we're exporting
+    // to single files, each item is appended to videodb.xml once it's complete.
+    CXBMCTinyXML xmlDoc;
+    TiXmlDeclaration decl("1.0", "UTF-8", "yes");
+    TiXmlNode *pMain = &xmlDoc;
+    CXMLStreamWriter writer;
+    CArtExportQueue artQueue;
+    if (singleFiles)
+      xmlDoc.InsertEndChild(decl);
+    else
+    {
+      if (!writer.Open(xmlFile, "videodb"))
+      {
+        CLog::Log(LOGERROR, "%s: Unable to create '%s'", __FUNCTION__, xmlFile.c_str());
+        return;
+      }
+      XMLUtils::SetInt(pMain,"version", GetExportVersion());
+
+      // now dump path info, ahead of the items so it's available first on import
+      set<CStdString> paths;
+      GetPaths(paths);
+      TiXmlElement xmlPathElement("paths");
+      TiXmlNode *pPaths = pMain->InsertEndChild(xmlPathElement);
+      for( set<CStdString>::iterator iter = paths.begin(); iter != paths.end(); ++iter)
+      {
+        bool foundDirectly = false;
+        SScanSettings settings;
+        ScraperPtr info = GetScraperForPath(*iter, settings, foundDirectly);
+        if (info && foundDirectly)
+        {
+          TiXmlElement xmlPathElement2("path");
+          TiXmlNode *pPath = pPaths->InsertEndChild(xmlPathElement2);
+          XMLUtils::SetString(pPath,"url", *iter);
+          XMLUtils::SetInt(pPath,"scanrecursive", settings.recurse);
+          XMLUtils::SetBoolean(pPath,"usefoldernames", settings.parent_name);
+          XMLUtils::SetString(pPath,"content", TranslateContent(info->Content()));
+          XMLUtils::SetString(pPath,"scraperpath", info->ID());
+        }
+      }
+      writer.Write(xmlDoc);
+      xmlDoc.Clear();
+    }
+
     progress = (CGUIDialogProgress *)g_windowManager.GetWindow(WINDOW_DIALOG_PROGRESS);
     // find all movies
     CStdString sql = "select * from movieview";
@@ -8416,20 +8786,6 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
     int total = m_pDS->num_rows();
     int current = 0;
 
-    // create our xml document
-    CXBMCTinyXML xmlDoc;
-    TiXmlDeclaration decl("1.0", "UTF-8", "yes");
-    xmlDoc.InsertEndChild(decl);
-    TiXmlNode *pMain = NULL;
-    if (singleFiles)
-      pMain = &xmlDoc;
-    else
-    {
-      TiXmlElement xmlMainElement("videodb");
-      pMain = xmlDoc.InsertEndChild(xmlMainElement);
-      XMLUtils::SetInt(pMain,"version", GetExportVersion());
-    }
-
     while (!m_pDS->eof())
     {
       CVideoInfoTag movie = GetDetailsForMovie(m_pDS, true);
@@ -8507,6 +8863,11 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
         TiXmlDeclaration decl("1.0", "UTF-8", "yes");
         xmlDoc.InsertEndChild(decl);
       }
+      else
+      {
+        writer.Write(xmlDoc);
+        xmlDoc.Clear();
+      }
 
       if (images && !bSkip)
       {
@@ -8520,13 +8881,14 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
         for (map<string, string>::const_iterator i = artwork.begin(); i != artwork.end(); ++i)
         {
           CStdString savedThumb = item.GetLocalArt(i->first, false);
-          CTextureCache::Get().Export(i->second, savedThumb, overwrite);
+          artQueue.Export(i->second, savedThumb, overwrite);
         }
         if (actorThumbs)
-          ExportActorThumbs(actorsDir, movie, singleFiles, overwrite);
+          ExportActorThumbs(actorsDir, movie, singleFiles, overwrite, &artQueue);
       }
       m_pDS->next();
       current++;
+      items++;
     }
     m_pDS->close();
 
@@ -8605,6 +8967,11 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
         TiXmlDeclaration decl("1.0", "UTF-8", "yes");
         xmlDoc.InsertEndChild(decl);
       }
+      else
+      {
+        writer.Write(xmlDoc);
+        xmlDoc.Clear();
+      }
       if (images && !bSkip)
       {
         if (!singleFiles)
@@ -8617,11 +8984,12 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
         for (map<string, string>::const_iterator i = artwork.begin(); i != artwork.end(); ++i)
         {
           CStdString savedThumb = item.GetLocalArt(i->first, false);
-          CTextureCache::Get().Export(i->second, savedThumb, overwrite);
+          artQueue.Export(i->second, savedThumb, overwrite);
         }
       }
       m_pDS->next();
       current++;
+      items++;
     }
     m_pDS->close();
 
@@ -8723,11 +9091,11 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
         for (map<string, string>::const_iterator i = artwork.begin(); i != artwork.end(); ++i)
         {
           CStdString savedThumb = item.GetLocalArt(i->first, true);
-          CTextureCache::Get().Export(i->second, savedThumb, overwrite);
+          artQueue.Export(i->second, savedThumb, overwrite);
         }
 
         if (actorThumbs)
-          ExportActorThumbs(actorsDir, tvshow, singleFiles, overwrite);
+          ExportActorThumbs(actorsDir, tvshow, singleFiles, overwrite, &artQueue);
 
         // export season thumbs
         for (map<int, map<string, string> >::const_iterator i = seasonArt.begin(); i != seasonArt.end(); ++i)
@@ -8743,7 +9111,7 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
           {
             CStdString savedThumb(item.GetLocalArt(seasonThumb + "-" + j->first, true));
             if (!i->second.empty())
-              CTextureCache::Get().Export(j->second, savedThumb, overwrite);
+              artQueue.Export(j->second, savedThumb, overwrite);
           }
         }
       }
@@ -8756,6 +9124,7 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
       while (!pDS->eof())
       {
         CVideoInfoTag episode = GetDetailsForEpisode(pDS, true);
+        items++;
         map<string, string> artwork;
         if (GetArtForItem(episode.m_iDbId, "episode", artwork) && !singleFiles)
         {
@@ -8774,6 +9143,7 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
                episode.m_iFileId == pDS->fv("idFile").get_asInt())
         {
           episode = GetDetailsForEpisode(pDS, true);
+          items++;
           episode.Save(pMain, "episodedetails", !singleFiles);
           pDS->next();
         }
@@ -8830,15 +9200,21 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
           for (map<string, string>::const_iterator i = artwork.begin(); i != artwork.end(); ++i)
           {
             CStdString savedThumb = item.GetLocalArt(i->first, false);
-            CTextureCache::Get().Export(i->second, savedThumb, overwrite);
+            artQueue.Export(i->second, savedThumb, overwrite);
           }
           if (actorThumbs)
-            ExportActorThumbs(actorsDir, episode, singleFiles, overwrite);
+            ExportActorThumbs(actorsDir, episode, singleFiles, overwrite, &artQueue);
         }
       }
       pDS->close();
+      if (!singleFiles)
+      { // the show with all its episodes
+        writer.Write(xmlDoc);
+        xmlDoc.Clear();
+      }
       m_pDS->next();
       current++;
+      items++;
     }
     m_pDS->close();
 
@@ -8848,31 +9224,15 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
       progress->Progress();
     }
 
-    if (!singleFiles)
-    {
-      // now dump path info
-      set<CStdString> paths;
-      GetPaths(paths);
-      TiXmlElement xmlPathElement("paths");
-      TiXmlNode *pPaths = pMain->InsertEndChild(xmlPathElement);
-      for( set<CStdString>::iterator iter = paths.begin(); iter != paths.end(); ++iter)
-      {
-        bool foundDirectly = false;
-        SScanSettings settings;
-        ScraperPtr info = GetScraperForPath(*iter, settings, foundDirectly);
-        if (info && foundDirectly)
-        {
-          TiXmlElement xmlPathElement2("path");
-          TiXmlNode *pPath = pPaths->InsertEndChild(xmlPathElement2);
-          XMLUtils::SetString(pPath,"url", *iter);
-          XMLUtils::SetInt(pPath,"scanrecursive", settings.recurse);
-          XMLUtils::SetBoolean(pPath,"usefoldernames", settings.parent_name);
-          XMLUtils::SetString(pPath,"content", TranslateContent(info->Content()));
-          XMLUtils::SetString(pPath,"scraperpath", info->ID());
-        }
-      }
-      xmlDoc.SaveFile(xmlFile);
-    }
+    if (!singleFiles && !writer.Close())
+      CLog::Log(LOGERROR, "%s: Writing '%s' failed", __FUNCTION__, xmlFile.c_str());
+
+    // wait for the art still being exported
+    artQueue.Wait();
+
+    time = XbmcThreads::SystemClockMillis() - time;
+    CLog::Log(LOGNOTICE, "%s: Exported %i items in %s (%.1f items/s), peak memory %li kB", __FUNCTION__,
+              items, StringUtils::SecondsToTimeString(time / 1000).c_str(), time ? items * 1000.0 / time : 0.0, GetPeakMemory());
   }
   catch (...)
   {
@@ -8883,7 +9243,7 @@ void CVideoDatabase::ExportToXML(const CStdString &path, bool singleFiles /* = f
     progress->Close();
 }
 
-void CVideoDatabase::ExportActorThumbs(const CStdString &strDir, const CVideoInfoTag &tag, bool singleFiles, bool overwrite /*=false*/)
+void CVideoDatabase::ExportActorThumbs(const CStdString &strDir, const CVideoInfoTag &tag, bool singleFiles, bool overwrite /*=false*/, CArtExportQueue *queue /* = NULL */)
 {
   CStdString strPath(strDir);
   if (singleFiles)
@@ -8903,7 +9263,10 @@ void CVideoDatabase::ExportActorThumbs(const CStdString &strDir, const CVideoInf
     if (!iter->thumb.IsEmpty())
     {
       CStdString thumbFile(GetSafeFile(strPath, iter->strName));
-      CTextureCache::Get().Export(iter->thumb, thumbFile, overwrite);
+      if (queue)
+        queue->Export(iter->thumb, thumbFile, overwrite);
+      else
+        CTextureCache::Get().Export(iter->thumb, thumbFile, overwrite);
     }
   }
 }
@@ -8932,13 +9295,12 @@ void CVideoDatabase::ImportFromXML(const CStdString &path)
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
-    CXBMCTinyXML xmlDoc;
-    if (!xmlDoc.LoadFile(URIUtils::AddFileToFolder(path, "videodb.xml")))
+    // the file is read one item at a time, as it can be larger than the memory available
+    CXMLStreamReader reader;
+    CStdString xmlFile = URIUtils::AddFileToFolder(path, "videodb.xml");
+    if (!reader.Open(xmlFile))
       return;
 
-    TiXmlElement *root = xmlDoc.RootElement();
-    if (!root) return;
-
     progress = (CGUIDialogProgress *)g_windowManager.GetWindow(WINDOW_DIALOG_PROGRESS);
     if (progress)
     {
@@ -8951,60 +9313,66 @@ void CVideoDatabase::ImportFromXML(const CStdString &path)
       progress->ShowProgressBar(true);
     }
 
+    unsigned int time = XbmcThreads::SystemClockMillis();
     int iVersion = 0;
-    XMLUtils::GetInt(root, "version", iVersion);
-
-    CLog::Log(LOGDEBUG, "%s: Starting import (export version = %i)", __FUNCTION__, iVersion);
-
-    TiXmlElement *movie = root->FirstChildElement();
     int current = 0;
-    int total = 0;
-    // first count the number of items...
-    while (movie)
-    {
-      if (strnicmp(movie->Value(), "movie", 5)==0 ||
-          strnicmp(movie->Value(), "tvshow", 6)==0 ||
-          strnicmp(movie->Value(), "musicvideo",10)==0 )
-        total++;
-      movie = movie->NextSiblingElement();
-    }
 
     CStdString actorsDir(URIUtils::AddFileToFolder(path, "actors"));
     CStdString moviesDir(URIUtils::AddFileToFolder(path, "movies"));
     CStdString musicvideosDir(URIUtils::AddFileToFolder(path, "musicvideos"));
     CStdString tvshowsDir(URIUtils::AddFileToFolder(path, "tvshows"));
     CVideoInfoScanner scanner;
-    // add paths first (so we have scraper settings available)
-    TiXmlElement *path = root->FirstChildElement("paths");
-    path = path->FirstChildElement();
-    while (path)
-    {
-      CStdString strPath;
-      if (XMLUtils::GetString(path,"url",strPath) && !strPath.empty())
-        AddPath(strPath);
-
-      CStdString content;
-      if (XMLUtils::GetString(path,"content", content) && !content.empty())
-      { // check the scraper exists, if so store the path
-        AddonPtr addon;
-        CStdString id;
-        XMLUtils::GetString(path,"scraperpath",id);
-        if (CAddonMgr::Get().GetAddon(id, addon))
-        {
-          SScanSettings settings;
-          ScraperPtr scraper = boost::dynamic_pointer_cast<CScraper>(addon);
-          // FIXME: scraper settings are not exported?
-          scraper->SetPathSettings(TranslateContent(content), "");
-          XMLUtils::GetInt(path,"scanrecursive",settings.recurse);
-          XMLUtils::GetBoolean(path,"usefoldernames",settings.parent_name);
-          SetScraperForPath(strPath,scraper,settings);
+    // add paths first (so we have scraper settings available). They come before the items in
+    // newer exports, older ones have them at the end so we read the file twice.
+    CXBMCTinyXML xmlDoc;
+    while (reader.Next(xmlDoc))
+    {
+      TiXmlElement *root = xmlDoc.RootElement();
+      if (strcmp(root->Value(), "version") == 0 && root->GetText())
+        iVersion = atoi(root->GetText());
+      if (strcmp(root->Value(), "paths") != 0)
+        continue;
+
+      TiXmlElement *pathElement = root->FirstChildElement();
+      while (pathElement)
+      {
+        CStdString strPath;
+        if (XMLUtils::GetString(pathElement,"url",strPath) && !strPath.empty())
+          AddPath(strPath);
+
+        CStdString content;
+        if (XMLUtils::GetString(pathElement,"content", content) && !content.empty())
+        { // check the scraper exists, if so store the path
+          AddonPtr addon;
+          CStdString id;
+          XMLUtils::GetString(pathElement,"scraperpath",id);
+          if (CAddonMgr::Get().GetAddon(id, addon))
+          {
+            SScanSettings settings;
+            ScraperPtr scraper = boost::dynamic_pointer_cast<CScraper>(addon);
+            // FIXME: scraper settings are not exported?
+            scraper->SetPathSettings(TranslateContent(content), "");
+            XMLUtils::GetInt(pathElement,"scanrecursive",settings.recurse);
+            XMLUtils::GetBoolean(pathElement,"usefoldernames",settings.parent_name);
+            SetScraperForPath(strPath,scraper,settings);
+          }
         }
+        pathElement = pathElement->NextSiblingElement();
       }
-      path = path->NextSiblingElement();
+      break;
+    }
+
+    CLog::Log(LOGDEBUG, "%s: Starting import (export version = %i)", __FUNCTION__, iVersion);
+
+    if (!reader.Open(xmlFile))
+    {
+      if (progress)
+        progress->Close();
+      return;
     }
-    movie = root->FirstChildElement();
-    while (movie)
+    while (reader.Next(xmlDoc))
     {
+      TiXmlElement *movie = xmlDoc.RootElement();
       CVideoInfoTag info;
       if (strnicmp(movie->Value(), "movie", 5) == 0)
       {
@@ -9079,10 +9447,9 @@ void CVideoDatabase::ImportFromXML(const CStdString &path)
           episode = episode->NextSiblingElement("episodedetails");
         }
       }
-      movie = movie->NextSiblingElement();
-      if (progress && total)
+      if (progress && reader.GetLength())
       {
-        progress->SetPercentage(current * 100 / total);
+        progress->SetPercentage((int)(reader.GetPosition() * 100 / reader.GetLength()));
         progress->SetLine(2, info.m_strTitle);
         progress->Progress();
         if (progress->IsCanceled())
@@ -9093,6 +9460,10 @@ void CVideoDatabase::ImportFromXML(const CStdString &path)
         }
       }
     }
+
+    time = XbmcThreads::SystemClockMillis() - time;
+    CLog::Log(LOGNOTICE, "%s: Imported %i items in %s (%.1f items/s), peak memory %li kB", __FUNCTION__,
+              current, StringUtils::SecondsToTimeString(time / 1000).c_str(), time ? current * 1000.0 / time : 0.0, GetPeakMemory());
   }
   catch (...)
   {
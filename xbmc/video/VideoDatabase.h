@@ -33,6 +33,7 @@ class CFileItemList;
 class CVideoSettings;
 class CGUIDialogProgress;
 class CGUIDialogProgressBarHandle;
+class CArtExportQueue;
 
 namespace dbiplus
 {
@@ -641,7 +642,7 @@ public:
 
   void ExportToXML(const CStdString &path, bool singleFiles = false, bool images=false, bool actorThumbs=false, bool overwrite=false);
   bool ExportSkipEntry(const CStdString &nfoFile);
-  void ExportActorThumbs(const CStdString &path, const CVideoInfoTag& tag, bool singleFiles, bool overwrite=false);
+  void ExportActorThumbs(const CStdString &path, const CVideoInfoTag& tag, bool singleFiles, bool overwrite=false, CArtExportQueue *queue=NULL);
   void ImportFromXML(const CStdString &path);
   void DumpToDummyFiles(const CStdString &path);
   bool ImportArtFromXML(const TiXmlNode *node, std::map<std::string, std::string> &artwork);
@@ -790,6 +791,25 @@ private:
    */
   virtual void CreateViews();
 
+  /*! \brief Create the full-text indexes of titles, plots and people, and the triggers
+   keeping them up to date
+   */
+  void CreateSearchIndexes();
+
+  /*! \brief (Re)create the triggers updating the full-text indexes, they only run on updates of indexed columns
+   */
+  void CreateSearchUpdateTriggers();
+
+  /*! \brief Condition matching the rows whose full-text index entry contains the search
+   \param table the full-text index
+   \param column the indexed column to search
+   \param idColumn the id column of the searched rows
+   \param search the search text
+   \param fallback condition to use if there is no full-text index
+   */
+  CStdString GetSearchCondition(const std::string &table, const std::string &column, const std::string &idColumn,
+                                const CStdString &search, const CStdString &fallback);
+
   /*! \brief Run a query on the main dataset and return the number of rows
    If no rows are found we close the dataset and return 0.
    \param sql the sql query to run
@@ -90,10 +90,16 @@ CGUIMediaWindow::CGUIMediaWindow(int id, const char *xmlFile)
   m_loadType = KEEP_IN_MEMORY;
   m_vecItems = new CFileItemList;
   m_unfilteredItems = new CFileItemList;
+  m_loadingItems = new CFileItemList;
   m_vecItems->SetPath("?");
   m_iLastControl = -1;
   m_iSelectedItem = -1;
   m_canFilterAdvanced = false;
+  m_loading = false;
+  m_loadingCancelled = false;
+  m_loadingStart = 0;
+  m_loadingShown = 0;
+  m_loadingSorted = 0;
 
   m_guiState.reset(CGUIViewState::GetViewState(GetID(), *m_vecItems));
 }
@@ -102,6 +108,7 @@ CGUIMediaWindow::~CGUIMediaWindow()
 {
   delete m_vecItems;
   delete m_unfilteredItems;
+  delete m_loadingItems;
 }
 
 #define CONTROL_VIEW_START        50
@@ -156,12 +163,15 @@ void CGUIMediaWindow::OnWindowUnload()
 
 CFileItemPtr CGUIMediaWindow::GetCurrentListItem(int offset)
 {
+  // the items of a directory being listed are shown instead of the current ones
+  CFileItemList &items = (m_loading && m_loadingShown) ? *m_loadingItems : *m_vecItems;
+
   int item = m_viewControl.GetSelectedItem();
-  if (!m_vecItems->Size() || item < 0)
+  if (!items.Size() || item < 0)
     return CFileItemPtr();
-  item = (item + offset) % m_vecItems->Size();
-  if (item < 0) item += m_vecItems->Size();
-  return m_vecItems->Get(item);
+  item = (item + offset) % items.Size();
+  if (item < 0) item += items.Size();
+  return items.Get(item);
 }
 
 bool CGUIMediaWindow::OnAction(const CAction &action)
@@ -232,6 +242,9 @@ bool CGUIMediaWindow::OnMessage(CGUIMessage& message)
   {
   case GUI_MSG_WINDOW_DEINIT:
     {
+      // stop listing a directory, it won't be shown
+      m_loadingCancelled = true;
+
       m_iSelectedItem = m_viewControl.GetSelectedItem();
       m_iLastControl = GetFocusedControlID();
       CGUIWindow::OnMessage(message);
@@ -691,6 +704,18 @@ bool CGUIMediaWindow::GetDirectory(const CStdString &strDirectory, CFileItemList
     items.AddFront(pItem, 0);
   }
 
+  RemoveExcludedItems(items);
+
+  // clear the filter
+  SetProperty("filter", "");
+  m_canFilterAdvanced = false;
+  m_filter.Reset();
+  return true;
+}
+
+// \brief Removes the items excluded from listings in advancedsettings.xml
+void CGUIMediaWindow::RemoveExcludedItems(CFileItemList &items)
+{
   int iWindow = GetID();
   CStdStringArray regexps;
 
@@ -712,12 +737,6 @@ bool CGUIMediaWindow::GetDirectory(const CStdString &strDirectory, CFileItemList
         i++;
     }
   }
-
-  // clear the filter
-  SetProperty("filter", "");
-  m_canFilterAdvanced = false;
-  m_filter.Reset();
-  return true;
 }
 
 // \brief Set window to a specific directory
@@ -756,9 +775,32 @@ bool CGUIMediaWindow::Update(const CStdString &strDirectory, bool updateFilterPa
     directory = RemoveParameterFromPath(directory, "filter");
   }
 
+  // show the items of slow listings while they're listed
+  m_loadingItems->Clear();
+  m_loadingItems->SetPath(directory);
+  m_loading = true;
+  m_loadingCancelled = false;
+  m_loadingStart = XbmcThreads::SystemClockMillis();
+  m_loadingShown = 0;
+  m_loadingSorted = 0;
+
   CFileItemList items;
-  if (!GetDirectory(directory, items))
+  m_rootDir.SetListingCallback(this);
+  bool result = GetDirectory(directory, items);
+  m_rootDir.SetListingCallback(NULL);
+  m_loading = false;
+
+  if (!result)
   {
+    m_loadingItems->Clear();
+
+    // the window was closed while listing, don't start over somewhere else
+    if (m_loadingCancelled)
+    {
+      CLog::Log(LOGDEBUG,"CGUIMediaWindow::GetDirectory(%s) cancelled", strDirectory.c_str());
+      return false;
+    }
+
     CLog::Log(LOGERROR,"CGUIMediaWindow::GetDirectory(%s) failed", strDirectory.c_str());
     // Try to return to the previous directory, if not the same
     // else fallback to root
@@ -902,11 +944,56 @@ bool CGUIMediaWindow::Update(const CStdString &strDirectory, bool updateFilterPa
   if (iWindow != WINDOW_PVR || (iWindow == WINDOW_PVR && m_vecItems->GetPath().Left(17) == "pvr://recordings/"))
     m_history.AddPath(m_vecItems->GetPath(), m_strFilterPath);
 
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - m_loadingStart;
+  if (m_loadingShown)
+    CLog::Log(LOGDEBUG, "CGUIMediaWindow::Update(%s) - first items shown after %u ms, all %i after %u ms",
+              strDirectory.c_str(), m_loadingShown - m_loadingStart, m_vecItems->Size(), elapsed);
+  else
+    CLog::Log(LOGDEBUG, "CGUIMediaWindow::Update(%s) - %i items shown after %u ms", strDirectory.c_str(), m_vecItems->Size(), elapsed);
+  m_loadingItems->Clear();
+
   //m_history.DumpPathHistory();
 
   return true;
 }
 
+bool CGUIMediaWindow::OnPartialListing(const CFileItemList &items)
+{
+  if (m_loadingCancelled)
+    return false;
+  if (!m_loading || items.IsEmpty())
+    return true;
+
+  // the items are copies, so they can be formatted like the final list will be
+  CFileItemList batch;
+  batch.Append(items);
+  RemoveExcludedItems(batch);
+  auto_ptr<CGUIViewState> viewState(CGUIViewState::GetViewState(GetID(), *m_loadingItems));
+  if (viewState.get())
+  {
+    LABEL_MASKS labelMasks;
+    viewState->GetSortMethodLabelMasks(labelMasks);
+    FormatItemLabels(batch, labelMasks);
+  }
+  batch.FillInDefaultIcons();
+  m_loadingItems->Append(batch);
+
+  // sorting all the items each time the list has grown by half adds up to a few sorts of the
+  // whole list, rather than one per batch
+  if (m_loadingItems->IsEmpty() || (m_loadingSorted && m_loadingItems->Size() < m_loadingSorted * 3 / 2))
+    return true;
+
+  SortItems(*m_loadingItems);
+  m_loadingSorted = m_loadingItems->Size();
+  m_viewControl.SetItems(*m_loadingItems);
+  if (!m_loadingShown)
+  {
+    m_viewControl.SetSelectedItem(0);
+    m_loadingShown = XbmcThreads::SystemClockMillis();
+  }
+  return true;
+}
+
 bool CGUIMediaWindow::Refresh(bool clearCache /* = false */)
 {
   CStdString strCurrentDirectory = m_vecItems->GetPath();
@@ -31,7 +31,7 @@
 class CFileItemList;
 
 // base class for all media windows
-class CGUIMediaWindow : public CGUIWindow
+class CGUIMediaWindow : public CGUIWindow, public XFILE::CDirectory::IListingCallback
 {
 public:
   CGUIMediaWindow(int id, const char *xmlFile);
@@ -52,6 +52,11 @@ public:
   virtual bool CanFilterAdvanced() { return m_canFilterAdvanced; }
   virtual bool IsFiltered();
 
+  /*! \brief Show the items of the directory Update() is listing as they arrive
+   \sa XFILE::CDirectory::IListingCallback
+   */
+  virtual bool OnPartialListing(const CFileItemList &items);
+
 protected:
   virtual void LoadAdditionalTags(TiXmlElement *root);
   CGUIControl *GetFirstFocusableControl(int id);
@@ -90,6 +95,7 @@ protected:
   virtual void OnCacheFileItems(CFileItemList &items);
   virtual void OnFinalizeFileItems(CFileItemList &items);
   virtual void GetGroupedItems(CFileItemList &items) { }
+  void RemoveExcludedItems(CFileItemList &items);
 
   void ClearFileItems();
   virtual void SortItems(CFileItemList &items);
@@ -185,4 +191,17 @@ protected:
    \sa Update
    */
   CStdString m_strFilterPath;
+
+  /*! \brief Items of the directory Update() is listing, shown until the listing is done
+
+   They are formatted and sorted like the final list, but not prepared by OnPrepareFileItems(),
+   and input is kept away from them by the busy dialog. Backing out of the busy dialog or closing
+   the window cancels the listing.
+   */
+  CFileItemList* m_loadingItems;
+  bool m_loading;               ///< Update() is listing a directory
+  bool m_loadingCancelled;
+  unsigned int m_loadingStart;  ///< time Update() started
+  unsigned int m_loadingShown;  ///< time the first items were shown, 0 if none were
+  int m_loadingSorted;          ///< number of items in the last sort of m_loadingItems
 };